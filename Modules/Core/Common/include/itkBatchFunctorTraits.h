@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBatchFunctorTraits_h
+#define itkBatchFunctorTraits_h
+
+#include "itkImage.h"
+#include "itkMetaProgrammingLibrary.h"
+#include <utility>
+
+namespace itk
+{
+namespace Functor
+{
+
+/** \class UnaryBatchFunctorTraits
+ * \brief Detects whether a unary pixel functor supports batch processing.
+ *
+ * In addition to its per-pixel operator(), a functor may provide
+ * \code
+ * void ProcessBatch(const TInput * input, TOutput * output, SizeValueType count) const;
+ * \endcode
+ * which computes \c count contiguous output pixels at once. The pixel-wise
+ * filters then call it once per scanline instead of calling operator() per
+ * pixel through the image iterators. A plain loop over raw pointers is
+ * readily vectorized by the compiler for the target instruction set.
+ *
+ * ProcessBatch must produce the same values as operator(), and must support
+ * \c input and \c output pointing to the same buffer (in-place filtering).
+ *
+ * \sa BinaryBatchFunctorTraits
+ * \ingroup ITKCommon
+ */
+template< typename TFunctor, typename TInput, typename TOutput >
+class UnaryBatchFunctorTraits
+{
+  template< typename F >
+  static auto Test(int) -> decltype( std::declval< const F & >().ProcessBatch(
+      std::declval< const TInput * >(), std::declval< TOutput * >(), SizeValueType() ), mpl::TrueType() );
+  template< typename F >
+  static mpl::FalseType Test(...);
+
+public:
+  using Type = decltype( Test< TFunctor >(0) );
+  static constexpr bool Value = Type::Value;
+};
+
+/** \class BinaryBatchFunctorTraits
+ * \brief Detects whether a binary pixel functor supports batch processing.
+ *
+ * The batch method of a binary functor has the signature
+ * \code
+ * void ProcessBatch(const TInput1 * input1, const TInput2 * input2,
+ *                   TOutput * output, SizeValueType count) const;
+ * \endcode
+ *
+ * \sa UnaryBatchFunctorTraits
+ * \ingroup ITKCommon
+ */
+template< typename TFunctor, typename TInput1, typename TInput2, typename TOutput >
+class BinaryBatchFunctorTraits
+{
+  template< typename F >
+  static auto Test(int) -> decltype( std::declval< const F & >().ProcessBatch(
+      std::declval< const TInput1 * >(), std::declval< const TInput2 * >(),
+      std::declval< TOutput * >(), SizeValueType() ), mpl::TrueType() );
+  template< typename F >
+  static mpl::FalseType Test(...);
+
+public:
+  using Type = decltype( Test< TFunctor >(0) );
+  static constexpr bool Value = Type::Value;
+};
+
+} // end namespace Functor
+
+/** \class ImageHasContiguousPixels
+ * \brief Whether the pixels of an image type are stored as a contiguous
+ * array of PixelType, so that a scanline can be accessed through a
+ * PixelType pointer.
+ *
+ * This holds for itk::Image, but not for VectorImage (whose pixels are
+ * views on the buffer) or ImageAdaptor (whose pixels go through an
+ * accessor).
+ *
+ * \ingroup ITKCommon
+ */
+template< typename TImage >
+struct ImageHasContiguousPixels: public mpl::FalseType
+{};
+
+/// \cond SPECIALIZATION_IMPLEMENTATION
+template< typename TPixel, unsigned int VImageDimension >
+struct ImageHasContiguousPixels< Image< TPixel, VImageDimension > >: public mpl::TrueType
+{};
+/// \endcond
+
+} // end namespace itk
+
+#endif
@@ -346,6 +346,14 @@ public:
    * by a filter.  */
   bool ShouldIReleaseData() const;
 
+  /** Return the number of bytes needed to hold the data of the requested
+   * region. Used by PipelineMemoryPlanner to plan the buffers of a
+   * pipeline. The default implementation returns 0, meaning unknown. */
+  virtual SizeValueType GetRequestedRegionMemorySize() const
+  {
+    return 0;
+  }
+
   /** Get the flag indicating the data has been released.  */
   bool GetDataReleased() const
   { return m_DataReleased; }
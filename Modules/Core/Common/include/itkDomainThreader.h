@@ -20,6 +20,8 @@
 
 #include "itkObject.h"
 #include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+#include <atomic>
 
 namespace itk
 {
@@ -107,6 +109,16 @@ public:
   ThreadIdType GetMaximumNumberOfThreads() const;
   void SetMaximumNumberOfThreads( const ThreadIdType threads );
 
+  /** Number of subdomains per thread the domain is partitioned into. With
+   * the default of 1, each thread processes exactly one subdomain. With
+   * larger values, the threads repeatedly claim the next unprocessed
+   * subdomain until all are done, which balances the load when the cost of
+   * processing varies over the domain (e.g. masked regions). In that case
+   * \c ThreadedExecution is called several times with the same \c threadId,
+   * and must accumulate its per-thread results rather than overwrite them. */
+  itkSetClampMacro( PiecesPerThread, ThreadIdType, 1, NumericTraits< ThreadIdType >::max() );
+  itkGetConstMacro( PiecesPerThread, ThreadIdType );
+
 protected:
   DomainThreader();
   ~DomainThreader() override;
@@ -152,6 +164,8 @@ private:
   struct ThreadStruct
     {
     DomainThreader     * domainThreader;
+    ThreadIdType         numberOfPieces;
+    std::atomic< ThreadIdType > nextPiece;
     };
 
   /** Store the actual number of threads used, which may be less than
@@ -159,6 +173,7 @@ private:
    * well into that number.
    * This value is determined at the beginning of \c Execute(). */
   ThreadIdType                             m_NumberOfThreadsUsed;
+  ThreadIdType                             m_PiecesPerThread;
   typename DomainPartitionerType::Pointer  m_DomainPartitioner;
   DomainType                               m_CompleteDomain;
   MultiThreaderBase::Pointer               m_MultiThreader;
@@ -30,6 +30,7 @@ DomainThreader< TDomainPartitioner, TAssociate >
   this->m_DomainPartitioner   = DomainPartitionerType::New();
   this->m_MultiThreader       = MultiThreaderBase::New();
   this->m_NumberOfThreadsUsed = 0;
+  this->m_PiecesPerThread     = 1;
   this->m_Associate           = nullptr;
 }
 
@@ -122,6 +123,17 @@ DomainThreader< TDomainPartitioner, TAssociate >
   // Set up the multithreaded processing
   ThreadStruct str;
   str.domainThreader = this;
+  str.numberOfPieces = 0;
+  str.nextPiece = 0;
+  if( this->m_PiecesPerThread > 1 && this->m_NumberOfThreadsUsed > 1 )
+    {
+    // Over-decompose the domain, the threads pull the subdomains on demand.
+    DomainType subdomain;
+    str.numberOfPieces = this->m_DomainPartitioner->PartitionDomain(0,
+                                            this->m_NumberOfThreadsUsed * this->m_PiecesPerThread,
+                                            this->m_CompleteDomain,
+                                            subdomain);
+    }
 
   MultiThreaderBase* multiThreader = this->GetMultiThreader();
   multiThreader->SetSingleMethod(this->ThreaderCallback, &str);
@@ -141,6 +153,24 @@ DomainThreader< TDomainPartitioner, TAssociate >
   const ThreadIdType threadId    = info->ThreadID;
   const ThreadIdType threadCount = info->NumberOfThreads;
 
+  if ( str->numberOfPieces > 0 )
+    {
+    // Process subdomains until there are none left.
+    DomainType subdomain;
+    for ( ThreadIdType piece = str->nextPiece++; piece < str->numberOfPieces; piece = str->nextPiece++ )
+      {
+      const ThreadIdType total = thisDomainThreader->GetDomainPartitioner()->PartitionDomain(piece,
+                                                str->numberOfPieces,
+                                                thisDomainThreader->m_CompleteDomain,
+                                                subdomain);
+      if ( piece < total )
+        {
+        thisDomainThreader->ThreadedExecution( subdomain, threadId );
+        }
+      }
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
   // Get the sub-domain to process for this thread.
   DomainType subdomain;
   const ThreadIdType total = thisDomainThreader->GetDomainPartitioner()->PartitionDomain(threadId,
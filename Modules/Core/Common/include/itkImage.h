@@ -276,6 +276,9 @@ public:
 
   unsigned int GetNumberOfComponentsPerPixel() const override;
 
+  /** Return the number of bytes of the pixels of the requested region. */
+  ::itk::SizeValueType GetRequestedRegionMemorySize() const override;
+
 protected:
   Image();
   void PrintSelf(std::ostream & os, Indent indent) const override;
@@ -164,6 +164,14 @@ Image< TPixel, VImageDimension >
   return NumericTraits< PixelType >::GetLength(p);
 }
 
+template< typename TPixel, unsigned int VImageDimension >
+SizeValueType
+Image< TPixel, VImageDimension >
+::GetRequestedRegionMemorySize() const
+{
+  return this->GetRequestedRegion().GetNumberOfPixels() * sizeof( PixelType );
+}
+
 
 template< typename TPixel, unsigned int VImageDimension >
 void
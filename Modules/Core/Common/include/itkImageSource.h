@@ -32,6 +32,9 @@
 #include "itkImage.h"
 #include "itkImageRegionSplitterBase.h"
 #include "itkImageSourceCommon.h"
+#include "itkNumericTraits.h"
+#include <atomic>
+#include <thread>
 
 namespace itk
 {
@@ -217,6 +220,18 @@ public:
   ProcessObject::DataObjectPointer MakeOutput(ProcessObject::DataObjectPointerArraySizeType idx) override;
   ProcessObject::DataObjectPointer MakeOutput(const ProcessObject::DataObjectIdentifierType &) override;
 
+  /** Number of pieces per thread the requested region is split into when
+   * DynamicMultiThreading is on. With the default of 1, the region is
+   * handed to the MultiThreader's ParallelizeImageRegion. With larger
+   * values, the region is over-decomposed by the ImageRegionSplitter into
+   * NumberOfThreads * PiecesPerThread pieces, which the threads pull one
+   * at a time as they become idle. This balances the load of filters whose
+   * cost per pixel varies over the image (e.g. masked or out-of-bounds
+   * pixels which are skipped), at the cost of more calls to
+   * DynamicThreadedGenerateData(). */
+  itkSetClampMacro(PiecesPerThread, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(PiecesPerThread, unsigned int);
+
 protected:
   ImageSource();
   ~ImageSource() override {}
@@ -369,6 +384,24 @@ protected:
     Pointer Filter;
   };
 
+  /** Static function used as a "callback" by the MultiThreader when the
+   * region is over-decomposed (PiecesPerThread > 1). Each thread repeatedly
+   * claims the next unprocessed piece and calls DynamicThreadedGenerateData()
+   * on it, until all the pieces are done. */
+  static ITK_THREAD_RETURN_TYPE DynamicPiecesThreaderCallback(void *arg);
+
+  /** Internal structure shared by the threads pulling pieces. */
+  struct DynamicPiecesThreadStruct
+  {
+    Self *                       Filter;
+    OutputImageRegionType        Region;
+    unsigned int                 NumberOfPieces;
+    std::atomic< unsigned int >  NextPiece;
+    SizeValueType                NumberOfPixels;
+    std::atomic< SizeValueType > PixelProgress;
+    std::thread::id              CallingThread;
+  };
+
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
   /** Whether to use classic multi-threading infrastructure (OFF by default).
@@ -379,6 +412,9 @@ protected:
   itkBooleanMacro(DynamicMultiThreading);
 
   bool m_DynamicMultiThreading;
+
+private:
+  unsigned int m_PiecesPerThread;
 };
 } // end namespace itk
 
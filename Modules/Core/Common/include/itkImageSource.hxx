@@ -35,6 +35,8 @@
 
 #include "itkMath.h"
 
+#include <algorithm>
+
 namespace itk
 {
 template< typename TOutputImage >
@@ -53,6 +55,7 @@ ImageSource< TOutputImage >
 #else
   m_DynamicMultiThreading = true;
 #endif
+  m_PiecesPerThread = 1;
 
   // Set the default behavior of an image source to NOT release its
   // output bulk data prior to GenerateData() in case that bulk data
@@ -236,6 +239,36 @@ ImageSource< TOutputImage >
     {
     this->ClassicMultiThread(this->ThreaderCallback);
     }
+  else if (m_PiecesPerThread > 1 && this->GetNumberOfThreads() > 1)
+    {
+    this->UpdateProgress(0.0f);
+
+    DynamicPiecesThreadStruct str;
+    str.Filter = this;
+    str.Region = this->GetOutput()->GetRequestedRegion();
+    str.NumberOfPieces = this->GetImageRegionSplitter()->GetNumberOfSplits(
+        str.Region, this->GetNumberOfThreads() * m_PiecesPerThread);
+    str.NextPiece = 0;
+    str.NumberOfPixels = str.Region.GetNumberOfPixels();
+    str.PixelProgress = 0;
+    str.CallingThread = std::this_thread::get_id();
+
+    this->GetMultiThreader()->SetNumberOfThreads(
+        std::min(this->GetNumberOfThreads(), str.NumberOfPieces));
+    this->GetMultiThreader()->SetSingleMethod(this->DynamicPiecesThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    this->UpdateProgress(1.0f);
+    if (this->GetAbortGenerateData())
+      {
+      std::string msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "AbortGenerateData was called in " + std::string(this->GetNameOfClass() )
+          + " during multi-threaded part of filter execution";
+      e.SetDescription(msg);
+      throw e;
+      }
+    }
   else
     {
     this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
@@ -306,6 +339,45 @@ ImageSource< TOutputImage >
   return ITK_THREAD_RETURN_VALUE;
 }
 
+// Callback routine used when the requested region is over-decomposed. Every
+// thread pulls pieces until there are none left, so that threads which
+// happen to get cheap pieces take over more of the work.
+template< typename TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ImageSource< TOutputImage >
+::DynamicPiecesThreaderCallback(void *arg)
+{
+  using ThreadInfo = MultiThreaderBase::ThreadInfoStruct;
+  ThreadInfo * threadInfo = static_cast<ThreadInfo *>(arg);
+  auto * str = static_cast<DynamicPiecesThreadStruct *>(threadInfo->UserData);
+  Self * filter = str->Filter;
+
+  for ( unsigned int piece = str->NextPiece++; piece < str->NumberOfPieces; piece = str->NextPiece++ )
+    {
+    if ( filter->GetAbortGenerateData() )
+      {
+      std::string msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+          + " during multi-threaded part of filter execution";
+      e.SetDescription(msg);
+      throw e;
+      }
+
+    OutputImageRegionType pieceRegion = str->Region;
+    filter->GetImageRegionSplitter()->GetSplit(piece, str->NumberOfPieces, pieceRegion);
+    filter->DynamicThreadedGenerateData(pieceRegion);
+
+    str->PixelProgress += pieceRegion.GetNumberOfPixels();
+    //make sure we are updating progress only from the thead which invoked filter->Update();
+    if ( str->CallingThread == std::this_thread::get_id() )
+      {
+      filter->UpdateProgress(float(str->PixelProgress) / str->NumberOfPixels);
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template<typename TOutputImage>
 void
 ImageSource<TOutputImage>
@@ -314,6 +386,7 @@ ImageSource<TOutputImage>
   Superclass::PrintSelf(os, indent);
   os << indent << "DynamicMultiThreading: "
       << (m_DynamicMultiThreading ? "On" : "Off") << std::endl;
+  os << indent << "PiecesPerThread: " << m_PiecesPerThread << std::endl;
 }
 
 } // end namespace itk
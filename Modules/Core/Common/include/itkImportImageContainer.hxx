@@ -29,6 +29,10 @@
 #define itkImportImageContainer_hxx
 
 #include "itkImportImageContainer.h"
+#include "itkPixelBufferPool.h"
+#include <memory>
+#include <new>
+#include <type_traits>
 
 namespace itk
 {
@@ -179,7 +183,29 @@ TElement *ImportImageContainer< TElementIdentifier, TElement >
 
   try
     {
-    if ( UseDefaultConstructor )
+    // Recycle the buffers of pixels which need no destructor while a
+    // pipeline memory planner executes.
+    void *pooled = nullptr;
+    if ( std::is_trivially_destructible< TElement >::value && PixelBufferPool::IsActive() )
+      {
+      pooled = PixelBufferPool::Allocate(sizeof( TElement ) * static_cast< std::size_t >( size ));
+      }
+    if ( pooled )
+      {
+      data = static_cast< TElement * >( pooled );
+      if ( UseDefaultConstructor )
+        {
+        std::uninitialized_fill_n(data, size, TElement());
+        }
+      else
+        {
+        for ( ElementIdentifier i = 0; i < size; ++i )
+          {
+          new( data + i ) TElement;
+          }
+        }
+      }
+    else if ( UseDefaultConstructor )
       {
       data = new TElement[size](); //POD types initialized to 0, others use default constructor.
       }
@@ -208,7 +234,7 @@ void ImportImageContainer< TElementIdentifier, TElement >
 ::DeallocateManagedMemory()
 {
   // Encapsulate all image memory deallocation here
-  if ( m_ContainerManageMemory )
+  if ( m_ContainerManageMemory && !PixelBufferPool::Release(m_ImportPointer) )
     {
     delete[] m_ImportPointer;
     }
@@ -34,6 +34,7 @@
 #include "itkIntTypes.h"
 #include "itkImageRegion.h"
 #include "itkImageIORegion.h"
+#include <atomic>
 #include <functional>
 #include <thread>
 
@@ -98,7 +99,7 @@ public:
 
   /** Currently supported types of multi-threader implementations.
    * Last will change with additional implementations. */
-  enum ThreaderType { Platform = 0, First = Platform, Pool, TBB, Last = TBB, Unknown = -1 };
+  enum ThreaderType { Platform = 0, First = Platform, Pool, TBB, WorkStealing, Last = WorkStealing, Unknown = -1 };
 
   /** Convert a threader name into its enum type. */
   static ThreaderType ThreaderTypeFromString(std::string threaderString);
@@ -117,6 +118,9 @@ public:
       case ThreaderType::TBB:
         return "TBB";
         break;
+      case ThreaderType::WorkStealing:
+        return "WorkStealing";
+        break;
       default:
         return "Unknown";
         break;
@@ -127,6 +131,7 @@ public:
    *
    * The default multi-threader type is picked up from ITK_GLOBAL_DEFAULT_THEADER
    * environment variable. Example ITK_GLOBAL_DEFAULT_THEADER=TBB
+   * or ITK_GLOBAL_DEFAULT_THEADER=WorkStealing
    * A deprecated ITK_USE_THREADPOOL environment variable is also examined,
    * but it can only choose Pool or Platform multi-threader.
    * Platform multi-threader should be avoided,
@@ -210,6 +215,50 @@ public:
       ThreadingFunctorType funcP,
       ProcessObject* filter);
 
+  using ArrayThreadingFunctorType = std::function<void(SizeValueType)>;
+  using ArrayRangeThreadingFunctorType = std::function<void(SizeValueType, SizeValueType)>;
+
+  /** Parallelize an operation over an array, i.e. call the function once
+   * for every index in [firstIndex, lastIndexPlus1). Contiguous indices are
+   * grouped into chunks of at least ArrayGrainSize elements.
+   * If filter argument is not nullptr, this function will update its progress
+   * as each chunk is completed. */
+  void ParallelizeArray(
+      SizeValueType firstIndex,
+      SizeValueType lastIndexPlus1,
+      ArrayThreadingFunctorType aFunc,
+      ProcessObject* filter)
+  {
+    this->ParallelizeArrayRange(firstIndex, lastIndexPlus1,
+        [aFunc](SizeValueType chunkFirst, SizeValueType chunkLastPlus1)
+    {
+      for (SizeValueType i = chunkFirst; i < chunkLastPlus1; ++i)
+        {
+        aFunc(i);
+        }
+    },
+        filter);
+  }
+
+  /** Break up [firstIndex, lastIndexPlus1) into chunks, and call the function
+   * with the first index and one past the last index of each chunk.
+   * This overload does the actual work and should be implemented by derived
+   * classes. The default implementation hands out chunks on demand to the
+   * threads started by SingleMethodExecute. */
+  virtual void ParallelizeArrayRange(
+      SizeValueType firstIndex,
+      SizeValueType lastIndexPlus1,
+      ArrayRangeThreadingFunctorType aFunc,
+      ProcessObject* filter);
+
+  /** Set/Get the minimum number of consecutive array elements processed as one
+   * chunk by ParallelizeArray and ParallelizeArrayRange. Larger values reduce
+   * the scheduling overhead for cheap per-element operations, smaller values
+   * improve load balancing. The default value of zero lets the multi-threader
+   * pick a grain size from the array size and the number of threads. */
+  itkSetMacro(ArrayGrainSize, SizeValueType);
+  itkGetConstMacro(ArrayGrainSize, SizeValueType);
+
   /** Set/Get the pointer to MultiThreaderBaseGlobals.
    * Note that these functions are not part of the public API and should not be
    * used outside of ITK. They are an implementation detail and will be
@@ -237,6 +286,25 @@ protected:
 
   static ITK_THREAD_RETURN_TYPE ParallelizeImageRegionHelper(void *arg);
 
+  struct ArrayCallback
+  {
+    ArrayRangeThreadingFunctorType functor;
+    const SizeValueType firstIndex;
+    const SizeValueType lastIndexPlus1;
+    const SizeValueType grainSize;
+    ProcessObject* filter;
+    std::thread::id callingThread;
+    std::atomic<SizeValueType> nextIndex;
+    std::atomic<SizeValueType> progress;
+  };
+
+  static ITK_THREAD_RETURN_TYPE ParallelizeArrayHelper(void *arg);
+
+  /** Grain size to use for an array of count elements split among
+   * m_NumberOfThreads threads: m_ArrayGrainSize, if set, otherwise a size
+   * which yields a few chunks per thread. */
+  SizeValueType GetArrayGrainSizeFor(SizeValueType count) const;
+
   /** The number of threads to use.
    *  The m_NumberOfThreads must always be less than or equal to
    *  the m_GlobalMaximumNumberOfThreads before it is used during the execution
@@ -248,6 +316,9 @@ protected:
    */
   ThreadIdType m_NumberOfThreads;
 
+  /** Minimum number of array elements per chunk, 0 for automatic. */
+  SizeValueType m_ArrayGrainSize;
+
   /** Static function used as a "proxy callback" by multi-threaders.  The
   * threading library will call this routine for each thread, which
   * will delegate the control to the prescribed SingleMethod. This
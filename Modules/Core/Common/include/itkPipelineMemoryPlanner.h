@@ -0,0 +1,161 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPipelineMemoryPlanner_h
+#define itkPipelineMemoryPlanner_h
+
+#include "itkDataObject.h"
+#include "itkProcessObject.h"
+#include <map>
+#include <vector>
+
+namespace itk
+{
+/** \class PipelineMemoryPlanner
+ * \brief Execute a pipeline, releasing and recycling the intermediate
+ * buffers as soon as they are no longer needed.
+ *
+ * Plan() computes the order in which the process objects upstream of a
+ * data object execute, from the requested regions propagated through the
+ * pipeline, and the lifetime of each intermediate data object: from the
+ * execution of its source to the execution of its last consumer. Execute()
+ * then runs the process objects in this order, releases each intermediate
+ * data object after its last consumer executed, and recycles the released
+ * pixel buffers for the next outputs of the same size, through
+ * PixelBufferPool.
+ *
+ * Only the data objects which are referenced by the pipeline alone are
+ * released: an intermediate image also referenced by the application, or
+ * used by a process object outside of the planned pipeline, is kept.
+ * The data object passed to Plan() is never released.
+ *
+ * GetPlannedPeakMemorySize() estimates, before the execution, the peak
+ * size of the buffers of the data objects generated by the pipeline,
+ * including the buffers kept in the pool for reuse.
+ * GetUnplannedPeakMemorySize() is the size of all these buffers, which the
+ * pipeline would keep without the planner. In-place filters are counted
+ * as allocating their output, hence the planned peak is an upper bound.
+ *
+ * Update() replaces DataObject::Update(); StreamingImageFilter uses a
+ * planner for each piece when one is set.
+ *
+ * \code
+ * PipelineMemoryPlanner::Pointer planner = PipelineMemoryPlanner::New();
+ * planner->Update( filter->GetOutput() );
+ * std::cout << planner->GetPlannedPeakMemorySize() << std::endl;
+ * \endcode
+ *
+ * \sa PixelBufferPool StreamingImageFilter
+ * \ingroup ITKSystemObjects
+ * \ingroup DataProcessing
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT PipelineMemoryPlanner:public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PipelineMemoryPlanner);
+
+  /** Standard class type aliases. */
+  using Self = PipelineMemoryPlanner;
+  using Superclass = Object;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PipelineMemoryPlanner, Object);
+
+  /** Plan the execution of the pipeline generating \c output. The
+   * requested regions must have been propagated through the pipeline, as
+   * done by UpdateOutputInformation() and PropagateRequestedRegion(). */
+  void Plan(DataObject *output);
+
+  /** Execute the planned pipeline. The pipeline must not be modified
+   * between Plan() and Execute(). */
+  void Execute();
+
+  /** Update the information, propagate the requested region, plan and
+   * execute the pipeline generating \c output. */
+  void Update(DataObject *output);
+
+  /** Estimated peak size in bytes of the buffers of the planned pipeline,
+   * when the intermediate buffers are released and recycled. */
+  itkGetConstMacro(PlannedPeakMemorySize, SizeValueType);
+
+  /** Size in bytes of all the buffers generated by the planned pipeline. */
+  itkGetConstMacro(UnplannedPeakMemorySize, SizeValueType);
+
+  /** Number of process objects executed by the planned pipeline. */
+  itkGetConstMacro(NumberOfPlannedStages, SizeValueType);
+
+  /** Number of data objects released by the last execution. */
+  itkGetConstMacro(NumberOfReleasedDataObjects, SizeValueType);
+
+protected:
+  PipelineMemoryPlanner();
+  ~PipelineMemoryPlanner() override = default;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  // A process object to execute, triggered by the update of one of its
+  // outputs. Pointers are not reference counted, not to change the
+  // reference counts checked before releasing data.
+  struct Stage
+  {
+    ProcessObject *             process;
+    DataObject *                trigger;
+    std::vector< DataObject * > outputs;
+    std::vector< DataObject * > releasedInputs;
+  };
+
+  // Lifetime of a data object generated by the pipeline.
+  struct Lifetime
+  {
+    SizeValueType memorySize;
+    SizeValueType producer;
+    SizeValueType lastConsumer;
+    SizeValueType numberOfConsumerSlots;
+    bool          releasable;
+  };
+
+  using LifetimeMapType = std::map< DataObject *, Lifetime >;
+
+  void Visit(DataObject *data);
+
+  bool IsReferencedByPipelineOnly(const DataObject *data, const Lifetime & lifetime) const;
+
+  void ComputePeakMemorySize();
+
+  std::vector< Stage > m_Stages;
+  LifetimeMapType      m_Lifetimes;
+  DataObject *         m_Output;
+
+  // Number of data objects of each size allocated by the stages which
+  // follow each stage.
+  std::vector< std::map< std::size_t, SizeValueType > > m_FutureAllocations;
+
+  SizeValueType m_NumberOfPlannedStages;
+  SizeValueType m_PlannedPeakMemorySize;
+  SizeValueType m_UnplannedPeakMemorySize;
+  SizeValueType m_NumberOfReleasedDataObjects;
+};
+} // end namespace itk
+
+#endif // itkPipelineMemoryPlanner_h
@@ -0,0 +1,93 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPixelBufferPool_h
+#define itkPixelBufferPool_h
+
+#include "itkIntTypes.h"
+#include "ITKCommonExport.h"
+#include <cstddef>
+#include <map>
+
+namespace itk
+{
+/** \class PixelBufferPool
+ * \brief Recycle the pixel buffers of images while a pipeline executes.
+ *
+ * While the pool is active, ImportImageContainer allocates the buffers of
+ * pixel types which need no destructor from the pool. A buffer released
+ * while the pool is active is kept in the pool, and reused for the next
+ * allocation of the same number of bytes, instead of being returned to
+ * the system. PipelineMemoryPlanner activates the pool while it executes
+ * a pipeline, and trims it to the buffers that the remaining stages will
+ * allocate.
+ *
+ * The pool is scoped to a thread: activating it only affects the buffers
+ * allocated and released by the calling thread, which keeps its own pooled
+ * buffers. The pipelines executed meanwhile by other threads, e.g. by
+ * another PipelineMemoryPlanner, allocate and release their buffers as
+ * usual, and a planner never trims the buffers pooled by another one.
+ * Buffers allocated by the worker threads of a filter do not use the pool.
+ * A buffer allocated from the pool may be released by any thread.
+ *
+ * All the methods are static and thread safe.
+ *
+ * \sa PipelineMemoryPlanner ImportImageContainer
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT PixelBufferPool
+{
+public:
+  /** Number of buffers to keep for each size in bytes. */
+  using BufferCountMapType = std::map< std::size_t, SizeValueType >;
+
+  /** Activate the pool for the calling thread. Calls may be nested: the
+   * pool stays active until Deactivate() is called as many times by the
+   * same thread. Deactivating the pool releases all the buffers pooled by
+   * the thread. */
+  static void Activate();
+  static void Deactivate();
+  static bool IsActive();
+
+  /** Allocate a buffer of \c size bytes, recycled from the pool when
+   * possible. Returns nullptr when the pool is not active for the calling
+   * thread, or when the allocation fails. */
+  static void * Allocate(std::size_t size);
+
+  /** Release a buffer. Returns false, without doing anything, if the
+   * buffer was not allocated by the pool. The buffer is kept in the pool
+   * if it is active for the calling thread, else returned to the system. */
+  static bool Release(void *buffer);
+
+  /** Return to the system the buffers pooled by the calling thread beyond
+   * the given number of buffers of each size. */
+  static void Trim(const BufferCountMapType & buffersToKeep);
+
+  /** Number of bytes of the buffers kept in the pool of the calling
+   * thread, unused. */
+  static std::size_t GetPooledMemorySize();
+
+  /** Number of allocations served by a buffer of the pool, since the
+   * program started. */
+  static SizeValueType GetNumberOfRecycledBuffers();
+
+private:
+  PixelBufferPool() = delete;
+};
+} // end namespace itk
+
+#endif // itkPixelBufferPool_h
@@ -20,6 +20,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkImageRegionSplitterBase.h"
+#include "itkPipelineMemoryPlanner.h"
 
 namespace itk
 {
@@ -36,6 +37,10 @@ namespace itk
  * This filter will produce the entire output as one image, but the upstream
  * filters will do their processing in pieces.
  *
+ * When a PipelineMemoryPlanner is set, the upstream pipeline executes
+ * through the planner for each piece, which releases and recycles the
+ * intermediate buffers as soon as they are no longer needed.
+ *
  * \ingroup ITKSystemObjects
  * \ingroup DataProcessing
  * \ingroup ITKCommon
@@ -90,6 +95,11 @@ public:
   itkSetObjectMacro(RegionSplitter, SplitterType);
   itkGetModifiableObjectMacro(RegionSplitter, SplitterType);
 
+  /** Get/Set the planner executing the upstream pipeline for each piece.
+   * Default is none: the upstream pipeline updates as usual. */
+  itkSetObjectMacro(MemoryPlanner, PipelineMemoryPlanner);
+  itkGetModifiableObjectMacro(MemoryPlanner, PipelineMemoryPlanner);
+
   /** Override UpdateOutputData() from ProcessObject to divide upstream
    * updates into pieces. This filter does not have a GenerateData()
    * or ThreadedGenerateData() method.  Instead, all the work is done
@@ -120,6 +130,8 @@ protected:
 private:
   unsigned int          m_NumberOfStreamDivisions;
   RegionSplitterPointer m_RegionSplitter;
+
+  PipelineMemoryPlanner::Pointer m_MemoryPlanner;
 };
 } // end namespace itk
 
@@ -60,6 +60,7 @@ StreamingImageFilter< TInputImage, TOutputImage >
      << std::endl;
 
   itkPrintSelfObjectMacro( RegionSplitter );
+  itkPrintSelfObjectMacro( MemoryPlanner );
 }
 
 /**
@@ -193,7 +194,15 @@ StreamingImageFilter< TInputImage, TOutputImage >
 
     inputPtr->SetRequestedRegion(streamRegion);
     inputPtr->PropagateRequestedRegion();
-    inputPtr->UpdateOutputData();
+    if ( m_MemoryPlanner )
+      {
+      m_MemoryPlanner->Plan(inputPtr);
+      m_MemoryPlanner->Execute();
+      }
+    else
+      {
+      inputPtr->UpdateOutputData();
+      }
 
     // copy the result to the proper place in the output. the input
     // requested region determined by the RegionSplitter (as opposed
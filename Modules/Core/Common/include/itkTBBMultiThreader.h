@@ -72,6 +72,12 @@ public:
       ThreadingFunctorType funcP,
       ProcessObject* filter) override;
 
+  void ParallelizeArrayRange(
+      SizeValueType firstIndex,
+      SizeValueType lastIndexPlus1,
+      ArrayRangeThreadingFunctorType aFunc,
+      ProcessObject* filter) override;
+
 protected:
   TBBMultiThreader();
   ~TBBMultiThreader() override;
@@ -21,6 +21,7 @@
 #include "itkMath.h"
 #include "itkInPlaceImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkBatchFunctorTraits.h"
 
 namespace itk
 {
@@ -36,8 +37,13 @@ namespace itk
  * UnaryFunctorImageFilter (like the CastImageFilter) can be used
  * to promote a 2D image to a 3D image, etc.
  *
+ * If the functor provides a ProcessBatch() method and both images store
+ * their pixels contiguously, the output is computed one scanline at a time
+ * by ProcessBatch() instead of one pixel at a time by operator().
+ *
  * \sa UnaryGeneratorImageFilter
  * \sa BinaryFunctorImageFilter TernaryFunctorImageFilter
+ * \sa Functor::UnaryBatchFunctorTraits
  *
  * \ingroup   IntensityImageFilters     MultiThreaded
  * \ingroup ITKCommon
@@ -126,6 +132,17 @@ protected:
   void DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
 
 private:
+  /** Whether whole scanlines are passed to the batch method of the functor,
+   * see Functor::UnaryBatchFunctorTraits. */
+  using UseBatchFunctorType = typename mpl::And<
+    typename Functor::UnaryBatchFunctorTraits< FunctorType, InputImagePixelType, OutputImagePixelType >::Type,
+    mpl::And< ImageHasContiguousPixels< TInputImage >, ImageHasContiguousPixels< TOutputImage > > >::Type;
+
+  void ProcessScanlines(const InputImageRegionType & inputRegionForThread,
+                        const OutputImageRegionType & outputRegionForThread, mpl::FalseType);
+  void ProcessScanlines(const InputImageRegionType & inputRegionForThread,
+                        const OutputImageRegionType & outputRegionForThread, mpl::TrueType);
+
   FunctorType m_Functor;
 };
 } // end namespace itk
@@ -84,8 +84,6 @@ UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
     {
     return;
     }
-  const TInputImage *inputPtr = this->GetInput();
-  TOutputImage *outputPtr = this->GetOutput(0);
 
   // Define the portion of the input to walk for this thread, using
   // the CallCopyOutputRegionToInputRegion method allows for the input
@@ -94,6 +92,18 @@ UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
 
   this->CallCopyOutputRegionToInputRegion(inputRegionForThread, outputRegionForThread);
 
+  this->ProcessScanlines(inputRegionForThread, outputRegionForThread, UseBatchFunctorType());
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction  >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::ProcessScanlines(const InputImageRegionType & inputRegionForThread,
+                   const OutputImageRegionType & outputRegionForThread, mpl::FalseType)
+{
+  const TInputImage *inputPtr = this->GetInput();
+  TOutputImage *outputPtr = this->GetOutput(0);
+
   ImageScanlineConstIterator< TInputImage > inputIt(inputPtr, inputRegionForThread);
   ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
 
@@ -111,6 +121,31 @@ UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
     outputIt.NextLine();
     }
 }
+
+template< typename TInputImage, typename TOutputImage, typename TFunction  >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::ProcessScanlines(const InputImageRegionType & inputRegionForThread,
+                   const OutputImageRegionType & outputRegionForThread, mpl::TrueType)
+{
+  const TInputImage *inputPtr = this->GetInput();
+  TOutputImage *outputPtr = this->GetOutput(0);
+  const SizeValueType lineLength = inputRegionForThread.GetSize(0);
+
+  ImageScanlineConstIterator< TInputImage > inputIt(inputPtr, inputRegionForThread);
+  ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+
+  inputIt.GoToBegin();
+  outputIt.GoToBegin();
+  while ( !inputIt.IsAtEnd() )
+    {
+    m_Functor.ProcessBatch( inputPtr->GetBufferPointer() + inputPtr->ComputeOffset( inputIt.GetIndex() ),
+                            outputPtr->GetBufferPointer() + outputPtr->ComputeOffset( outputIt.GetIndex() ),
+                            lineLength );
+    inputIt.NextLine();
+    outputIt.NextLine();
+    }
+}
 } // end namespace itk
 
 #endif
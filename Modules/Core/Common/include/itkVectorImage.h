@@ -337,6 +337,9 @@ public:
 
   void SetNumberOfComponentsPerPixel(unsigned int n) override;
 
+  /** Return the number of bytes of the pixels of the requested region. */
+  ::itk::SizeValueType GetRequestedRegionMemorySize() const override;
+
 protected:
   VectorImage();
   void PrintSelf(std::ostream & os, Indent indent) const override;
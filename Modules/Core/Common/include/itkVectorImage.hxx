@@ -164,6 +164,15 @@ VectorImage< TPixel, VImageDimension >
   return this->m_VectorLength;
 }
 
+//----------------------------------------------------------------------------
+template< typename TPixel, unsigned int VImageDimension >
+SizeValueType
+VectorImage< TPixel, VImageDimension >
+::GetRequestedRegionMemorySize() const
+{
+  return this->GetRequestedRegion().GetNumberOfPixels() * m_VectorLength * sizeof( InternalPixelType );
+}
+
 //----------------------------------------------------------------------------
 template< typename TPixel, unsigned int VImageDimension >
 void
@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkWorkStealingMultiThreader_h
+#define itkWorkStealingMultiThreader_h
+
+#include "itkMultiThreaderBase.h"
+#include "itkWorkStealingThreadPool.h"
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+/** \class WorkStealingMultiThreader
+ * \brief A class for performing multithreaded execution with a
+ * work-stealing thread pool back end.
+ *
+ * ParallelizeImageRegion recursively splits the region in halves along the
+ * slowest varying dimension. Each half which is split off becomes a task on
+ * the deque of the executing thread, where idle workers can steal it. Work is
+ * therefore balanced dynamically, in the same spirit as the TBB back end,
+ * but without requiring the TBB library.
+ *
+ * Nested calls are supported: a filter running inside a parallel section
+ * (e.g. a composite filter updated from within a registration metric
+ * threader) submits its pieces to the same pool, and the waiting thread
+ * executes pending tasks instead of blocking. Neither deadlocks nor
+ * additional threads result from nesting.
+ *
+ * SingleMethodExecute submits one task per requested "thread". As some
+ * algorithms synchronize those through a Barrier, the pool is grown when
+ * needed so that all of them can run concurrently.
+ *
+ * \sa WorkStealingThreadPool
+ *
+ * \ingroup OSSystemObjects
+ *
+ * \ingroup ITKCommon
+ */
+
+class ITKCommon_EXPORT WorkStealingMultiThreader : public MultiThreaderBase
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(WorkStealingMultiThreader);
+
+  /** Standard class type aliases. */
+  using Self = WorkStealingMultiThreader;
+  using Superclass = MultiThreaderBase;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(WorkStealingMultiThreader, MultiThreaderBase);
+
+  /** Execute the SingleMethod (as define by SetSingleMethod) using
+   * m_NumberOfThreads threads. As a side effect the m_NumberOfThreads will be
+   * checked against the current m_GlobalMaximumNumberOfThreads and clamped if
+   * necessary. */
+  void SingleMethodExecute() override;
+
+  /** Set the SingleMethod to f() and the UserData field of the
+   * ThreadInfoStruct that is passed to it will be data.
+   * This method must be of type itkThreadFunctionType and
+   * must take a single argument of type void. */
+  void SetSingleMethod(ThreadFunctionType, void *data) override;
+
+  using Superclass::ParallelizeImageRegion;
+  void ParallelizeImageRegion(
+      unsigned int dimension,
+      const IndexValueType index[],
+      const SizeValueType size[],
+      ThreadingFunctorType funcP,
+      ProcessObject* filter) override;
+
+  void ParallelizeArrayRange(
+      SizeValueType firstIndex,
+      SizeValueType lastIndexPlus1,
+      ArrayRangeThreadingFunctorType aFunc,
+      ProcessObject* filter) override;
+
+  /** Number of pieces per thread ParallelizeImageRegion aims for, and
+   * ParallelizeArrayRange when ArrayGrainSize is zero. More pieces give idle
+   * threads more opportunities to steal, at the cost of more scheduling
+   * overhead. Default is 4. */
+  itkSetClampMacro(PiecesPerThread, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(PiecesPerThread, unsigned int);
+
+protected:
+  WorkStealingMultiThreader();
+  ~WorkStealingMultiThreader() override;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  WorkStealingThreadPool::Pointer m_ThreadPool;
+
+  unsigned int m_PiecesPerThread;
+
+  /** ProcessObject is a friend so that it can call PrintSelf() on its Multithreader. */
+  friend class ProcessObject;
+};
+
+}  // end namespace itk
+#endif
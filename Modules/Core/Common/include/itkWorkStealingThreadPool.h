@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkWorkStealingThreadPool_h
+#define itkWorkStealingThreadPool_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkIntTypes.h"
+#include "itkThreadSupport.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class WorkStealingThreadPool
+ * \brief Thread pool with one task deque per worker and work stealing.
+ *
+ * Every worker thread owns a deque of tasks. A worker pushes the tasks it
+ * creates to the back of its own deque and pops from the back (LIFO), which
+ * keeps recently split, cache-warm work local. When its deque is empty, it
+ * steals from the front (FIFO) of another worker's deque, which takes the
+ * largest pending pieces of work. Tasks submitted by threads which are not
+ * pool workers go to a shared injection deque.
+ *
+ * Tasks are grouped into TaskGroup objects. A thread waiting for a group
+ * does not block while tasks of that group are pending: it keeps executing
+ * them (its own first, then stolen ones) until the group is finished. This
+ * is what makes nested parallelism safe. A task running on a worker may
+ * itself split work and wait for it without deadlocking the pool, and
+ * without creating any additional threads. A waiting thread only executes
+ * the tasks of the group it waits for, and of the groups created by these
+ * tasks, never unrelated tasks which could block it, for example on the
+ * result of the wait. When none of them is pending, it sleeps until new
+ * tasks are added or the group is finished.
+ *
+ * The pool is a process-wide singleton, started with
+ * GlobalDefaultNumberOfThreads - 1 workers, because the thread which submits
+ * the work also participates in executing it.
+ *
+ * \sa WorkStealingMultiThreader
+ * \sa ThreadPool
+ *
+ * \ingroup OSSystemObjects
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT WorkStealingThreadPool : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(WorkStealingThreadPool);
+
+  /** Standard class type aliases. */
+  using Self = WorkStealingThreadPool;
+  using Superclass = Object;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(WorkStealingThreadPool, Object);
+
+  /** Returns the global instance */
+  static Pointer New();
+
+  /** Returns the global singleton instance of the WorkStealingThreadPool */
+  static Pointer GetInstance();
+
+  using TaskFunctionType = std::function< void() >;
+
+  /** \class TaskGroup
+   * \brief A set of tasks which can be waited for as a whole.
+   *
+   * The group must outlive all of its tasks, which is guaranteed if
+   * WorkStealingThreadPool::Wait is invoked before the group is destroyed.
+   * \ingroup ITKCommon */
+  class TaskGroup
+  {
+  public:
+    TaskGroup():
+      m_NumberOfPendingTasks(0),
+      m_Parent( WorkStealingThreadPool::GetCurrentTaskGroup() )
+    {}
+
+    /** True when all the tasks added to this group have finished. */
+    bool IsDone() const
+    {
+      return m_NumberOfPendingTasks.load(std::memory_order_acquire) == 0;
+    }
+
+  private:
+    friend class WorkStealingThreadPool;
+
+    std::atomic< SizeValueType > m_NumberOfPendingTasks;
+    /** Group of the task which created this group, if any. The tasks of a
+     * group may be executed by the threads waiting for its ancestors. */
+    TaskGroup *                  m_Parent;
+    std::mutex                   m_ExceptionMutex;
+    std::exception_ptr           m_Exception;
+  };
+
+  /** Add a task to the group and make it available for execution.
+   * If the calling thread is a worker of this pool, the task is pushed to
+   * its own deque, otherwise to the injection deque. */
+  void AddTask(TaskGroup & group, TaskFunctionType task);
+
+  /** Executes pending tasks of the group, and of the groups created by its
+   * tasks, until all the tasks of the group have finished.
+   * If any task of the group threw an exception, the first one is rethrown
+   * here, after all the other tasks of the group have finished. */
+  void Wait(TaskGroup & group);
+
+  /** Can call this method if we want to add extra workers to the pool, e.g.
+   * when the tasks synchronize with each other through a Barrier and
+   * therefore need to run concurrently. The total number of workers is
+   * limited to ITK_MAX_THREADS. */
+  void AddWorkers(ThreadIdType count);
+
+  /** Number of worker threads owned by the pool. */
+  ThreadIdType GetNumberOfWorkers() const;
+
+  /** True if the calling thread is one of the workers of this pool. */
+  static bool IsWorkerThread();
+
+  /** Group of the task executed by the calling thread, or nullptr when the
+   * calling thread is not executing a task of the pool. */
+  static TaskGroup * GetCurrentTaskGroup();
+
+protected:
+  WorkStealingThreadPool();
+  ~WorkStealingThreadPool() override;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  struct Task
+  {
+    TaskFunctionType m_Function;
+    TaskGroup *      m_Group;
+  };
+
+  /** One deque per worker, plus the injection deque. The mutex is only
+   * contended when another thread tries to steal from this deque. */
+  struct TaskQueue
+  {
+    std::mutex         m_Mutex;
+    std::deque< Task > m_Tasks;
+  };
+
+  /** Take a task from a deque: the most recent one of the calling thread's
+   * own deque, the oldest one of another deque. When \c group is not null,
+   * only the tasks of this group or of its descendants are taken. */
+  bool PopTask(ThreadIdType queueIndex, Task & task, const TaskGroup * group);
+  bool StealTask(ThreadIdType queueIndex, Task & task, const TaskGroup * group);
+  bool GetTask(Task & task, const TaskGroup * group);
+  static bool BelongsToGroup(const Task & task, const TaskGroup * group);
+  void ExecuteTask(Task & task);
+  /** Wake up one idle worker when a task was added, and all the threads
+   * waiting for a group, whose group may have finished or may own the new
+   * task. */
+  void WakeUpSleepingThreads(bool newTask);
+  void WorkerExecute(ThreadIdType workerIndex);
+
+  /** Index of the injection deque, used by threads which are not workers. */
+  static constexpr ThreadIdType InjectionQueueIndex = ITK_MAX_THREADS;
+
+  std::vector< std::unique_ptr< TaskQueue > > m_Queues;
+
+  std::vector< std::thread > m_Threads;
+  std::mutex                 m_ThreadsMutex;
+  std::atomic< ThreadIdType > m_NumberOfWorkers;
+
+  /** Approximate number of tasks sitting in any of the deques. */
+  std::atomic< SizeValueType > m_NumberOfQueuedTasks;
+
+  /** Incremented each time a task is added. A waiting thread which found no
+   * task of its group sleeps until this changes. */
+  std::atomic< SizeValueType > m_NumberOfAddedTasks;
+
+  /** Idle workers sleep on m_SleepCondition, and the threads waiting for
+   * a group on m_WaitCondition. */
+  std::mutex              m_SleepMutex;
+  std::condition_variable m_SleepCondition;
+  std::condition_variable m_WaitCondition;
+  bool                    m_Stop;
+};
+
+} // end namespace itk
+
+#endif
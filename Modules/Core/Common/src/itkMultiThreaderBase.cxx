@@ -28,6 +28,7 @@
 #include "itkMultiThreaderBase.h"
 #include "itkPlatformMultiThreader.h"
 #include "itkPoolMultiThreader.h"
+#include "itkWorkStealingMultiThreader.h"
 #include "itkNumericTraits.h"
 #include "itkMutexLockHolder.h"
 #include "itkSimpleFastMutexLock.h"
@@ -282,6 +283,10 @@ MultiThreaderBase
     {
     return ThreaderType::TBB;
     }
+  else if (threaderString == "WORKSTEALING")
+    {
+    return ThreaderType::WorkStealing;
+    }
   else
     {
     return ThreaderType::Unknown;
@@ -389,6 +394,8 @@ MultiThreaderBase::Pointer MultiThreaderBase::New()
 #else
         itkGenericExceptionMacro("ITK has been built without TBB support!");
 #endif
+      case ThreaderType::WorkStealing:
+        return WorkStealingMultiThreader::New();
       default:
         itkGenericExceptionMacro("MultiThreaderBase::GetGlobalDefaultThreader returned Unknown!");
       }
@@ -398,7 +405,8 @@ MultiThreaderBase::Pointer MultiThreaderBase::New()
 }
 
 
-MultiThreaderBase::MultiThreaderBase()
+MultiThreaderBase::MultiThreaderBase():
+  m_ArrayGrainSize(0)
 {
   m_NumberOfThreads = MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
 }
@@ -535,6 +543,116 @@ MultiThreaderBase
   return ITK_THREAD_RETURN_VALUE;
 }
 
+SizeValueType
+MultiThreaderBase
+::GetArrayGrainSizeFor(SizeValueType count) const
+{
+  if (m_ArrayGrainSize > 0)
+    {
+    return m_ArrayGrainSize;
+    }
+  // A few chunks per thread allow threads which finish early to pick up
+  // some of the remaining work.
+  const SizeValueType chunks = 4 * SizeValueType(m_NumberOfThreads);
+  return std::max<SizeValueType>(1, (count + chunks - 1) / chunks);
+}
+
+void
+MultiThreaderBase
+::ParallelizeArrayRange(
+    SizeValueType firstIndex,
+    SizeValueType lastIndexPlus1,
+    ArrayRangeThreadingFunctorType aFunc,
+    ProcessObject* filter)
+{
+  // This implementation simply delegates parallelization to the old interface
+  // SetSingleMethod+SingleMethodExecute. This method is meant to be overloaded!
+  if (filter)
+    {
+    filter->UpdateProgress(0.0f);
+    }
+
+  const SizeValueType count = lastIndexPlus1 > firstIndex ? lastIndexPlus1 - firstIndex : 0;
+  const SizeValueType grainSize = this->GetArrayGrainSizeFor(count);
+  if (count > 0 && (m_NumberOfThreads == 1 || count <= grainSize)) //no multi-threading needed
+    {
+    aFunc(firstIndex, lastIndexPlus1);
+    }
+  else if (count > 0)
+    {
+    struct ArrayCallback acParams {
+        aFunc,
+        firstIndex,
+        lastIndexPlus1,
+        grainSize,
+        filter,
+        std::this_thread::get_id(),
+        {firstIndex},
+        {0} };
+    this->SetSingleMethod(&MultiThreaderBase::ParallelizeArrayHelper, &acParams);
+    this->SingleMethodExecute();
+    }
+
+  if (filter)
+    {
+    filter->UpdateProgress(1.0f);
+    if (filter->GetAbortGenerateData())
+      {
+      std::string msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+          + " during multi-threaded part of filter execution";
+      e.SetDescription(msg);
+      throw e;
+      }
+    }
+}
+
+ITK_THREAD_RETURN_TYPE
+MultiThreaderBase
+::ParallelizeArrayHelper(void * arg)
+{
+  using ThreadInfo = MultiThreaderBase::ThreadInfoStruct;
+  auto * threadInfo = static_cast<ThreadInfo *>(arg);
+  auto * acParams = static_cast<struct ArrayCallback *>(threadInfo->UserData);
+  const SizeValueType count = acParams->lastIndexPlus1 - acParams->firstIndex;
+
+  // Threads claim chunks on demand, which balances the load when the cost
+  // per element varies.
+  while (true)
+    {
+    if (acParams->filter && acParams->filter->GetAbortGenerateData())
+      {
+      std::string msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "AbortGenerateData was called in " + std::string(acParams->filter->GetNameOfClass() )
+          + " during multi-threaded part of filter execution";
+      e.SetDescription(msg);
+      throw e;
+      }
+
+    const SizeValueType first = acParams->nextIndex.fetch_add(acParams->grainSize);
+    if (first >= acParams->lastIndexPlus1)
+      {
+      break;
+      }
+    const SizeValueType lastPlus1 = std::min(first + acParams->grainSize, acParams->lastIndexPlus1);
+    acParams->functor(first, lastPlus1);
+
+    if (acParams->filter)
+      {
+      acParams->progress += lastPlus1 - first;
+      //make sure we are updating progress only from the thead which invoked filter->Update();
+      if (acParams->callingThread == std::this_thread::get_id())
+        {
+        acParams->filter->UpdateProgress(float(acParams->progress) / count);
+        }
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 std::ostream& operator << (std::ostream& os,
     const MultiThreaderBase::ThreaderType& threader)
 {
@@ -548,6 +666,7 @@ void MultiThreaderBase::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Number of Threads: " << m_NumberOfThreads << "\n";
+  os << indent << "Array Grain Size: " << m_ArrayGrainSize << "\n";
   os << indent << "Global Maximum Number Of Threads: "
      << m_MultiThreaderBaseGlobals->m_GlobalMaximumNumberOfThreads << std::endl;
   os << indent << "Global Default Number Of Threads: "
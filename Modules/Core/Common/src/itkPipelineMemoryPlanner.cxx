@@ -0,0 +1,277 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPipelineMemoryPlanner.h"
+#include "itkPixelBufferPool.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace
+{
+// Keep the pixel buffer pool active while a pipeline executes, even when
+// it throws an exception.
+class PixelBufferPoolActivation
+{
+public:
+  PixelBufferPoolActivation()
+  {
+    PixelBufferPool::Activate();
+  }
+  ~PixelBufferPoolActivation()
+  {
+    PixelBufferPool::Deactivate();
+  }
+  ITK_DISALLOW_COPY_AND_ASSIGN(PixelBufferPoolActivation);
+};
+
+// Same condition as DataObject::UpdateOutputData().
+bool NeedsUpdate(DataObject *data)
+{
+  return data->GetUpdateMTime() < data->GetPipelineMTime() || data->GetDataReleased()
+         || data->RequestedRegionIsOutsideOfTheBufferedRegion();
+}
+}
+
+PipelineMemoryPlanner::PipelineMemoryPlanner():
+  m_Output(nullptr),
+  m_NumberOfPlannedStages(0),
+  m_PlannedPeakMemorySize(0),
+  m_UnplannedPeakMemorySize(0),
+  m_NumberOfReleasedDataObjects(0)
+{
+}
+
+void
+PipelineMemoryPlanner::Plan(DataObject *output)
+{
+  if ( output == nullptr )
+    {
+    itkExceptionMacro("No data object to plan");
+    }
+  m_Stages.clear();
+  m_Lifetimes.clear();
+  m_FutureAllocations.clear();
+  m_Output = output;
+
+  this->Visit(output);
+
+  // An intermediate data object is released after its last consumer.
+  for ( auto & lifetime : m_Lifetimes )
+    {
+    if ( lifetime.first != m_Output && lifetime.second.numberOfConsumerSlots > 0 )
+      {
+      lifetime.second.releasable = this->IsReferencedByPipelineOnly(lifetime.first, lifetime.second);
+      if ( lifetime.second.releasable )
+        {
+        m_Stages[lifetime.second.lastConsumer].releasedInputs.push_back(lifetime.first);
+        }
+      }
+    }
+
+  // Sizes of the buffers that the following stages will allocate, to
+  // keep in the pool after each stage.
+  m_FutureAllocations.resize(m_Stages.size());
+  for ( SizeValueType s = m_Stages.size(); s > 1; --s )
+    {
+    m_FutureAllocations[s - 2] = m_FutureAllocations[s - 1];
+    for ( DataObject *data : m_Stages[s - 1].outputs )
+      {
+      const SizeValueType size = m_Lifetimes[data].memorySize;
+      if ( size > 0 )
+        {
+        ++m_FutureAllocations[s - 2][size];
+        }
+      }
+    }
+
+  m_NumberOfPlannedStages = m_Stages.size();
+  this->ComputePeakMemorySize();
+  this->Modified();
+}
+
+void
+PipelineMemoryPlanner::Visit(DataObject *data)
+{
+  ProcessObject *process = data->GetSource().GetPointer();
+  if ( process == nullptr || !NeedsUpdate(data) )
+    {
+    return;
+    }
+  for ( const Stage & stage : m_Stages )
+    {
+    if ( stage.process == process )
+      {
+      return;
+      }
+    }
+
+  // Raw pointers to the inputs: the array of smart pointers returned by
+  // GetInputs() must not outlive this block, not to change the reference
+  // counts.
+  std::vector< DataObject * > inputs;
+    {
+    const ProcessObject::DataObjectPointerArray inputArray = process->GetInputs();
+    for ( const auto & input : inputArray )
+      {
+      if ( input.IsNotNull() )
+        {
+        inputs.push_back(input.GetPointer());
+        }
+      }
+    }
+  for ( DataObject *input : inputs )
+    {
+    this->Visit(input);
+    }
+
+  // Inputs first, in post order.
+  Stage stage;
+  stage.process = process;
+  stage.trigger = data;
+    {
+    const ProcessObject::DataObjectPointerArray outputArray = process->GetOutputs();
+    for ( const auto & output : outputArray )
+      {
+      if ( output.IsNotNull() )
+        {
+        stage.outputs.push_back(output.GetPointer());
+        }
+      }
+    }
+  const SizeValueType stageIndex = m_Stages.size();
+  for ( DataObject *output : stage.outputs )
+    {
+    Lifetime & lifetime = m_Lifetimes[output];
+    lifetime.memorySize = output->GetRequestedRegionMemorySize();
+    lifetime.producer = stageIndex;
+    lifetime.lastConsumer = stageIndex;
+    lifetime.numberOfConsumerSlots = 0;
+    lifetime.releasable = false;
+    }
+  for ( DataObject *input : inputs )
+    {
+    auto lifetime = m_Lifetimes.find(input);
+    if ( lifetime != m_Lifetimes.end() )
+      {
+      lifetime->second.lastConsumer = stageIndex;
+      ++lifetime->second.numberOfConsumerSlots;
+      }
+    }
+  m_Stages.push_back(stage);
+}
+
+bool
+PipelineMemoryPlanner::IsReferencedByPipelineOnly(const DataObject *data, const Lifetime & lifetime) const
+{
+  // One reference from the source, one from each input of the consumers.
+  return data->GetReferenceCount() == static_cast< int >( 1 + lifetime.numberOfConsumerSlots );
+}
+
+void
+PipelineMemoryPlanner::ComputePeakMemorySize()
+{
+  std::map< std::size_t, SizeValueType > pool;
+  SizeValueType live = 0;
+  SizeValueType pooled = 0;
+  m_PlannedPeakMemorySize = 0;
+  m_UnplannedPeakMemorySize = 0;
+  for ( SizeValueType s = 0; s < m_Stages.size(); ++s )
+    {
+    for ( DataObject *data : m_Stages[s].outputs )
+      {
+      const SizeValueType size = m_Lifetimes[data].memorySize;
+      auto recycled = pool.find(size);
+      if ( recycled != pool.end() && recycled->second > 0 )
+        {
+        --recycled->second;
+        pooled -= size;
+        }
+      live += size;
+      m_UnplannedPeakMemorySize += size;
+      }
+    m_PlannedPeakMemorySize = std::max(m_PlannedPeakMemorySize, live + pooled);
+
+    for ( DataObject *data : m_Stages[s].releasedInputs )
+      {
+      const SizeValueType size = m_Lifetimes[data].memorySize;
+      live -= size;
+      ++pool[size];
+      pooled += size;
+      }
+    for ( auto & buffers : pool )
+      {
+      const auto future = m_FutureAllocations[s].find(buffers.first);
+      const SizeValueType keep = std::min(buffers.second,
+                                          future == m_FutureAllocations[s].end() ? 0 : future->second);
+      pooled -= ( buffers.second - keep ) * buffers.first;
+      buffers.second = keep;
+      }
+    }
+}
+
+void
+PipelineMemoryPlanner::Execute()
+{
+  m_NumberOfReleasedDataObjects = 0;
+  PixelBufferPoolActivation activation;
+  for ( SizeValueType s = 0; s < m_Stages.size(); ++s )
+    {
+    m_Stages[s].trigger->UpdateOutputData();
+    for ( DataObject *data : m_Stages[s].releasedInputs )
+      {
+      // Checked again: an observer of the pipeline may have referenced it.
+      if ( this->IsReferencedByPipelineOnly(data, m_Lifetimes[data]) )
+        {
+        data->ReleaseData();
+        ++m_NumberOfReleasedDataObjects;
+        }
+      }
+    PixelBufferPool::Trim(m_FutureAllocations[s]);
+    }
+  // The stages point to data objects that the application may delete.
+  m_Stages.clear();
+  m_Lifetimes.clear();
+  m_FutureAllocations.clear();
+  m_Output = nullptr;
+}
+
+void
+PipelineMemoryPlanner::Update(DataObject *output)
+{
+  if ( output == nullptr )
+    {
+    itkExceptionMacro("No data object to update");
+    }
+  output->UpdateOutputInformation();
+  output->PropagateRequestedRegion();
+  this->Plan(output);
+  this->Execute();
+}
+
+void
+PipelineMemoryPlanner::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfPlannedStages: " << m_NumberOfPlannedStages << std::endl;
+  os << indent << "PlannedPeakMemorySize: " << m_PlannedPeakMemorySize << std::endl;
+  os << indent << "UnplannedPeakMemorySize: " << m_UnplannedPeakMemorySize << std::endl;
+  os << indent << "NumberOfReleasedDataObjects: " << m_NumberOfReleasedDataObjects << std::endl;
+}
+} // end namespace itk
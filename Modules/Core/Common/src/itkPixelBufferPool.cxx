@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPixelBufferPool.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace itk
+{
+namespace
+{
+// Buffers allocated by the pool and in use, with their size. They may be
+// released by any thread.
+struct AllocatedBuffers
+{
+  std::mutex mutex;
+  std::unordered_map< void *, std::size_t > sizes;
+};
+
+AllocatedBuffers & GetAllocatedBuffers()
+{
+  static AllocatedBuffers allocated;
+  return allocated;
+}
+
+// The activation and the buffers released while the pool is active belong
+// to a thread, so that the pipelines executed by other threads are not
+// affected.
+struct ThreadPool
+{
+  unsigned int activeCount = 0;
+  // Buffers released while the pool is active, by size
+  std::multimap< std::size_t, void * > pooled;
+  std::size_t pooledSize = 0;
+
+  ~ThreadPool()
+  {
+    for ( const auto & buffer : pooled )
+      {
+      ::operator delete(buffer.second);
+      }
+  }
+};
+
+thread_local ThreadPool threadPool;
+
+// Checked without locking, so that releasing a buffer costs nothing when
+// the pool was never used.
+std::atomic< SizeValueType > allocatedCount(0);
+std::atomic< SizeValueType > recycledCount(0);
+
+void ReleasePooledBuffers(ThreadPool & pool, const PixelBufferPool::BufferCountMapType & buffersToKeep)
+{
+  auto it = pool.pooled.begin();
+  while ( it != pool.pooled.end() )
+    {
+    const auto keep = buffersToKeep.find(it->first);
+    const SizeValueType numberToKeep = keep == buffersToKeep.end() ? 0 : keep->second;
+    auto range = pool.pooled.equal_range(it->first);
+    SizeValueType kept = 0;
+    for ( it = range.first; it != range.second; )
+      {
+      if ( kept < numberToKeep )
+        {
+        ++kept;
+        ++it;
+        }
+      else
+        {
+        ::operator delete(it->second);
+        pool.pooledSize -= it->first;
+        it = pool.pooled.erase(it);
+        }
+      }
+    }
+}
+}
+
+void
+PixelBufferPool::Activate()
+{
+  ++threadPool.activeCount;
+}
+
+void
+PixelBufferPool::Deactivate()
+{
+  if ( threadPool.activeCount > 0 && --threadPool.activeCount == 0 )
+    {
+    ReleasePooledBuffers(threadPool, BufferCountMapType());
+    }
+}
+
+bool
+PixelBufferPool::IsActive()
+{
+  return threadPool.activeCount > 0;
+}
+
+void *
+PixelBufferPool::Allocate(std::size_t size)
+{
+  ThreadPool & pool = threadPool;
+  if ( pool.activeCount == 0 )
+    {
+    return nullptr;
+    }
+  void *buffer = nullptr;
+  auto  pooled = pool.pooled.find(size);
+  if ( pooled != pool.pooled.end() )
+    {
+    buffer = pooled->second;
+    pool.pooled.erase(pooled);
+    pool.pooledSize -= size;
+    ++recycledCount;
+    }
+  else
+    {
+    buffer = ::operator new(size > 0 ? size : 1, std::nothrow);
+    if ( buffer == nullptr )
+      {
+      // Give the memory of the pool back before failing.
+      ReleasePooledBuffers(pool, BufferCountMapType());
+      buffer = ::operator new(size > 0 ? size : 1, std::nothrow);
+      if ( buffer == nullptr )
+        {
+        return nullptr;
+        }
+      }
+    }
+  AllocatedBuffers & allocated = GetAllocatedBuffers();
+  std::lock_guard< std::mutex > lock(allocated.mutex);
+  allocated.sizes[buffer] = size;
+  ++allocatedCount;
+  return buffer;
+}
+
+bool
+PixelBufferPool::Release(void *buffer)
+{
+  if ( buffer == nullptr || allocatedCount == 0 )
+    {
+    return false;
+    }
+  std::size_t size;
+  {
+  AllocatedBuffers & allocated = GetAllocatedBuffers();
+  std::lock_guard< std::mutex > lock(allocated.mutex);
+  auto it = allocated.sizes.find(buffer);
+  if ( it == allocated.sizes.end() )
+    {
+    return false;
+    }
+  size = it->second;
+  allocated.sizes.erase(it);
+  --allocatedCount;
+  }
+  ThreadPool & pool = threadPool;
+  if ( pool.activeCount > 0 )
+    {
+    pool.pooled.emplace(size, buffer);
+    pool.pooledSize += size;
+    }
+  else
+    {
+    ::operator delete(buffer);
+    }
+  return true;
+}
+
+void
+PixelBufferPool::Trim(const BufferCountMapType & buffersToKeep)
+{
+  ReleasePooledBuffers(threadPool, buffersToKeep);
+}
+
+std::size_t
+PixelBufferPool::GetPooledMemorySize()
+{
+  return threadPool.pooledSize;
+}
+
+SizeValueType
+PixelBufferPool::GetNumberOfRecycledBuffers()
+{
+  return recycledCount;
+}
+} // end namespace itk
@@ -23,6 +23,7 @@
 #include <atomic>
 #include <thread>
 #include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
 
 namespace itk
 {
@@ -212,4 +213,74 @@ void TBBMultiThreader
       }
     }
 }
+
+void TBBMultiThreader
+::ParallelizeArrayRange(
+    SizeValueType firstIndex,
+    SizeValueType lastIndexPlus1,
+    ArrayRangeThreadingFunctorType aFunc,
+    ProcessObject* filter)
+{
+  if (filter)
+    {
+    filter->UpdateProgress(0.0f);
+    }
+
+  if (firstIndex < lastIndexPlus1)
+    {
+    if (m_NumberOfThreads == 1) //no multi-threading wanted
+      {
+      aFunc(firstIndex, lastIndexPlus1);
+      }
+    else //normal multi-threading
+      {
+      std::atomic<SizeValueType> progress = { 0 };
+      const SizeValueType totalCount = lastIndexPlus1 - firstIndex;
+      std::thread::id callingThread = std::this_thread::get_id();
+
+      // TBB splits ranges larger than its grain size in halves. Passing
+      // 2 * m_ArrayGrainSize - 1 keeps every half at least m_ArrayGrainSize
+      // long, while the automatic grain size of 1 leaves the chunking to the
+      // auto_partitioner.
+      const SizeValueType grainSize = m_ArrayGrainSize > 1 ? 2 * m_ArrayGrainSize - 1 : 1;
+      tbb::parallel_for(tbb::blocked_range<SizeValueType>(firstIndex, lastIndexPlus1, grainSize),
+          [&](const tbb::blocked_range<SizeValueType> & r)
+        {
+        if (filter && filter->GetAbortGenerateData())
+          {
+          std::string msg;
+          ProcessAborted e(__FILE__, __LINE__);
+          msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+              + " during multi-threaded part of filter execution";
+          e.SetDescription(msg);
+          throw e;
+          }
+        aFunc(r.begin(), r.end());
+        if (filter) //filter is provided, update progress
+          {
+          progress += r.size();
+          //make sure we are updating progress only from the thead which invoked filter->Update();
+          if (callingThread == std::this_thread::get_id())
+            {
+            filter->UpdateProgress(float(progress) / totalCount);
+            }
+          }
+        });
+      }
+    }
+
+  if (filter)
+    {
+    filter->UpdateProgress(1.0f);
+    if (filter->GetAbortGenerateData())
+      {
+      std::string msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+          + " during multi-threaded part of filter execution";
+      e.SetDescription(msg);
+      throw e;
+      }
+    }
+}
 }
@@ -0,0 +1,330 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkWorkStealingMultiThreader.h"
+#include "itkProcessObject.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+
+WorkStealingMultiThreader::WorkStealingMultiThreader() :
+  m_ThreadPool( WorkStealingThreadPool::GetInstance() ),
+  m_PiecesPerThread( 4 )
+{
+  m_SingleMethod = nullptr;
+  m_SingleData = nullptr;
+
+  m_NumberOfThreads = std::max(1u, GetGlobalDefaultNumberOfThreads());
+}
+
+WorkStealingMultiThreader::~WorkStealingMultiThreader()
+{
+}
+
+void WorkStealingMultiThreader::SetSingleMethod(ThreadFunctionType f, void *data)
+{
+  m_SingleMethod = f;
+  m_SingleData   = data;
+}
+
+void WorkStealingMultiThreader::SingleMethodExecute()
+{
+  if( !m_SingleMethod )
+    {
+    itkExceptionMacro(<< "No single method set!");
+    }
+
+  // obey the global maximum number of threads limit
+  m_NumberOfThreads = std::min( this->GetGlobalMaximumNumberOfThreads(), m_NumberOfThreads );
+
+  // The calling thread executes the first "thread", the pool the others.
+  // They might wait for each other on a Barrier, so make sure there are
+  // enough workers for all of them to run at the same time.
+  const ThreadIdType numberOfWorkers = m_ThreadPool->GetNumberOfWorkers();
+  if ( numberOfWorkers + 1 < m_NumberOfThreads )
+    {
+    m_ThreadPool->AddWorkers( m_NumberOfThreads - 1 - numberOfWorkers );
+    }
+
+  std::vector< ThreadInfoStruct > threadInfoArray( m_NumberOfThreads );
+  for ( ThreadIdType i = 0; i < m_NumberOfThreads; ++i )
+    {
+    threadInfoArray[i].ThreadID = i;
+    threadInfoArray[i].NumberOfThreads = m_NumberOfThreads;
+    threadInfoArray[i].UserData = m_SingleData;
+    threadInfoArray[i].ThreadFunction = m_SingleMethod;
+    }
+
+  WorkStealingThreadPool::TaskGroup group;
+  ThreadFunctionType singleMethod = m_SingleMethod;
+  for ( ThreadIdType i = 1; i < m_NumberOfThreads; ++i )
+    {
+    ThreadInfoStruct * threadInfo = &threadInfoArray[i];
+    m_ThreadPool->AddTask( group, [singleMethod, threadInfo]()
+      {
+      singleMethod( threadInfo );
+      } );
+    }
+
+  try
+    {
+    singleMethod( &threadInfoArray[0] );
+    }
+  catch( ... )
+    {
+    // The other tasks reference threadInfoArray, let them finish before
+    // propagating the exception.
+    try
+      {
+      m_ThreadPool->Wait( group );
+      }
+    catch( ... )
+      {
+      }
+    throw;
+    }
+  m_ThreadPool->Wait( group ); // rethrows exceptions of the other threads
+}
+
+void
+WorkStealingMultiThreader
+::ParallelizeImageRegion(
+    unsigned int dimension,
+    const IndexValueType index[],
+    const SizeValueType size[],
+    ThreadingFunctorType funcP,
+    ProcessObject* filter)
+{
+  if (filter)
+    {
+    filter->UpdateProgress(0.0f);
+    }
+
+  if (m_NumberOfThreads == 1) //no multi-threading wanted
+    {
+    funcP(index, size);
+    }
+  else //normal multi-threading
+    {
+    ImageIORegion region(dimension);
+    for (unsigned d = 0; d < dimension; d++)
+      {
+      region.SetIndex(d, index[d]);
+      region.SetSize(d, size[d]);
+      }
+
+    std::atomic<SizeValueType> pixelProgress = { 0 };
+    const SizeValueType totalCount = region.GetNumberOfPixels();
+    const SizeValueType grainSize = std::max<SizeValueType>( 1,
+      totalCount / ( SizeValueType( m_NumberOfThreads ) * m_PiecesPerThread ) );
+    std::thread::id callingThread = std::this_thread::get_id();
+
+    WorkStealingThreadPool::TaskGroup group;
+    std::function<void(ImageIORegion)> processRegion;
+    processRegion = [&](ImageIORegion regionToProcess)
+      {
+      if (filter && filter->GetAbortGenerateData())
+        {
+        std::string msg;
+        ProcessAborted e(__FILE__, __LINE__);
+        msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+            + " during multi-threaded part of filter execution";
+        e.SetDescription(msg);
+        throw e;
+        }
+
+      // Split off the upper half along the slowest varying dimension and
+      // make it available for stealing, until the piece is small enough.
+      while ( regionToProcess.GetNumberOfPixels() > grainSize )
+        {
+        int d = int(dimension) - 1;
+        while ( d >= 0 && regionToProcess.GetSize(d) <= 1 )
+          {
+          --d;
+          }
+        if ( d < 0 )
+          {
+          break;
+          }
+        const SizeValueType lowerSize = regionToProcess.GetSize(d) / 2;
+        ImageIORegion upper = regionToProcess;
+        upper.SetIndex(d, regionToProcess.GetIndex(d) + lowerSize);
+        upper.SetSize(d, regionToProcess.GetSize(d) - lowerSize);
+        regionToProcess.SetSize(d, lowerSize);
+        m_ThreadPool->AddTask(group, [&processRegion, upper]()
+          {
+          processRegion(upper);
+          });
+        }
+
+      funcP(&regionToProcess.GetIndex()[0], &regionToProcess.GetSize()[0]);
+      if (filter) //filter is provided, update progress
+        {
+        pixelProgress += regionToProcess.GetNumberOfPixels();
+        //make sure we are updating progress only from the thead which invoked filter->Update();
+        if (callingThread == std::this_thread::get_id())
+          {
+          filter->UpdateProgress(float(pixelProgress) / totalCount);
+          }
+        }
+      };
+
+    try
+      {
+      processRegion(region);
+      }
+    catch( ... )
+      {
+      // Tasks of the group reference processRegion, which lives on this stack.
+      try
+        {
+        m_ThreadPool->Wait(group);
+        }
+      catch( ... )
+        {
+        }
+      throw;
+      }
+    m_ThreadPool->Wait(group);
+    }
+
+  if (filter)
+    {
+    filter->UpdateProgress(1.0f);
+    if (filter->GetAbortGenerateData())
+      {
+      std::string msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+          + " during multi-threaded part of filter execution";
+      e.SetDescription(msg);
+      throw e;
+      }
+    }
+}
+
+void
+WorkStealingMultiThreader
+::ParallelizeArrayRange(
+    SizeValueType firstIndex,
+    SizeValueType lastIndexPlus1,
+    ArrayRangeThreadingFunctorType aFunc,
+    ProcessObject* filter)
+{
+  if (filter)
+    {
+    filter->UpdateProgress(0.0f);
+    }
+
+  const SizeValueType totalCount = lastIndexPlus1 > firstIndex ? lastIndexPlus1 - firstIndex : 0;
+  const SizeValueType grainSize = m_ArrayGrainSize > 0 ? m_ArrayGrainSize :
+    std::max<SizeValueType>( 1, totalCount / ( SizeValueType( m_NumberOfThreads ) * m_PiecesPerThread ) );
+
+  if (totalCount > 0 && (m_NumberOfThreads == 1 || totalCount <= grainSize)) //no multi-threading needed
+    {
+    aFunc(firstIndex, lastIndexPlus1);
+    }
+  else if (totalCount > 0)
+    {
+    std::atomic<SizeValueType> progress = { 0 };
+    std::thread::id callingThread = std::this_thread::get_id();
+
+    WorkStealingThreadPool::TaskGroup group;
+    std::function<void(SizeValueType, SizeValueType)> processRange;
+    processRange = [&](SizeValueType first, SizeValueType lastPlus1)
+      {
+      if (filter && filter->GetAbortGenerateData())
+        {
+        std::string msg;
+        ProcessAborted e(__FILE__, __LINE__);
+        msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+            + " during multi-threaded part of filter execution";
+        e.SetDescription(msg);
+        throw e;
+        }
+
+      // Split off the upper half and make it available for stealing, as
+      // long as both halves keep at least grainSize elements.
+      while ( lastPlus1 - first >= 2 * grainSize )
+        {
+        const SizeValueType middle = first + ( lastPlus1 - first ) / 2;
+        m_ThreadPool->AddTask(group, [&processRange, middle, lastPlus1]()
+          {
+          processRange(middle, lastPlus1);
+          });
+        lastPlus1 = middle;
+        }
+
+      aFunc(first, lastPlus1);
+      if (filter) //filter is provided, update progress
+        {
+        progress += lastPlus1 - first;
+        //make sure we are updating progress only from the thead which invoked filter->Update();
+        if (callingThread == std::this_thread::get_id())
+          {
+          filter->UpdateProgress(float(progress) / totalCount);
+          }
+        }
+      };
+
+    try
+      {
+      processRange(firstIndex, lastIndexPlus1);
+      }
+    catch( ... )
+      {
+      // Tasks of the group reference processRange, which lives on this stack.
+      try
+        {
+        m_ThreadPool->Wait(group);
+        }
+      catch( ... )
+        {
+        }
+      throw;
+      }
+    m_ThreadPool->Wait(group);
+    }
+
+  if (filter)
+    {
+    filter->UpdateProgress(1.0f);
+    if (filter->GetAbortGenerateData())
+      {
+      std::string msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "AbortGenerateData was called in " + std::string(filter->GetNameOfClass() )
+          + " during multi-threaded part of filter execution";
+      e.SetDescription(msg);
+      throw e;
+      }
+    }
+}
+
+void WorkStealingMultiThreader::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "PiecesPerThread: " << m_PiecesPerThread << std::endl;
+  os << indent << "ThreadPool: " << m_ThreadPool.GetPointer() << std::endl;
+}
+
+}
@@ -0,0 +1,381 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkWorkStealingThreadPool.h"
+#include "itkMultiThreaderBase.h"
+#include "itkThreadPool.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+// Index of the pool worker running on the current thread. Threads which do
+// not belong to the pool keep the injection deque index.
+thread_local itk::ThreadIdType currentWorkerIndex = ITK_MAX_THREADS;
+
+// State of a cheap per-thread pseudo-random generator used to pick the first
+// victim when stealing, so that thieves do not all hammer the same deque.
+thread_local unsigned int stealSeed = 0;
+
+// Group of the task being executed by the current thread.
+thread_local itk::WorkStealingThreadPool::TaskGroup * currentTaskGroup = nullptr;
+
+std::mutex                           instanceMutex;
+itk::WorkStealingThreadPool::Pointer instance;
+} // end anonymous namespace
+
+namespace itk
+{
+
+constexpr ThreadIdType WorkStealingThreadPool::InjectionQueueIndex;
+
+WorkStealingThreadPool::Pointer
+WorkStealingThreadPool
+::New()
+{
+  return Self::GetInstance();
+}
+
+WorkStealingThreadPool::Pointer
+WorkStealingThreadPool
+::GetInstance()
+{
+  std::lock_guard< std::mutex > lock(instanceMutex);
+  if ( instance.IsNull() )
+    {
+    instance = ObjectFactory< Self >::Create();
+    if ( instance.IsNull() )
+      {
+      instance = new Self;
+      instance->UnRegister(); // Remove extra reference
+      }
+    }
+  return instance;
+}
+
+bool
+WorkStealingThreadPool
+::IsWorkerThread()
+{
+  return currentWorkerIndex != InjectionQueueIndex;
+}
+
+WorkStealingThreadPool::TaskGroup *
+WorkStealingThreadPool
+::GetCurrentTaskGroup()
+{
+  return currentTaskGroup;
+}
+
+WorkStealingThreadPool
+::WorkStealingThreadPool():
+  m_NumberOfWorkers(0),
+  m_NumberOfQueuedTasks(0),
+  m_NumberOfAddedTasks(0),
+  m_Stop(false)
+{
+  // Allocate all the deques up front, so that workers can be added while
+  // other threads are stealing without reallocating the container.
+  m_Queues.reserve(ITK_MAX_THREADS + 1);
+  for ( ThreadIdType i = 0; i <= ITK_MAX_THREADS; ++i )
+    {
+    m_Queues.emplace_back(new TaskQueue);
+    }
+
+  // The thread which submits work also executes it while waiting.
+  const ThreadIdType defaultNumberOfThreads = MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  this->AddWorkers( std::max< ThreadIdType >( 1, defaultNumberOfThreads - 1 ) );
+}
+
+WorkStealingThreadPool
+::~WorkStealingThreadPool()
+{
+  {
+  std::lock_guard< std::mutex > lock(m_SleepMutex);
+  m_Stop = true;
+  }
+  m_SleepCondition.notify_all();
+
+  std::lock_guard< std::mutex > lock(m_ThreadsMutex);
+  for ( auto & thread : m_Threads )
+    {
+#if defined( _WIN32 ) && defined( ITKCommon_EXPORTS )
+    // Called during DLL_PROCESS_DETACH, when the worker threads have already
+    // been terminated. See ThreadPool::~ThreadPool.
+    thread.detach();
+#else
+    if ( ThreadPool::GetDoNotWaitForThreads() )
+      {
+      thread.detach();
+      }
+    else
+      {
+      thread.join();
+      }
+#endif
+    }
+}
+
+void
+WorkStealingThreadPool
+::AddWorkers(ThreadIdType count)
+{
+  std::lock_guard< std::mutex > lock(m_ThreadsMutex);
+  const ThreadIdType first = m_NumberOfWorkers.load();
+  const ThreadIdType last = std::min< ThreadIdType >( first + count, ITK_MAX_THREADS );
+  for ( ThreadIdType i = first; i < last; ++i )
+    {
+    m_Threads.emplace_back(&Self::WorkerExecute, this, i);
+    }
+  m_NumberOfWorkers = last;
+}
+
+ThreadIdType
+WorkStealingThreadPool
+::GetNumberOfWorkers() const
+{
+  return m_NumberOfWorkers.load();
+}
+
+void
+WorkStealingThreadPool
+::AddTask(TaskGroup & group, TaskFunctionType task)
+{
+  group.m_NumberOfPendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+  TaskQueue & queue = *m_Queues[currentWorkerIndex];
+  {
+  std::lock_guard< std::mutex > lock(queue.m_Mutex);
+  queue.m_Tasks.push_back( Task{ std::move(task), &group } );
+  m_NumberOfQueuedTasks.fetch_add(1);
+  }
+  m_NumberOfAddedTasks.fetch_add(1);
+
+  this->WakeUpSleepingThreads(true);
+}
+
+void
+WorkStealingThreadPool
+::WakeUpSleepingThreads(bool newTask)
+{
+  // Taking the lock orders this notification after the predicate check of
+  // any thread which is about to sleep, so that no wake up can be lost.
+  {
+  std::lock_guard< std::mutex > lock(m_SleepMutex);
+  }
+  // Any idle worker can execute a new task, but only some of the waiting
+  // threads may accept it.
+  if ( newTask )
+    {
+    m_SleepCondition.notify_one();
+    }
+  m_WaitCondition.notify_all();
+}
+
+bool
+WorkStealingThreadPool
+::BelongsToGroup(const Task & task, const TaskGroup * group)
+{
+  for ( const TaskGroup * taskGroup = task.m_Group; taskGroup; taskGroup = taskGroup->m_Parent )
+    {
+    if ( taskGroup == group )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+bool
+WorkStealingThreadPool
+::PopTask(ThreadIdType queueIndex, Task & task, const TaskGroup * group)
+{
+  TaskQueue & queue = *m_Queues[queueIndex];
+  std::lock_guard< std::mutex > lock(queue.m_Mutex);
+  auto it = queue.m_Tasks.rbegin();
+  if ( group )
+    {
+    it = std::find_if( queue.m_Tasks.rbegin(), queue.m_Tasks.rend(),
+                       [group](const Task & t) { return BelongsToGroup(t, group); } );
+    }
+  if ( it == queue.m_Tasks.rend() )
+    {
+    return false;
+    }
+  task = std::move( *it );
+  queue.m_Tasks.erase( std::next(it).base() );
+  m_NumberOfQueuedTasks.fetch_sub(1);
+  return true;
+}
+
+bool
+WorkStealingThreadPool
+::StealTask(ThreadIdType queueIndex, Task & task, const TaskGroup * group)
+{
+  // The deque locks are only held for a few instructions: block on them
+  // rather than skip a deque which may hold the only pending task.
+  TaskQueue & queue = *m_Queues[queueIndex];
+  std::lock_guard< std::mutex > lock(queue.m_Mutex);
+  auto it = queue.m_Tasks.begin();
+  if ( group )
+    {
+    it = std::find_if( queue.m_Tasks.begin(), queue.m_Tasks.end(),
+                       [group](const Task & t) { return BelongsToGroup(t, group); } );
+    }
+  if ( it == queue.m_Tasks.end() )
+    {
+    return false;
+    }
+  task = std::move( *it );
+  queue.m_Tasks.erase( it );
+  m_NumberOfQueuedTasks.fetch_sub(1);
+  return true;
+}
+
+bool
+WorkStealingThreadPool
+::GetTask(Task & task, const TaskGroup * group)
+{
+  const ThreadIdType self = currentWorkerIndex;
+  if ( this->PopTask(self, task, group) )
+    {
+    return true;
+    }
+
+  // Visit all the worker deques and the injection deque, starting at a
+  // pseudo-random victim.
+  const ThreadIdType numberOfQueues = m_NumberOfWorkers.load() + 1;
+  stealSeed = stealSeed * 1103515245u + 12345u;
+  const ThreadIdType start = ( stealSeed >> 16 ) % numberOfQueues;
+  for ( ThreadIdType i = 0; i < numberOfQueues; ++i )
+    {
+    ThreadIdType victim = ( start + i ) % numberOfQueues;
+    if ( victim == numberOfQueues - 1 )
+      {
+      victim = InjectionQueueIndex;
+      }
+    if ( victim != self && this->StealTask(victim, task, group) )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+void
+WorkStealingThreadPool
+::ExecuteTask(Task & task)
+{
+  TaskGroup * group = task.m_Group;
+  TaskGroup * previousTaskGroup = currentTaskGroup;
+  currentTaskGroup = group;
+  try
+    {
+    task.m_Function();
+    }
+  catch ( ... )
+    {
+    std::lock_guard< std::mutex > lock(group->m_ExceptionMutex);
+    if ( !group->m_Exception )
+      {
+      group->m_Exception = std::current_exception();
+      }
+    }
+  currentTaskGroup = previousTaskGroup;
+  // Release the functor (and whatever it captured) before signaling
+  // completion: the waiter may destroy the captured state right after.
+  task.m_Function = nullptr;
+
+  // The group must not be accessed after this point, it may already be gone.
+  if ( group->m_NumberOfPendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+    {
+    this->WakeUpSleepingThreads(false);
+    }
+}
+
+void
+WorkStealingThreadPool
+::Wait(TaskGroup & group)
+{
+  while ( !group.IsDone() )
+    {
+    const SizeValueType numberOfAddedTasks = m_NumberOfAddedTasks.load();
+    Task task;
+    if ( this->GetTask(task, &group) )
+      {
+      this->ExecuteTask(task);
+      continue;
+      }
+
+    // Nothing to help with: the remaining tasks of the group are being
+    // executed by other threads. Sleep until either the group finishes or
+    // new tasks, which may belong to the group, are added.
+    std::unique_lock< std::mutex > lock(m_SleepMutex);
+    m_WaitCondition.wait( lock, [this, &group, numberOfAddedTasks]
+      {
+      return group.IsDone() || m_NumberOfAddedTasks.load() != numberOfAddedTasks;
+      } );
+    }
+
+  if ( group.m_Exception )
+    {
+    std::exception_ptr exception = group.m_Exception;
+    group.m_Exception = nullptr;
+    std::rethrow_exception(exception);
+    }
+}
+
+void
+WorkStealingThreadPool
+::WorkerExecute(ThreadIdType workerIndex)
+{
+  currentWorkerIndex = workerIndex;
+  stealSeed = workerIndex + 1;
+
+  while ( true )
+    {
+    Task task;
+    if ( this->GetTask(task, nullptr) )
+      {
+      this->ExecuteTask(task);
+      continue;
+      }
+
+    std::unique_lock< std::mutex > lock(m_SleepMutex);
+    m_SleepCondition.wait( lock, [this]
+      {
+      return m_Stop || m_NumberOfQueuedTasks.load() > 0;
+      } );
+    if ( m_Stop && m_NumberOfQueuedTasks.load() == 0 )
+      {
+      break;
+      }
+    }
+}
+
+void
+WorkStealingThreadPool
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfWorkers: " << m_NumberOfWorkers.load() << std::endl;
+  os << indent << "NumberOfQueuedTasks: " << m_NumberOfQueuedTasks.load() << std::endl;
+}
+
+} // end namespace itk
@@ -0,0 +1,270 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageSource.h"
+#include "itkDomainThreader.h"
+#include "itkThreadedImageRegionPartitioner.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+#include "itkTestingMacros.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+// Benchmark and test of over-decomposed dynamic multi-threading
+// (PiecesPerThread > 1). The cost per pixel is concentrated in the last rows
+// of the image, so that with one piece per thread a single thread does most
+// of the work while the others wait for it.
+
+namespace itk
+{
+
+using PiecesImageType = Image< float, 2 >;
+
+class ImbalancedImageSource : public ImageSource< PiecesImageType >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ImbalancedImageSource);
+
+  using Self = ImbalancedImageSource;
+  using Superclass = ImageSource< PiecesImageType >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  itkNewMacro(Self);
+  itkTypeMacro(ImbalancedImageSource, ImageSource);
+
+  unsigned int GetNumberOfCalls() const { return m_NumberOfCalls; }
+
+  /** Largest amount of time spent by a single thread, and average over all
+   * the threads which did some work. */
+  double GetSlowestThreadTime() const { return m_SlowestThreadTime; }
+  double GetMeanThreadTime() const { return m_MeanThreadTime; }
+
+protected:
+  ImbalancedImageSource() = default;
+  ~ImbalancedImageSource() override = default;
+
+  void GenerateOutputInformation() override
+  {
+    OutputImageType * output = this->GetOutput();
+    RegionType region;
+    region.SetSize( { { 64, 256 } } );
+    output->SetLargestPossibleRegion( region );
+  }
+
+  void BeforeThreadedGenerateData() override
+  {
+    m_NumberOfCalls = 0;
+    m_ThreadTimes.clear();
+  }
+
+  void AfterThreadedGenerateData() override
+  {
+    m_SlowestThreadTime = 0.0;
+    double total = 0.0;
+    for ( const auto & threadTime : m_ThreadTimes )
+      {
+      m_SlowestThreadTime = std::max( m_SlowestThreadTime, threadTime.second );
+      total += threadTime.second;
+      }
+    m_MeanThreadTime = m_ThreadTimes.empty() ? 0.0 : total / m_ThreadTimes.size();
+  }
+
+  void DynamicThreadedGenerateData( const OutputImageRegionType & outputRegionForThread ) override
+  {
+    const auto start = std::chrono::steady_clock::now();
+    ++m_NumberOfCalls;
+
+    const IndexValueType expensiveRow = 3 * this->GetOutput()->GetLargestPossibleRegion().GetSize(1) / 4;
+    ImageRegionIteratorWithIndex< OutputImageType > it( this->GetOutput(), outputRegionForThread );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      const OutputImageType::IndexType index = it.GetIndex();
+      double value = index[0] + index[1];
+      if ( index[1] >= expensiveRow )
+        {
+        for ( unsigned int i = 0; i < 2000; ++i )
+          {
+          value = std::sqrt( value * value + 1.0 );
+          }
+        }
+      it.Set( static_cast< float >( value ) );
+      }
+
+    const std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+    std::lock_guard< std::mutex > lock( m_Mutex );
+    m_ThreadTimes[std::this_thread::get_id()] += elapsed.count();
+  }
+
+private:
+  using RegionType = OutputImageRegionType;
+
+  std::atomic< unsigned int >           m_NumberOfCalls{ 0 };
+  std::mutex                            m_Mutex;
+  std::map< std::thread::id, double >   m_ThreadTimes;
+  double                                m_SlowestThreadTime{ 0.0 };
+  double                                m_MeanThreadTime{ 0.0 };
+};
+
+
+class CountingDomainThreader
+  : public DomainThreader< ThreadedImageRegionPartitioner< 2 >, std::vector< std::atomic< unsigned int > > >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(CountingDomainThreader);
+
+  using Self = CountingDomainThreader;
+  using Superclass = DomainThreader< ThreadedImageRegionPartitioner< 2 >, std::vector< std::atomic< unsigned int > > >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  itkNewMacro(Self);
+  itkTypeMacro(CountingDomainThreader, DomainThreader);
+
+  using DomainType = Superclass::DomainType;
+
+  unsigned int GetNumberOfCalls() const { return m_NumberOfCalls; }
+
+protected:
+  CountingDomainThreader() = default;
+  ~CountingDomainThreader() override = default;
+
+  void BeforeThreadedExecution() override
+  {
+    m_NumberOfCalls = 0;
+  }
+
+  void ThreadedExecution( const DomainType & subdomain, const ThreadIdType threadId ) override
+  {
+    if ( threadId >= this->GetNumberOfThreadsUsed() )
+      {
+      itkExceptionMacro( "Unexpected thread id " << threadId );
+      }
+    ++m_NumberOfCalls;
+    const IndexValueType width = 32;
+    for ( IndexValueType y = subdomain.GetIndex(1); y <= subdomain.GetUpperIndex()[1]; ++y )
+      {
+      for ( IndexValueType x = subdomain.GetIndex(0); x <= subdomain.GetUpperIndex()[0]; ++x )
+        {
+        ++( *this->m_Associate )[y * width + x];
+        }
+      }
+  }
+
+private:
+  std::atomic< unsigned int > m_NumberOfCalls{ 0 };
+};
+
+} // end namespace itk
+
+int itkImageSourcePiecesPerThreadTest(int, char* [])
+{
+  constexpr itk::ThreadIdType numberOfThreads = 4;
+
+  itk::ImbalancedImageSource::Pointer source = itk::ImbalancedImageSource::New();
+  source->SetNumberOfThreads( numberOfThreads );
+
+  TEST_SET_GET_VALUE( 1u, source->GetPiecesPerThread() );
+  source->SetPiecesPerThread( 0 );
+  TEST_SET_GET_VALUE( 1u, source->GetPiecesPerThread() );
+
+  // Reference: one piece per thread.
+  itk::TimeProbe staticProbe;
+  staticProbe.Start();
+  TRY_EXPECT_NO_EXCEPTION( source->Update() );
+  staticProbe.Stop();
+  itk::ImbalancedImageSource::OutputImageType::Pointer reference = source->GetOutput();
+  reference->DisconnectPipeline();
+  const double staticSlowest = source->GetSlowestThreadTime();
+  const double staticMean = source->GetMeanThreadTime();
+
+  // Over-decomposed: the threads pull small pieces on demand.
+  source->SetPiecesPerThread( 16 );
+  TEST_SET_GET_VALUE( 16u, source->GetPiecesPerThread() );
+  itk::TimeProbe dynamicProbe;
+  dynamicProbe.Start();
+  TRY_EXPECT_NO_EXCEPTION( source->Update() );
+  dynamicProbe.Stop();
+  const double dynamicSlowest = source->GetSlowestThreadTime();
+  const double dynamicMean = source->GetMeanThreadTime();
+
+  std::cout << "PiecesPerThread  Time(s)  SlowestThread(s)  MeanThread(s)" << std::endl;
+  std::cout << " 1               " << staticProbe.GetTotal() << "  " << staticSlowest
+            << "  " << staticMean << std::endl;
+  std::cout << "16               " << dynamicProbe.GetTotal() << "  " << dynamicSlowest
+            << "  " << dynamicMean << std::endl;
+
+  if ( source->GetNumberOfCalls() <= numberOfThreads )
+    {
+    std::cerr << "Test failed! The region was not over-decomposed: "
+              << source->GetNumberOfCalls() << " pieces." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIterator< itk::ImbalancedImageSource::OutputImageType >
+    referenceIt( reference, reference->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< itk::ImbalancedImageSource::OutputImageType >
+    outputIt( source->GetOutput(), source->GetOutput()->GetBufferedRegion() );
+  for ( ; !referenceIt.IsAtEnd(); ++referenceIt, ++outputIt )
+    {
+    if ( referenceIt.Get() != outputIt.Get() )
+      {
+      std::cerr << "Test failed! Output differs at " << outputIt.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // DomainThreader with a ThreadedImageRegionPartitioner: every pixel of the
+  // domain is visited exactly once, with valid thread ids.
+  itk::CountingDomainThreader::Pointer domainThreader = itk::CountingDomainThreader::New();
+  TEST_SET_GET_VALUE( 1u, domainThreader->GetPiecesPerThread() );
+  domainThreader->SetPiecesPerThread( 8 );
+  TEST_SET_GET_VALUE( 8u, domainThreader->GetPiecesPerThread() );
+  domainThreader->SetMaximumNumberOfThreads( numberOfThreads );
+
+  itk::CountingDomainThreader::DomainType domain;
+  domain.SetSize( { { 32, 100 } } );
+  std::vector< std::atomic< unsigned int > > visits( domain.GetNumberOfPixels() );
+  for ( auto & v : visits )
+    {
+    v = 0;
+    }
+  TRY_EXPECT_NO_EXCEPTION( domainThreader->Execute( &visits, domain ) );
+  for ( auto & v : visits )
+    {
+    if ( v.load() != 1 )
+      {
+      std::cerr << "Test failed! DomainThreader visited a pixel " << v.load() << " times." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if ( domainThreader->GetNumberOfThreadsUsed() > 1
+       && domainThreader->GetNumberOfCalls() <= domainThreader->GetNumberOfThreadsUsed() )
+    {
+    std::cerr << "Test failed! The domain was not over-decomposed: "
+              << domainThreader->GetNumberOfCalls() << " subdomains." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED!" << std::endl;
+  return EXIT_SUCCESS;
+}
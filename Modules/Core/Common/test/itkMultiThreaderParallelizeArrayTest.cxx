@@ -0,0 +1,128 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMultiThreaderBase.h"
+#include "itkTestingMacros.h"
+#include <atomic>
+#include <vector>
+
+namespace
+{
+bool CheckParallelizeArray(itk::MultiThreaderBase * threader,
+                           itk::SizeValueType firstIndex,
+                           itk::SizeValueType lastIndexPlus1,
+                           itk::SizeValueType grainSize)
+{
+  threader->SetArrayGrainSize( grainSize );
+
+  std::vector< std::atomic< unsigned > > visits( lastIndexPlus1 + 1 );
+  for ( auto & v : visits )
+    {
+    v = 0;
+    }
+  std::atomic< itk::SizeValueType > smallestChunk( itk::NumericTraits< itk::SizeValueType >::max() );
+
+  threader->ParallelizeArrayRange( firstIndex, lastIndexPlus1,
+    [&]( itk::SizeValueType first, itk::SizeValueType lastPlus1 )
+    {
+    for ( itk::SizeValueType i = first; i < lastPlus1; ++i )
+      {
+      ++visits[i];
+      }
+    // Only the chunk at the end of the range may be smaller than the grain.
+    if ( lastPlus1 != lastIndexPlus1 )
+      {
+      itk::SizeValueType current = smallestChunk.load();
+      while ( lastPlus1 - first < current && !smallestChunk.compare_exchange_weak( current, lastPlus1 - first ) )
+        {
+        }
+      }
+    },
+    nullptr );
+
+  threader->ParallelizeArray( firstIndex, lastIndexPlus1,
+    [&visits]( itk::SizeValueType i )
+    {
+    ++visits[i];
+    },
+    nullptr );
+
+  bool success = true;
+  for ( itk::SizeValueType i = 0; i < visits.size(); ++i )
+    {
+    const unsigned expected = ( i >= firstIndex && i < lastIndexPlus1 ) ? 2 : 0;
+    if ( visits[i].load() != expected )
+      {
+      std::cerr << "Error: " << threader->GetNameOfClass() << " visited index " << i << " "
+                << visits[i].load() << " times instead of " << expected
+                << " (grain size " << grainSize << ")" << std::endl;
+      success = false;
+      break;
+      }
+    }
+  if ( grainSize > 0 && smallestChunk.load() < grainSize )
+    {
+    std::cerr << "Error: " << threader->GetNameOfClass() << " produced a chunk of "
+              << smallestChunk.load() << " elements with grain size " << grainSize << std::endl;
+    success = false;
+    }
+  return success;
+}
+}
+
+int itkMultiThreaderParallelizeArrayTest(int, char* [])
+{
+  using ThreaderType = itk::MultiThreaderBase::ThreaderType;
+
+  bool success = true;
+  for ( int t = ThreaderType::First; t <= ThreaderType::Last; ++t )
+    {
+    const auto threaderType = static_cast< ThreaderType >( t );
+#ifndef ITK_USE_TBB
+    if ( threaderType == ThreaderType::TBB )
+      {
+      continue;
+      }
+#endif
+    itk::MultiThreaderBase::SetGlobalDefaultThreader( threaderType );
+    itk::MultiThreaderBase::Pointer threader = itk::MultiThreaderBase::New();
+    std::cout << "Testing " << threader->GetNameOfClass() << std::endl;
+
+    TEST_SET_GET_VALUE( 0u, threader->GetArrayGrainSize() );
+
+    for ( itk::ThreadIdType numberOfThreads : { 1u, 3u, 8u } )
+      {
+      threader->SetNumberOfThreads( numberOfThreads );
+      success &= CheckParallelizeArray( threader, 0, 1000, 0 );
+      success &= CheckParallelizeArray( threader, 17, 1000, 0 );
+      success &= CheckParallelizeArray( threader, 5, 6, 0 );
+      success &= CheckParallelizeArray( threader, 7, 7, 0 );
+      success &= CheckParallelizeArray( threader, 3, 10003, 1 );
+      success &= CheckParallelizeArray( threader, 3, 10003, 64 );
+      success &= CheckParallelizeArray( threader, 0, 100, 1000 );
+      }
+    }
+
+  if ( !success )
+    {
+    std::cout << "Test FAILED!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test PASSED!" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -66,7 +66,7 @@ int itkMultiThreaderTypeFromEnvironmentTest(int argc, char* argv[])
   success &= checkThreaderByName(expectedThreaderType);
 
   //check that developer's choice for default is respected
-  std::set<ThreaderType> threadersToTest = { ThreaderType::Platform, ThreaderType::Pool };
+  std::set<ThreaderType> threadersToTest = { ThreaderType::Platform, ThreaderType::Pool, ThreaderType::WorkStealing };
 #ifdef ITK_USE_TBB
   threadersToTest.insert(ThreaderType::TBB);
 #endif // ITK_USE_TBB
@@ -80,7 +80,7 @@ int itkMultiThreaderTypeFromEnvironmentTest(int argc, char* argv[])
   // 1. insert it into threadersToTest set
   // 2. add tests to Modules/Core/Common/test/CMakeLists.txt similarily to tests for other multi-threaders
   // 3. rewrite the condition below to use whatever is really the last threader type
-  itkAssertOrThrowMacro(ThreaderType::TBB == ThreaderType::Last,
+  itkAssertOrThrowMacro(ThreaderType::WorkStealing == ThreaderType::Last,
       "All multi-threader implementation have to be tested!");
 
   if (success)
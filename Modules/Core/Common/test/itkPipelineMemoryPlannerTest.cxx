@@ -0,0 +1,196 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPipelineMemoryPlanner.h"
+#include "itkPixelBufferPool.h"
+#include "itkStreamingImageFilter.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkAddImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include <thread>
+
+// Execute a pipeline with a branch through a PipelineMemoryPlanner, alone
+// and for each piece of a StreamingImageFilter, and check that the result
+// is the one of a plain update, that the intermediate images are released
+// and their buffers recycled, and that an image referenced by the
+// application is kept. The pixel buffer pool is scoped to the thread which
+// activates it.
+
+namespace
+{
+using ImageType = itk::Image< float, 3 >;
+using ShiftScaleType = itk::ShiftScaleImageFilter< ImageType, ImageType >;
+using AddType = itk::AddImageFilter< ImageType, ImageType, ImageType >;
+
+// input -> a -> b -> add(a, b) -> c -> d
+class Pipeline
+{
+public:
+  explicit Pipeline( ImageType * input, bool inPlace )
+  {
+    for ( auto & filter : m_Filters )
+      {
+      filter = ShiftScaleType::New();
+      }
+    m_Add = AddType::New();
+    m_Add->SetInPlace( inPlace );
+
+    m_Filters[0]->SetInput( input );
+    m_Filters[0]->SetShift( 1.0 );
+    m_Filters[1]->SetInput( m_Filters[0]->GetOutput() );
+    m_Filters[1]->SetScale( 2.0 );
+    m_Add->SetInput1( m_Filters[0]->GetOutput() );
+    m_Add->SetInput2( m_Filters[1]->GetOutput() );
+    m_Filters[2]->SetInput( m_Add->GetOutput() );
+    m_Filters[2]->SetScale( 0.5 );
+    m_Filters[3]->SetInput( m_Filters[2]->GetOutput() );
+    m_Filters[3]->SetShift( -3.0 );
+  }
+
+  ImageType * GetOutput()
+  {
+    return m_Filters[3]->GetOutput();
+  }
+
+  ImageType * GetIntermediate( unsigned int i )
+  {
+    return m_Filters[i]->GetOutput();
+  }
+
+private:
+  ShiftScaleType::Pointer m_Filters[4];
+  AddType::Pointer        m_Add;
+};
+
+bool
+SameImage( const ImageType * image1, const ImageType * image2 )
+{
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( image1, image1->GetRequestedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != image2->GetPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Different pixels at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkPipelineMemoryPlannerTest( int, char *[] )
+{
+  ImageType::Pointer input = ImageType::New();
+  ImageType::SizeType size = { { 40, 30, 20 } };
+  input->SetRegions( size );
+  input->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( input, input->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    it.Set( static_cast< float >( index[0] + 3 * index[1] - index[2] ) );
+    }
+  const itk::SizeValueType imageMemorySize = input->GetBufferedRegion().GetNumberOfPixels() * sizeof( float );
+
+  Pipeline reference( input, false );
+  reference.GetOutput()->Update();
+
+  itk::PipelineMemoryPlanner::Pointer planner = itk::PipelineMemoryPlanner::New();
+  EXERCISE_BASIC_OBJECT_METHODS( planner, PipelineMemoryPlanner, Object );
+
+  // Plan without executing: 5 images, of which at most 3 are needed at once.
+  Pipeline pipeline( input, false );
+  pipeline.GetOutput()->UpdateOutputInformation();
+  pipeline.GetOutput()->PropagateRequestedRegion();
+  planner->Plan( pipeline.GetOutput() );
+  TEST_EXPECT_EQUAL( planner->GetNumberOfPlannedStages(), 5 );
+  TEST_EXPECT_EQUAL( planner->GetUnplannedPeakMemorySize(), 5 * imageMemorySize );
+  TEST_EXPECT_EQUAL( planner->GetPlannedPeakMemorySize(), 3 * imageMemorySize );
+
+  const itk::SizeValueType recycled = itk::PixelBufferPool::GetNumberOfRecycledBuffers();
+  planner->Execute();
+  TEST_EXPECT_EQUAL( planner->GetNumberOfReleasedDataObjects(), 4 );
+  TEST_EXPECT_TRUE( itk::PixelBufferPool::GetNumberOfRecycledBuffers() > recycled );
+  TEST_EXPECT_TRUE( !itk::PixelBufferPool::IsActive() );
+  TEST_EXPECT_EQUAL( itk::PixelBufferPool::GetPooledMemorySize(), 0 );
+  TEST_EXPECT_TRUE( pipeline.GetIntermediate( 1 )->GetDataReleased() );
+  TEST_EXPECT_TRUE( !pipeline.GetOutput()->GetDataReleased() );
+  TEST_EXPECT_TRUE( SameImage( reference.GetOutput(), pipeline.GetOutput() ) );
+
+  // Up to date: nothing to execute.
+  planner->Update( pipeline.GetOutput() );
+  TEST_EXPECT_EQUAL( planner->GetNumberOfPlannedStages(), 0 );
+
+  // An intermediate image referenced by the application is kept.
+  Pipeline referenced( input, false );
+  ImageType::Pointer intermediate = referenced.GetIntermediate( 1 );
+  planner->Update( referenced.GetOutput() );
+  TEST_EXPECT_EQUAL( planner->GetNumberOfReleasedDataObjects(), 3 );
+  TEST_EXPECT_TRUE( !intermediate->GetDataReleased() );
+  TEST_EXPECT_TRUE( SameImage( reference.GetIntermediate( 1 ), intermediate ) );
+  TEST_EXPECT_TRUE( SameImage( reference.GetOutput(), referenced.GetOutput() ) );
+
+  // In-place addition.
+  Pipeline inPlace( input, true );
+  planner->Update( inPlace.GetOutput() );
+  TEST_EXPECT_TRUE( SameImage( reference.GetOutput(), inPlace.GetOutput() ) );
+
+  // Streaming, with the planner executing each piece.
+  Pipeline streamed( input, false );
+  using StreamingType = itk::StreamingImageFilter< ImageType, ImageType >;
+  StreamingType::Pointer streamer = StreamingType::New();
+  streamer->SetInput( streamed.GetOutput() );
+  streamer->SetNumberOfStreamDivisions( 4 );
+  streamer->SetMemoryPlanner( planner );
+  TEST_SET_GET_VALUE( planner.GetPointer(), streamer->GetMemoryPlanner() );
+  streamer->Update();
+  TEST_EXPECT_TRUE( planner->GetPlannedPeakMemorySize() < imageMemorySize );
+  TEST_EXPECT_TRUE( SameImage( reference.GetOutput(), streamer->GetOutput() ) );
+
+  // The pool activated by a thread is not used by the other threads, which
+  // may release its buffers.
+  itk::PixelBufferPool::Activate();
+  void *buffer = itk::PixelBufferPool::Allocate( 1000 );
+  TEST_EXPECT_TRUE( buffer != nullptr );
+  bool otherThreadIsActive = true;
+  void *otherThreadBuffer = buffer;
+  std::size_t otherThreadPooledMemorySize = 1;
+  std::thread otherThread( [&]()
+    {
+    otherThreadIsActive = itk::PixelBufferPool::IsActive();
+    otherThreadBuffer = itk::PixelBufferPool::Allocate( 1000 );
+    itk::PixelBufferPool::Release( buffer );
+    otherThreadPooledMemorySize = itk::PixelBufferPool::GetPooledMemorySize();
+    } );
+  otherThread.join();
+  TEST_EXPECT_TRUE( !otherThreadIsActive );
+  TEST_EXPECT_TRUE( otherThreadBuffer == nullptr );
+  TEST_EXPECT_EQUAL( otherThreadPooledMemorySize, 0 );
+  TEST_EXPECT_EQUAL( itk::PixelBufferPool::GetPooledMemorySize(), 0 );
+  TEST_EXPECT_TRUE( !itk::PixelBufferPool::Release( buffer ) );
+  buffer = itk::PixelBufferPool::Allocate( 1000 );
+  TEST_EXPECT_TRUE( itk::PixelBufferPool::Release( buffer ) );
+  TEST_EXPECT_EQUAL( itk::PixelBufferPool::GetPooledMemorySize(), 1000 );
+  itk::PixelBufferPool::Deactivate();
+  TEST_EXPECT_TRUE( !itk::PixelBufferPool::IsActive() );
+  TEST_EXPECT_EQUAL( itk::PixelBufferPool::GetPooledMemorySize(), 0 );
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
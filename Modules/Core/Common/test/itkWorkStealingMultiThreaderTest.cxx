@@ -0,0 +1,201 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkWorkStealingMultiThreader.h"
+#include "itkBarrier.h"
+#include "itkTestingMacros.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct BarrierData
+{
+  itk::Barrier::Pointer      m_Barrier;
+  std::atomic< unsigned >    m_Arrived;
+  std::atomic< unsigned >    m_Failures;
+};
+
+ITK_THREAD_RETURN_TYPE BarrierCallback(void * arg)
+{
+  auto * threadInfo = static_cast< itk::MultiThreaderBase::ThreadInfoStruct * >( arg );
+  auto * data = static_cast< BarrierData * >( threadInfo->UserData );
+
+  ++data->m_Arrived;
+  data->m_Barrier->Wait();
+  // Everybody must have arrived before anybody leaves the barrier.
+  if ( data->m_Arrived.load() != threadInfo->NumberOfThreads )
+    {
+    ++data->m_Failures;
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+ITK_THREAD_RETURN_TYPE ThrowingCallback(void * arg)
+{
+  auto * threadInfo = static_cast< itk::MultiThreaderBase::ThreadInfoStruct * >( arg );
+  if ( threadInfo->ThreadID == threadInfo->NumberOfThreads - 1 )
+    {
+    itkGenericExceptionMacro( "Exception from the last thread" );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+}
+
+int itkWorkStealingMultiThreaderTest(int, char* [])
+{
+  itk::WorkStealingMultiThreader::Pointer threader = itk::WorkStealingMultiThreader::New();
+  EXERCISE_BASIC_OBJECT_METHODS(threader, WorkStealingMultiThreader, MultiThreaderBase);
+
+  TEST_SET_GET_VALUE( 4u, threader->GetPiecesPerThread() );
+  threader->SetPiecesPerThread( 8 );
+  TEST_SET_GET_VALUE( 8u, threader->GetPiecesPerThread() );
+
+  threader->SetNumberOfThreads( 8 );
+
+  // Nested parallelism: every piece of the outer region launches a parallel
+  // loop over an inner region. Every (outer, inner) pair has to be visited
+  // exactly once, and the scheduler must not deadlock.
+  using OuterRegionType = itk::ImageRegion< 2 >;
+  using InnerRegionType = itk::ImageRegion< 3 >;
+  OuterRegionType outerRegion;
+  outerRegion.SetSize( { { 16, 12 } } );
+  InnerRegionType innerRegion;
+  innerRegion.SetSize( { { 5, 7, 9 } } );
+  const itk::SizeValueType innerCount = innerRegion.GetNumberOfPixels();
+
+  std::vector< std::atomic< unsigned > > visits( outerRegion.GetNumberOfPixels() * innerCount );
+  for ( auto & v : visits )
+    {
+    v = 0;
+    }
+
+  threader->ParallelizeImageRegion< 2 >( outerRegion,
+    [&]( const OuterRegionType & outerPiece )
+    {
+    itk::MultiThreaderBase::Pointer nested = itk::WorkStealingMultiThreader::New();
+    nested->SetNumberOfThreads( 8 );
+    for ( itk::IndexValueType y = outerPiece.GetIndex(1); y < outerPiece.GetUpperIndex()[1] + 1; ++y )
+      {
+      for ( itk::IndexValueType x = outerPiece.GetIndex(0); x < outerPiece.GetUpperIndex()[0] + 1; ++x )
+        {
+        const itk::SizeValueType outerOffset = ( y * outerRegion.GetSize(0) + x ) * innerCount;
+        nested->ParallelizeImageRegion< 3 >( innerRegion,
+          [&]( const InnerRegionType & innerPiece )
+          {
+          const InnerRegionType::IndexType first = innerPiece.GetIndex();
+          const InnerRegionType::IndexType last = innerPiece.GetUpperIndex();
+          for ( itk::IndexValueType k = first[2]; k <= last[2]; ++k )
+            {
+            for ( itk::IndexValueType j = first[1]; j <= last[1]; ++j )
+              {
+              for ( itk::IndexValueType i = first[0]; i <= last[0]; ++i )
+                {
+                ++visits[ outerOffset + ( k * 7 + j ) * 5 + i ];
+                }
+              }
+            }
+          },
+          nullptr );
+        }
+      }
+    },
+    nullptr );
+
+  for ( auto & v : visits )
+    {
+    if ( v.load() != 1 )
+      {
+      std::cerr << "Test failed! Nested ParallelizeImageRegion visited a pixel "
+                << v.load() << " times." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // SingleMethodExecute has to run all the threads concurrently, even when
+  // more threads are requested than the pool has workers.
+  const itk::ThreadIdType numberOfThreads =
+    std::min< itk::ThreadIdType >( 2 * itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads() + 3,
+                                   itk::MultiThreaderBase::GetGlobalMaximumNumberOfThreads() );
+  threader->SetNumberOfThreads( numberOfThreads );
+  BarrierData barrierData;
+  barrierData.m_Barrier = itk::Barrier::New();
+  barrierData.m_Barrier->Initialize( threader->GetNumberOfThreads() );
+  barrierData.m_Arrived = 0;
+  barrierData.m_Failures = 0;
+  threader->SetSingleMethod( &BarrierCallback, &barrierData );
+  threader->SingleMethodExecute();
+  if ( barrierData.m_Failures.load() != 0 || barrierData.m_Arrived.load() != threader->GetNumberOfThreads() )
+    {
+    std::cerr << "Test failed! SingleMethodExecute did not run all threads concurrently." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A thread waiting for a group only executes the tasks of this group. The
+  // unrelated task below blocks until the wait is over: executing it while
+  // the task of the group runs on a worker would deadlock.
+  {
+  itk::WorkStealingThreadPool::Pointer pool = itk::WorkStealingThreadPool::GetInstance();
+  std::atomic< bool > started( false );
+  itk::WorkStealingThreadPool::TaskGroup group;
+  pool->AddTask( group, [&started]()
+    {
+    started = true;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    } );
+  while ( !started )
+    {
+    std::this_thread::yield();
+    }
+
+  std::promise< void > waitIsOver;
+  std::shared_future< void > waitIsOverFuture = waitIsOver.get_future().share();
+  itk::WorkStealingThreadPool::TaskGroup unrelatedGroup;
+  pool->AddTask( unrelatedGroup, [waitIsOverFuture]()
+    {
+    waitIsOverFuture.wait();
+    } );
+
+  pool->Wait( group );
+  waitIsOver.set_value();
+  pool->Wait( unrelatedGroup );
+  }
+
+  // Exceptions thrown in any thread are propagated to the caller.
+  threader->SetNumberOfThreads( 4 );
+  threader->SetSingleMethod( &ThrowingCallback, nullptr );
+  TRY_EXPECT_EXCEPTION( threader->SingleMethodExecute() );
+
+  OuterRegionType throwingRegion;
+  throwingRegion.SetSize( { { 64, 64 } } );
+  TRY_EXPECT_EXCEPTION( threader->ParallelizeImageRegion< 2 >( throwingRegion,
+    []( const OuterRegionType & piece )
+    {
+    if ( piece.IsInside( OuterRegionType::IndexType{ { 63, 63 } } ) )
+      {
+      itkGenericExceptionMacro( "Exception from the last piece" );
+      }
+    },
+    nullptr ) );
+
+  std::cout << "Test PASSED!" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -28,6 +28,7 @@
 #ifndef itkBSplineInterpolateImageFunction_h
 #define itkBSplineInterpolateImageFunction_h
 
+#include <type_traits>
 #include <vector>
 
 #include "itkInterpolateImageFunction.h"
@@ -110,6 +111,7 @@ public:
 
   /** Index type alias support */
   using IndexType = typename Superclass::IndexType;
+  using IndexValueType = typename Superclass::IndexValueType;
 
   /** ContinuousIndex type alias support */
   using ContinuousIndexType = typename Superclass::ContinuousIndexType;
@@ -180,6 +182,20 @@ public:
                                                index,
                                                ThreadIdType threadId) const;
 
+  /** Evaluate the function at a sequence of continuous index positions.
+   *
+   * The weights are computed separably: for each position, the spline
+   * weights and the mirrored coefficient offsets are computed once per
+   * dimension, and are reused from the previous position along the
+   * dimensions where its coordinate does not change, as along the
+   * scanlines of an axis aligned resampling. The coefficients are then
+   * combined one dimension at a time, directly from the coefficient
+   * buffer. The working space is on the stack, hence this method is
+   * thread safe without a thread identifier. No bounds checking is done. */
+  void EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                                   OutputType *values,
+                                   SizeValueType numberOfIndices) const override;
+
   CovariantVectorType EvaluateDerivative(const PointType & point) const
   {
     ContinuousIndexType index;
@@ -366,6 +382,39 @@ protected:
   typename CoefficientImageType::ConstPointer m_Coefficients;
 
 private:
+  /** Largest support of the supported splines, of order 5. */
+  static constexpr unsigned int MaximumSupportSize = 6;
+
+  using CoefficientOffsetType = typename CoefficientImageType::OffsetValueType;
+  using SupportWeightsType = double[ImageDimension][MaximumSupportSize];
+  using SupportOffsetsType = CoefficientOffsetType[ImageDimension][MaximumSupportSize];
+
+  /** Determines the weights for interpolation of the value x along one
+   * dimension, given its offset \c w from the center of the support. */
+  static void SetInterpolationWeights(double w, double *weights, unsigned int splineOrder);
+
+  /** Determines the weights and the mirrored coefficient offsets of the
+   * support of coordinate \c x along dimension \c dim. */
+  void SetSupportWeightsAndOffsets(unsigned int dim,
+                                   double x,
+                                   double *weights,
+                                   CoefficientOffsetType *offsets) const;
+
+  /** Sum of the coefficients of the support weighted separably, one
+   * dimension at a time, from the last one. */
+  template< unsigned int VDimension >
+  static double SeparableSum(const CoefficientDataType *coefficients,
+                             const SupportWeightsType & weights,
+                             const SupportOffsetsType & offsets,
+                             unsigned int supportSize,
+                             std::integral_constant< unsigned int, VDimension >);
+
+  static double SeparableSum(const CoefficientDataType *coefficients,
+                             const SupportWeightsType & weights,
+                             const SupportOffsetsType & offsets,
+                             unsigned int supportSize,
+                             std::integral_constant< unsigned int, 0 >);
+
   /** Determines the weights for interpolation of the value x */
   void SetInterpolationWeights(const ContinuousIndexType & x,
                                const vnl_matrix< long > & EvaluateIndex,
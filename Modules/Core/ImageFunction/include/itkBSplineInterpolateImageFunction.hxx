@@ -386,97 +386,80 @@ BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
                           vnl_matrix< double > & weights,
                           unsigned int splineOrder) const
 {
-  // For speed improvements we could make each case a separate function and use
-  // function pointers to reference the correct weight order.
-  // Left as is for now for readability.
-  double w, w2, w4, t, t0, t1;
+  // The weights are given by the offset from the center of the support.
+  for ( unsigned int n = 0; n < ImageDimension; n++ )
+    {
+    Self::SetInterpolationWeights(x[n] - (double)EvaluateIndex[n][splineOrder / 2], weights[n], splineOrder);
+    }
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+void
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::SetInterpolationWeights(double w, double *weights, unsigned int splineOrder)
+{
+  double w2, w4, t, t0, t1;
 
   switch ( splineOrder )
     {
     case 3:
       {
-      for ( unsigned int n = 0; n < ImageDimension; n++ )
-        {
-        w = x[n] - (double)EvaluateIndex[n][1];
-        weights[n][3] = ( 1.0 / 6.0 ) * w * w * w;
-        weights[n][0] = ( 1.0 / 6.0 ) + 0.5 * w * ( w - 1.0 ) - weights[n][3];
-        weights[n][2] = w + weights[n][0] - 2.0 * weights[n][3];
-        weights[n][1] = 1.0 - weights[n][0] - weights[n][2] - weights[n][3];
-        }
+      weights[3] = ( 1.0 / 6.0 ) * w * w * w;
+      weights[0] = ( 1.0 / 6.0 ) + 0.5 * w * ( w - 1.0 ) - weights[3];
+      weights[2] = w + weights[0] - 2.0 * weights[3];
+      weights[1] = 1.0 - weights[0] - weights[2] - weights[3];
       break;
       }
     case 0:
       {
-      for ( unsigned int n = 0; n < ImageDimension; n++ )
-        {
-        weights[n][0] = 1; // implements nearest neighbor
-        }
+      weights[0] = 1; // implements nearest neighbor
       break;
       }
     case 1:
       {
-      for ( unsigned int n = 0; n < ImageDimension; n++ )
-        {
-        w = x[n] - (double)EvaluateIndex[n][0];
-        weights[n][1] = w;
-        weights[n][0] = 1.0 - w;
-        }
+      weights[1] = w;
+      weights[0] = 1.0 - w;
       break;
       }
     case 2:
       {
-      for ( unsigned int n = 0; n < ImageDimension; n++ )
-        {
-        /* x */
-        w = x[n] - (double)EvaluateIndex[n][1];
-        weights[n][1] = 0.75 - w * w;
-        weights[n][2] = 0.5 * ( w - weights[n][1] + 1.0 );
-        weights[n][0] = 1.0 - weights[n][1] - weights[n][2];
-        }
+      weights[1] = 0.75 - w * w;
+      weights[2] = 0.5 * ( w - weights[1] + 1.0 );
+      weights[0] = 1.0 - weights[1] - weights[2];
       break;
       }
     case 4:
       {
-      for ( unsigned int n = 0; n < ImageDimension; n++ )
-        {
-        /* x */
-        w = x[n] - (double)EvaluateIndex[n][2];
-        w2 = w * w;
-        t = ( 1.0 / 6.0 ) * w2;
-        weights[n][0] = 0.5 - w;
-        weights[n][0] *= weights[n][0];
-        weights[n][0] *= ( 1.0 / 24.0 ) * weights[n][0];
-        t0 = w * ( t - 11.0 / 24.0 );
-        t1 = 19.0 / 96.0 + w2 * ( 0.25 - t );
-        weights[n][1] = t1 + t0;
-        weights[n][3] = t1 - t0;
-        weights[n][4] = weights[n][0] + t0 + 0.5 * w;
-        weights[n][2] = 1.0 - weights[n][0] - weights[n][1] - weights[n][3] - weights[n][4];
-        }
+      w2 = w * w;
+      t = ( 1.0 / 6.0 ) * w2;
+      weights[0] = 0.5 - w;
+      weights[0] *= weights[0];
+      weights[0] *= ( 1.0 / 24.0 ) * weights[0];
+      t0 = w * ( t - 11.0 / 24.0 );
+      t1 = 19.0 / 96.0 + w2 * ( 0.25 - t );
+      weights[1] = t1 + t0;
+      weights[3] = t1 - t0;
+      weights[4] = weights[0] + t0 + 0.5 * w;
+      weights[2] = 1.0 - weights[0] - weights[1] - weights[3] - weights[4];
       break;
       }
     case 5:
       {
-      for ( unsigned int n = 0; n < ImageDimension; n++ )
-        {
-        /* x */
-        w = x[n] - (double)EvaluateIndex[n][2];
-        w2 = w * w;
-        weights[n][5] = ( 1.0 / 120.0 ) * w * w2 * w2;
-        w2 -= w;
-        w4 = w2 * w2;
-        w -= 0.5;
-        t = w2 * ( w2 - 3.0 );
-        weights[n][0] = ( 1.0 / 24.0 ) * ( 1.0 / 5.0 + w2 + w4 ) - weights[n][5];
-        t0 = ( 1.0 / 24.0 ) * ( w2 * ( w2 - 5.0 ) + 46.0 / 5.0 );
-        t1 = ( -1.0 / 12.0 ) * w * ( t + 4.0 );
-        weights[n][2] = t0 + t1;
-        weights[n][3] = t0 - t1;
-        t0 = ( 1.0 / 16.0 ) * ( 9.0 / 5.0 - t );
-        t1 = ( 1.0 / 24.0 ) * w * ( w4 - w2 - 5.0 );
-        weights[n][1] = t0 + t1;
-        weights[n][4] = t0 - t1;
-        }
+      w2 = w * w;
+      weights[5] = ( 1.0 / 120.0 ) * w * w2 * w2;
+      w2 -= w;
+      w4 = w2 * w2;
+      w -= 0.5;
+      t = w2 * ( w2 - 3.0 );
+      weights[0] = ( 1.0 / 24.0 ) * ( 1.0 / 5.0 + w2 + w4 ) - weights[5];
+      t0 = ( 1.0 / 24.0 ) * ( w2 * ( w2 - 5.0 ) + 46.0 / 5.0 );
+      t1 = ( -1.0 / 12.0 ) * w * ( t + 4.0 );
+      weights[2] = t0 + t1;
+      weights[3] = t0 - t1;
+      t0 = ( 1.0 / 16.0 ) * ( 9.0 / 5.0 - t );
+      t1 = ( 1.0 / 24.0 ) * w * ( w4 - w2 - 5.0 );
+      weights[1] = t0 + t1;
+      weights[4] = t0 - t1;
       break;
       }
     default:
@@ -692,7 +675,7 @@ BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
       {
       for ( unsigned int k = 0; k <= splineOrder; k++ )
         {
-        evaluateIndex[n][k] = 0;
+        evaluateIndex[n][k] = startIndex[n];
         }
       }
     else
@@ -901,6 +884,117 @@ BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
 
   return ( derivativeValue );
 }
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+void
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::SetSupportWeightsAndOffsets(unsigned int dim,
+                              double x,
+                              double *weights,
+                              CoefficientOffsetType *offsets) const
+{
+  // Same support and mirror boundary conditions as DetermineRegionOfSupport()
+  // and ApplyMirrorBoundaryConditions().
+  const float halfOffset = m_SplineOrder & 1 ? 0.0 : 0.5;
+  const long  center = (long)std::floor( (float)x + halfOffset );
+
+  Self::SetInterpolationWeights(x - (double)center, weights, m_SplineOrder);
+
+  const IndexValueType startIndex = this->GetStartIndex()[dim];
+  const IndexValueType endIndex = this->GetEndIndex()[dim];
+  const IndexValueType bufferStart = m_Coefficients->GetBufferedRegion().GetIndex(dim);
+  const CoefficientOffsetType stride = m_Coefficients->GetOffsetTable()[dim];
+  long index = center - m_SplineOrder / 2;
+  for ( unsigned int k = 0; k <= m_SplineOrder; k++, index++ )
+    {
+    long mirrored = startIndex;
+    if ( m_DataLength[dim] != 1 )
+      {
+      mirrored = index;
+      if ( mirrored < startIndex )
+        {
+        mirrored = startIndex + ( startIndex - mirrored );
+        }
+      if ( mirrored >= endIndex )
+        {
+        mirrored = endIndex - ( mirrored - endIndex );
+        }
+      }
+    offsets[k] = ( mirrored - bufferStart ) * stride;
+    }
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+template< unsigned int VDimension >
+double
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::SeparableSum(const CoefficientDataType *coefficients,
+               const SupportWeightsType & weights,
+               const SupportOffsetsType & offsets,
+               unsigned int supportSize,
+               std::integral_constant< unsigned int, VDimension >)
+{
+  double sum = 0.0;
+  for ( unsigned int k = 0; k < supportSize; k++ )
+    {
+    sum += weights[VDimension][k]
+           * Self::SeparableSum(coefficients + offsets[VDimension][k], weights, offsets, supportSize,
+                                std::integral_constant< unsigned int, VDimension - 1 >());
+    }
+  return sum;
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+double
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::SeparableSum(const CoefficientDataType *coefficients,
+               const SupportWeightsType & weights,
+               const SupportOffsetsType & offsets,
+               unsigned int supportSize,
+               std::integral_constant< unsigned int, 0 >)
+{
+  // Innermost dimension: the coefficients are contiguous, except where
+  // mirrored at the boundaries.
+  double sum = 0.0;
+  for ( unsigned int k = 0; k < supportSize; k++ )
+    {
+    sum += weights[0][k] * static_cast< double >( coefficients[offsets[0][k]] );
+    }
+  return sum;
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+void
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                              OutputType *values,
+                              SizeValueType numberOfIndices) const
+{
+  if ( m_SplineOrder + 1 > MaximumSupportSize )
+    {
+    itkExceptionMacro("SplineOrder must be between 0 and 5. Requested spline order has not been implemented yet.");
+    }
+
+  const CoefficientDataType *coefficients = m_Coefficients->GetBufferPointer();
+  const unsigned int         supportSize = m_SplineOrder + 1;
+
+  SupportWeightsType weights;
+  SupportOffsetsType offsets;
+  for ( SizeValueType i = 0; i < numberOfIndices; ++i )
+    {
+    const ContinuousIndexType & x = indices[i];
+    for ( unsigned int n = 0; n < ImageDimension; n++ )
+      {
+      // Along a scanline, most coordinates do not change.
+      if ( i == 0 || x[n] != indices[i - 1][n] )
+        {
+        this->SetSupportWeightsAndOffsets(n, x[n], weights[n], offsets[n]);
+        }
+      }
+    values[i] = Self::SeparableSum(coefficients, weights, offsets, supportSize,
+                                   std::integral_constant< unsigned int, ImageDimension - 1 >());
+    }
+}
 } // namespace itk
 
 #endif
@@ -124,6 +124,23 @@ public:
     return ( static_cast< RealType >( this->GetInputImage()->GetPixel(index) ) );
   }
 
+  /** Interpolate the image at a sequence of continuous index positions.
+   *
+   * Writes to \c values the interpolated image intensities at the
+   * \c numberOfIndices positions of \c indices. No bounds checking is
+   * done. The default implementation calls EvaluateAtContinuousIndex() for
+   * each position. Subclasses may override it to share the work between
+   * consecutive positions, such as the positions along a scanline. */
+  virtual void EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                                           OutputType *values,
+                                           SizeValueType numberOfIndices) const
+  {
+    for ( SizeValueType i = 0; i < numberOfIndices; ++i )
+      {
+      values[i] = this->EvaluateAtContinuousIndex(indices[i]);
+      }
+  }
+
 protected:
   InterpolateImageFunction(){}
   ~InterpolateImageFunction() override {}
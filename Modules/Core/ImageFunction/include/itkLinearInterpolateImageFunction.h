@@ -101,6 +101,18 @@ public:
     return this->EvaluateOptimized(Dispatch< ImageDimension >(), index);
   }
 
+  /** Evaluate the function at a sequence of continuous index positions,
+   * without a virtual call for each position. No bounds checking is done. */
+  void EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                                   OutputType *values,
+                                   SizeValueType numberOfIndices) const override
+  {
+    for ( SizeValueType i = 0; i < numberOfIndices; ++i )
+      {
+      values[i] = this->EvaluateOptimized(Dispatch< ImageDimension >(), indices[i]);
+      }
+  }
+
 protected:
   LinearInterpolateImageFunction();
   ~LinearInterpolateImageFunction() override;
@@ -86,6 +86,21 @@ public:
     return static_cast< OutputType >( this->GetInputImage()->GetPixel(nindex) );
   }
 
+  /** Evaluate the function at a sequence of continuous index positions,
+   * without a virtual call for each position. No bounds checking is done. */
+  void EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                                   OutputType *values,
+                                   SizeValueType numberOfIndices) const override
+  {
+    const InputImageType *image = this->GetInputImage();
+    IndexType             nindex;
+    for ( SizeValueType i = 0; i < numberOfIndices; ++i )
+      {
+      this->ConvertContinuousIndexToNearestIndex(indices[i], nindex);
+      values[i] = static_cast< OutputType >( image->GetPixel(nindex) );
+      }
+  }
+
 protected:
   NearestNeighborInterpolateImageFunction(){}
   ~NearestNeighborInterpolateImageFunction() override {}
@@ -137,6 +137,23 @@ public:
     return ( output );
   }
 
+  /** Interpolate the image at a sequence of continuous index positions.
+   *
+   * Writes to \c values the interpolated image vectors at the
+   * \c numberOfIndices positions of \c indices. No bounds checking is
+   * done. The default implementation calls EvaluateAtContinuousIndex() for
+   * each position. Subclasses may override it to avoid a virtual call for
+   * each position. */
+  virtual void EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                                           OutputType *values,
+                                           SizeValueType numberOfIndices) const
+  {
+    for ( SizeValueType i = 0; i < numberOfIndices; ++i )
+      {
+      values[i] = this->EvaluateAtContinuousIndex(indices[i]);
+      }
+  }
+
 protected:
   VectorInterpolateImageFunction() {}
   ~VectorInterpolateImageFunction() override {}
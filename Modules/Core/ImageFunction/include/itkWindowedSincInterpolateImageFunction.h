@@ -308,6 +308,18 @@ public:
   OutputType EvaluateAtContinuousIndex(
     const ContinuousIndexType & index) const override;
 
+  /** Evaluate the function at a sequence of continuous index positions,
+   * without a virtual call for each position. */
+  void EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                                   OutputType *values,
+                                   SizeValueType numberOfIndices) const override
+  {
+    for ( SizeValueType i = 0; i < numberOfIndices; ++i )
+      {
+      values[i] = this->Self::EvaluateAtContinuousIndex(indices[i]);
+      }
+  }
+
 protected:
   WindowedSincInterpolateImageFunction();
   ~WindowedSincInterpolateImageFunction() override;
@@ -0,0 +1,244 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include <vector>
+
+// Check that the values interpolated along lines by
+// EvaluateAtContinuousIndices() are the ones of EvaluateAtContinuousIndex(),
+// for all the spline orders, along axis aligned lines whose other
+// coordinates do not change, and along oblique lines reaching the mirrored
+// boundaries of the image. Check also both against the known values of
+// constant and linear images, whose last dimension has a single pixel that
+// is not at the origin of the index space.
+
+namespace
+{
+
+template< unsigned int VDimension >
+bool
+TestBatchEvaluation( unsigned int splineOrder )
+{
+  using ImageType = itk::Image< float, VDimension >;
+  using InterpolatorType = itk::BSplineInterpolateImageFunction< ImageType, double, double >;
+  using ContinuousIndexType = typename InterpolatorType::ContinuousIndexType;
+  using OutputType = typename InterpolatorType::OutputType;
+
+  typename ImageType::Pointer image = ImageType::New();
+  typename ImageType::IndexType start;
+  typename ImageType::SizeType size;
+  for ( unsigned int d = 0; d < VDimension; ++d )
+    {
+    start[d] = 3 - static_cast< int >( d );
+    size[d] = 9 + 2 * d;
+    }
+  // A dimension of size one is not interpolated.
+  if ( VDimension > 2 )
+    {
+    size[VDimension - 1] = 1;
+    }
+  typename ImageType::RegionType region( start, size );
+  image->SetRegions( region );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const typename ImageType::IndexType index = it.GetIndex();
+    double value = 0.0;
+    for ( unsigned int d = 0; d < VDimension; ++d )
+      {
+      value += ( d + 1 ) * std::sin( 0.7 * index[d] + d );
+      }
+    it.Set( static_cast< float >( value ) );
+    }
+
+  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetSplineOrder( splineOrder );
+  interpolator->SetInputImage( image );
+
+  // Lines through the buffer, from one corner to the other, and along the
+  // first axis.
+  constexpr unsigned int numberOfPoints = 57;
+  std::vector< ContinuousIndexType > indices;
+  for ( unsigned int line = 0; line < 2; ++line )
+    {
+    for ( unsigned int i = 0; i < numberOfPoints; ++i )
+      {
+      const double alpha = i / static_cast< double >( numberOfPoints - 1 );
+      ContinuousIndexType index;
+      for ( unsigned int d = 0; d < VDimension; ++d )
+        {
+        const double first = start[d] - 0.5 + 0.01;
+        const double last = start[d] + size[d] - 0.5 - 0.01;
+        index[d] = ( line == 0 || d == 0 ) ? first + alpha * ( last - first ) : start[d] + 0.3 * size[d];
+        }
+      indices.push_back( index );
+      }
+    }
+
+  std::vector< OutputType > values( indices.size() );
+  interpolator->EvaluateAtContinuousIndices( indices.data(), values.data(), indices.size() );
+  for ( size_t i = 0; i < indices.size(); ++i )
+    {
+    const OutputType expected = interpolator->EvaluateAtContinuousIndex( indices[i] );
+    if ( std::abs( values[i] - expected ) > 1e-10 * ( 1.0 + std::abs( expected ) ) )
+      {
+      std::cerr << "Order " << splineOrder << ", dimension " << VDimension << ": " << values[i]
+                << " instead of " << expected << " at " << indices[i] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+
+template< unsigned int VDimension >
+bool
+TestKnownValues( unsigned int splineOrder )
+{
+  using ImageType = itk::Image< float, VDimension >;
+  using InterpolatorType = itk::BSplineInterpolateImageFunction< ImageType, double, double >;
+  using ContinuousIndexType = typename InterpolatorType::ContinuousIndexType;
+  using OutputType = typename InterpolatorType::OutputType;
+
+  typename ImageType::Pointer image = ImageType::New();
+  typename ImageType::IndexType start;
+  typename ImageType::SizeType size;
+  for ( unsigned int d = 0; d < VDimension; ++d )
+    {
+    start[d] = 5 - static_cast< int >( d );
+    size[d] = 7 + d;
+    }
+  if ( VDimension > 1 )
+    {
+    size[VDimension - 1] = 1;
+    }
+  typename ImageType::RegionType region( start, size );
+  image->SetRegions( region );
+  image->Allocate();
+
+  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetSplineOrder( splineOrder );
+
+  for ( unsigned int linear = 0; linear < 2; ++linear )
+    {
+    // f(x) = 2.5 for the constant image, 2.5 + sum (d + 1) x_d for the
+    // linear image, the coordinates of the single pixel dimension aside.
+    const auto knownValue = [&]( const ContinuousIndexType & index )
+      {
+      double value = 2.5;
+      for ( unsigned int d = 0; linear && d < VDimension; ++d )
+        {
+        if ( size[d] > 1 )
+          {
+          value += ( d + 1 ) * index[d];
+          }
+        }
+      return value;
+    };
+
+    itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      ContinuousIndexType index;
+      for ( unsigned int d = 0; d < VDimension; ++d )
+        {
+        index[d] = it.GetIndex()[d];
+        }
+      it.Set( static_cast< float >( knownValue( index ) ) );
+      }
+    image->Modified();
+    interpolator->SetInputImage( image );
+
+    // A constant image is reproduced everywhere, up to the mirrored
+    // boundaries. A linear image is interpolated exactly at the pixels for
+    // all the orders, and everywhere inside the buffer for the first order.
+    const bool everywhere = !linear || splineOrder == 1;
+    constexpr unsigned int samplesPerPixel = 4;
+    std::vector< ContinuousIndexType > indices;
+    for ( unsigned int i = 0; i < samplesPerPixel * ( size[0] - 1 ) + 1; ++i )
+      {
+      if ( !everywhere && i % samplesPerPixel != 0 )
+        {
+        continue;
+        }
+      ContinuousIndexType index;
+      for ( unsigned int d = 0; d < VDimension; ++d )
+        {
+        index[d] = start[d] + ( size[d] - 1 ) / 2;
+        if ( everywhere && size[d] > 1 )
+          {
+          index[d] += 0.25;
+          }
+        }
+      index[0] = start[0] + i / static_cast< double >( samplesPerPixel );
+      indices.push_back( index );
+      }
+    if ( !linear )
+      {
+      // Beyond the buffer, close to its boundaries.
+      ContinuousIndexType index = indices.front();
+      index[0] = start[0] - 0.4;
+      indices.push_back( index );
+      index[0] = start[0] + size[0] - 0.6;
+      indices.push_back( index );
+      }
+
+    std::vector< OutputType > values( indices.size() );
+    interpolator->EvaluateAtContinuousIndices( indices.data(), values.data(), indices.size() );
+    for ( size_t i = 0; i < indices.size(); ++i )
+      {
+      const double expected = knownValue( indices[i] );
+      const OutputType single = interpolator->EvaluateAtContinuousIndex( indices[i] );
+      if ( std::abs( values[i] - expected ) > 1e-6 * ( 1.0 + std::abs( expected ) )
+           || std::abs( single - expected ) > 1e-6 * ( 1.0 + std::abs( expected ) ) )
+        {
+        std::cerr << ( linear ? "Linear" : "Constant" ) << " image, order " << splineOrder << ", dimension "
+                  << VDimension << ": " << values[i] << " and " << single << " instead of " << expected
+                  << " at " << indices[i] << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+}
+
+int itkBSplineInterpolateImageFunctionBatchTest( int, char *[] )
+{
+  bool success = true;
+  for ( unsigned int splineOrder = 0; splineOrder <= 5; ++splineOrder )
+    {
+    success &= TestBatchEvaluation< 1 >( splineOrder );
+    success &= TestBatchEvaluation< 2 >( splineOrder );
+    success &= TestBatchEvaluation< 3 >( splineOrder );
+    success &= TestKnownValues< 1 >( splineOrder );
+    success &= TestKnownValues< 2 >( splineOrder );
+    success &= TestKnownValues< 3 >( splineOrder );
+    }
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -20,6 +20,7 @@
 
 #include "itkTransformMeshFilter.h"
 #include "itkMacro.h"
+#include <vector>
 
 namespace itk
 {
@@ -89,18 +90,37 @@ TransformMeshFilter< TInputMesh, TOutputMesh, TTransform >
   outPoints->Squeeze();  // in case the previous mesh had
                          // allocated a larger memory
 
+  // The points containers may be maps, so first gather the addresses of the
+  // points, then transform them in parallel.
+  const SizeValueType numberOfPoints = inPoints->Size();
+  std::vector< const typename InputPointsContainer::Element * > inputPoints;
+  std::vector< typename OutputPointsContainer::Element * >      outputPoints;
+  inputPoints.reserve( numberOfPoints );
+  outputPoints.reserve( numberOfPoints );
+
   typename InputPointsContainer::ConstIterator inputPoint  = inPoints->Begin();
   typename OutputPointsContainer::Iterator outputPoint = outPoints->Begin();
 
   while ( inputPoint != inPoints->End() )
     {
-    outputPoint.Value() =
-      m_Transform->TransformPoint( inputPoint.Value() );
+    inputPoints.push_back( &inputPoint.Value() );
+    outputPoints.push_back( &outputPoint.Value() );
 
     ++inputPoint;
     ++outputPoint;
     }
 
+  const TransformType * transform = m_Transform;
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->ParallelizeArrayRange( 0, numberOfPoints,
+      [transform, &inputPoints, &outputPoints]( SizeValueType first, SizeValueType lastPlus1 )
+        {
+        for ( SizeValueType i = first; i < lastPlus1; ++i )
+          {
+          *outputPoints[i] = transform->TransformPoint( *inputPoints[i] );
+          }
+        }, nullptr );
+
   // Create duplicate references to the rest of data on the mesh
   this->CopyInputMeshToOutputMeshPointData();
   this->CopyInputMeshToOutputMeshCellLinks();
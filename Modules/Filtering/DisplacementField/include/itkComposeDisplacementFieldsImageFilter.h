@@ -20,6 +20,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkVectorInterpolateImageFunction.h"
+#include "itkDisplacementWarpEngine.h"
 
 namespace itk
 {
@@ -29,6 +30,11 @@ namespace itk
  *
  * \brief Compose two displacement fields.
  *
+ * The output is the warping field plus the displacement field interpolated
+ * at the points displaced by the warping field. The warping field is
+ * traversed in tiles by a DisplacementWarpEngine, and the scan lines of
+ * the tiles are interpolated with batched calls to the interpolator.
+ *
  * \author Nick Tustison
  * \author Brian Avants
  *
@@ -143,6 +149,9 @@ private:
   /** The interpolator. */
   typename InterpolatorType::Pointer             m_Interpolator;
 
+  /** Maps the points of the warping field to the displacement field. */
+  DisplacementWarpEngine<ImageDimension, typename InterpolatorType::CoordRepType> m_WarpEngine;
+
 };
 
 } // end namespace itk
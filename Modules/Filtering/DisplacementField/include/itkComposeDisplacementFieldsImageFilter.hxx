@@ -20,9 +20,9 @@
 
 #include "itkComposeDisplacementFieldsImageFilter.h"
 
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkImageRegionIterator.h"
+#include "itkImageScanlineIterator.h"
 #include "itkVectorLinearInterpolateImageFunction.h"
+#include <vector>
 
 namespace itk
 {
@@ -78,6 +78,8 @@ ComposeDisplacementFieldsImageFilter<InputImage, TOutputImage>
     {
     itkExceptionMacro( "Displacement field not set in interpolator." );
     }
+
+  this->m_WarpEngine.SetGrids( this->GetWarpingField(), this->m_Interpolator->GetInputImage() );
 }
 
 template<typename InputImage, typename TOutputImage>
@@ -88,41 +90,58 @@ ComposeDisplacementFieldsImageFilter<InputImage, TOutputImage>
   typename OutputFieldType::Pointer output = this->GetOutput();
   typename InputFieldType::ConstPointer warpingField = this->GetWarpingField();
 
-  ImageRegionConstIteratorWithIndex<InputFieldType> ItW( warpingField, region );
-  ImageRegionIterator<OutputFieldType> ItF( output, region );
-
-  PointType pointIn1;
-  PointType pointIn2;
-  PointType pointIn3;
+  // The composed displacement at a point p is w(p) + u(p + w(p)), where w
+  // is the warping field and u the displacement field, and u is zero
+  // outside of its buffer.
+  using ContinuousIndexType = typename InterpolatorType::ContinuousIndexType;
+  using OutputType = typename InterpolatorType::OutputType;
+  std::vector<OutputType> displacements( region.GetSize( 0 ) );
 
-  typename OutputFieldType::PixelType outDisplacement;
-
-  for( ItW.GoToBegin(), ItF.GoToBegin(); !ItW.IsAtEnd(); ++ItW, ++ItF )
+  auto composeLine = [this, &output, &warpingField, &displacements]( const IndexType & lineIndex,
+    SizeValueType lineLength, const ContinuousIndexType * indices )
     {
-    warpingField->TransformIndexToPhysicalPoint( ItW.GetIndex(), pointIn1 );
-
-    VectorType warpVector = ItW.Get();
-
-    for( unsigned int d = 0; d < ImageDimension; d++ )
+    RegionType lineRegion;
+    lineRegion.SetIndex( lineIndex );
+    lineRegion.SetSize( 0, lineLength );
+    for( unsigned int d = 1; d < ImageDimension; d++ )
       {
-      pointIn2[d] = pointIn1[d] + warpVector[d];
+      lineRegion.SetSize( d, 1 );
       }
 
-    typename InterpolatorType::OutputType displacement( 0.0 );
-    if( this->m_Interpolator->IsInsideBuffer( pointIn2 ) )
+    SizeValueType i = 0;
+    while( i < lineLength )
       {
-      displacement = this->m_Interpolator->Evaluate( pointIn2 );
+      SizeValueType runEnd = i;
+      while( runEnd < lineLength && this->m_Interpolator->IsInsideBuffer( indices[runEnd] ) )
+        {
+        ++runEnd;
+        }
+      if( runEnd > i )
+        {
+        this->m_Interpolator->EvaluateAtContinuousIndices( indices + i, displacements.data() + i, runEnd - i );
+        i = runEnd;
+        }
+      else
+        {
+        displacements[i] = OutputType( 0.0 );
+        ++i;
+        }
       }
 
-    for( unsigned int d = 0; d < ImageDimension; d++ )
+    ImageScanlineConstIterator<InputFieldType> ItW( warpingField, lineRegion );
+    ImageScanlineIterator<OutputFieldType> ItF( output, lineRegion );
+    for( i = 0; i < lineLength; ++i, ++ItW, ++ItF )
       {
-      pointIn3[d] = pointIn2[d] + displacement[d];
+      const VectorType warpVector = ItW.Get();
+      VectorType outDisplacement;
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        outDisplacement[d] = warpVector[d] + displacements[i][d];
+        }
+      ItF.Set( outDisplacement );
       }
-
-    outDisplacement = pointIn3 - pointIn1;
-
-    ItF.Set( outDisplacement );
-    }
+    };
+  this->m_WarpEngine.Warp( region, warpingField.GetPointer(), composeLine );
 }
 
 template<typename InputImage, typename TOutputImage>
@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSeparableDistanceTransform_h
+#define itkSeparableDistanceTransform_h
+
+#include "itkImage.h"
+#include "itkMultiThreaderBase.h"
+
+namespace itk
+{
+/** \class SeparableDistanceTransform
+ * \brief Exact Euclidean distance transform computed by separable passes.
+ *
+ * The squared Euclidean distances to the nearest feature pixels are
+ * computed by one pass per image axis, as described by Maurer, Qi and
+ * Raghavan (A Linear Time Algorithm for Computing Exact Euclidean Distance
+ * Transforms of Binary Images in Arbitrary Dimensions. IEEE Transactions on
+ * Pattern Analysis and Machine Intelligence, 25(2): 265-270, 2003). Each
+ * pass replaces the values of every line along its axis by the lower
+ * envelope of the parabolas centered on the pixels of the line.
+ *
+ * The lines of a pass are processed in parallel by the multi-threader.
+ * Along the axes other than the first one, bundles of adjacent lines are
+ * copied to a contiguous buffer, so that the image is read and written by
+ * whole cache lines. Each thread reuses its buffers from one bundle to the
+ * next.
+ *
+ * The transform optionally computes the feature transform: for each pixel,
+ * the offset in the image buffer of its nearest feature pixel.
+ *
+ * The distances are computed with the pixel type of the image, which may
+ * be an integer type when the spacing is not used.
+ *
+ * \sa SignedMaurerDistanceMapImageFilter
+ * \ingroup ITKDistanceMap
+ */
+template< typename TDistanceImage >
+class ITK_TEMPLATE_EXPORT SeparableDistanceTransform
+{
+public:
+  using DistanceImageType = TDistanceImage;
+  using PixelType = typename DistanceImageType::PixelType;
+  using RegionType = typename DistanceImageType::RegionType;
+  using SpacingType = typename DistanceImageType::SpacingType;
+
+  static constexpr unsigned int ImageDimension = DistanceImageType::ImageDimension;
+
+  /** Image of the offsets in the buffer of the nearest feature pixels. */
+  using FeatureImageType = Image< OffsetValueType, ImageDimension >;
+
+  SeparableDistanceTransform();
+
+  /** Set/Get the spacing of the pixels. Default is 1 along all axes. */
+  void SetSpacing(const SpacingType & spacing)
+  {
+    m_Spacing = spacing;
+  }
+  const SpacingType & GetSpacing() const
+  {
+    return m_Spacing;
+  }
+
+  /** Set/Get the multi-threader processing the lines. By default, the
+   * lines are processed by the calling thread. */
+  void SetMultiThreader(MultiThreaderBase *multiThreader)
+  {
+    m_MultiThreader = multiThreader;
+  }
+  MultiThreaderBase * GetMultiThreader() const
+  {
+    return m_MultiThreader;
+  }
+
+  /** Set/Get the image receiving the feature transform. It must have the
+   * same buffered region as the distance image. Default is none. */
+  void SetFeatureImage(FeatureImageType *featureImage)
+  {
+    m_FeatureImage = featureImage;
+  }
+  FeatureImageType * GetFeatureImage() const
+  {
+    return m_FeatureImage;
+  }
+
+  /** Replace the pixels of a region of the image by their squared
+   * distances to the nearest feature pixel of the region. Before the call,
+   * the feature pixels hold zero and the other pixels hold
+   * NumericTraits< PixelType >::max(). The pixels remain at max when the
+   * region has no feature pixel. */
+  void Compute(DistanceImageType *image, const RegionType & region);
+
+  /** Initialize the feature transform, then run the passes one at a time:
+   * after the pass along an axis, the pixels hold their squared distances
+   * to the nearest feature pixels in the subspace of the processed axes. */
+  void InitializeFeatures(const DistanceImageType *image, const RegionType & region);
+  void ComputeAxis(DistanceImageType *image, const RegionType & region, unsigned int axis);
+
+private:
+  // The scratch buffers of a thread
+  struct LineBuffers
+  {
+    std::vector< PixelType >       g;
+    std::vector< PixelType >       h;
+    std::vector< OffsetValueType > features;
+  };
+
+  // Lower envelope of the parabolas of a contiguous line, at the positions
+  // of the pixels. The envelope positions are the positions used for the
+  // apexes of the parabolas.
+  static void TransformLine(PixelType *distances, OffsetValueType *features, SizeValueType length,
+                            const PixelType *envelopePositions, const PixelType *positions,
+                            LineBuffers & buffers);
+
+  static bool Remove(PixelType d1, PixelType d2, PixelType df, PixelType x1, PixelType x2, PixelType xf);
+
+  SpacingType         m_Spacing;
+  MultiThreaderBase * m_MultiThreader;
+  FeatureImageType *  m_FeatureImage;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSeparableDistanceTransform.hxx"
+#endif
+
+#endif
@@ -0,0 +1,289 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSeparableDistanceTransform_hxx
+#define itkSeparableDistanceTransform_hxx
+
+#include "itkSeparableDistanceTransform.h"
+#include "itkMath.h"
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+template< typename TDistanceImage >
+SeparableDistanceTransform< TDistanceImage >
+::SeparableDistanceTransform():
+  m_MultiThreader(nullptr),
+  m_FeatureImage(nullptr)
+{
+  m_Spacing.Fill(1.0);
+}
+
+template< typename TDistanceImage >
+void
+SeparableDistanceTransform< TDistanceImage >
+::Compute(DistanceImageType *image, const RegionType & region)
+{
+  if ( m_FeatureImage )
+    {
+    this->InitializeFeatures(image, region);
+    }
+  for ( unsigned int axis = 0; axis < ImageDimension; ++axis )
+    {
+    this->ComputeAxis(image, region, axis);
+    }
+}
+
+template< typename TDistanceImage >
+void
+SeparableDistanceTransform< TDistanceImage >
+::InitializeFeatures(const DistanceImageType *image, const RegionType & region)
+{
+  if ( !m_FeatureImage || region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+  // the feature pixels are their own nearest feature pixels
+  const SizeValueType   length = region.GetSize(0);
+  const SizeValueType   numberOfLines = region.GetNumberOfPixels() / length;
+  const PixelType *     distances = image->GetBufferPointer();
+  OffsetValueType *     features = m_FeatureImage->GetBufferPointer();
+  auto initializeLines = [&](SizeValueType firstLine, SizeValueType lastLinePlus1)
+    {
+    typename RegionType::IndexType index = region.GetIndex();
+    for ( SizeValueType line = firstLine; line < lastLinePlus1; ++line )
+      {
+      SizeValueType remainder = line;
+      for ( unsigned int d = 1; d < ImageDimension; ++d )
+        {
+        index[d] = region.GetIndex(d) + static_cast< IndexValueType >( remainder % region.GetSize(d) );
+        remainder /= region.GetSize(d);
+        }
+      const OffsetValueType start = image->ComputeOffset(index);
+      for ( OffsetValueType p = start; p < start + static_cast< OffsetValueType >( length ); ++p )
+        {
+        features[p] = Math::NotExactlyEquals( distances[p], NumericTraits< PixelType >::max() ) ? p : -1;
+        }
+      }
+    };
+  if ( m_MultiThreader )
+    {
+    m_MultiThreader->ParallelizeArrayRange(0, numberOfLines, initializeLines, nullptr);
+    }
+  else
+    {
+    initializeLines(0, numberOfLines);
+    }
+}
+
+template< typename TDistanceImage >
+void
+SeparableDistanceTransform< TDistanceImage >
+::ComputeAxis(DistanceImageType *image, const RegionType & region, unsigned int axis)
+{
+  const SizeValueType length = region.GetSize(axis);
+  if ( region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  // positions of the pixels along the axis
+  std::vector< PixelType > envelopePositions(length);
+  std::vector< PixelType > positions(length);
+  for ( SizeValueType i = 0; i < length; ++i )
+    {
+    envelopePositions[i] = static_cast< PixelType >( i ) * static_cast< PixelType >( m_Spacing[axis] );
+    positions[i] = static_cast< PixelType >( i * m_Spacing[axis] );
+    }
+
+  // The lines along the axis are grouped in bundles of adjacent lines along
+  // the first axis, and the bundles in rows spanning the first axis.
+  constexpr SizeValueType MaximumBundleWidth = 16;
+  const SizeValueType     rowWidth = axis == 0 ? 1 : region.GetSize(0);
+  const SizeValueType     bundleWidth = std::min(rowWidth, MaximumBundleWidth);
+  const SizeValueType     bundlesPerRow = ( rowWidth + bundleWidth - 1 ) / bundleWidth;
+  const SizeValueType     numberOfRows = region.GetNumberOfPixels() / ( length * rowWidth );
+
+  const OffsetValueType *offsetTable = image->GetOffsetTable();
+  const OffsetValueType  stride = offsetTable[axis];
+  PixelType *            distances = image->GetBufferPointer() + image->ComputeOffset( region.GetIndex() );
+  OffsetValueType *      features = nullptr;
+  if ( m_FeatureImage )
+    {
+    features = m_FeatureImage->GetBufferPointer() + image->ComputeOffset( region.GetIndex() );
+    }
+
+  auto transformBundles = [&](SizeValueType firstBundle, SizeValueType lastBundlePlus1)
+    {
+    std::vector< PixelType >       distanceBuffer(bundleWidth * length);
+    std::vector< OffsetValueType > featureBuffer(features ? bundleWidth * length : 0);
+    LineBuffers                    buffers;
+    buffers.g.resize(length);
+    buffers.h.resize(length);
+    buffers.features.resize(features ? length : 0);
+
+    for ( SizeValueType bundle = firstBundle; bundle < lastBundlePlus1; ++bundle )
+      {
+      // offset of the first pixel of the bundle
+      SizeValueType   row = bundle / bundlesPerRow;
+      const auto      first = static_cast< OffsetValueType >( ( bundle % bundlesPerRow ) * bundleWidth );
+      OffsetValueType start = axis == 0 ? 0 : first;
+      for ( unsigned int d = 1; d < ImageDimension; ++d )
+        {
+        if ( d == axis )
+          {
+          continue;
+          }
+        start += static_cast< OffsetValueType >( row % region.GetSize(d) ) * offsetTable[d];
+        row /= region.GetSize(d);
+        }
+      const SizeValueType lanes = std::min(bundleWidth, rowWidth - static_cast< SizeValueType >( first ));
+
+      // copy the lines to the buffers, transform them, and copy them back
+      for ( SizeValueType i = 0; i < length; ++i )
+        {
+        const OffsetValueType p = start + static_cast< OffsetValueType >( i ) * stride;
+        for ( SizeValueType lane = 0; lane < lanes; ++lane )
+          {
+          distanceBuffer[lane * length + i] = distances[p + lane];
+          }
+        if ( features )
+          {
+          for ( SizeValueType lane = 0; lane < lanes; ++lane )
+            {
+            featureBuffer[lane * length + i] = features[p + lane];
+            }
+          }
+        }
+      for ( SizeValueType lane = 0; lane < lanes; ++lane )
+        {
+        TransformLine(distanceBuffer.data() + lane * length,
+                      features ? featureBuffer.data() + lane * length : nullptr,
+                      length, envelopePositions.data(), positions.data(), buffers);
+        }
+      for ( SizeValueType i = 0; i < length; ++i )
+        {
+        const OffsetValueType p = start + static_cast< OffsetValueType >( i ) * stride;
+        for ( SizeValueType lane = 0; lane < lanes; ++lane )
+          {
+          distances[p + lane] = distanceBuffer[lane * length + i];
+          }
+        if ( features )
+          {
+          for ( SizeValueType lane = 0; lane < lanes; ++lane )
+            {
+            features[p + lane] = featureBuffer[lane * length + i];
+            }
+          }
+        }
+      }
+    };
+
+  const SizeValueType numberOfBundles = numberOfRows * bundlesPerRow;
+  if ( m_MultiThreader )
+    {
+    m_MultiThreader->ParallelizeArrayRange(0, numberOfBundles, transformBundles, nullptr);
+    }
+  else
+    {
+    transformBundles(0, numberOfBundles);
+    }
+}
+
+template< typename TDistanceImage >
+void
+SeparableDistanceTransform< TDistanceImage >
+::TransformLine(PixelType *distances, OffsetValueType *features, SizeValueType length,
+                const PixelType *envelopePositions, const PixelType *positions, LineBuffers & buffers)
+{
+  PixelType *       g = buffers.g.data();
+  PixelType *       h = buffers.h.data();
+  OffsetValueType * f = buffers.features.data();
+
+  // the parabolas of the lower envelope
+  OffsetValueType l = -1;
+  for ( SizeValueType i = 0; i < length; ++i )
+    {
+    const PixelType di = distances[i];
+    if ( Math::ExactlyEquals( di, NumericTraits< PixelType >::max() ) )
+      {
+      continue;
+      }
+    const PixelType iw = envelopePositions[i];
+    while ( l >= 1 && Remove(g[l - 1], g[l], di, h[l - 1], h[l], iw) )
+      {
+      l--;
+      }
+    l++;
+    g[l] = di;
+    h[l] = iw;
+    if ( features )
+      {
+      f[l] = features[i];
+      }
+    }
+
+  if ( l == -1 )
+    {
+    return;
+    }
+
+  // the values of the lower envelope
+  const OffsetValueType ns = l;
+  l = 0;
+  for ( SizeValueType i = 0; i < length; ++i )
+    {
+    const PixelType iw = positions[i];
+    PixelType       d1 = Math::abs( g[l] ) + ( h[l] - iw ) * ( h[l] - iw );
+    while ( l < ns )
+      {
+      // be sure to compute d2 *only* if l < ns
+      const PixelType d2 = Math::abs( g[l + 1] ) + ( h[l + 1] - iw ) * ( h[l + 1] - iw );
+      // then compare d1 and d2
+      if ( d1 <= d2 )
+        {
+        break;
+        }
+      l++;
+      d1 = d2;
+      }
+    distances[i] = d1;
+    if ( features )
+      {
+      features[i] = f[l];
+      }
+    }
+}
+
+template< typename TDistanceImage >
+bool
+SeparableDistanceTransform< TDistanceImage >
+::Remove(PixelType d1, PixelType d2, PixelType df, PixelType x1, PixelType x2, PixelType xf)
+{
+  const PixelType a = x2 - x1;
+  const PixelType b = xf - x2;
+  const PixelType c = xf - x1;
+
+  const PixelType value =
+    ( c * Math::abs(d2) - b * Math::abs(d1) - a * Math::abs(df) - a * b * c );
+
+  return ( value > 0 );
+}
+} // end namespace itk
+
+#endif
@@ -19,6 +19,7 @@
 #define itkSignedMaurerDistanceMapImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include "itkSeparableDistanceTransform.h"
 
 namespace itk
 {
@@ -49,6 +50,9 @@ namespace itk
  *  the itk::DanielssonDistanceImageFilter class except it does not return
  *  the Voronoi map.
  *
+ *  The squared distances are computed by a SeparableDistanceTransform,
+ *  which processes the lines of each axis in parallel.
+ *
  *  Reference:
  *  C. R. Maurer, Jr., R. Qi, and V. Raghavan, "A Linear Time Algorithm
  *  for Computing Exact Euclidean Distance Transforms of Binary Images in
@@ -160,31 +164,13 @@ protected:
 
   void GenerateData() override;
 
-  unsigned int SplitRequestedRegion(unsigned int i, unsigned int num,
-    OutputImageRegionType & splitRegion) override;
-
-  void ThreadedGenerateData(const OutputImageRegionType &, ThreadIdType ) override;
-
-  void DynamicThreadedGenerateData( const OutputImageRegionType & ) override
-  {
-    itkExceptionMacro("This class requires threadId so it must use classic multi-threading model");
-  }
-
 private:
-  void Voronoi(unsigned int, OutputIndexType idx, OutputImageType *output );
-  bool Remove(OutputPixelType, OutputPixelType, OutputPixelType,
-              OutputPixelType, OutputPixelType, OutputPixelType);
-
   InputPixelType   m_BackgroundValue;
   InputSpacingType m_Spacing;
 
-  unsigned int m_CurrentDimension;
-
   bool m_InsideIsPositive;
   bool m_UseImageSpacing;
   bool m_SquaredDistance;
-
-  const InputImageType *m_InputCache;
 };
 } // end namespace itk
 
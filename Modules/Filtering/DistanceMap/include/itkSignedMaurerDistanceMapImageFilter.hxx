@@ -22,11 +22,9 @@
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkBinaryThresholdImageFilter.h"
 #include "itkBinaryContourImageFilter.h"
-#include "itkProgressReporter.h"
+#include "itkImageRegionIterator.h"
 #include "itkProgressAccumulator.h"
 #include "itkMath.h"
-#include "vnl/vnl_vector.h"
-#include "itkMath.h"
 
 namespace itk
 {
@@ -35,13 +33,10 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 ::SignedMaurerDistanceMapImageFilter():
   m_BackgroundValue( NumericTraits< InputPixelType >::ZeroValue() ),
   m_Spacing(0.0),
-  m_CurrentDimension(0),
   m_InsideIsPositive(false),
   m_UseImageSpacing(true),
-  m_SquaredDistance(false),
-  m_InputCache(nullptr)
+  m_SquaredDistance(false)
 {
-  this->DynamicMultiThreadingOff();
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -49,66 +44,6 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 ::~SignedMaurerDistanceMapImageFilter()
 {}
 
-template< typename TInputImage, typename TOutputImage >
-unsigned int
-SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
-::SplitRequestedRegion(unsigned int i, unsigned int num,
-  OutputImageRegionType & splitRegion)
-{
-  // Get the output pointer
-  OutputImageType *outputPtr = this->GetOutput();
-
-  // Initialize the splitRegion to the output requested region
-  splitRegion = outputPtr->GetRequestedRegion();
-
-  const OutputSizeType & requestedRegionSize = splitRegion.GetSize();
-
-  OutputIndexType splitIndex = splitRegion.GetIndex();
-  OutputSizeType  splitSize  = splitRegion.GetSize();
-
-  // split on the outermost dimension available
-  // and avoid the current dimension
-  int splitAxis = static_cast< int >( outputPtr->GetImageDimension() ) - 1;
-  while ( ( requestedRegionSize[splitAxis] == 1 ) ||
-          ( splitAxis == static_cast< int >( m_CurrentDimension ) ) )
-    {
-    --splitAxis;
-    if ( splitAxis < 0 )
-      { // cannot split
-      itkDebugMacro("Cannot Split");
-      return 1;
-      }
-    }
-
-  // determine the actual number of pieces that will be generated
-  auto range = static_cast< double >( requestedRegionSize[splitAxis] );
-
-  auto valuesPerThread = static_cast< unsigned int >( std::ceil( range / static_cast< double >( num ) ) );
-  unsigned int maxThreadIdUsed =
-    static_cast< unsigned int >( std::ceil( range / static_cast< double >( valuesPerThread ) ) ) - 1;
-
-  // Split the region
-  if ( i < maxThreadIdUsed )
-    {
-    splitIndex[splitAxis] += i * valuesPerThread;
-    splitSize[splitAxis] = valuesPerThread;
-    }
-  if ( i == maxThreadIdUsed )
-    {
-    splitIndex[splitAxis] += i * valuesPerThread;
-    // last thread needs to process the "rest" dimension being split
-    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
-    }
-
-  // set the split region ivars
-  splitRegion.SetIndex(splitIndex);
-  splitRegion.SetSize(splitSize);
-
-  itkDebugMacro("Split Piece: " << splitRegion);
-
-  return maxThreadIdUsed + 1;
-}
-
 template< typename TInputImage, typename TOutputImage >
 void
 SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
@@ -118,7 +53,6 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 
   OutputImageType *outputPtr = this->GetOutput();
   const InputImageType *inputPtr = this->GetInput();
-  m_InputCache = this->GetInput();
 
   // prepare the data
   this->AllocateOutputs();
@@ -163,298 +97,70 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 
   this->GraftOutput( borderFilter->GetOutput() );
 
-  // Set up the multithreaded processing
-  typename ImageSource< OutputImageType >::ThreadStruct str;
-  str.Filter = this;
-
-  this->GetMultiThreader()->SetNumberOfThreads( nbthreads );
-  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
-
-  // multithread the execution
-  for( unsigned int d=0; d<ImageDimension; d++ )
-    {
-    m_CurrentDimension = d;
-    this->GetMultiThreader()->SingleMethodExecute();
-    }
-}
-
-template< typename TInputImage, typename TOutputImage >
-void
-SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
-::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId)
-{
-  OutputImageType      *outputImage = this->GetOutput();
-
-  InputRegionType region = outputRegionForThread;
-  InputSizeType   size   = region.GetSize();
-  InputIndexType  startIndex = outputRegionForThread.GetIndex();
-
-  OutputImageType      *outputPtr = this->GetOutput();
-
-  // compute the number of rows first, so we can setup a progress reporter
-  std::vector< InputSizeValueType > NumberOfRows;
-  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+  // compute the squared distances along each dimension in turn
+  using DistanceTransformType = SeparableDistanceTransform< OutputImageType >;
+  DistanceTransformType distanceTransform;
+  if ( this->m_UseImageSpacing )
     {
-    NumberOfRows.push_back(1);
-    for ( unsigned int d = 0; d < InputImageDimension; d++ )
-      {
-      if ( d != i )
-        {
-        NumberOfRows[i] *= size[d];
-        }
-      }
+    distanceTransform.SetSpacing( this->m_Spacing );
     }
+  this->GetMultiThreader()->SetNumberOfThreads( nbthreads );
+  distanceTransform.SetMultiThreader( this->GetMultiThreader() );
 
-  // set the progress reporter. Use a pointer to be able to destroy it before
-  // the creation of progress2
-  // so it won't set wrong progress at the end of ThreadedGenerateData()
+  const OutputImageRegionType region = outputPtr->GetRequestedRegion();
   float progressPerDimension = 0.67f / static_cast< float >( ImageDimension );
   if ( !this->m_SquaredDistance )
     {
     progressPerDimension = 0.67f / ( static_cast< float >( ImageDimension ) + 1 );
     }
-  auto * progress = new ProgressReporter(this,
-                           threadId,
-                           NumberOfRows[m_CurrentDimension],
-                           30,
-                           0.33f + static_cast< float >( m_CurrentDimension * progressPerDimension ),
-                           progressPerDimension);
-
-  // This variable provides the amount by which to divide the dimensionless index in order to get the index for each dimension.
-  vnl_vector< unsigned int > k(InputImageDimension - 1);
-  unsigned int count = 0;
-  k[count] = 1;
-  for ( unsigned int d = m_CurrentDimension + InputImageDimension - 1;
-         d > m_CurrentDimension + 1;
-         d-- )
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
     {
-    k[count+1] = k[count] * size[d % InputImageDimension];
-    count++;
+    distanceTransform.ComputeAxis( outputPtr, region, d );
+    this->UpdateProgress( 0.33f + static_cast< float >( d + 1 ) * progressPerDimension );
     }
-  k.flip();
-
-  // The index is defined as the dimensionless index into the pixel.
-  // It must be divided by each dimension size in order to get the index for that dimension.
-  // The result of this division is the offsetIndex, which is the index offset relative to the region of this thread.
-  // The true pixel location (idx) is provided by the sum of the offsetIndex and the startIndex.
-  InputSizeValueType index;
-  OutputIndexType offsetIndex;
-  offsetIndex.Fill(0);
-  InputSizeValueType tempRow = NumberOfRows[m_CurrentDimension];
-  OutputIndexType idx;
-  idx.Fill(0);
 
-  for ( InputSizeValueType n = 0; n < tempRow; n++ )
-    {
-    index = n;
-    count = 0;
-    for ( unsigned int d = m_CurrentDimension + 1;
-         d < m_CurrentDimension + InputImageDimension; d++ )
+  // sign the distances, and take their square root if requested
+  const bool squaredDistance = this->m_SquaredDistance;
+  const bool insideIsPositive = this->m_InsideIsPositive;
+  const InputPixelType backgroundValue = this->m_BackgroundValue;
+  this->GetMultiThreader()->template ParallelizeImageRegion< ImageDimension >(
+    region,
+    [=](const OutputImageRegionType & outputRegion)
       {
-      offsetIndex[d % InputImageDimension] = static_cast< OutputIndexValueType >( static_cast< double >( index ) / static_cast< double >( k[count] ) );
-      idx[d % InputImageDimension] = offsetIndex[d % InputImageDimension] + static_cast< OutputIndexValueType >( startIndex[d % InputImageDimension] );
-
-      index %= k[count];
-      count++;
-      }
-    this->Voronoi(m_CurrentDimension, idx,outputImage);
-    progress->CompletedPixel();
-    }
-  delete progress;
+      using OutputRealType = typename NumericTraits< OutputPixelType >::RealType;
 
-  if ( m_CurrentDimension == ImageDimension - 1 && !this->m_SquaredDistance )
-    {
-    using OutputIterator = ImageRegionIterator< OutputImageType >;
-    using InputIterator = ImageRegionConstIterator< InputImageType  >;
-
-    typename OutputImageType::RegionType outputRegion = outputRegionForThread;
-
-    OutputIterator Ot(outputPtr, outputRegion);
-    InputIterator  It(m_InputCache,  outputRegion);
-
-    Ot.GoToBegin();
-    It.GoToBegin();
-
-    ProgressReporter progress2(this, threadId,
-                               outputRegionForThread.GetNumberOfPixels(), 30,
-                               0.33f + static_cast< float >( ImageDimension * progressPerDimension ),
-                               progressPerDimension);
-
-    using OutputRealType = typename NumericTraits< OutputPixelType >::RealType;
-
-    while ( !Ot.IsAtEnd() )
-      {
-      // cast to a real type is required on some platforms
-      const auto outputValue = static_cast< OutputPixelType >(
-          std::sqrt( static_cast< OutputRealType >( itk::Math::abs( Ot.Get() ) ) ) );
-
-      if ( Math::NotExactlyEquals( It.Get(), this->m_BackgroundValue ) )
+      ImageRegionIterator< OutputImageType >     Ot( outputPtr, outputRegion );
+      ImageRegionConstIterator< InputImageType > It( inputPtr, outputRegion );
+      while ( !Ot.IsAtEnd() )
         {
-        if ( this->GetInsideIsPositive() )
+        OutputPixelType outputValue = Ot.Get();
+        if ( !squaredDistance )
           {
-          Ot.Set(outputValue);
+          // cast to a real type is required on some platforms
+          outputValue = static_cast< OutputPixelType >(
+              std::sqrt( static_cast< OutputRealType >( itk::Math::abs( outputValue ) ) ) );
           }
-        else
+        else if ( Math::ExactlyEquals( outputValue, NumericTraits< OutputPixelType >::max() ) )
           {
-          Ot.Set(-outputValue);
+          // no object in the image: the pixel keeps its value
+          ++Ot;
+          ++It;
+          continue;
           }
-        }
-      else
-        {
-        if ( this->GetInsideIsPositive() )
-          {
-          Ot.Set(-outputValue);
-          }
-        else
-          {
-          Ot.Set(outputValue);
-          }
-        }
 
-      ++Ot;
-      ++It;
-      progress2.CompletedPixel();
-      }
-    }
-}
-
-template< typename TInputImage, typename TOutputImage >
-void
-SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
-::Voronoi(unsigned int d, OutputIndexType idx, OutputImageType *output)
-{
-  OutputRegionType      oRegion = output->GetRequestedRegion();
-  OutputSizeValueType   nd = oRegion.GetSize()[d];
-
-  vnl_vector< OutputPixelType > g(nd, 0 );
-  vnl_vector< OutputPixelType > h(nd, 0 );
-
-
-  InputRegionType iRegion = m_InputCache->GetRequestedRegion();
-  InputIndexType startIndex = iRegion.GetIndex();
-
-  OutputPixelType di;
-
-  int l = -1;
-
-  for ( unsigned int i = 0; i < nd; i++ )
-    {
-    idx[d] = i + startIndex[d];
-
-    di = output->GetPixel(idx);
-
-    OutputPixelType iw;
-
-    if ( this->GetUseImageSpacing() )
-      {
-      iw = static_cast< OutputPixelType >( i ) *
-           static_cast< OutputPixelType >( this->m_Spacing[d] );
-      }
-    else
-      {
-      iw  = static_cast< OutputPixelType >( i );
-      }
-
-    if ( Math::NotExactlyEquals( di, NumericTraits< OutputPixelType >::max() ) )
-      {
-      if ( l < 1 )
-        {
-        l++;
-        g(l) = di;
-        h(l) = iw;
+        // the zero distances of the object boundary keep a positive sign
+        // once their square root is taken, but are negated like the other
+        // distances in the squared distance map
+        const bool inside = Math::NotExactlyEquals( It.Get(), backgroundValue );
+        const bool positive = inside == insideIsPositive
+          || ( !squaredDistance && Math::ExactlyEquals( outputValue, NumericTraits< OutputPixelType >::ZeroValue() ) );
+        Ot.Set( positive ? outputValue : -outputValue );
+        ++Ot;
+        ++It;
         }
-      else
-        {
-        while ( ( l >= 1 )
-                && this->Remove(g(l - 1), g(l), di, h(l - 1), h(l), iw) )
-          {
-          l--;
-          }
-        l++;
-        g(l) = di;
-        h(l) = iw;
-        }
-      }
-    }
-
-  if ( l == -1 )
-    {
-    return;
-    }
-
-  int ns = l;
-
-  l = 0;
-
-  for ( unsigned int i = 0; i < nd; i++ )
-    {
-    OutputPixelType iw;
-
-    if ( this->GetUseImageSpacing() )
-      {
-      iw = static_cast< OutputPixelType >( i * this->m_Spacing[d] );
-      }
-    else
-      {
-      iw = static_cast< OutputPixelType >( i );
-      }
-
-    OutputPixelType d1 = itk::Math::abs( g(l) ) + ( h(l) - iw ) * ( h(l) - iw );
-
-    while ( l < ns )
-      {
-      // be sure to compute d2 *only* if l < ns
-      OutputPixelType d2 = itk::Math::abs( g(l + 1) ) + ( h(l + 1) - iw ) * ( h(l + 1) - iw );
-      // then compare d1 and d2
-      if ( d1 <= d2 )
-        {
-        break;
-        }
-      l++;
-      d1 = d2;
-      }
-    idx[d] = i + startIndex[d];
-
-    if ( Math::NotExactlyEquals( m_InputCache->GetPixel(idx), this->m_BackgroundValue ) )
-      {
-      if ( this->m_InsideIsPositive )
-        {
-        output->SetPixel(idx,  d1);
-        }
-      else
-        {
-        output->SetPixel(idx, -d1);
-        }
-      }
-    else
-      {
-      if ( this->m_InsideIsPositive )
-        {
-        output->SetPixel(idx, -d1);
-        }
-      else
-        {
-        output->SetPixel(idx,  d1);
-        }
-      }
-    }
-}
-
-template< typename TInputImage, typename TOutputImage >
-bool
-SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
-::Remove(OutputPixelType d1, OutputPixelType d2, OutputPixelType df,
-         OutputPixelType x1, OutputPixelType x2, OutputPixelType xf)
-{
-  OutputPixelType a = x2 - x1;
-  OutputPixelType b = xf - x2;
-  OutputPixelType c = xf - x1;
-
-  OutputPixelType value =
-      ( c * itk::Math::abs(d2) - b * itk::Math::abs(d1)
-       - a * itk::Math::abs(df) - a * b * c );
-
-  return ( value > 0 );
+      },
+    nullptr);
+  this->UpdateProgress( 1.0f );
 }
 
 /**
@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSeparableDistanceTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+// Compare the distance and feature transforms to a brute force computation,
+// with and without threads, on a region which does not start at the origin
+// of the buffer.
+
+namespace
+{
+
+template< typename TPixel >
+bool
+TestDistanceTransform( double density, unsigned int numberOfThreads )
+{
+  using ImageType = itk::Image< TPixel, 3 >;
+  using TransformType = itk::SeparableDistanceTransform< ImageType >;
+  using FeatureImageType = typename TransformType::FeatureImageType;
+
+  typename ImageType::IndexType bufferIndex = { { -2, 3, 1 } };
+  typename ImageType::SizeType  bufferSize = { { 37, 21, 13 } };
+  typename ImageType::RegionType bufferedRegion( bufferIndex, bufferSize );
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( bufferedRegion );
+  image->Allocate();
+  image->FillBuffer( 7 );
+
+  typename ImageType::IndexType index = { { 1, 4, 2 } };
+  typename ImageType::SizeType  size = { { 33, 17, 11 } };
+  typename ImageType::RegionType region( index, size );
+
+  typename ImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 0.5;
+  spacing[2] = 2.25;
+
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 17 );
+  std::vector< typename ImageType::IndexType > features;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( generator->GetUniformVariate( 0.0, 1.0 ) < density )
+      {
+      it.Set( 0 );
+      features.push_back( it.GetIndex() );
+      }
+    else
+      {
+      it.Set( itk::NumericTraits< TPixel >::max() );
+      }
+    }
+
+  typename FeatureImageType::Pointer featureImage = FeatureImageType::New();
+  featureImage->SetRegions( bufferedRegion );
+  featureImage->Allocate();
+
+  itk::MultiThreaderBase::Pointer multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->SetNumberOfThreads( numberOfThreads );
+
+  TransformType transform;
+  transform.SetSpacing( spacing );
+  transform.SetFeatureImage( featureImage );
+  transform.SetMultiThreader( multiThreader );
+  if ( transform.GetFeatureImage() != featureImage.GetPointer()
+       || transform.GetMultiThreader() != multiThreader.GetPointer()
+       || transform.GetSpacing() != spacing )
+    {
+    std::cerr << "Set/Get mismatch" << std::endl;
+    return false;
+    }
+  transform.Compute( image, region );
+
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename ImageType::IndexType pixelIndex = it.GetIndex();
+    double expected = itk::NumericTraits< double >::max();
+    for ( const auto & feature : features )
+      {
+      double distance = 0.0;
+      for ( unsigned int d = 0; d < 3; ++d )
+        {
+        const double delta = ( pixelIndex[d] - feature[d] ) * spacing[d];
+        distance += delta * delta;
+        }
+      expected = std::min( expected, distance );
+      }
+
+    const itk::OffsetValueType featureOffset = featureImage->GetPixel( pixelIndex );
+    if ( features.empty() )
+      {
+      if ( it.Get() != itk::NumericTraits< TPixel >::max() || featureOffset != -1 )
+        {
+        std::cerr << "Pixel " << pixelIndex << " has a distance without features" << std::endl;
+        return false;
+        }
+      continue;
+      }
+    if ( std::abs( it.Get() - expected ) > 1e-4 * ( 1.0 + expected ) )
+      {
+      std::cerr << "Distance " << it.Get() << " instead of " << expected << " at " << pixelIndex << std::endl;
+      return false;
+      }
+
+    // the feature must be one of the nearest features
+    const typename ImageType::IndexType feature = image->ComputeIndex( featureOffset );
+    double distance = 0.0;
+    for ( unsigned int d = 0; d < 3; ++d )
+      {
+      const double delta = ( pixelIndex[d] - feature[d] ) * spacing[d];
+      distance += delta * delta;
+      }
+    if ( !region.IsInside( feature ) || image->GetPixel( feature ) != 0
+         || std::abs( distance - expected ) > 1e-4 * ( 1.0 + expected ) )
+      {
+      std::cerr << "Wrong feature " << feature << " for " << pixelIndex << std::endl;
+      return false;
+      }
+    }
+
+  // the pixels outside of the region are not modified
+  itk::ImageRegionIteratorWithIndex< ImageType > bufferIt( image, bufferedRegion );
+  for ( ; !bufferIt.IsAtEnd(); ++bufferIt )
+    {
+    if ( !region.IsInside( bufferIt.GetIndex() ) && bufferIt.Get() != 7 )
+      {
+      std::cerr << "Pixel " << bufferIt.GetIndex() << " outside of the region modified" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkSeparableDistanceTransformTest( int, char *[] )
+{
+  bool success = true;
+  for ( unsigned int numberOfThreads = 1; numberOfThreads <= 3; numberOfThreads += 2 )
+    {
+    for ( double density : { 0.0, 0.0005, 0.01, 0.2 } )
+      {
+      std::cout << "Density " << density << ", " << numberOfThreads << " threads" << std::endl;
+      success &= TestDistanceTransform< float >( density, numberOfThreads );
+      success &= TestDistanceTransform< double >( density, numberOfThreads );
+      }
+    }
+
+  if ( !success )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 #include "itkShowDistanceMap.h"
 #include "itkSignedMaurerDistanceMapImageFilter.h"
 #include "itkStdStreamStateSave.h"
+#include <cmath>
 
 int itkSignedMaurerDistanceMapImageFilterTest11(int, char* [] )
 {
@@ -153,5 +154,21 @@ int itkSignedMaurerDistanceMapImageFilterTest11(int, char* [] )
   std::cout << "Use ImageSpacing Distance Map with squared distance turned off" << std::endl;
   ShowDistanceMap(outputDistance2D2);
 
+  /* Test the sign of the zero distances of the object boundary: they are
+   * negated with InsideIsPositive off in the squared distance map only */
+  filter2D->InsideIsPositiveOff();
+  for( bool squaredDistance : { false, true } )
+    {
+    filter2D->SetSquaredDistance( squaredDistance );
+    filter2D->Update();
+    const myImageType2D2::PixelType zeroDistance = outputDistance2D2->GetPixel( index2D );
+    if( zeroDistance != 0 || std::signbit( zeroDistance ) != squaredDistance )
+      {
+      std::cerr << "Wrong sign of the zero distance with squared distance "
+                << squaredDistance << ": signbit is " << std::signbit( zeroDistance ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
   return EXIT_SUCCESS;
 }
@@ -22,6 +22,7 @@
 #include "itkIntTypes.h"
 #include "itkFastMarchingStoppingCriterionBase.h"
 #include "itkFastMarchingTraits.h"
+#include "itkIndexedMinHeap.h"
 
 #include <queue>
 #include <functional>
@@ -40,7 +41,7 @@ namespace itk
  *
  * Updates are preformed using an entropy satisfy scheme where only
  * "upwind" neighborhoods are used. This implementation of Fast Marching
- * uses a std::priority_queue to locate the next proper node to
+ * uses an IndexedMinHeap to locate the next proper node to
  * update.
  *
  * Fast Marching sweeps through N points in (N log N) steps to obtain
@@ -68,9 +69,11 @@ namespace itk
  *    \li Superclass (itk::ImageToImageFilter or
  * itk::QuadEdgeMeshToQuadEdgeMeshFilter )
  *
- * \todo In the current implementation, std::priority_queue only allows
- * taking nodes out from the front and putting nodes in from the back.
- * Use itk::PriorityQueueContainer instead.
+ * The subclasses push the trial nodes in the heap with an identifier, when
+ * their nodes have one, so that a node updated several times is stored
+ * once in the heap. Nodes pushed without identifier are added to the heap
+ * at each update, and their outdated copies are skipped when popped.
+ * Trial nodes with equal values are processed by increasing identifier.
  *
  * \par Topology constraints:
  * Additional flexibiility in this class includes the implementation of
@@ -233,8 +236,7 @@ protected:
   using HeapContainerType = std::vector< NodePairType >;
   using NodeComparerType = std::greater< NodePairType >;
 
-  using PriorityQueueType = std::priority_queue<
-    NodePairType, HeapContainerType, NodeComparerType >;
+  using PriorityQueueType = IndexedMinHeap< NodePairType >;
 
   PriorityQueueType m_Heap;
 
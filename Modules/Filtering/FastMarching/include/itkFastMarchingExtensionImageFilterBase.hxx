@@ -245,10 +245,7 @@ FastMarchingExtensionImageFilterBase< TInput, TOutput, TAuxValue, VAuxDimension
     // insert point into trial heap
     this->m_LabelImage->SetPixel( iNode, Traits::Trial );
 
-    //node.SetValue( outputPixel );
-    //node.SetIndex( index );
-    //m_TrialHeap.push(node);
-    this->m_Heap.push( NodePairType( iNode, outputPixel ) );
+    this->m_Heap.push( NodePairType( iNode, outputPixel ), this->m_LabelImage->ComputeOffset( iNode ) );
 
     // update auxiliary values
     for ( unsigned int k = 0; k < AuxDimension; k++ )
@@ -21,6 +21,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkLevelSet.h"
+#include "itkIndexedMinHeap.h"
 #include "itkMath.h"
 
 #include <functional>
@@ -39,7 +40,7 @@ namespace itk
  *
  * Updates are preformed using an entropy satisfy scheme where only
  * "upwind" neighborhoods are used. This implementation of Fast Marching
- * uses a std::priority_queue to locate the next proper grid position to
+ * uses an IndexedMinHeap to locate the next proper grid position to
  * update.
  *
  * Fast Marching sweeps through N grid points in (N log N) steps to obtain
@@ -86,17 +87,11 @@ namespace itk
  *
  * For an alternative implementation, see itk::FastMarchingImageFilter.
  *
- * Possible Improvements:
- * In the current implementation, std::priority_queue only allows
- * taking nodes out from the front and putting nodes in from the back.
- * To update a value already on the heap, a new node is added to the heap.
- * The defunct old node is left on the heap. When it is removed from the
- * top, it will be recognized as invalid and not used.
- * Future implementations can implement the heap in a different way
- * allowing the values to be updated. This will generally require
- * some sift-up and sift-down functions and
- * an image of back-pointers going from the image to heap in order
- * to locate the node which is to be updated.
+ * The trial points are stored in the heap by their offset in the output
+ * buffer. When the value of a trial point is updated, its node is moved in
+ * the heap instead of adding a new node, so that the heap holds at most one
+ * node per pixel. Trial points with equal values are processed by
+ * increasing offset.
  *
  * \sa FastMarchingImageFilterBase
  * \sa LevelSetTypeDefault
@@ -395,11 +390,9 @@ private:
 
   /** Trial points are stored in a min-heap. This allow efficient access
    * to the trial point with minimum value which is the next grid point
-   * the algorithm processes. */
-  using HeapContainer = std::vector< AxisNodeType >;
-  using NodeComparer = std::greater< AxisNodeType >;
-  using HeapType =
-      std::priority_queue< AxisNodeType, HeapContainer, NodeComparer >;
+   * the algorithm processes. The values are identified by the offsets of
+   * the trial points in the output buffer. */
+  using HeapType = IndexedMinHeap< PixelType >;
 
   HeapType m_TrialHeap;
 
@@ -238,10 +238,7 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
     }
 
   // make sure the heap is empty
-  while ( !m_TrialHeap.empty() )
-    {
-    m_TrialHeap.pop();
-    }
+  m_TrialHeap.SetNumberOfIdentifiers( m_BufferedRegion.GetNumberOfPixels() );
 
   // process the input trial points
   if ( m_TrialPoints )
@@ -264,7 +261,7 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
         outputPixel = node.GetValue();
         output->SetPixel(idx, outputPixel);
 
-        m_TrialHeap.push(node);
+        m_TrialHeap.push( outputPixel, m_LabelImage->ComputeOffset(idx) );
         }
       ++pointsIter;
       }
@@ -305,7 +302,8 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
   while ( !m_TrialHeap.empty() )
     {
     // get the node with the smallest value
-    node = m_TrialHeap.top();
+    node.SetValue( m_TrialHeap.top() );
+    node.SetIndex( m_LabelImage->ComputeIndex( static_cast< OffsetValueType >( m_TrialHeap.GetTopIdentifier() ) ) );
     m_TrialHeap.pop();
 
     // does this node contain the current value ?
@@ -352,6 +350,9 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
         }
       }
     }
+
+  // release the memory of the heap
+  m_TrialHeap.clear();
 }
 
 template< typename TLevelSet, typename TSpeedImage >
@@ -515,9 +516,7 @@ FastMarchingImageFilter< TLevelSet, TSpeedImage >
 
     // insert point into trial heap
     m_LabelImage->SetPixel(index, TrialPoint);
-    node.SetValue( outputPixel );
-    node.SetIndex( index );
-    m_TrialHeap.push(node);
+    m_TrialHeap.push( outputPixel, m_LabelImage->ComputeOffset(index) );
     }
 
   return solution;
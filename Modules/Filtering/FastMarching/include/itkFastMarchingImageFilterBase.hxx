@@ -220,7 +220,7 @@ UpdateValue( OutputImageType* oImage, const NodeType& iNode )
     this->SetLabelValueForGivenNode( iNode, Traits::Trial );
 
     // Insert point into trial heap
-    this->m_Heap.push( NodePairType( iNode, outputPixel ) );
+    this->m_Heap.push( NodePairType( iNode, outputPixel ), m_LabelImage->ComputeOffset( iNode ) );
     }
 }
 
@@ -498,6 +498,9 @@ InitializeOutput( OutputImageType* oImage )
   m_LabelImage->Allocate();
   m_LabelImage->FillBuffer( Traits::Far );
 
+  // The trial nodes are identified in the heap by their offsets
+  this->m_Heap.SetNumberOfIdentifiers( m_BufferedRegion.GetNumberOfPixels() );
+
   NodeType idx;
   OutputPixelType outputPixel = this->m_LargeValue;
 
@@ -600,8 +603,7 @@ InitializeOutput( OutputImageType* oImage )
         outputPixel = pointsIter->Value().GetValue();
         this->SetOutputValue( oImage, idx, outputPixel );
 
-        //this->m_Heap->Push( PriorityQueueElementType( idx, pointsIter->second ) );
-        this->m_Heap.push( pointsIter->Value() );
+        this->m_Heap.push( pointsIter->Value(), m_LabelImage->ComputeOffset( idx ) );
         }
       ++pointsIter;
       }
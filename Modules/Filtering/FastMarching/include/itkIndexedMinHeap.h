@@ -0,0 +1,271 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkIndexedMinHeap_h
+#define itkIndexedMinHeap_h
+
+#include "itkIntTypes.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace itk
+{
+/** \class IndexedMinHeap
+ * \brief Binary min-heap whose elements can be found and updated by
+ * identifier.
+ *
+ * An element pushed with an identifier replaces the element of the heap
+ * with the same identifier, if any, and is moved up or down the heap
+ * according to its new value (decrease-key or increase-key). Hence a node
+ * of a front propagation is stored at most once, instead of once per update
+ * of its value as with std::priority_queue. The identifiers are in
+ * [0, GetNumberOfIdentifiers()), and the heap keeps the position of each
+ * identifier in an array of 32-bit integers.
+ *
+ * Elements pushed without identifier are simply added to the heap.
+ * Elements pushed with an identifier that is not tracked, e.g. when the
+ * number of identifiers does not fit in the 32-bit positions, are also
+ * added to the heap, and keep their identifier: GetTopIdentifier() still
+ * returns it, but the heap may then hold several elements with the same
+ * identifier, and the caller has to skip the outdated ones when popped,
+ * as with std::priority_queue.
+ *
+ * Equal elements are popped by increasing identifier, the elements without
+ * identifier last, whatever the order in which they were pushed or
+ * updated. With std::priority_queue, their order depends on the history of
+ * the heap and on the standard library.
+ *
+ * push(), top(), pop(), empty() and size() behave as the methods of
+ * std::priority_queue< TElement, std::vector< TElement >, std::greater< TElement > >,
+ * which the heap replaces.
+ *
+ * \ingroup ITKFastMarching
+ */
+template< typename TElement, typename TCompare = std::less< TElement > >
+class IndexedMinHeap
+{
+public:
+  using ElementType = TElement;
+  using CompareType = TCompare;
+
+  /** Identifier of the elements pushed without identifier. */
+  static constexpr IdentifierType NoIdentifier = std::numeric_limits< IdentifierType >::max();
+
+  IndexedMinHeap() = default;
+
+  /** Remove all the elements, release the memory, and set the number of
+   * identifiers. The identifiers are not tracked when their number does not
+   * fit in the positions of the heap: elements with the same identifier are
+   * then added to the heap instead of being replaced. */
+  void SetNumberOfIdentifiers(SizeValueType numberOfIdentifiers)
+  {
+    this->clear();
+    if ( numberOfIdentifiers < NotInHeap )
+      {
+      m_Positions.assign(numberOfIdentifiers, NotInHeap);
+      }
+  }
+  SizeValueType GetNumberOfIdentifiers() const
+  {
+    return m_Positions.size();
+  }
+
+  /** Whether the heap replaces the elements pushed with this identifier. */
+  bool IsTracked(IdentifierType identifier) const
+  {
+    return identifier < m_Positions.size();
+  }
+
+  /** Whether an element with this tracked identifier is in the heap. */
+  bool Contains(IdentifierType identifier) const
+  {
+    return identifier < m_Positions.size() && m_Positions[identifier] != NotInHeap;
+  }
+
+  bool empty() const
+  {
+    return m_Entries.empty();
+  }
+
+  SizeValueType size() const
+  {
+    return m_Entries.size();
+  }
+
+  /** Smallest element. */
+  const ElementType & top() const
+  {
+    return m_Entries.front().m_Element;
+  }
+
+  /** Identifier of the smallest element, or NoIdentifier if it was pushed
+   * without identifier. */
+  IdentifierType GetTopIdentifier() const
+  {
+    return m_Entries.front().m_Identifier;
+  }
+
+  /** Add an element. */
+  void push(const ElementType & element)
+  {
+    m_Entries.push_back( Entry{ element, NoIdentifier } );
+    this->MoveUp(m_Entries.size() - 1);
+  }
+
+  /** Add an element, or replace the element with the same identifier if
+   * the identifier is tracked. */
+  void push(const ElementType & element, IdentifierType identifier)
+  {
+    if ( !this->IsTracked(identifier) )
+      {
+      m_Entries.push_back( Entry{ element, identifier } );
+      this->MoveUp(m_Entries.size() - 1);
+      return;
+      }
+    const PositionType position = m_Positions[identifier];
+    if ( position == NotInHeap )
+      {
+      m_Entries.push_back( Entry{ element, identifier } );
+      this->MoveUp(m_Entries.size() - 1);
+      }
+    else if ( m_Compare(element, m_Entries[position].m_Element) )
+      {
+      m_Entries[position].m_Element = element;
+      this->MoveUp(position);
+      }
+    else
+      {
+      m_Entries[position].m_Element = element;
+      this->MoveDown(position);
+      }
+  }
+
+  /** Remove the smallest element. */
+  void pop()
+  {
+    this->SetPosition(m_Entries.front().m_Identifier, NotInHeap);
+    if ( m_Entries.size() > 1 )
+      {
+      m_Entries.front() = m_Entries.back();
+      m_Entries.pop_back();
+      this->MoveDown(0);
+      }
+    else
+      {
+      m_Entries.pop_back();
+      }
+  }
+
+  /** Remove all the elements and the identifiers, and release the memory. */
+  void clear()
+  {
+    std::vector< Entry >().swap(m_Entries);
+    std::vector< PositionType >().swap(m_Positions);
+  }
+
+private:
+  using PositionType = uint32_t;
+  static constexpr PositionType NotInHeap = std::numeric_limits< PositionType >::max();
+
+  struct Entry
+  {
+    ElementType    m_Element;
+    IdentifierType m_Identifier;
+  };
+
+  void SetPosition(IdentifierType identifier, SizeValueType position)
+  {
+    if ( this->IsTracked(identifier) )
+      {
+      m_Positions[identifier] = static_cast< PositionType >( position );
+      }
+  }
+
+  // Order of the entries: equal elements are ordered by identifier, so that
+  // the order in which they are popped does not depend on the history of
+  // the heap.
+  bool IsBefore(const Entry & a, const Entry & b) const
+  {
+    if ( m_Compare(a.m_Element, b.m_Element) )
+      {
+      return true;
+      }
+    return !m_Compare(b.m_Element, a.m_Element) && a.m_Identifier < b.m_Identifier;
+  }
+
+  // Move an entry up to its place, shifting its ancestors down.
+  void MoveUp(SizeValueType position)
+  {
+    const Entry entry = m_Entries[position];
+    while ( position > 0 )
+      {
+      const SizeValueType parent = ( position - 1 ) / 2;
+      if ( !this->IsBefore(entry, m_Entries[parent]) )
+        {
+        break;
+        }
+      m_Entries[position] = m_Entries[parent];
+      this->SetPosition(m_Entries[position].m_Identifier, position);
+      position = parent;
+      }
+    m_Entries[position] = entry;
+    this->SetPosition(entry.m_Identifier, position);
+  }
+
+  // Move an entry down to its place, shifting its smallest descendants up.
+  void MoveDown(SizeValueType position)
+  {
+    const Entry         entry = m_Entries[position];
+    const SizeValueType size = m_Entries.size();
+    for (;; )
+      {
+      SizeValueType child = 2 * position + 1;
+      if ( child >= size )
+        {
+        break;
+        }
+      if ( child + 1 < size && this->IsBefore(m_Entries[child + 1], m_Entries[child]) )
+        {
+        ++child;
+        }
+      if ( !this->IsBefore(m_Entries[child], entry) )
+        {
+        break;
+        }
+      m_Entries[position] = m_Entries[child];
+      this->SetPosition(m_Entries[position].m_Identifier, position);
+      position = child;
+      }
+    m_Entries[position] = entry;
+    this->SetPosition(entry.m_Identifier, position);
+  }
+
+  std::vector< Entry >        m_Entries;
+  std::vector< PositionType > m_Positions;
+  CompareType                 m_Compare;
+};
+
+template< typename TElement, typename TCompare >
+constexpr IdentifierType IndexedMinHeap< TElement, TCompare >::NoIdentifier;
+
+template< typename TElement, typename TCompare >
+constexpr typename IndexedMinHeap< TElement, TCompare >::PositionType IndexedMinHeap< TElement, TCompare >::NotInHeap;
+} // end namespace itk
+
+#endif
@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkIndexedMinHeap.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+
+// Push, update and pop random elements, and compare the heap with a
+// reference map from identifier to value.
+int itkIndexedMinHeapTest( int, char *[] )
+{
+  using HeapType = itk::IndexedMinHeap< double >;
+
+  constexpr itk::SizeValueType numberOfIdentifiers = 500;
+
+  HeapType heap;
+  heap.SetNumberOfIdentifiers( numberOfIdentifiers );
+  if ( heap.GetNumberOfIdentifiers() != numberOfIdentifiers || !heap.empty() )
+    {
+    std::cerr << "Wrong initial state" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::mt19937                             generator( 42 );
+  std::uniform_real_distribution< double > value( 0.0, 100.0 );
+  std::uniform_int_distribution< int >     identifier( 0, numberOfIdentifiers - 1 );
+  std::uniform_int_distribution< int >     operation( 0, 2 );
+
+  std::map< itk::IdentifierType, double > reference;
+  for ( unsigned int i = 0; i < 20000; ++i )
+    {
+    if ( operation( generator ) > 0 || reference.empty() )
+      {
+      // Insert, decrease or increase the value of an identifier.
+      const itk::IdentifierType id = identifier( generator );
+      const double              v = value( generator );
+      heap.push( v, id );
+      reference[id] = v;
+      }
+    else
+      {
+      auto smallest = reference.begin();
+      for ( auto it = reference.begin(); it != reference.end(); ++it )
+        {
+        if ( it->second < smallest->second )
+          {
+          smallest = it;
+          }
+        }
+      if ( heap.top() != smallest->second || heap.GetTopIdentifier() != smallest->first )
+        {
+        std::cerr << "Wrong top element " << heap.top() << " (" << heap.GetTopIdentifier()
+                  << "), expected " << smallest->second << " (" << smallest->first << ")" << std::endl;
+        return EXIT_FAILURE;
+        }
+      heap.pop();
+      reference.erase( smallest );
+      }
+    if ( heap.size() != reference.size() )
+      {
+      std::cerr << "Wrong size " << heap.size() << ", expected " << reference.size() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  for ( itk::IdentifierType id = 0; id < numberOfIdentifiers; ++id )
+    {
+    if ( heap.Contains( id ) != ( reference.count( id ) > 0 ) )
+      {
+      std::cerr << "Wrong membership of identifier " << id << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Equal elements are popped by increasing identifier, whatever the order
+  // of their insertions and updates.
+  heap.SetNumberOfIdentifiers( numberOfIdentifiers );
+  const itk::IdentifierType tiedIdentifiers[] = { 9, 2, 7, 4, 0, 5 };
+  for ( itk::IdentifierType id : tiedIdentifiers )
+    {
+    heap.push( 10.0 + id, id );
+    }
+  for ( itk::IdentifierType id : tiedIdentifiers )
+    {
+    heap.push( 1.0, id );
+    }
+  heap.push( 1.0 );
+  const itk::IdentifierType sortedIdentifiers[] = { 0, 2, 4, 5, 7, 9, HeapType::NoIdentifier };
+  for ( itk::IdentifierType id : sortedIdentifiers )
+    {
+    if ( heap.empty() || heap.top() != 1.0 || heap.GetTopIdentifier() != id )
+      {
+      std::cerr << "Wrong order of equal elements, expected identifier " << id << std::endl;
+      return EXIT_FAILURE;
+      }
+    heap.pop();
+    }
+
+  // Elements without identifier, or with an identifier that is not
+  // tracked, are kept as duplicates, as in std::priority_queue, and the
+  // latter keep their identifier.
+  heap.SetNumberOfIdentifiers( 0 );
+  if ( heap.IsTracked( 7 ) )
+    {
+    std::cerr << "No identifier should be tracked" << std::endl;
+    return EXIT_FAILURE;
+    }
+  heap.push( 3.0 );
+  heap.push( 1.0, 7 );
+  heap.push( 2.0 );
+  heap.push( 4.0, 7 );
+  const double              expectedValues[] = { 1.0, 2.0, 3.0, 4.0 };
+  const itk::IdentifierType expectedIdentifiers[] = { 7, HeapType::NoIdentifier, HeapType::NoIdentifier, 7 };
+  for ( unsigned int i = 0; i < 4; ++i )
+    {
+    if ( heap.empty() || heap.top() != expectedValues[i] || heap.GetTopIdentifier() != expectedIdentifiers[i] )
+      {
+      std::cerr << "Wrong untracked element, expected " << expectedValues[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    heap.pop();
+    }
+  if ( !heap.empty() )
+    {
+    std::cerr << "The heap should be empty" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #include "itkFixedArray.h"
 #include "itkNeighborhoodIterator.h"
 #include "itkNeighborhood.h"
+#include <vector>
 
 namespace itk
 {
@@ -52,6 +53,19 @@ namespace itk
  * Manduchi (Bilateral Filtering for Gray and ColorImages. IEEE
  * ICCV. 1998.)
  *
+ * The Exact algorithm evaluates the product of the domain and range
+ * Gaussians over the whole kernel of each pixel, so its cost grows with
+ * the size of the kernel. The BilateralGrid algorithm approximates the
+ * filter with a Gaussian blur of a grid downsampled in the image domain and
+ * in the intensity range, as described by Chen, Paris and Durand
+ * (Real-time Edge-Aware Image Processing with the Bilateral Grid. ACM
+ * SIGGRAPH. 2007.). Its cost does not depend on the sigmas, and it is much
+ * faster than the exact filter for large domain sigmas.
+ *
+ * An optional guide image turns the filter into a joint (or cross)
+ * bilateral filter: the range Gaussian is evaluated on the differences of
+ * the pixels of the guide image instead of the input image.
+ *
  * \sa GaussianOperator
  * \sa RecursiveGaussianImageFilter
  * \sa DiscreteGaussianImageFilter
@@ -168,6 +182,26 @@ public:
   itkSetMacro(NumberOfRangeGaussianSamples, unsigned long);
   itkGetConstMacro(NumberOfRangeGaussianSamples, unsigned long);
 
+  /** Algorithms computing the filter. */
+  typedef enum { Exact = 0,
+                 BilateralGrid = 1 } AlgorithmType;
+
+  /** Set/Get the algorithm computing the filter. Default is Exact. */
+  itkSetEnumMacro(Algorithm, AlgorithmType);
+  itkGetEnumMacro(Algorithm, AlgorithmType);
+
+  /** Set/Get the spacing of the bilateral grid, in units of the domain
+   * and range sigmas. Smaller spacings are more accurate, but the memory
+   * and time used by the grid grow with the inverse of the spacing to the
+   * power of ImageDimension + 1. Default is 1. */
+  itkSetClampMacro(GridSpacing, double, 0.1, 10.0);
+  itkGetConstMacro(GridSpacing, double);
+
+  /** Set/Get the guide image of a joint bilateral filter. It must have the
+   * same geometry as the input. By default the input is its own guide. */
+  itkSetInputMacro(GuideImage, InputImageType);
+  itkGetInputMacro(GuideImage, InputImageType);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   // Begin concept checking
   itkConceptMacro( OutputHasNumericTraitsCheck,
@@ -188,6 +222,9 @@ protected:
   /** Do some setup before the ThreadedGenerateData */
   void BeforeThreadedGenerateData() override;
 
+  /** Release the bilateral grid. */
+  void AfterThreadedGenerateData() override;
+
   /** Standard pipeline method. This filter is implemented as a multi-threaded
    * filter. */
   void DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
@@ -201,6 +238,19 @@ protected:
   void GenerateInputRequestedRegion() override;
 
 private:
+  static constexpr unsigned int GridDimension = ImageDimension + 1;
+
+  /** Radius of the kernel, in pixels. */
+  SizeType GetKernelRadius() const;
+
+  /** Bilateral grid: build the grid, sample the pixels whose positions
+   * along the last image axis are near a plane of the grid, blur the grid
+   * along an axis, and interpolate the filtered values of a region. */
+  void BuildGrid();
+  void SplatGridPlane(SizeValueType plane);
+  void BlurGrid(unsigned int axis);
+  void SliceGrid(const OutputImageRegionType & outputRegion);
+
   /** The standard deviation of the gaussian blurring kernel in the image
       range. Units are intensity. */
   double m_RangeSigma;
@@ -227,6 +277,20 @@ private:
   double                m_DynamicRange;
   double                m_DynamicRangeUsed;
   std::vector< double > m_RangeGaussianTable;
+
+  AlgorithmType m_Algorithm;
+  double        m_GridSpacing;
+
+  /** The bilateral grid. The first axis is the intensity range, the other
+   * ones the image axes. Each node holds the sum of the weighted pixel
+   * values and the sum of the weights. */
+  std::vector< float >                       m_Grid;
+  FixedArray< SizeValueType, GridDimension > m_GridSize;
+  FixedArray< SizeValueType, GridDimension > m_GridStride;
+  FixedArray< double, GridDimension >        m_GridNodeSpacing;
+  FixedArray< double, GridDimension >        m_GridOrigin;
+  FixedArray< double, GridDimension >        m_GridBlurSigma;
+  FixedArray< SizeValueType, GridDimension > m_GridBlurRadius;
 };
 } // end namespace itk
 
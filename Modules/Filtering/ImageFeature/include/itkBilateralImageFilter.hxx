@@ -25,6 +25,8 @@
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 #include "itkProgressReporter.h"
 #include "itkStatisticsImageFilter.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 
 namespace itk
 {
@@ -43,7 +45,11 @@ BilateralImageFilter< TInputImage, TOutputImage >
   this->m_DomainMu = 2.5;  // keep small to keep kernels small
   this->m_RangeMu = 4.0;   // can be bigger then DomainMu since we only
                            // index into a single table
+  this->m_Algorithm = Exact;
+  this->m_GridSpacing = 1.0;
   this->DynamicMultiThreadingOn();
+
+  Self::AddOptionalInputName("GuideImage", 1);
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -54,6 +60,30 @@ BilateralImageFilter< TInputImage, TOutputImage >
   m_Radius.Fill(i);
 }
 
+template< typename TInputImage, typename TOutputImage >
+typename BilateralImageFilter< TInputImage, TOutputImage >::SizeType
+BilateralImageFilter< TInputImage, TOutputImage >
+::GetKernelRadius() const
+{
+  // Pad the image by 2.5*sigma in all directions
+  SizeType radius;
+
+  if ( m_AutomaticKernelSize )
+    {
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      radius[i] =
+        ( typename TInputImage::SizeType::SizeValueType )
+        std::ceil(m_DomainMu * m_DomainSigma[i] / this->GetInput()->GetSpacing()[i]);
+      }
+    }
+  else
+    {
+    radius = m_Radius;
+    }
+  return radius;
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 BilateralImageFilter< TInputImage, TOutputImage >
@@ -72,26 +102,7 @@ BilateralImageFilter< TInputImage, TOutputImage >
     return;
     }
 
-  // Pad the image by 2.5*sigma in all directions
-  typename TInputImage::SizeType radius;
-  unsigned int i;
-
-  if ( m_AutomaticKernelSize )
-    {
-    for ( i = 0; i < ImageDimension; i++ )
-      {
-      radius[i] =
-        ( typename TInputImage::SizeType::SizeValueType )
-        std::ceil(m_DomainMu * m_DomainSigma[i] / this->GetInput()->GetSpacing()[i]);
-      }
-    }
-  else
-    {
-    for ( i = 0; i < ImageDimension; i++ )
-      {
-      radius[i] = m_Radius[i];
-      }
-    }
+  const SizeType radius = this->GetKernelRadius();
 
   // get a copy of the input requested region (should equal the output
   // requested region)
@@ -105,6 +116,13 @@ BilateralImageFilter< TInputImage, TOutputImage >
   if ( inputRequestedRegion.Crop( inputPtr->GetLargestPossibleRegion() ) )
     {
     inputPtr->SetRequestedRegion(inputRequestedRegion);
+
+    // the guide image has the same geometry as the input
+    auto * guidePtr = const_cast< TInputImage * >( this->GetGuideImage() );
+    if ( guidePtr )
+      {
+      guidePtr->SetRequestedRegion(inputRequestedRegion);
+      }
     return;
     }
   else
@@ -129,13 +147,24 @@ void
 BilateralImageFilter< TInputImage, TOutputImage >
 ::BeforeThreadedGenerateData()
 {
+  if ( m_RangeSigma <= 0.0 )
+    {
+    itkExceptionMacro(<< "RangeSigma must be positive.");
+    }
+
+  if ( m_Algorithm == BilateralGrid )
+    {
+    this->BuildGrid();
+    return;
+    }
+
   // Build a small image of the N-dimensional Gaussian used for domain filter
   //
   // Gaussian image size will be (2*std::ceil(2.5*sigma)+1) x
   // (2*std::ceil(2.5*sigma)+1)
   unsigned int i;
 
-  typename InputImageType::SizeType radius;
+  const typename InputImageType::SizeType radius = this->GetKernelRadius();
   typename InputImageType::SizeType domainKernelSize;
 
   const InputImageType *inputImage = this->GetInput();
@@ -143,23 +172,9 @@ BilateralImageFilter< TInputImage, TOutputImage >
   const typename InputImageType::SpacingType inputSpacing = inputImage->GetSpacing();
   const typename InputImageType::PointType inputOrigin  = inputImage->GetOrigin();
 
-  if ( m_AutomaticKernelSize )
-    {
-    for ( i = 0; i < ImageDimension; i++ )
-      {
-      radius[i] =
-        ( typename TInputImage::SizeType::SizeValueType )
-        std::ceil(m_DomainMu * m_DomainSigma[i] / inputSpacing[i]);
-      domainKernelSize[i] = 2 * radius[i] + 1;
-      }
-    }
-  else
+  for ( i = 0; i < ImageDimension; i++ )
     {
-    for ( i = 0; i < ImageDimension; i++ )
-      {
-      radius[i] = m_Radius[i];
-      domainKernelSize[i] = 2 * radius[i] + 1;
-      }
+    domainKernelSize[i] = 2 * radius[i] + 1;
     }
 
   typename GaussianImageSource< GaussianImageType >::Pointer gaussianImage;
@@ -208,7 +223,7 @@ BilateralImageFilter< TInputImage, TOutputImage >
   typename StatisticsImageFilter< TInputImage >::Pointer statistics =
     StatisticsImageFilter< TInputImage >::New();
 
-  statistics->SetInput(inputImage);
+  statistics->SetInput( this->GetGuideImage() ? this->GetGuideImage() : inputImage );
   statistics->GetOutput()
   ->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
   statistics->Update();
@@ -248,11 +263,20 @@ void
 BilateralImageFilter< TInputImage, TOutputImage >
 ::DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread)
 {
+  if ( m_Algorithm == BilateralGrid )
+    {
+    this->SliceGrid(outputRegionForThread);
+    return;
+    }
+
   typename TInputImage::ConstPointer input = this->GetInput();
   typename TOutputImage::Pointer output = this->GetOutput();
   typename TInputImage::IndexValueType i;
   const double  rangeDistanceThreshold = m_DynamicRangeUsed;
 
+  // the range distances are measured in the guide image, if any
+  const InputImageType *guide = this->GetGuideImage();
+
   ZeroFluxNeumannBoundaryCondition< TInputImage > BC;
 
   // Find the boundary "faces"
@@ -274,6 +298,7 @@ BilateralImageFilter< TInputImage, TOutputImage >
   // whether a specified region needs to use the boundary conditions or
   // not.
   NeighborhoodIteratorType               b_iter;
+  NeighborhoodIteratorType               g_iter;
   ImageRegionIterator< OutputImageType > o_iter;
   KernelConstIteratorType                k_it;
   KernelConstIteratorType                kernelEnd = m_GaussianKernel.End();
@@ -284,12 +309,17 @@ BilateralImageFilter< TInputImage, TOutputImage >
     b_iter = NeighborhoodIteratorType(m_GaussianKernel.GetRadius(),
                                       this->GetInput(), *fit);
     b_iter.OverrideBoundaryCondition(&BC);
+    if ( guide )
+      {
+      g_iter = NeighborhoodIteratorType(m_GaussianKernel.GetRadius(), guide, *fit);
+      g_iter.OverrideBoundaryCondition(&BC);
+      }
     o_iter = ImageRegionIterator< OutputImageType >(this->GetOutput(), *fit);
 
     while ( !b_iter.IsAtEnd() )
       {
       // Setup
-      centerPixel = static_cast< OutputPixelRealType >( b_iter.GetCenterPixel() );
+      centerPixel = static_cast< OutputPixelRealType >( guide ? g_iter.GetCenterPixel() : b_iter.GetCenterPixel() );
       val = 0.0;
       normFactor = 0.0;
 
@@ -299,7 +329,7 @@ BilateralImageFilter< TInputImage, TOutputImage >
         {
         // range distance between neighborhood pixel and neighborhood center
         pixel = static_cast< OutputPixelRealType >( b_iter.GetPixel(i) );
-        rangeDistance = pixel - centerPixel;
+        rangeDistance = ( guide ? static_cast< OutputPixelRealType >( g_iter.GetPixel(i) ) : pixel ) - centerPixel;
         // flip sign if needed
         if ( rangeDistance < 0.0 )
           {
@@ -330,7 +360,283 @@ BilateralImageFilter< TInputImage, TOutputImage >
 
       ++b_iter;
       ++o_iter;
+      if ( guide )
+        {
+        ++g_iter;
+        }
+      }
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  std::vector< float >().swap(m_Grid);
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::BuildGrid()
+{
+  const InputImageType *inputImage = this->GetInput();
+  const InputImageType *guideImage = this->GetGuideImage() ? this->GetGuideImage() : inputImage;
+  // all the pixels of the input requested region are sampled in the grid
+  const typename InputImageType::RegionType  region = inputImage->GetRequestedRegion();
+  const typename InputImageType::SpacingType inputSpacing = inputImage->GetSpacing();
+  const SizeType                             radius = this->GetKernelRadius();
+
+  using CalculatorType = MinimumMaximumImageCalculator< InputImageType >;
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetImage(guideImage);
+  calculator->SetRegion(region);
+  calculator->Compute();
+  m_DynamicRange = static_cast< double >( calculator->GetMaximum() )
+                   - static_cast< double >( calculator->GetMinimum() );
+  m_DynamicRangeUsed = m_RangeMu * m_RangeSigma;
+
+  // The linear interpolations of the samples in the grid and of the
+  // filtered values from the grid each blur by a variance of about 1/6
+  // node, which is removed from the Gaussian blur of the grid.
+  const double interpolationVariance = 2.0 / 6.0;
+
+  // intensity range
+  m_GridNodeSpacing[0] = m_RangeSigma * m_GridSpacing;
+  m_GridOrigin[0] = static_cast< double >( calculator->GetMinimum() );
+  m_GridSize[0] = static_cast< SizeValueType >( std::floor(m_DynamicRange / m_GridNodeSpacing[0]) ) + 2;
+  m_GridBlurSigma[0] = std::sqrt( std::max(1.0 / ( m_GridSpacing * m_GridSpacing ) - interpolationVariance, 0.0) );
+  m_GridBlurRadius[0] = static_cast< SizeValueType >( std::ceil(m_RangeMu / m_GridSpacing) );
+
+  // image domain. The grid is not finer than the image.
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    const double sigma = m_DomainSigma[d] / inputSpacing[d];
+    const double nodeSpacing = std::max(sigma * m_GridSpacing, 1.0);
+    const double blurSigma = sigma / nodeSpacing;
+    m_GridNodeSpacing[d + 1] = nodeSpacing;
+    m_GridOrigin[d + 1] = static_cast< double >( region.GetIndex(d) );
+    m_GridSize[d + 1] =
+      static_cast< SizeValueType >( std::floor(static_cast< double >( region.GetSize(d) - 1 ) / nodeSpacing) ) + 2;
+    m_GridBlurSigma[d + 1] =
+      std::sqrt( std::max(blurSigma * blurSigma - ( nodeSpacing > 1.0 ? interpolationVariance : 0.0 ), 0.0) );
+    m_GridBlurRadius[d + 1] = static_cast< SizeValueType >( std::ceil(radius[d] / nodeSpacing) );
+    }
+
+  SizeValueType numberOfNodes = 1;
+  for ( unsigned int a = 0; a < GridDimension; ++a )
+    {
+    m_GridStride[a] = numberOfNodes;
+    numberOfNodes *= m_GridSize[a];
+    }
+  m_Grid.assign(2 * numberOfNodes, 0.0f);
+
+  // Sample the pixels, one plane of the grid at a time so that the threads
+  // do not write to the same nodes, then blur the grid along each axis.
+  MultiThreaderBase *multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  multiThreader->ParallelizeArray(0, m_GridSize[ImageDimension],
+                                  [this](SizeValueType plane)
+                                    {
+                                    this->SplatGridPlane(plane);
+                                    },
+                                  nullptr);
+  for ( unsigned int a = 0; a < GridDimension; ++a )
+    {
+    this->BlurGrid(a);
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::SplatGridPlane(SizeValueType plane)
+{
+  const InputImageType *inputImage = this->GetInput();
+  const InputImageType *guideImage = this->GetGuideImage() ? this->GetGuideImage() : inputImage;
+  const unsigned int    last = ImageDimension - 1;
+
+  // the pixels whose positions along the last axis are between the
+  // neighbor planes
+  typename InputImageType::RegionType region = inputImage->GetRequestedRegion();
+  const double         lastSpacing = m_GridNodeSpacing[ImageDimension];
+  const IndexValueType regionStart = region.GetIndex(last);
+  const IndexValueType regionEnd = regionStart + static_cast< IndexValueType >( region.GetSize(last) );
+  const IndexValueType start =
+    std::max(regionStart, regionStart + static_cast< IndexValueType >( std::floor(( plane - 1.0 ) * lastSpacing) ));
+  const IndexValueType end =
+    std::min(regionEnd, regionStart + static_cast< IndexValueType >( std::ceil(( plane + 1.0 ) * lastSpacing) ) + 1);
+  if ( start >= end )
+    {
+    return;
+    }
+  region.SetIndex(last, start);
+  region.SetSize( last, static_cast< SizeValueType >( end - start ) );
+
+  ImageRegionConstIteratorWithIndex< InputImageType > it(inputImage, region);
+  ImageRegionConstIterator< InputImageType >          git(guideImage, region);
+  constexpr unsigned int                              numberOfCorners = 1u << ImageDimension;
+  for ( ; !it.IsAtEnd(); ++it, ++git )
+    {
+    // position of the pixel in the grid, along the last axis
+    const double lastPosition = ( it.GetIndex()[last] - m_GridOrigin[ImageDimension] ) / lastSpacing;
+    const auto   lastNode = static_cast< SizeValueType >( lastPosition );
+    double       weight = lastPosition - lastNode;
+    if ( lastNode == plane )
+      {
+      weight = 1.0 - weight;
+      }
+    else if ( lastNode + 1 != plane )
+      {
+      continue;
+      }
+
+    // and along the other axes
+    SizeValueType node = plane * m_GridStride[ImageDimension];
+    double        fraction[GridDimension];
+    double        position = ( static_cast< double >( git.Get() ) - m_GridOrigin[0] ) / m_GridNodeSpacing[0];
+    for ( unsigned int a = 0; a < ImageDimension; ++a )
+      {
+      if ( a > 0 )
+        {
+        position = ( it.GetIndex()[a - 1] - m_GridOrigin[a] ) / m_GridNodeSpacing[a];
+        }
+      const auto n = static_cast< SizeValueType >( position );
+      node += n * m_GridStride[a];
+      fraction[a] = position - n;
+      }
+
+    const double value = static_cast< double >( it.Get() );
+    for ( unsigned int corner = 0; corner < numberOfCorners; ++corner )
+      {
+      double        cornerWeight = weight;
+      SizeValueType cornerNode = node;
+      for ( unsigned int a = 0; a < ImageDimension; ++a )
+        {
+        if ( corner & ( 1u << a ) )
+          {
+          cornerWeight *= fraction[a];
+          cornerNode += m_GridStride[a];
+          }
+        else
+          {
+          cornerWeight *= 1.0 - fraction[a];
+          }
+        }
+      m_Grid[2 * cornerNode] += static_cast< float >( cornerWeight * value );
+      m_Grid[2 * cornerNode + 1] += static_cast< float >( cornerWeight );
+      }
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::BlurGrid(unsigned int axis)
+{
+  const SizeValueType length = m_GridSize[axis];
+  const SizeValueType stride = m_GridStride[axis];
+  const SizeValueType radius = std::min(m_GridBlurRadius[axis], length - 1);
+  const double        sigma = m_GridBlurSigma[axis];
+  if ( radius == 0 || sigma <= 0.0 )
+    {
+    return;
+    }
+
+  std::vector< float > kernel(2 * radius + 1);
+  for ( SizeValueType k = 0; k < kernel.size(); ++k )
+    {
+    const double x = ( static_cast< double >( k ) - static_cast< double >( radius ) ) / sigma;
+    kernel[k] = static_cast< float >( std::exp(-0.5 * x * x) );
+    }
+
+  // The lines along the axis are numbered by the nodes before the axis,
+  // then by the nodes after the axis. The grid is zero outside, which is
+  // compensated by the normalization by the sum of the weights.
+  const SizeValueType numberOfLines = m_Grid.size() / ( 2 * length );
+  float *             grid = m_Grid.data();
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->ParallelizeArrayRange(0, numberOfLines,
+    [&](SizeValueType firstLine, SizeValueType lastLinePlus1)
+      {
+      std::vector< float > line(2 * length);
+      for ( SizeValueType l = firstLine; l < lastLinePlus1; ++l )
+        {
+        float *lineStart = grid + 2 * ( l % stride + ( l / stride ) * stride * length );
+        for ( SizeValueType n = 0; n < length; ++n )
+          {
+          line[2 * n] = lineStart[2 * n * stride];
+          line[2 * n + 1] = lineStart[2 * n * stride + 1];
+          }
+        for ( SizeValueType n = 0; n < length; ++n )
+          {
+          const SizeValueType first = n > radius ? n - radius : 0;
+          const SizeValueType last = std::min(n + radius, length - 1);
+          float               value = 0.0f;
+          float               weight = 0.0f;
+          for ( SizeValueType m = first; m <= last; ++m )
+            {
+            const float k = kernel[m + radius - n];
+            value += k * line[2 * m];
+            weight += k * line[2 * m + 1];
+            }
+          lineStart[2 * n * stride] = value;
+          lineStart[2 * n * stride + 1] = weight;
+          }
+        }
+      },
+    nullptr);
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+BilateralImageFilter< TInputImage, TOutputImage >
+::SliceGrid(const OutputImageRegionType & outputRegion)
+{
+  const InputImageType *guideImage = this->GetGuideImage() ? this->GetGuideImage() : this->GetInput();
+  constexpr unsigned int numberOfCorners = 1u << GridDimension;
+
+  ImageRegionConstIteratorWithIndex< InputImageType > git(guideImage, outputRegion);
+  ImageRegionIterator< OutputImageType >              oit(this->GetOutput(), outputRegion);
+  for ( ; !git.IsAtEnd(); ++git, ++oit )
+    {
+    // position of the pixel in the grid
+    SizeValueType node = 0;
+    double        fraction[GridDimension];
+    for ( unsigned int a = 0; a < GridDimension; ++a )
+      {
+      const double position = a == 0
+                              ? ( static_cast< double >( git.Get() ) - m_GridOrigin[0] ) / m_GridNodeSpacing[0]
+                              : ( git.GetIndex()[a - 1] - m_GridOrigin[a] ) / m_GridNodeSpacing[a];
+      const auto n = static_cast< SizeValueType >( position );
+      node += n * m_GridStride[a];
+      fraction[a] = position - n;
+      }
+
+    // interpolate the sums of the values and of the weights
+    double value = 0.0;
+    double weight = 0.0;
+    for ( unsigned int corner = 0; corner < numberOfCorners; ++corner )
+      {
+      double        cornerWeight = 1.0;
+      SizeValueType cornerNode = node;
+      for ( unsigned int a = 0; a < GridDimension; ++a )
+        {
+        if ( corner & ( 1u << a ) )
+          {
+          cornerWeight *= fraction[a];
+          cornerNode += m_GridStride[a];
+          }
+        else
+          {
+          cornerWeight *= 1.0 - fraction[a];
+          }
+        }
+      value += cornerWeight * m_Grid[2 * cornerNode];
+      weight += cornerWeight * m_Grid[2 * cornerNode + 1];
       }
+    oit.Set( static_cast< OutputPixelType >( value / weight ) );
     }
 }
 
@@ -349,6 +655,8 @@ BilateralImageFilter< TInputImage, TOutputImage >
   os << indent << "Amount of dynamic range used: " << m_DynamicRangeUsed << std::endl;
   os << indent << "AutomaticKernelSize: " << m_AutomaticKernelSize << std::endl;
   os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "Algorithm: " << ( m_Algorithm == BilateralGrid ? "BilateralGrid" : "Exact" ) << std::endl;
+  os << indent << "GridSpacing: " << m_GridSpacing << std::endl;
 }
 } // end namespace itk
 
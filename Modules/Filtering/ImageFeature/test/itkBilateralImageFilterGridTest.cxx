@@ -0,0 +1,175 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkBilateralImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+#include "itkTestingMacros.h"
+#include <random>
+
+// Compare the bilateral grid with the exact bilateral filter on a noisy
+// sphere, and report their times and differences. Then check that the grid
+// does not depend on the number of threads, and that a guide image drives
+// the range Gaussian of both algorithms.
+
+namespace
+{
+
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image< float, Dimension >;
+using FilterType = itk::BilateralImageFilter< ImageType, ImageType >;
+
+ImageType::Pointer
+CreateSphere( double noiseSigma )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill( 32 );
+  image->SetRegions( size );
+  image->Allocate();
+
+  std::mt19937                       generator( 3 );
+  std::normal_distribution< double > noise( 0.0, noiseSigma );
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    double distance = 0.0;
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      const double x = it.GetIndex()[d] - 15.5;
+      distance += x * x;
+      }
+    const double value = distance < 10.0 * 10.0 ? 100.0 : 0.0;
+    it.Set( static_cast< float >( value + ( noiseSigma > 0.0 ? noise( generator ) : 0.0 ) ) );
+    }
+  return image;
+}
+
+ImageType::Pointer
+Filter( const ImageType * input, const ImageType * guide, FilterType::AlgorithmType algorithm, double domainSigma,
+        unsigned int numberOfThreads, double & seconds )
+{
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  filter->SetGuideImage( guide );
+  filter->SetAlgorithm( algorithm );
+  filter->SetDomainSigma( domainSigma );
+  filter->SetRangeSigma( 30.0 );
+  filter->SetNumberOfThreads( numberOfThreads );
+  itk::TimeProbe probe;
+  probe.Start();
+  filter->Update();
+  probe.Stop();
+  seconds = probe.GetTotal();
+  ImageType::Pointer output = filter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+// Mean and maximum of the absolute differences of two images.
+void
+Difference( const ImageType * image1, const ImageType * image2, double & mean, double & maximum )
+{
+  itk::ImageRegionConstIterator< ImageType > it1( image1, image1->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType > it2( image2, image2->GetBufferedRegion() );
+  mean = 0.0;
+  maximum = 0.0;
+  for ( ; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    const double difference = std::abs( static_cast< double >( it1.Get() ) - it2.Get() );
+    mean += difference;
+    maximum = std::max( maximum, difference );
+    }
+  mean /= image1->GetBufferedRegion().GetNumberOfPixels();
+}
+
+}
+
+int itkBilateralImageFilterGridTest( int, char *[] )
+{
+  FilterType::Pointer filter = FilterType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( filter, BilateralImageFilter, ImageToImageFilter );
+  TEST_SET_GET_VALUE( FilterType::Exact, filter->GetAlgorithm() );
+  TEST_SET_GET_VALUE( 1.0, filter->GetGridSpacing() );
+  filter->SetGridSpacing( 0.5 );
+  TEST_SET_GET_VALUE( 0.5, filter->GetGridSpacing() );
+
+  ImageType::Pointer clean = CreateSphere( 0.0 );
+  ImageType::Pointer noisy = CreateSphere( 10.0 );
+
+  double seconds;
+  double mean;
+  double maximum;
+  bool   success = true;
+  for ( double domainSigma = 1.5; domainSigma <= 2.5; domainSigma += 1.0 )
+    {
+    double             exactSeconds;
+    ImageType::Pointer exact = Filter( noisy, nullptr, FilterType::Exact, domainSigma, 2, exactSeconds );
+    ImageType::Pointer grid = Filter( noisy, nullptr, FilterType::BilateralGrid, domainSigma, 2, seconds );
+    Difference( exact, grid, mean, maximum );
+    std::cout << "DomainSigma " << domainSigma << ": exact " << exactSeconds << " s, grid " << seconds
+              << " s, mean difference " << mean << ", maximum difference " << maximum << std::endl;
+    // The noise and the edge of the sphere have amplitudes of 10 and 100.
+    if ( mean > 1.5 || maximum > 25.0 )
+      {
+      std::cerr << "The bilateral grid is too far from the exact filter" << std::endl;
+      success = false;
+      }
+
+    ImageType::Pointer grid1 = Filter( noisy, nullptr, FilterType::BilateralGrid, domainSigma, 1, seconds );
+    ImageType::Pointer grid3 = Filter( noisy, nullptr, FilterType::BilateralGrid, domainSigma, 3, seconds );
+    Difference( grid1, grid3, mean, maximum );
+    if ( maximum != 0.0 )
+      {
+      std::cerr << "The bilateral grid depends on the number of threads" << std::endl;
+      success = false;
+      }
+    }
+
+  // The input is its own guide by default.
+  for ( auto algorithm : { FilterType::Exact, FilterType::BilateralGrid } )
+    {
+    ImageType::Pointer unguided = Filter( noisy, nullptr, algorithm, 2.0, 2, seconds );
+    ImageType::Pointer selfGuided = Filter( noisy, noisy, algorithm, 2.0, 2, seconds );
+    Difference( unguided, selfGuided, mean, maximum );
+    if ( maximum != 0.0 )
+      {
+      std::cerr << "Guiding algorithm " << algorithm << " by the input changes the output" << std::endl;
+      success = false;
+      }
+
+    // With the noiseless sphere as guide, the noise is smoothed without
+    // blurring the edge of the sphere.
+    ImageType::Pointer guided = Filter( noisy, clean, algorithm, 2.0, 2, seconds );
+    Difference( clean, guided, mean, maximum );
+    std::cout << "Guided algorithm " << algorithm << ": mean difference to the sphere " << mean
+              << ", maximum difference " << maximum << std::endl;
+    if ( mean > 1.5 || maximum > 10.0 )
+      {
+      std::cerr << "The guide image did not preserve the edge of the sphere" << std::endl;
+      success = false;
+      }
+    }
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
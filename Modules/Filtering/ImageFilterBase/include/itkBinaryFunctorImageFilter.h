@@ -20,6 +20,7 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkSimpleDataObjectDecorator.h"
+#include "itkBatchFunctorTraits.h"
 
 namespace itk
 {
@@ -36,8 +37,13 @@ namespace itk
  * the pipeline. The SetConstant() and GetConstant() methods are provided as shortcuts
  * to set or get the constant value without manipulating the decorator.
  *
+ * If the functor provides a ProcessBatch() method and all the images store
+ * their pixels contiguously, the output is computed one scanline at a time
+ * by ProcessBatch() instead of one pixel at a time by operator().
+ *
  * \sa BinaryGeneratorImagFilter
  * \sa UnaryFunctorImageFilter TernaryFunctorImageFilter
+ * \sa Functor::BinaryBatchFunctorTraits
  *
  * \ingroup IntensityImageFilters   MultiThreaded
  * \ingroup ITKImageFilterBase
@@ -186,6 +192,17 @@ protected:
   void GenerateOutputInformation() override;
 
 private:
+  /** Whether whole scanlines are passed to the batch method of the functor,
+   * see Functor::BinaryBatchFunctorTraits. */
+  using UseBatchFunctorType = typename mpl::And<
+    typename Functor::BinaryBatchFunctorTraits< FunctorType, Input1ImagePixelType,
+                                                Input2ImagePixelType, OutputImagePixelType >::Type,
+    mpl::And< mpl::And< ImageHasContiguousPixels< TInputImage1 >, ImageHasContiguousPixels< TInputImage2 > >,
+              ImageHasContiguousPixels< TOutputImage > > >::Type;
+
+  void ProcessScanlines(const OutputImageRegionType & outputRegionForThread, mpl::FalseType);
+  void ProcessScanlines(const OutputImageRegionType & outputRegionForThread, mpl::TrueType);
+
   FunctorType m_Functor;
 };
 } // end namespace itk
@@ -21,6 +21,8 @@
 #include "itkBinaryFunctorImageFilter.h"
 #include "itkImageScanlineIterator.h"
 #include "itkProgressReporter.h"
+#include <algorithm>
+#include <memory>
 
 
 namespace itk
@@ -188,6 +190,19 @@ template< typename TInputImage1, typename TInputImage2, typename TOutputImage, t
 void
 BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
 ::DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread)
+{
+  if( outputRegionForThread.GetSize(0) == 0 )
+    {
+    return;
+    }
+  this->ProcessScanlines(outputRegionForThread, UseBatchFunctorType());
+}
+
+template< typename TInputImage1, typename TInputImage2,
+          typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::ProcessScanlines(const OutputImageRegionType & outputRegionForThread, mpl::FalseType)
 {
   // We use dynamic_cast since inputs are stored as DataObjects. The
   // ImageToImageFilter::GetInput(int) always returns a pointer to a
@@ -195,11 +210,6 @@ BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
   const auto * inputPtr1 = dynamic_cast< const TInputImage1 * >( ProcessObject::GetInput(0) );
   const auto * inputPtr2 = dynamic_cast< const TInputImage2 * >( ProcessObject::GetInput(1) );
   TOutputImage *outputPtr = this->GetOutput(0);
-  const SizeValueType size0 = outputRegionForThread.GetSize(0);
-  if( size0 == 0)
-    {
-    return;
-    }
 
   if( inputPtr1 && inputPtr2 )
     {
@@ -265,6 +275,52 @@ BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
     itkGenericExceptionMacro(<<"At most one of the inputs can be a constant.");
     }
 }
+
+template< typename TInputImage1, typename TInputImage2,
+          typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::ProcessScanlines(const OutputImageRegionType & outputRegionForThread, mpl::TrueType)
+{
+  const auto * inputPtr1 = dynamic_cast< const TInputImage1 * >( ProcessObject::GetInput(0) );
+  const auto * inputPtr2 = dynamic_cast< const TInputImage2 * >( ProcessObject::GetInput(1) );
+  TOutputImage *outputPtr = this->GetOutput(0);
+  const SizeValueType size0 = outputRegionForThread.GetSize(0);
+
+  if( !inputPtr1 && !inputPtr2 )
+    {
+    itkGenericExceptionMacro(<<"At most one of the inputs can be a constant.");
+    }
+
+  // A constant input is expanded to a whole scanline, so that the same batch
+  // method handles both the image and the constant cases.
+  std::unique_ptr< Input1ImagePixelType[] > constant1Line;
+  std::unique_ptr< Input2ImagePixelType[] > constant2Line;
+  if( !inputPtr1 )
+    {
+    constant1Line.reset( new Input1ImagePixelType[size0] );
+    std::fill_n( constant1Line.get(), size0, this->GetConstant1() );
+    }
+  if( !inputPtr2 )
+    {
+    constant2Line.reset( new Input2ImagePixelType[size0] );
+    std::fill_n( constant2Line.get(), size0, this->GetConstant2() );
+    }
+
+  ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+  while ( !outputIt.IsAtEnd() )
+    {
+    const typename OutputImageRegionType::IndexType & index = outputIt.GetIndex();
+    const Input1ImagePixelType * line1 = inputPtr1 ?
+      inputPtr1->GetBufferPointer() + inputPtr1->ComputeOffset( index ) : constant1Line.get();
+    const Input2ImagePixelType * line2 = inputPtr2 ?
+      inputPtr2->GetBufferPointer() + inputPtr2->ComputeOffset( index ) : constant2Line.get();
+    m_Functor.ProcessBatch( line1, line2,
+                            outputPtr->GetBufferPointer() + outputPtr->ComputeOffset( index ),
+                            size0 );
+    outputIt.NextLine();
+    }
+}
 } // end namespace itk
 
 #endif
@@ -20,6 +20,7 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkSimpleDataObjectDecorator.h"
+#include "itkBatchFunctorTraits.h"
 
 
 #include <functional>
@@ -45,8 +46,13 @@ namespace itk
  * the pipeline. The SetConstant() and GetConstant() methods are provided as shortcuts
  * to set or get the constant value without manipulating the decorator.
  *
+ * If a functor object provides a ProcessBatch() method and all the images
+ * store their pixels contiguously, the output is computed one scanline at a
+ * time by ProcessBatch() instead of one pixel at a time by operator().
+ *
  * \sa UnaryGeneratorImageFilter
  * \sa BinaryFunctorImageFilter
+ * \sa Functor::BinaryBatchFunctorTraits
  *
  * \ingroup IntensityImageFilters   MultiThreaded
  * \ingroup ITKImageFilterBase
@@ -236,6 +242,20 @@ protected:
   void GenerateOutputInformation() override;
 
 private:
+  /** Whether whole scanlines are passed to the batch method of the functor,
+   * see Functor::BinaryBatchFunctorTraits. */
+  template <typename TFunctor>
+  using UseBatchFunctorType = typename mpl::And<
+    typename Functor::BinaryBatchFunctorTraits< TFunctor, Input1ImagePixelType,
+                                                Input2ImagePixelType, OutputImagePixelType >::Type,
+    mpl::And< mpl::And< ImageHasContiguousPixels< TInputImage1 >, ImageHasContiguousPixels< TInputImage2 > >,
+              ImageHasContiguousPixels< TOutputImage > > >::Type;
+
+  template <typename TFunctor>
+  void ProcessScanlines(const TFunctor &, const OutputImageRegionType & outputRegionForThread, mpl::FalseType);
+  template <typename TFunctor>
+  void ProcessScanlines(const TFunctor &, const OutputImageRegionType & outputRegionForThread, mpl::TrueType);
+
   std::function<void(const OutputImageRegionType &)> m_DynamicThreadedGenerateDataFunction;
 };
 } // end namespace itk
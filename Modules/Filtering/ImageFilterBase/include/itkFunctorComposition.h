@@ -0,0 +1,378 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFunctorComposition_h
+#define itkFunctorComposition_h
+
+#include "itkBatchFunctorTraits.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace itk
+{
+namespace Functor
+{
+
+/** \class Identity
+ * \brief Functor returning its argument unchanged.
+ *
+ * Used as the default argument functor of BinaryComposition and
+ * TernaryComposition.
+ *
+ * \ingroup ITKImageFilterBase
+ */
+class Identity
+{
+public:
+  bool operator!=(const Identity &) const
+  {
+    return false;
+  }
+
+  bool operator==(const Identity & other) const
+  {
+    return !( *this != other );
+  }
+
+  template< typename TInput >
+  inline const TInput & operator()(const TInput & A) const
+  {
+    return A;
+  }
+};
+
+/// \cond HIDE_META_PROGRAMMING
+namespace Details
+{
+/** Number of pixels processed at once by the batch methods of the
+ * compositions. The intermediate results of a block stay in the L1 cache. */
+constexpr SizeValueType CompositionBlockSize = 256;
+
+template< typename TFunctor, typename TInput, typename TOutput >
+inline void ApplyUnary(const TFunctor & functor, const TInput * input, TOutput * output, SizeValueType count,
+                       mpl::TrueType)
+{
+  functor.ProcessBatch(input, output, count);
+}
+
+template< typename TFunctor, typename TInput, typename TOutput >
+inline void ApplyUnary(const TFunctor & functor, const TInput * input, TOutput * output, SizeValueType count,
+                       mpl::FalseType)
+{
+  for ( SizeValueType i = 0; i < count; ++i )
+    {
+    output[i] = functor(input[i]);
+    }
+}
+
+template< typename TFunctor, typename TInput, typename TOutput >
+inline void ApplyUnary(const TFunctor & functor, const TInput * input, TOutput * output, SizeValueType count)
+{
+  ApplyUnary(functor, input, output, count,
+             typename UnaryBatchFunctorTraits< TFunctor, TInput, TOutput >::Type());
+}
+
+template< typename TFunctor, typename TInput1, typename TInput2, typename TOutput >
+inline void ApplyBinary(const TFunctor & functor, const TInput1 * input1, const TInput2 * input2,
+                        TOutput * output, SizeValueType count, mpl::TrueType)
+{
+  functor.ProcessBatch(input1, input2, output, count);
+}
+
+template< typename TFunctor, typename TInput1, typename TInput2, typename TOutput >
+inline void ApplyBinary(const TFunctor & functor, const TInput1 * input1, const TInput2 * input2,
+                        TOutput * output, SizeValueType count, mpl::FalseType)
+{
+  for ( SizeValueType i = 0; i < count; ++i )
+    {
+    output[i] = functor(input1[i], input2[i]);
+    }
+}
+
+template< typename TFunctor, typename TInput1, typename TInput2, typename TOutput >
+inline void ApplyBinary(const TFunctor & functor, const TInput1 * input1, const TInput2 * input2,
+                        TOutput * output, SizeValueType count)
+{
+  ApplyBinary(functor, input1, input2, output, count,
+              typename BinaryBatchFunctorTraits< TFunctor, TInput1, TInput2, TOutput >::Type());
+}
+
+/** Type of the result of a functor applied to a pixel, without reference
+ * and cv-qualifiers. */
+template< typename TFunctor, typename... TInputs >
+using ResultType = typename std::decay<
+  decltype( std::declval< const TFunctor & >()( std::declval< const TInputs & >()... ) ) >::type;
+} // end namespace Details
+/// \endcond
+
+/** \class UnaryComposition
+ * \brief Functor applying an outer functor to the result of an inner one.
+ *
+ * UnaryComposition< TInner, TOuter >()(A) is TOuter()( TInner()(A) ).
+ * Used as the functor of a UnaryFunctorImageFilter or
+ * UnaryGeneratorImageFilter, a chain of pixel-wise operations runs in a
+ * single pass over the image: no intermediate image is allocated, and every
+ * pixel is read and written once instead of once per operation.
+ *
+ * Longer chains are created with MakeUnaryComposition(), which nests the
+ * compositions:
+ * \code
+ * using CastType = itk::Functor::Cast< short, float >;
+ * using ScaleType = itk::Functor::IntensityLinearTransform< float, float >;
+ * using ThresholdType = itk::Functor::BinaryThreshold< float, unsigned char >;
+ *
+ * auto filter = itk::UnaryGeneratorImageFilter< ShortImageType, UCharImageType >::New();
+ * filter->SetFunctor( itk::Functor::MakeUnaryComposition( CastType(), scale, threshold ) );
+ * \endcode
+ *
+ * The batch method processes blocks of pixels stage by stage, calling the
+ * batch methods of the stages which provide one, see
+ * UnaryBatchFunctorTraits. The intermediate pixel type of a stage is the
+ * return type of its operator().
+ *
+ * \sa BinaryComposition TernaryComposition
+ * \ingroup ITKImageFilterBase
+ */
+template< typename TInner, typename TOuter >
+class UnaryComposition
+{
+public:
+  using InnerFunctorType = TInner;
+  using OuterFunctorType = TOuter;
+
+  UnaryComposition() = default;
+  UnaryComposition(const TInner & inner, const TOuter & outer):
+    m_Inner(inner),
+    m_Outer(outer)
+  {}
+
+  TInner & GetInner() { return m_Inner; }
+  const TInner & GetInner() const { return m_Inner; }
+  TOuter & GetOuter() { return m_Outer; }
+  const TOuter & GetOuter() const { return m_Outer; }
+
+  bool operator!=(const UnaryComposition & other) const
+  {
+    return m_Inner != other.m_Inner || m_Outer != other.m_Outer;
+  }
+
+  bool operator==(const UnaryComposition & other) const
+  {
+    return !( *this != other );
+  }
+
+  template< typename TInput >
+  inline Details::ResultType< TOuter, Details::ResultType< TInner, TInput > >
+  operator()(const TInput & A) const
+  {
+    return m_Outer( m_Inner( A ) );
+  }
+
+  /** Batch version of operator(), see Functor::UnaryBatchFunctorTraits. */
+  template< typename TInput, typename TOutput >
+  void ProcessBatch(const TInput * A, TOutput * output, SizeValueType count) const
+  {
+    using IntermediateType = Details::ResultType< TInner, TInput >;
+    IntermediateType block[Details::CompositionBlockSize];
+    for ( SizeValueType first = 0; first < count; first += Details::CompositionBlockSize )
+      {
+      const SizeValueType blockCount = std::min( Details::CompositionBlockSize, count - first );
+      Details::ApplyUnary( m_Inner, A + first, block, blockCount );
+      Details::ApplyUnary( m_Outer, static_cast< const IntermediateType * >( block ), output + first,
+                           blockCount );
+      }
+  }
+
+private:
+  TInner m_Inner;
+  TOuter m_Outer;
+};
+
+/** \class BinaryComposition
+ * \brief Functor applying a binary functor to the results of two unary
+ * functors.
+ *
+ * BinaryComposition< TBinary, TFirst, TSecond >()(A, B) is
+ * TBinary()( TFirst()(A), TSecond()(B) ). With a UnaryComposition as first
+ * argument functor, this fuses a chain of unary operations followed by a
+ * binary one, e.g. masking, in a single BinaryFunctorImageFilter or
+ * BinaryGeneratorImageFilter.
+ *
+ * \sa UnaryComposition
+ * \ingroup ITKImageFilterBase
+ */
+template< typename TBinary, typename TFirst = Identity, typename TSecond = Identity >
+class BinaryComposition
+{
+public:
+  using BinaryFunctorType = TBinary;
+  using FirstFunctorType = TFirst;
+  using SecondFunctorType = TSecond;
+
+  BinaryComposition() = default;
+  BinaryComposition(const TBinary & binary, const TFirst & first = TFirst(), const TSecond & second = TSecond()):
+    m_Binary(binary),
+    m_First(first),
+    m_Second(second)
+  {}
+
+  TBinary & GetBinary() { return m_Binary; }
+  const TBinary & GetBinary() const { return m_Binary; }
+  TFirst & GetFirst() { return m_First; }
+  const TFirst & GetFirst() const { return m_First; }
+  TSecond & GetSecond() { return m_Second; }
+  const TSecond & GetSecond() const { return m_Second; }
+
+  bool operator!=(const BinaryComposition & other) const
+  {
+    return m_Binary != other.m_Binary || m_First != other.m_First || m_Second != other.m_Second;
+  }
+
+  bool operator==(const BinaryComposition & other) const
+  {
+    return !( *this != other );
+  }
+
+  template< typename TInput1, typename TInput2 >
+  inline Details::ResultType< TBinary, Details::ResultType< TFirst, TInput1 >, Details::ResultType< TSecond, TInput2 > >
+  operator()(const TInput1 & A, const TInput2 & B) const
+  {
+    return m_Binary( m_First( A ), m_Second( B ) );
+  }
+
+  /** Batch version of operator(), see Functor::BinaryBatchFunctorTraits. */
+  template< typename TInput1, typename TInput2, typename TOutput >
+  void ProcessBatch(const TInput1 * A, const TInput2 * B, TOutput * output, SizeValueType count) const
+  {
+    using Intermediate1Type = Details::ResultType< TFirst, TInput1 >;
+    using Intermediate2Type = Details::ResultType< TSecond, TInput2 >;
+    Intermediate1Type block1[Details::CompositionBlockSize];
+    Intermediate2Type block2[Details::CompositionBlockSize];
+    for ( SizeValueType first = 0; first < count; first += Details::CompositionBlockSize )
+      {
+      const SizeValueType blockCount = std::min( Details::CompositionBlockSize, count - first );
+      Details::ApplyUnary( m_First, A + first, block1, blockCount );
+      Details::ApplyUnary( m_Second, B + first, block2, blockCount );
+      Details::ApplyBinary( m_Binary, static_cast< const Intermediate1Type * >( block1 ),
+                            static_cast< const Intermediate2Type * >( block2 ), output + first, blockCount );
+      }
+  }
+
+private:
+  TBinary m_Binary;
+  TFirst  m_First;
+  TSecond m_Second;
+};
+
+/** \class TernaryComposition
+ * \brief Functor applying a ternary functor to the results of three unary
+ * functors, for use with TernaryFunctorImageFilter.
+ *
+ * \sa BinaryComposition
+ * \ingroup ITKImageFilterBase
+ */
+template< typename TTernary, typename TFirst = Identity, typename TSecond = Identity, typename TThird = Identity >
+class TernaryComposition
+{
+public:
+  TernaryComposition() = default;
+  TernaryComposition(const TTernary & ternary, const TFirst & first = TFirst(), const TSecond & second = TSecond(),
+                     const TThird & third = TThird()):
+    m_Ternary(ternary),
+    m_First(first),
+    m_Second(second),
+    m_Third(third)
+  {}
+
+  TTernary & GetTernary() { return m_Ternary; }
+  const TTernary & GetTernary() const { return m_Ternary; }
+  TFirst & GetFirst() { return m_First; }
+  const TFirst & GetFirst() const { return m_First; }
+  TSecond & GetSecond() { return m_Second; }
+  const TSecond & GetSecond() const { return m_Second; }
+  TThird & GetThird() { return m_Third; }
+  const TThird & GetThird() const { return m_Third; }
+
+  bool operator!=(const TernaryComposition & other) const
+  {
+    return m_Ternary != other.m_Ternary || m_First != other.m_First || m_Second != other.m_Second
+           || m_Third != other.m_Third;
+  }
+
+  bool operator==(const TernaryComposition & other) const
+  {
+    return !( *this != other );
+  }
+
+  template< typename TInput1, typename TInput2, typename TInput3 >
+  inline Details::ResultType< TTernary, Details::ResultType< TFirst, TInput1 >,
+                              Details::ResultType< TSecond, TInput2 >, Details::ResultType< TThird, TInput3 > >
+  operator()(const TInput1 & A, const TInput2 & B, const TInput3 & C) const
+  {
+    return m_Ternary( m_First( A ), m_Second( B ), m_Third( C ) );
+  }
+
+private:
+  TTernary m_Ternary;
+  TFirst   m_First;
+  TSecond  m_Second;
+  TThird   m_Third;
+};
+
+/** \class UnaryCompositionType
+ * \brief Type of the composition of a chain of unary functors, as returned
+ * by MakeUnaryComposition().
+ *
+ * UnaryCompositionType< F1, F2, F3 >::Type applies F1 first and F3 last.
+ *
+ * \ingroup ITKImageFilterBase
+ */
+template< typename... TFunctors >
+struct UnaryCompositionType;
+
+/// \cond SPECIALIZATION_IMPLEMENTATION
+template< typename TFunctor >
+struct UnaryCompositionType< TFunctor >
+{
+  using Type = TFunctor;
+};
+
+template< typename TFirst, typename TSecond, typename... TOthers >
+struct UnaryCompositionType< TFirst, TSecond, TOthers... >
+{
+  using Type = typename UnaryCompositionType< UnaryComposition< TFirst, TSecond >, TOthers... >::Type;
+};
+/// \endcond
+
+/** Composes a chain of unary functors, the first one being applied first. */
+template< typename TFunctor >
+TFunctor MakeUnaryComposition(const TFunctor & functor)
+{
+  return functor;
+}
+
+template< typename TFirst, typename TSecond, typename... TOthers >
+typename UnaryCompositionType< TFirst, TSecond, TOthers... >::Type
+MakeUnaryComposition(const TFirst & first, const TSecond & second, const TOthers & ... others)
+{
+  return MakeUnaryComposition( UnaryComposition< TFirst, TSecond >( first, second ), others... );
+}
+
+} // end namespace Functor
+} // end namespace itk
+
+#endif
@@ -21,6 +21,7 @@
 #include "itkMath.h"
 #include "itkInPlaceImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkBatchFunctorTraits.h"
 
 #include <functional>
 
@@ -45,7 +46,12 @@ namespace itk
  * UnaryGeneratorImageFilter can be used to promote a 2D image to a 3D
  * image, etc.
  *
+ * If a functor object provides a ProcessBatch() method and both images
+ * store their pixels contiguously, the output is computed one scanline at a
+ * time by ProcessBatch() instead of one pixel at a time by operator().
+ *
  * \sa UnaryFunctorImageFilter
+ * \sa Functor::UnaryBatchFunctorTraits
  * \sa BinaryGeneratorImageFilter TernaryGeneratormageFilter
  *
  * \ingroup ITKImageFilterBase MultiThreaded
@@ -171,6 +177,20 @@ protected:
   void DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
 
 private:
+  /** Whether whole scanlines are passed to the batch method of the functor,
+   * see Functor::UnaryBatchFunctorTraits. */
+  template <typename TFunctor>
+  using UseBatchFunctorType = typename mpl::And<
+    typename Functor::UnaryBatchFunctorTraits< TFunctor, InputImagePixelType, OutputImagePixelType >::Type,
+    mpl::And< ImageHasContiguousPixels< TInputImage >, ImageHasContiguousPixels< TOutputImage > > >::Type;
+
+  template <typename TFunctor>
+  void ProcessScanlines(const TFunctor &, const InputImageRegionType & inputRegionForThread,
+                        const OutputImageRegionType & outputRegionForThread, mpl::FalseType);
+  template <typename TFunctor>
+  void ProcessScanlines(const TFunctor &, const InputImageRegionType & inputRegionForThread,
+                        const OutputImageRegionType & outputRegionForThread, mpl::TrueType);
+
   std::function<void(const OutputImageRegionType &)> m_DynamicThreadedGenerateDataFunction;
 };
 } // end namespace itk
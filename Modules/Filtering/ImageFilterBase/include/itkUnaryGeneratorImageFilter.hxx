@@ -102,8 +102,6 @@ UnaryGeneratorImageFilter< TInputImage, TOutputImage >
     {
     return;
     }
-  const TInputImage *inputPtr = this->GetInput();
-  TOutputImage *outputPtr = this->GetOutput(0);
 
   // Define the portion of the input to walk for this thread, using
   // the CallCopyOutputRegionToInputRegion method allows for the input
@@ -112,6 +110,23 @@ UnaryGeneratorImageFilter< TInputImage, TOutputImage >
 
   this->CallCopyOutputRegionToInputRegion(inputRegionForThread, outputRegionForThread);
 
+  this->ProcessScanlines(functor, inputRegionForThread, outputRegionForThread,
+                         UseBatchFunctorType< TFunctor >());
+}
+
+template< typename TInputImage, typename TOutputImage >
+template< typename TFunctor >
+void
+UnaryGeneratorImageFilter< TInputImage, TOutputImage >
+::ProcessScanlines(
+    const TFunctor &functor,
+    const InputImageRegionType & inputRegionForThread,
+    const OutputImageRegionType & outputRegionForThread,
+    mpl::FalseType)
+{
+  const TInputImage *inputPtr = this->GetInput();
+  TOutputImage *outputPtr = this->GetOutput(0);
+
   // Define the iterators
   ImageScanlineConstIterator< TInputImage > inputIt(inputPtr, inputRegionForThread);
   ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
@@ -130,6 +145,35 @@ UnaryGeneratorImageFilter< TInputImage, TOutputImage >
     outputIt.NextLine();
     }
 }
+
+template< typename TInputImage, typename TOutputImage >
+template< typename TFunctor >
+void
+UnaryGeneratorImageFilter< TInputImage, TOutputImage >
+::ProcessScanlines(
+    const TFunctor &functor,
+    const InputImageRegionType & inputRegionForThread,
+    const OutputImageRegionType & outputRegionForThread,
+    mpl::TrueType)
+{
+  const TInputImage *inputPtr = this->GetInput();
+  TOutputImage *outputPtr = this->GetOutput(0);
+  const SizeValueType lineLength = inputRegionForThread.GetSize(0);
+
+  ImageScanlineConstIterator< TInputImage > inputIt(inputPtr, inputRegionForThread);
+  ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+
+  inputIt.GoToBegin();
+  outputIt.GoToBegin();
+  while ( !inputIt.IsAtEnd() )
+    {
+    functor.ProcessBatch( inputPtr->GetBufferPointer() + inputPtr->ComputeOffset( inputIt.GetIndex() ),
+                          outputPtr->GetBufferPointer() + outputPtr->ComputeOffset( outputIt.GetIndex() ),
+                          lineLength );
+    inputIt.NextLine();
+    outputIt.NextLine();
+    }
+}
 } // end namespace itk
 
 #endif
@@ -0,0 +1,104 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDisplacementWarpEngine_h
+#define itkDisplacementWarpEngine_h
+
+#include "itkImageBase.h"
+#include "itkContinuousIndex.h"
+#include "itkImageScanlineIterator.h"
+#include <vector>
+
+namespace itk
+{
+/** \class DisplacementWarpEngine
+ * \brief Map the pixels of a region through a displacement field, tile by
+ * tile.
+ *
+ * The engine computes the continuous indices, in the grid of an input
+ * image, of the physical points of the pixels of an output grid displaced
+ * by a displacement field, \f$ p_{in} = p_{out} + d \f$. The displacement
+ * field must have the grid of the output.
+ *
+ * The region is traversed in tiles of TileSize pixels, and each scan line
+ * of a tile is passed at once to a function, which typically interpolates
+ * the input image at the continuous indices with a batched call to the
+ * interpolator. Smooth displacements map a tile to a compact block of the
+ * input, which stays in the cache while the tile is processed, whereas a
+ * traversal of whole scan lines of a large volume reads scattered input
+ * blocks. The continuous indices are computed incrementally along each
+ * scan line, with a single matrix product for the displacement.
+ *
+ * WarpImageFilter and ComposeDisplacementFieldsImageFilter use the engine
+ * when the displacement field and the output have the same grid.
+ *
+ * \ingroup ITKImageGrid
+ */
+template< unsigned int VDimension, typename TCoordRep = double >
+class ITK_TEMPLATE_EXPORT DisplacementWarpEngine
+{
+public:
+  /** Standard class type aliases. */
+  using Self = DisplacementWarpEngine;
+
+  static constexpr unsigned int ImageDimension = VDimension;
+
+  using ImageBaseType = ImageBase< VDimension >;
+  using IndexType = typename ImageBaseType::IndexType;
+  using SizeType = typename ImageBaseType::SizeType;
+  using RegionType = typename ImageBaseType::RegionType;
+  using ContinuousIndexType = ContinuousIndex< TCoordRep, VDimension >;
+
+  DisplacementWarpEngine();
+
+  /** Set the grid of the pixels mapped and the grid of the continuous
+   * indices. Only their origin, spacing and direction are used. */
+  void SetGrids(const ImageBaseType *outputGrid, const ImageBaseType *inputGrid);
+
+  /** Set/Get the size of the tiles. Default is 64 pixels along the first
+   * dimension and 8 pixels along the other dimensions. */
+  void SetTileSize(const SizeType & tileSize) { m_TileSize = tileSize; }
+  const SizeType & GetTileSize() const { return m_TileSize; }
+
+  /** Traverse the region tile by tile and call, for each scan line of each
+   * tile, \c function( lineIndex, lineLength, indices ), where lineIndex is
+   * the index of the first pixel of the scan line and indices holds the
+   * lineLength continuous indices of its displaced pixels. The region must
+   * be inside the buffered region of the field. */
+  template< typename TDisplacementField, typename TFunction >
+  void Warp(const RegionType & region, const TDisplacementField *field, TFunction && function) const;
+
+private:
+  using MatrixType = typename ImageBaseType::DirectionType;
+  using VectorType = Vector< double, VDimension >;
+
+  SizeType   m_TileSize;
+
+  // Output index to input continuous index: m_IndexMatrix * index + m_Offset
+  MatrixType m_IndexMatrix;
+  VectorType m_Offset;
+
+  // Physical displacement to continuous index displacement
+  MatrixType m_DisplacementMatrix;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDisplacementWarpEngine.hxx"
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDisplacementWarpEngine_hxx
+#define itkDisplacementWarpEngine_hxx
+
+#include "itkDisplacementWarpEngine.h"
+#include <algorithm>
+
+namespace itk
+{
+template< unsigned int VDimension, typename TCoordRep >
+DisplacementWarpEngine< VDimension, TCoordRep >
+::DisplacementWarpEngine()
+{
+  m_TileSize.Fill(8);
+  m_TileSize[0] = 64;
+  m_IndexMatrix.SetIdentity();
+  m_Offset.Fill(0.0);
+  m_DisplacementMatrix.SetIdentity();
+}
+
+template< unsigned int VDimension, typename TCoordRep >
+void
+DisplacementWarpEngine< VDimension, TCoordRep >
+::SetGrids(const ImageBaseType *outputGrid, const ImageBaseType *inputGrid)
+{
+  // Physical point to input continuous index
+  MatrixType physicalPointToIndex;
+  for ( unsigned int i = 0; i < VDimension; ++i )
+    {
+    for ( unsigned int j = 0; j < VDimension; ++j )
+      {
+      physicalPointToIndex[i][j] = inputGrid->GetInverseDirection()[i][j] / inputGrid->GetSpacing()[i];
+      }
+    }
+
+  // Output index to physical point
+  MatrixType indexToPhysicalPoint;
+  for ( unsigned int i = 0; i < VDimension; ++i )
+    {
+    for ( unsigned int j = 0; j < VDimension; ++j )
+      {
+      indexToPhysicalPoint[i][j] = outputGrid->GetDirection()[i][j] * outputGrid->GetSpacing()[j];
+      }
+    }
+
+  m_DisplacementMatrix = physicalPointToIndex;
+  m_IndexMatrix = physicalPointToIndex * indexToPhysicalPoint;
+  m_Offset = physicalPointToIndex * ( outputGrid->GetOrigin() - inputGrid->GetOrigin() );
+}
+
+template< unsigned int VDimension, typename TCoordRep >
+template< typename TDisplacementField, typename TFunction >
+void
+DisplacementWarpEngine< VDimension, TCoordRep >
+::Warp(const RegionType & region, const TDisplacementField *field, TFunction && function) const
+{
+  for ( unsigned int d = 0; d < VDimension; ++d )
+    {
+    if ( region.GetSize(d) == 0 || m_TileSize[d] == 0 )
+      {
+      return;
+      }
+    }
+
+  std::vector< ContinuousIndexType > indices( std::min(m_TileSize[0], region.GetSize(0)) );
+  const IndexType regionIndex = region.GetIndex();
+  const IndexType regionEnd = region.GetUpperIndex();
+
+  IndexType tileIndex = regionIndex;
+  for (;; )
+    {
+    RegionType tile;
+    tile.SetIndex(tileIndex);
+    for ( unsigned int d = 0; d < VDimension; ++d )
+      {
+      tile.SetSize(d, std::min(static_cast< IndexValueType >( m_TileSize[d] ), regionEnd[d] - tileIndex[d] + 1));
+      }
+
+    ImageScanlineConstIterator< TDisplacementField > fieldIt(field, tile);
+    while ( !fieldIt.IsAtEnd() )
+      {
+      const IndexType lineIndex = fieldIt.GetIndex();
+      VectorType      lineStart = m_Offset;
+      for ( unsigned int i = 0; i < VDimension; ++i )
+        {
+        for ( unsigned int j = 0; j < VDimension; ++j )
+          {
+          lineStart[i] += m_IndexMatrix[i][j] * lineIndex[j];
+          }
+        }
+
+      SizeValueType lineLength = 0;
+      while ( !fieldIt.IsAtEndOfLine() )
+        {
+        const typename TDisplacementField::PixelType displacement = fieldIt.Get();
+        ContinuousIndexType &                        index = indices[lineLength];
+        for ( unsigned int i = 0; i < VDimension; ++i )
+          {
+          double value = lineStart[i] + m_IndexMatrix[i][0] * lineLength;
+          for ( unsigned int j = 0; j < VDimension; ++j )
+            {
+            value += m_DisplacementMatrix[i][j] * displacement[j];
+            }
+          index[i] = static_cast< TCoordRep >( value );
+          }
+        ++lineLength;
+        ++fieldIt;
+        }
+      function(lineIndex, lineLength, indices.data());
+      fieldIt.NextLine();
+      }
+
+    // Next tile
+    unsigned int d = 0;
+    for (; d < VDimension; ++d )
+      {
+      tileIndex[d] += static_cast< IndexValueType >( m_TileSize[d] );
+      if ( tileIndex[d] <= regionEnd[d] )
+        {
+        break;
+        }
+      tileIndex[d] = regionIndex[d];
+      }
+    if ( d == VDimension )
+      {
+      break;
+      }
+    }
+}
+} // end namespace itk
+
+#endif
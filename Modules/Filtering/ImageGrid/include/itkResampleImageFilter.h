@@ -325,6 +325,20 @@ protected:
    *  transformation types. */
   virtual void LinearThreadedGenerateData(const OutputImageRegionType & outputRegionForThread);
 
+  /** Compute the positions [spanBegin, spanEnd) of a scan line of
+   * lineLength pixels, starting lineOffset pixels after the start of the
+   * largest possible region, which map inside the buffer of the
+   * interpolator. The scan line of the largest possible region maps from
+   * startIndex to endIndex. The span assumes that the interpolator is
+   * inside the buffer between its start and end continuous indices, and
+   * may be off by one position at its ends because of rounding. */
+  void ComputeScanlineSpanInsideBuffer(const ContinuousInputIndexType & startIndex,
+                                       const ContinuousInputIndexType & endIndex,
+                                       IndexValueType lineOffset,
+                                       SizeValueType lineLength,
+                                       SizeValueType & spanBegin,
+                                       SizeValueType & spanEnd) const;
+
   /** Cast pixel from interpolator output to PixelType. */
   virtual PixelType CastPixelWithBoundsChecking( const InterpolatorOutputType value,
                                                  const ComponentType minComponent,
@@ -26,6 +26,7 @@
 #include "itkImageScanlineIterator.h"
 #include "itkSpecialCoordinatesImage.h"
 #include "itkDefaultConvertPixelTraits.h"
+#include <vector>
 
 namespace itk
 {
@@ -366,6 +367,12 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
   // how the whole image is split for processing ( threading,
   // streaming, etc ).
   //
+  // The continuous indices of each scan line are computed first, and
+  // interpolated at once by the interpolator.
+  using InterpolatorContinuousIndexType = typename InterpolatorType::ContinuousIndexType;
+  const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+  std::vector< InterpolatorContinuousIndexType > inputIndices( lineLength );
+  std::vector< OutputType >                      values( lineLength );
 
   while ( !outIt.IsAtEnd() )
     {
@@ -388,27 +395,74 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
 
     IndexValueType scanlineIndex = outIt.GetIndex()[0];
 
-
-    while ( !outIt.IsAtEndOfLine() )
+    for ( SizeValueType i = 0; i < lineLength; ++i, ++scanlineIndex )
       {
-
       // Perform linear interpolation between startIndex and endIndex
       const double alpha = (scanlineIndex - largestPossibleRegion.GetIndex(0)) / (double)(largestPossibleRegion.GetSize(0));
 
       ContinuousInputIndexType inputIndex( startIndex );
-      for (unsigned int i = 0; i < ImageDimension; ++i)
+      for (unsigned int j = 0; j < ImageDimension; ++j)
         {
-        inputIndex[i] += alpha * ( endIndex[i] - startIndex[i] );
+        inputIndex[j] += alpha * ( endIndex[j] - startIndex[j] );
         }
+      inputIndices[i] = inputIndex;
+      }
 
-      PixelType  pixval;
-      OutputType value;
-      // Evaluate input at right position and copy to the output
-      if ( m_Interpolator->IsInsideBuffer(inputIndex) )
+    // Span of the scan line inside the buffer, computed analytically from
+    // the linear path, then adjusted at its ends where rounding differs.
+    // The positions of the span are interpolated at once, without bounds
+    // checking.
+    SizeValueType spanBegin = 0;
+    SizeValueType spanEnd = 0;
+    this->ComputeScanlineSpanInsideBuffer(startIndex, endIndex, outIt.GetIndex()[0] - largestPossibleRegion.GetIndex(0),
+                                          lineLength, spanBegin, spanEnd);
+    if ( spanBegin < spanEnd )
+      {
+      while ( spanBegin < spanEnd && !m_Interpolator->IsInsideBuffer(inputIndices[spanBegin]) )
         {
-        value = m_Interpolator->EvaluateAtContinuousIndex(inputIndex);
-        pixval = this->CastPixelWithBoundsChecking( value, minOutputValue, maxOutputValue );
-        outIt.Set(pixval);
+        ++spanBegin;
+        }
+      while ( spanBegin > 0 && spanBegin < spanEnd && m_Interpolator->IsInsideBuffer(inputIndices[spanBegin - 1]) )
+        {
+        --spanBegin;
+        }
+      while ( spanEnd > spanBegin && !m_Interpolator->IsInsideBuffer(inputIndices[spanEnd - 1]) )
+        {
+        --spanEnd;
+        }
+      while ( spanEnd > spanBegin && spanEnd < lineLength && m_Interpolator->IsInsideBuffer(inputIndices[spanEnd]) )
+        {
+        ++spanEnd;
+        }
+      }
+
+    SizeValueType i = 0;
+    while ( i < lineLength )
+      {
+      // Evaluate input at right position and copy to the output. Outside
+      // of the span, the bounds are checked for each position, and the runs
+      // of positions inside the buffer are interpolated at once.
+      SizeValueType runEnd = i;
+      if ( i == spanBegin && spanBegin < spanEnd )
+        {
+        runEnd = spanEnd;
+        }
+      else
+        {
+        const SizeValueType checkedEnd = i < spanBegin ? spanBegin : lineLength;
+        while ( runEnd < checkedEnd && m_Interpolator->IsInsideBuffer(inputIndices[runEnd]) )
+          {
+          ++runEnd;
+          }
+        }
+      if ( runEnd > i )
+        {
+        m_Interpolator->EvaluateAtContinuousIndices(&inputIndices[i], &values[i], runEnd - i);
+        for (; i < runEnd; ++i )
+          {
+          outIt.Set( this->CastPixelWithBoundsChecking( values[i], minOutputValue, maxOutputValue ) );
+          ++outIt;
+          }
         }
       else
         {
@@ -418,19 +472,76 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
           }
         else
           {
-          value = m_Extrapolator->EvaluateAtContinuousIndex( inputIndex );
-          pixval = this->CastPixelWithBoundsChecking( value, minOutputValue, maxOutputValue );
-          outIt.Set(pixval);
+          const OutputType value = m_Extrapolator->EvaluateAtContinuousIndex( inputIndices[i] );
+          outIt.Set( this->CastPixelWithBoundsChecking( value, minOutputValue, maxOutputValue ) );
           }
+        ++outIt;
+        ++i;
         }
-
-      ++outIt;
-      ++scanlineIndex;
       }
     outIt.NextLine();
     }
 }
 
+template< typename TInputImage,
+          typename TOutputImage,
+          typename TInterpolatorPrecisionType,
+          typename TTransformPrecisionType >
+void
+ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::ComputeScanlineSpanInsideBuffer(const ContinuousInputIndexType & startIndex,
+                                  const ContinuousInputIndexType & endIndex,
+                                  IndexValueType lineOffset,
+                                  SizeValueType lineLength,
+                                  SizeValueType & spanBegin,
+                                  SizeValueType & spanEnd) const
+{
+  // The position i of the line is a + b * i along each dimension, and is
+  // inside the buffer when bufferStart <= a + b * i < bufferEnd.
+  const typename InterpolatorType::ContinuousIndexType & bufferStart = m_Interpolator->GetStartContinuousIndex();
+  const typename InterpolatorType::ContinuousIndexType & bufferEnd = m_Interpolator->GetEndContinuousIndex();
+  const double lineSize = static_cast< double >( this->GetOutput()->GetLargestPossibleRegion().GetSize(0) );
+
+  double first = 0.0;
+  double last = static_cast< double >( lineLength );
+  for ( unsigned int j = 0; j < ImageDimension && first < last; ++j )
+    {
+    const double b = ( endIndex[j] - startIndex[j] ) / lineSize;
+    const double a = startIndex[j] + lineOffset * b;
+    if ( !std::isfinite(a) || !std::isfinite(b) )
+      {
+      last = first;
+      }
+    else if ( b == 0.0 )
+      {
+      if ( !( a >= bufferStart[j] && a < bufferEnd[j] ) )
+        {
+        last = first;
+        }
+      }
+    else if ( b > 0.0 )
+      {
+      first = std::max(first, std::ceil( ( bufferStart[j] - a ) / b ));
+      last = std::min(last, std::ceil( ( bufferEnd[j] - a ) / b ));
+      }
+    else
+      {
+      first = std::max(first, std::floor( ( bufferEnd[j] - a ) / b ) + 1.0);
+      last = std::min(last, std::floor( ( bufferStart[j] - a ) / b ) + 1.0);
+      }
+    }
+  if ( first < last )
+    {
+    spanBegin = static_cast< SizeValueType >( first );
+    spanEnd = static_cast< SizeValueType >( last );
+    }
+  else
+    {
+    spanBegin = 0;
+    spanEnd = 0;
+    }
+}
+
 template< typename TInputImage,
           typename TOutputImage,
           typename TInterpolatorPrecisionType,
@@ -20,6 +20,7 @@
 #include "itkImageBase.h"
 #include "itkImageToImageFilter.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkDisplacementWarpEngine.h"
 
 namespace itk
 {
@@ -68,7 +69,10 @@ namespace itk
  * The input image is set via SetInput. The input displacement field
  * is set via SetDisplacementField.
  *
- * This filter is implemented as a multithreaded filter.
+ * This filter is implemented as a multithreaded filter. When the
+ * displacement field has the grid of the output, the output is traversed
+ * in tiles by a DisplacementWarpEngine, and the scan lines of the tiles
+ * are interpolated with batched calls to the interpolator.
  *
  * \warning This filter assumes that the input type, output type
  * and displacement field type all have the same number of dimensions.
@@ -281,6 +285,9 @@ private:
   SizeType            m_OutputSize;               // Size of the output image
   IndexType           m_OutputStartIndex;         // output image start index
 
+  // Maps the output pixels through a field with the grid of the output
+  DisplacementWarpEngine< Self::ImageDimension, CoordRepType > m_WarpEngine;
+
 };
 } // end namespace itk
 
@@ -27,6 +27,7 @@
 #include "itkProgressReporter.h"
 #include "itkContinuousIndex.h"
 #include "itkMath.h"
+#include <vector>
 namespace itk
 {
 template< typename TInputImage, typename TOutputImage, typename TDisplacementField >
@@ -162,6 +163,11 @@ WarpImageFilter< TInputImage, TOutputImage, TDisplacementField >
   // Connect input image to interpolator
   m_Interpolator->SetInputImage( this->GetInput() );
 
+  if ( m_DefFieldSameInformation )
+    {
+    m_WarpEngine.SetGrids( this->GetOutput(), this->GetInput() );
+    }
+
   if ( !m_DefFieldSameInformation )
     {
     m_StartIndex = fieldPtr->GetBufferedRegion().GetIndex();
@@ -296,50 +302,63 @@ WarpImageFilter< TInputImage, TOutputImage, TDisplacementField >
   OutputImageType             *outputPtr = this->GetOutput();
   const DisplacementFieldType *fieldPtr = this->GetDisplacementField();
 
-  // iterator for the output image
-  ImageRegionIteratorWithIndex< OutputImageType > outputIt(
-    outputPtr, outputRegionForThread);
-  IndexType        index;
-  PointType        point;
-  DisplacementType displacement;
-  NumericTraits<DisplacementType>::SetLength(displacement,ImageDimension);
   if ( this->m_DefFieldSameInformation )
     {
-    // iterator for the deformation field
-    ImageRegionConstIterator< DisplacementFieldType >
-    fieldIt(fieldPtr, outputRegionForThread);
-
-    while ( !outputIt.IsAtEnd() )
+    // The output is traversed in tiles, and each scan line of a tile is
+    // interpolated at once, by runs of positions inside the buffer.
+    using ContinuousIndexType = typename InterpolatorType::ContinuousIndexType;
+    using OutputType = typename InterpolatorType::OutputType;
+    std::vector< OutputType > values( outputRegionForThread.GetSize(0) );
+
+    auto warpLine = [this, outputPtr, &values](const IndexType & lineIndex, SizeValueType lineLength,
+                                                const ContinuousIndexType * indices)
       {
-      // get the output image index
-      index = outputIt.GetIndex();
-      outputPtr->TransformIndexToPhysicalPoint(index, point);
-
-      // get the required displacement
-      displacement = fieldIt.Get();
-
-      // compute the required input image point
-      for ( unsigned int j = 0; j < ImageDimension; j++ )
+      OutputImageRegionType lineRegion;
+      lineRegion.SetIndex(lineIndex);
+      lineRegion.SetSize(0, lineLength);
+      for ( unsigned int j = 1; j < ImageDimension; j++ )
         {
-        point[j] += displacement[j];
+        lineRegion.SetSize(j, 1);
         }
+      ImageScanlineIterator< OutputImageType > lineIt(outputPtr, lineRegion);
 
-      // get the interpolated value
-      if ( m_Interpolator->IsInsideBuffer(point) )
-        {
-        auto value = static_cast< PixelType >( m_Interpolator->Evaluate(point) );
-        outputIt.Set(value);
-        }
-      else
+      SizeValueType i = 0;
+      while ( i < lineLength )
         {
-        outputIt.Set(m_EdgePaddingValue);
+        SizeValueType runEnd = i;
+        while ( runEnd < lineLength && m_Interpolator->IsInsideBuffer(indices[runEnd]) )
+          {
+          ++runEnd;
+          }
+        if ( runEnd > i )
+          {
+          m_Interpolator->EvaluateAtContinuousIndices(indices + i, values.data() + i, runEnd - i);
+          for (; i < runEnd; ++i )
+            {
+            lineIt.Set( static_cast< PixelType >( values[i] ) );
+            ++lineIt;
+            }
+          }
+        else
+          {
+          lineIt.Set(m_EdgePaddingValue);
+          ++lineIt;
+          ++i;
+          }
         }
-      ++outputIt;
-      ++fieldIt;
-      }
+      };
+    m_WarpEngine.Warp(outputRegionForThread, fieldPtr, warpLine);
     }
   else
     {
+    // iterator for the output image
+    ImageRegionIteratorWithIndex< OutputImageType > outputIt(
+      outputPtr, outputRegionForThread);
+    IndexType        index;
+    PointType        point;
+    DisplacementType displacement;
+    NumericTraits<DisplacementType>::SetLength(displacement,ImageDimension);
+
     while ( !outputIt.IsAtEnd() )
       {
       // get the output image index
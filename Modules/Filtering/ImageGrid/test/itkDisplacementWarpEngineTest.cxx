@@ -0,0 +1,182 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkDisplacementWarpEngine.h"
+#include "itkWarpImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+// Check that the engine visits each pixel of a region once, with the
+// continuous indices of the displaced points, and that WarpImageFilter
+// gives the per-pixel interpolation of the displaced points.
+
+namespace
+{
+
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image< float, Dimension >;
+using FieldType = itk::Image< itk::Vector< float, Dimension >, Dimension >;
+using EngineType = itk::DisplacementWarpEngine< Dimension >;
+
+void
+SetGrid( itk::ImageBase< Dimension > * image, double angle, double spacing, double origin )
+{
+  itk::ImageBase< Dimension >::DirectionType direction;
+  direction.SetIdentity();
+  direction[0][0] = std::cos( angle );
+  direction[0][1] = -std::sin( angle );
+  direction[1][0] = std::sin( angle );
+  direction[1][1] = std::cos( angle );
+  image->SetDirection( direction );
+  itk::ImageBase< Dimension >::SpacingType spacings;
+  spacings.Fill( spacing );
+  spacings[2] = 1.5 * spacing;
+  image->SetSpacing( spacings );
+  itk::ImageBase< Dimension >::PointType origin3;
+  origin3.Fill( origin );
+  image->SetOrigin( origin3 );
+}
+
+}
+
+int itkDisplacementWarpEngineTest( int, char * [] )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType imageSize = { { 40, 35, 20 } };
+  image->SetRegions( imageSize );
+  SetGrid( image, 0.3, 1.2, -4.0 );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > imageIt( image, image->GetBufferedRegion() );
+  for ( ; !imageIt.IsAtEnd(); ++imageIt )
+    {
+    const ImageType::IndexType index = imageIt.GetIndex();
+    imageIt.Set( static_cast< float >( std::sin( 0.2 * index[0] ) * 10.0 + index[1] - 0.5 * index[2] ) );
+    }
+
+  FieldType::Pointer field = FieldType::New();
+  FieldType::IndexType fieldIndex = { { 3, -2, 1 } };
+  FieldType::SizeType fieldSize = { { 150, 37, 19 } };
+  field->SetRegions( FieldType::RegionType( fieldIndex, fieldSize ) );
+  SetGrid( field, -0.1, 0.5, 2.0 );
+  field->Allocate();
+  itk::ImageRegionIteratorWithIndex< FieldType > fieldIt( field, field->GetBufferedRegion() );
+  for ( ; !fieldIt.IsAtEnd(); ++fieldIt )
+    {
+    const FieldType::IndexType index = fieldIt.GetIndex();
+    FieldType::PixelType displacement;
+    displacement[0] = static_cast< float >( 3.0 * std::sin( 0.05 * index[1] ) );
+    displacement[1] = static_cast< float >( 2.0 * std::cos( 0.07 * index[0] ) );
+    displacement[2] = static_cast< float >( 0.1 * index[2] - 1.0 );
+    fieldIt.Set( displacement );
+    }
+
+  // Each pixel is visited once, with the continuous index of its displaced
+  // point.
+  EngineType engine;
+  TEST_SET_GET_VALUE( 64, engine.GetTileSize()[0] );
+  FieldType::SizeType tileSize = { { 16, 5, 3 } };
+  engine.SetTileSize( tileSize );
+  engine.SetGrids( field, image );
+
+  using CountImageType = itk::Image< unsigned int, Dimension >;
+  CountImageType::Pointer counts = CountImageType::New();
+  counts->SetRegions( field->GetBufferedRegion() );
+  counts->Allocate( true );
+
+  FieldType::RegionType region = field->GetBufferedRegion();
+  region.ShrinkByRadius( 1 );
+  bool success = true;
+  engine.Warp( region, field.GetPointer(),
+               [&]( const FieldType::IndexType & lineIndex, itk::SizeValueType lineLength,
+                    const EngineType::ContinuousIndexType * indices )
+                 {
+                 FieldType::IndexType index = lineIndex;
+                 for ( itk::SizeValueType i = 0; i < lineLength; ++i, ++index[0] )
+                   {
+                   counts->SetPixel( index, counts->GetPixel( index ) + 1 );
+                   FieldType::PointType point;
+                   field->TransformIndexToPhysicalPoint( index, point );
+                   point += field->GetPixel( index );
+                   EngineType::ContinuousIndexType expected;
+                   image->TransformPhysicalPointToContinuousIndex( point, expected );
+                   if ( expected.EuclideanDistanceTo( indices[i] ) > 1e-9 )
+                     {
+                     std::cerr << "Continuous index " << indices[i] << " instead of " << expected << " at " << index
+                               << std::endl;
+                     success = false;
+                     }
+                   }
+                 } );
+  itk::ImageRegionConstIteratorWithIndex< CountImageType > countIt( counts, counts->GetBufferedRegion() );
+  for ( ; !countIt.IsAtEnd(); ++countIt )
+    {
+    if ( countIt.Get() != ( region.IsInside( countIt.GetIndex() ) ? 1u : 0u ) )
+      {
+      std::cerr << "Pixel " << countIt.GetIndex() << " visited " << countIt.Get() << " times" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The warped image is the interpolated image at the displaced points, or
+  // the edge padding value outside of the image.
+  using WarpFilterType = itk::WarpImageFilter< ImageType, ImageType, FieldType >;
+  WarpFilterType::Pointer warp = WarpFilterType::New();
+  warp->SetInput( image );
+  warp->SetDisplacementField( field );
+  warp->SetOutputParametersFromImage( field );
+  warp->SetEdgePaddingValue( -100.0f );
+  warp->Update();
+
+  WarpFilterType::InterpolatorType * interpolator = warp->GetModifiableInterpolator();
+  interpolator->SetInputImage( image );
+  ImageType * output = warp->GetOutput();
+  itk::ImageRegionConstIteratorWithIndex< ImageType > outputIt( output, output->GetBufferedRegion() );
+  unsigned int numberOfInsidePixels = 0;
+  for ( ; !outputIt.IsAtEnd(); ++outputIt )
+    {
+    FieldType::PointType point;
+    output->TransformIndexToPhysicalPoint( outputIt.GetIndex(), point );
+    point += field->GetPixel( outputIt.GetIndex() );
+    float expected = -100.0f;
+    if ( interpolator->IsInsideBuffer( point ) )
+      {
+      expected = static_cast< float >( interpolator->Evaluate( point ) );
+      ++numberOfInsidePixels;
+      }
+    if ( std::abs( expected - outputIt.Get() ) > 1e-4f )
+      {
+      std::cerr << "Warped pixel " << outputIt.Get() << " instead of " << expected << " at " << outputIt.GetIndex()
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  std::cout << numberOfInsidePixels << " of " << output->GetBufferedRegion().GetNumberOfPixels()
+            << " pixels warped inside the image" << std::endl;
+  if ( numberOfInsidePixels == 0 || numberOfInsidePixels == output->GetBufferedRegion().GetNumberOfPixels() )
+    {
+    std::cerr << "The test should warp pixels inside and outside of the image" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
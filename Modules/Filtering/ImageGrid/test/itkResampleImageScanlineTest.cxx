@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkResampleImageFilter.h"
+#include "itkAffineTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkWindowedSincInterpolateImageFunction.h"
+#include "itkNearestNeighborExtrapolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+// Resample with affine transforms mapping the scan lines partly outside of
+// the input image, and check that the interpolated scan lines are equal to
+// the per-pixel evaluation of the interpolator or of the extrapolator.
+
+namespace
+{
+
+using ImageType = itk::Image< float, 3 >;
+using TransformType = itk::AffineTransform< double, 3 >;
+using ResampleFilterType = itk::ResampleImageFilter< ImageType, ImageType >;
+using InterpolatorType = ResampleFilterType::InterpolatorType;
+
+bool
+TestInterpolator( const char * name, InterpolatorType * interpolator, ImageType * image,
+                  TransformType * transform, bool extrapolate )
+{
+  const float defaultValue = -7.0f;
+
+  ResampleFilterType::Pointer resample = ResampleFilterType::New();
+  resample->SetInput( image );
+  resample->SetTransform( transform );
+  resample->SetInterpolator( interpolator );
+  resample->SetSize( image->GetLargestPossibleRegion().GetSize() );
+  resample->SetDefaultPixelValue( defaultValue );
+  using ExtrapolatorType = itk::NearestNeighborExtrapolateImageFunction< ImageType, double >;
+  ExtrapolatorType::Pointer extrapolator = ExtrapolatorType::New();
+  if ( extrapolate )
+    {
+    resample->SetExtrapolator( extrapolator );
+    }
+  resample->Update();
+
+  // The filter disconnects the image functions from the input.
+  interpolator->SetInputImage( image );
+  extrapolator->SetInputImage( image );
+
+  ImageType * output = resample->GetOutput();
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( output, output->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    output->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    itk::ContinuousIndex< double, 3 > index;
+    image->TransformPhysicalPointToContinuousIndex( transform->TransformPoint( point ), index );
+
+    float expected = defaultValue;
+    if ( interpolator->IsInsideBuffer( index ) )
+      {
+      expected = static_cast< float >( interpolator->EvaluateAtContinuousIndex( index ) );
+      }
+    else if ( extrapolate )
+      {
+      expected = static_cast< float >( extrapolator->EvaluateAtContinuousIndex( index ) );
+      }
+    if ( std::abs( expected - it.Get() ) > 1e-4f * ( 1.0f + std::abs( expected ) ) )
+      {
+      std::cerr << name << ": expected " << expected << " but got " << it.Get() << " at " << it.GetIndex()
+                << " with extrapolation " << extrapolate << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkResampleImageScanlineTest( int, char * [] )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size = { { 41, 33, 27 } };
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    it.Set( static_cast< float >( std::sin( 0.3 * index[0] ) * 20.0 + index[1] * 0.5 - index[2] ) );
+    }
+
+  bool success = true;
+  const double scales[] = { 1.0, 1.4, 0.6 };
+  for ( double scale : scales )
+    {
+    TransformType::Pointer transform = TransformType::New();
+    TransformType::OutputVectorType translation;
+    translation[0] = 3.3;
+    translation[1] = -2.1;
+    translation[2] = 1.0;
+    transform->Translate( translation );
+    transform->Rotate( 0, 1, 0.2 );
+    transform->Scale( scale );
+
+    for ( int extrapolate = 0; extrapolate < 2; ++extrapolate )
+      {
+      success &= TestInterpolator( "Linear", itk::LinearInterpolateImageFunction< ImageType, double >::New(),
+                                   image, transform, extrapolate );
+      success &= TestInterpolator( "NearestNeighbor",
+                                   itk::NearestNeighborInterpolateImageFunction< ImageType, double >::New(),
+                                   image, transform, extrapolate );
+      success &= TestInterpolator( "BSpline", itk::BSplineInterpolateImageFunction< ImageType, double >::New(),
+                                   image, transform, extrapolate );
+      success &= TestInterpolator( "WindowedSinc",
+                                   itk::WindowedSincInterpolateImageFunction< ImageType, 2 >::New(),
+                                   image, transform, extrapolate );
+      }
+    }
+
+  // Scan lines parallel to the input axes, inside and outside of the image.
+  const double shifts[] = { 0.0, -20.5, 95.0 };
+  for ( double shift : shifts )
+    {
+    TransformType::Pointer transform = TransformType::New();
+    TransformType::OutputVectorType translation;
+    translation.Fill( shift );
+    translation[2] = 0.0;
+    transform->Translate( translation );
+    success &= TestInterpolator( "Linear translation",
+                                 itk::LinearInterpolateImageFunction< ImageType, double >::New(),
+                                 image, transform, false );
+    }
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -49,6 +49,15 @@ public:
   {
     return static_cast<TOutput>( itk::Math::abs( A ) );
   }
+
+  /** Batch version of operator(), see Functor::UnaryBatchFunctorTraits. */
+  void ProcessBatch(const TInput * A, TOutput * output, SizeValueType count) const
+  {
+    for ( SizeValueType i = 0; i < count; ++i )
+      {
+      output[i] = static_cast<TOutput>( itk::Math::abs( A[i] ) );
+      }
+  }
 };
 }
 
@@ -50,6 +50,15 @@ public:
   {
     return static_cast< TOutput >( A + B );
   }
+
+  /** Batch version of operator(), see Functor::BinaryBatchFunctorTraits. */
+  void ProcessBatch(const TInput1 * A, const TInput2 * B, TOutput * output, SizeValueType count) const
+  {
+    for ( SizeValueType i = 0; i < count; ++i )
+      {
+      output[i] = static_cast< TOutput >( A[i] + B[i] );
+      }
+  }
 };
 
 
@@ -130,6 +139,15 @@ public:
 
   inline TOutput operator()(const TInput1 & A, const TInput2 & B) const
   { return static_cast<TOutput>( A * B ); }
+
+  /** Batch version of operator(), see Functor::BinaryBatchFunctorTraits. */
+  void ProcessBatch(const TInput1 * A, const TInput2 * B, TOutput * output, SizeValueType count) const
+  {
+    for ( SizeValueType i = 0; i < count; ++i )
+      {
+      output[i] = static_cast< TOutput >( A[i] * B[i] );
+      }
+  }
 };
 
 
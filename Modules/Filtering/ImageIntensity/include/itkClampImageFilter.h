@@ -69,6 +69,9 @@ public:
 
   OutputType operator()( const InputType & A ) const;
 
+  /** Batch version of operator(), see Functor::UnaryBatchFunctorTraits. */
+  void ProcessBatch( const InputType * A, OutputType * output, SizeValueType count ) const;
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   itkConceptMacro(InputConvertibleToOutputCheck,
     (Concept::Convertible< InputType, OutputType >));
@@ -107,6 +110,22 @@ Clamp< TInput, TOutput >
   return static_cast< OutputType >( A );
   }
 
+template< typename TInput, typename TOutput >
+inline
+void
+Clamp< TInput, TOutput >
+::ProcessBatch( const InputType * A, OutputType * output, SizeValueType count ) const
+  {
+  const OutputType lowerBound = m_LowerBound;
+  const OutputType upperBound = m_UpperBound;
+  for ( SizeValueType i = 0; i < count; ++i )
+    {
+    const auto dA = static_cast< double >( A[i] );
+    output[i] = dA < lowerBound ? lowerBound
+              : ( dA > upperBound ? upperBound : static_cast< OutputType >( A[i] ) );
+    }
+  }
+
 } // end namespace Functor
 
 
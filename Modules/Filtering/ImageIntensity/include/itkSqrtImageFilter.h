@@ -50,6 +50,15 @@ public:
   {
     return static_cast<TOutput>( std::sqrt( static_cast<double>(A) ) );
   }
+
+  /** Batch version of operator(), see Functor::UnaryBatchFunctorTraits. */
+  void ProcessBatch(const TInput * A, TOutput * output, SizeValueType count) const
+  {
+    for ( SizeValueType i = 0; i < count; ++i )
+      {
+      output[i] = static_cast<TOutput>( std::sqrt( static_cast<double>(A[i]) ) );
+      }
+  }
 };
 }
 
@@ -0,0 +1,222 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAddImageFilter.h"
+#include "itkMultiplyImageFilter.h"
+#include "itkAbsImageFilter.h"
+#include "itkSqrtImageFilter.h"
+#include "itkClampImageFilter.h"
+#include "itkBinaryFunctorImageFilter.h"
+#include "itkVectorImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "itkGTest.h"
+
+// The pixel-wise filters process whole scanlines through the ProcessBatch
+// method of functors providing one. These tests check that the results are
+// the same as applying operator() pixel by pixel.
+
+namespace
+{
+
+using FloatImageType = itk::Image< float, 3 >;
+using ShortImageType = itk::Image< short, 3 >;
+
+template< typename TImage >
+typename TImage::Pointer CreateImage( unsigned int seed )
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size = { { 13, 7, 5 } };
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType index = it.GetIndex();
+    const int value = ( ( index[0] * 31 + index[1] * 17 + index[2] * 7 + seed ) % 101 ) - 50;
+    it.Set( static_cast< typename TImage::PixelType >( value ) );
+    }
+  return image;
+}
+
+// Sub-region whose scanlines do not start at the beginning of the buffer
+// lines, to check the pointer offsets.
+template< typename TImage >
+typename TImage::RegionType CreateSubRegion()
+{
+  typename TImage::RegionType region;
+  region.SetIndex( { { 3, 1, 2 } } );
+  region.SetSize( { { 7, 5, 2 } } );
+  return region;
+}
+
+template< typename TOutputImage, typename TInputImage, typename TFunctor >
+void CheckUnary( TOutputImage * output, const TInputImage * input, const TFunctor & functor )
+{
+  itk::ImageRegionConstIteratorWithIndex< TOutputImage > it( output, output->GetRequestedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    EXPECT_EQ( functor( input->GetPixel( it.GetIndex() ) ), it.Get() ) << "at " << it.GetIndex();
+    }
+}
+
+template< typename TOutputImage, typename TInputImage1, typename TInputImage2, typename TFunctor >
+void CheckBinary( TOutputImage * output, const TInputImage1 * input1, const TInputImage2 * input2,
+                  const TFunctor & functor )
+{
+  itk::ImageRegionConstIteratorWithIndex< TOutputImage > it( output, output->GetRequestedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    EXPECT_EQ( functor( input1->GetPixel( it.GetIndex() ), input2->GetPixel( it.GetIndex() ) ), it.Get() )
+      << "at " << it.GetIndex();
+    }
+}
+
+}
+
+
+TEST(BatchFunctorImageFilter, Traits)
+{
+  using AddFunctorType = itk::Functor::Add2< float, float, float >;
+  using AbsFunctorType = itk::Functor::Abs< short, short >;
+  using LambdaType = std::function< float( float ) >;
+
+  EXPECT_TRUE( ( itk::Functor::BinaryBatchFunctorTraits< AddFunctorType, float, float, float >::Value ) );
+  EXPECT_TRUE( ( itk::Functor::UnaryBatchFunctorTraits< AbsFunctorType, short, short >::Value ) );
+  EXPECT_FALSE( ( itk::Functor::UnaryBatchFunctorTraits< LambdaType, float, float >::Value ) );
+
+  EXPECT_TRUE( itk::ImageHasContiguousPixels< FloatImageType >::Value );
+  EXPECT_FALSE( ( itk::ImageHasContiguousPixels< itk::VectorImage< float, 3 > >::Value ) );
+}
+
+
+TEST(BatchFunctorImageFilter, Add)
+{
+  using FilterType = itk::AddImageFilter< FloatImageType, FloatImageType, FloatImageType >;
+  FloatImageType::Pointer input1 = CreateImage< FloatImageType >( 0 );
+  FloatImageType::Pointer input2 = CreateImage< FloatImageType >( 42 );
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( input1 );
+  filter->SetInput2( input2 );
+  filter->GetOutput()->SetRequestedRegion( CreateSubRegion< FloatImageType >() );
+  filter->Update();
+  CheckBinary( filter->GetOutput(), input1.GetPointer(), input2.GetPointer(),
+               itk::Functor::Add2< float, float, float >() );
+
+  // Constant second input.
+  filter = FilterType::New();
+  filter->SetInput1( input1 );
+  filter->SetConstant2( 2.5f );
+  filter->Update();
+  itk::ImageRegionConstIteratorWithIndex< FloatImageType > it( filter->GetOutput(),
+                                                               filter->GetOutput()->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    EXPECT_EQ( input1->GetPixel( it.GetIndex() ) + 2.5f, it.Get() );
+    }
+
+  // Constant first input.
+  filter = FilterType::New();
+  filter->SetConstant1( -1.0f );
+  filter->SetInput2( input2 );
+  filter->Update();
+  it = itk::ImageRegionConstIteratorWithIndex< FloatImageType >( filter->GetOutput(),
+                                                                 filter->GetOutput()->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    EXPECT_EQ( -1.0f + input2->GetPixel( it.GetIndex() ), it.Get() );
+    }
+}
+
+
+TEST(BatchFunctorImageFilter, MultiplyInPlace)
+{
+  using FilterType = itk::MultiplyImageFilter< ShortImageType, ShortImageType, ShortImageType >;
+  ShortImageType::Pointer input1 = CreateImage< ShortImageType >( 3 );
+  ShortImageType::Pointer reference = CreateImage< ShortImageType >( 3 );
+  ShortImageType::Pointer input2 = CreateImage< ShortImageType >( 5 );
+
+  const short * inputBuffer = input1->GetBufferPointer();
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( input1 );
+  filter->SetInput2( input2 );
+  filter->InPlaceOn();
+  filter->Update();
+  EXPECT_EQ( inputBuffer, filter->GetOutput()->GetBufferPointer() );
+  CheckBinary( filter->GetOutput(), reference.GetPointer(), input2.GetPointer(),
+               itk::Functor::Mult< short, short, short >() );
+}
+
+
+TEST(BatchFunctorImageFilter, BinaryFunctorImageFilter)
+{
+  using FunctorType = itk::Functor::Add2< short, float, float >;
+  using FilterType = itk::BinaryFunctorImageFilter< ShortImageType, FloatImageType, FloatImageType, FunctorType >;
+  ShortImageType::Pointer input1 = CreateImage< ShortImageType >( 11 );
+  FloatImageType::Pointer input2 = CreateImage< FloatImageType >( 13 );
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( input1 );
+  filter->SetInput2( input2 );
+  filter->GetOutput()->SetRequestedRegion( CreateSubRegion< FloatImageType >() );
+  filter->Update();
+  CheckBinary( filter->GetOutput(), input1.GetPointer(), input2.GetPointer(), FunctorType() );
+
+  filter = FilterType::New();
+  filter->SetConstant1( 7 );
+  filter->SetInput2( input2 );
+  filter->Update();
+  itk::ImageRegionConstIteratorWithIndex< FloatImageType > it( filter->GetOutput(),
+                                                               filter->GetOutput()->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    EXPECT_EQ( FunctorType()( 7, input2->GetPixel( it.GetIndex() ) ), it.Get() );
+    }
+}
+
+
+TEST(BatchFunctorImageFilter, Unary)
+{
+  ShortImageType::Pointer shortInput = CreateImage< ShortImageType >( 1 );
+  FloatImageType::Pointer floatInput = CreateImage< FloatImageType >( 2 );
+
+  using AbsFilterType = itk::AbsImageFilter< ShortImageType, ShortImageType >;
+  AbsFilterType::Pointer absFilter = AbsFilterType::New();
+  absFilter->SetInput( shortInput );
+  absFilter->GetOutput()->SetRequestedRegion( CreateSubRegion< ShortImageType >() );
+  absFilter->Update();
+  CheckUnary( absFilter->GetOutput(), shortInput.GetPointer(), itk::Functor::Abs< short, short >() );
+
+  using SqrtFilterType = itk::SqrtImageFilter< ShortImageType, FloatImageType >;
+  SqrtFilterType::Pointer sqrtFilter = SqrtFilterType::New();
+  sqrtFilter->SetInput( absFilter->GetOutput() );
+  sqrtFilter->GetOutput()->SetRequestedRegion( CreateSubRegion< FloatImageType >() );
+  sqrtFilter->Update();
+  CheckUnary( sqrtFilter->GetOutput(), absFilter->GetOutput(), itk::Functor::Sqrt< short, float >() );
+
+  using ClampFilterType = itk::ClampImageFilter< FloatImageType, ShortImageType >;
+  ClampFilterType::Pointer clampFilter = ClampFilterType::New();
+  clampFilter->SetInput( floatInput );
+  clampFilter->SetBounds( -20, 30 );
+  clampFilter->GetOutput()->SetRequestedRegion( CreateSubRegion< ShortImageType >() );
+  clampFilter->Update();
+  CheckUnary( clampFilter->GetOutput(), floatInput.GetPointer(), clampFilter->GetFunctor() );
+}
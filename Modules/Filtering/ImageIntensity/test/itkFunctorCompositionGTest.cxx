@@ -0,0 +1,219 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFunctorComposition.h"
+#include "itkCastImageFilter.h"
+#include "itkClampImageFilter.h"
+#include "itkAbsImageFilter.h"
+#include "itkMaskImageFilter.h"
+#include "itkRescaleIntensityImageFilter.h"
+#include "itkTernaryAddImageFilter.h"
+#include "itkUnaryGeneratorImageFilter.h"
+#include "itkBinaryGeneratorImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "itkGTest.h"
+
+// A chain Cast -> linear transform -> Clamp -> Mask fused in a single
+// filter has to give the same result as the individual operations.
+
+namespace
+{
+
+using ShortImageType = itk::Image< short, 2 >;
+using FloatImageType = itk::Image< float, 2 >;
+using UCharImageType = itk::Image< unsigned char, 2 >;
+
+using CastType = itk::Functor::Cast< short, float >;
+using ScaleType = itk::Functor::IntensityLinearTransform< float, float >;
+using ClampType = itk::Functor::Clamp< float, unsigned char >;
+using MaskType = itk::Functor::MaskInput< unsigned char, unsigned char >;
+
+template< typename TImage >
+typename TImage::Pointer CreateImage( int seed )
+{
+  typename TImage::Pointer image = TImage::New();
+  // Wider than the block size of the compositions.
+  typename TImage::SizeType size = { { 300, 6 } };
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType index = it.GetIndex();
+    const int value = ( ( index[0] * 37 + index[1] * 11 + seed ) % 201 ) - 60;
+    it.Set( static_cast< typename TImage::PixelType >( seed < 0 ? value > 0 : value ) );
+    }
+  return image;
+}
+
+ScaleType CreateScale()
+{
+  ScaleType scale;
+  scale.SetFactor( 1.7 );
+  scale.SetOffset( 20.0 );
+  return scale;
+}
+
+ClampType CreateClamp()
+{
+  ClampType clamp;
+  clamp.SetBounds( 10, 200 );
+  return clamp;
+}
+
+}
+
+
+TEST(FunctorComposition, Functors)
+{
+  const ScaleType scale = CreateScale();
+  const ClampType clamp = CreateClamp();
+
+  const auto chain = itk::Functor::MakeUnaryComposition( CastType(), scale, clamp );
+  using ChainType = itk::Functor::UnaryCompositionType< CastType, ScaleType, ClampType >::Type;
+  EXPECT_TRUE( ( std::is_same< const ChainType, decltype( chain ) >::value ) );
+  EXPECT_EQ( chain, ChainType( itk::Functor::UnaryComposition< CastType, ScaleType >( CastType(), scale ), clamp ) );
+  EXPECT_NE( chain, ChainType() );
+  EXPECT_TRUE( ( itk::Functor::UnaryBatchFunctorTraits< ChainType, short, unsigned char >::Value ) );
+
+  std::vector< short > input( 1000 );
+  for ( unsigned int i = 0; i < input.size(); ++i )
+    {
+    input[i] = static_cast< short >( ( i * 37 ) % 401 ) - 100;
+    }
+  std::vector< unsigned char > output( input.size() );
+  chain.ProcessBatch( input.data(), output.data(), output.size() );
+  for ( unsigned int i = 0; i < input.size(); ++i )
+    {
+    EXPECT_EQ( clamp( scale( CastType()( input[i] ) ) ), chain( input[i] ) );
+    EXPECT_EQ( chain( input[i] ), output[i] );
+    }
+
+  itk::Functor::BinaryComposition< MaskType, ChainType > masked( MaskType(), chain );
+  std::vector< unsigned char > mask( input.size() );
+  for ( unsigned int i = 0; i < mask.size(); ++i )
+    {
+    mask[i] = i % 3 == 0;
+    }
+  masked.ProcessBatch( input.data(), mask.data(), output.data(), output.size() );
+  for ( unsigned int i = 0; i < input.size(); ++i )
+    {
+    EXPECT_EQ( MaskType()( chain( input[i] ), mask[i] ), output[i] );
+    }
+}
+
+
+TEST(FunctorComposition, UnaryFilter)
+{
+  ShortImageType::Pointer input = CreateImage< ShortImageType >( 5 );
+
+  // Reference: one filter per operation.
+  using CastFilterType = itk::CastImageFilter< ShortImageType, FloatImageType >;
+  CastFilterType::Pointer castFilter = CastFilterType::New();
+  castFilter->SetInput( input );
+  using ScaleFilterType = itk::UnaryGeneratorImageFilter< FloatImageType, FloatImageType >;
+  ScaleFilterType::Pointer scaleFilter = ScaleFilterType::New();
+  scaleFilter->SetInput( castFilter->GetOutput() );
+  scaleFilter->SetFunctor( CreateScale() );
+  using ClampFilterType = itk::ClampImageFilter< FloatImageType, UCharImageType >;
+  ClampFilterType::Pointer clampFilter = ClampFilterType::New();
+  clampFilter->SetInput( scaleFilter->GetOutput() );
+  clampFilter->SetBounds( 10, 200 );
+  clampFilter->Update();
+  UCharImageType::Pointer reference = clampFilter->GetOutput();
+
+  // Fused, in a generator filter and in a functor filter.
+  using FusedGeneratorType = itk::UnaryGeneratorImageFilter< ShortImageType, UCharImageType >;
+  FusedGeneratorType::Pointer fusedGenerator = FusedGeneratorType::New();
+  fusedGenerator->SetInput( input );
+  fusedGenerator->SetFunctor( itk::Functor::MakeUnaryComposition( CastType(), CreateScale(), CreateClamp() ) );
+  fusedGenerator->Update();
+
+  using ChainType = itk::Functor::UnaryCompositionType< CastType, ScaleType, ClampType >::Type;
+  using FusedFilterType = itk::UnaryFunctorImageFilter< ShortImageType, UCharImageType, ChainType >;
+  FusedFilterType::Pointer fusedFilter = FusedFilterType::New();
+  fusedFilter->SetInput( input );
+  fusedFilter->SetFunctor( itk::Functor::MakeUnaryComposition( CastType(), CreateScale(), CreateClamp() ) );
+  fusedFilter->Update();
+
+  itk::ImageRegionConstIteratorWithIndex< UCharImageType > it( reference, reference->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    EXPECT_EQ( it.Get(), fusedGenerator->GetOutput()->GetPixel( it.GetIndex() ) ) << "at " << it.GetIndex();
+    EXPECT_EQ( it.Get(), fusedFilter->GetOutput()->GetPixel( it.GetIndex() ) ) << "at " << it.GetIndex();
+    }
+}
+
+
+TEST(FunctorComposition, BinaryFilter)
+{
+  ShortImageType::Pointer input = CreateImage< ShortImageType >( 7 );
+  UCharImageType::Pointer mask = CreateImage< UCharImageType >( -1 );
+
+  const auto chain = itk::Functor::MakeUnaryComposition( CastType(), CreateScale(), CreateClamp() );
+  using ChainType = itk::Functor::UnaryCompositionType< CastType, ScaleType, ClampType >::Type;
+  MaskType maskFunctor;
+  maskFunctor.SetOutsideValue( 3 );
+
+  using FilterType = itk::BinaryGeneratorImageFilter< ShortImageType, UCharImageType, UCharImageType >;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( input );
+  filter->SetInput2( mask );
+  filter->SetFunctor( itk::Functor::BinaryComposition< MaskType, ChainType >( maskFunctor, chain ) );
+  filter->Update();
+
+  itk::ImageRegionConstIteratorWithIndex< UCharImageType > it( filter->GetOutput(),
+                                                               filter->GetOutput()->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const unsigned char expected =
+      mask->GetPixel( it.GetIndex() ) ? chain( input->GetPixel( it.GetIndex() ) ) : 3;
+    EXPECT_EQ( expected, it.Get() ) << "at " << it.GetIndex();
+    }
+}
+
+
+TEST(FunctorComposition, TernaryFilter)
+{
+  using AbsType = itk::Functor::Abs< short, short >;
+  using AddType = itk::Functor::Add3< short, short, short, float >;
+  using FunctorType = itk::Functor::TernaryComposition< AddType, AbsType, itk::Functor::Identity, AbsType >;
+  using FilterType = itk::TernaryFunctorImageFilter< ShortImageType, ShortImageType, ShortImageType,
+                                                     FloatImageType, FunctorType >;
+
+  ShortImageType::Pointer input1 = CreateImage< ShortImageType >( 1 );
+  ShortImageType::Pointer input2 = CreateImage< ShortImageType >( 2 );
+  ShortImageType::Pointer input3 = CreateImage< ShortImageType >( 3 );
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( input1 );
+  filter->SetInput2( input2 );
+  filter->SetInput3( input3 );
+  filter->Update();
+
+  itk::ImageRegionConstIteratorWithIndex< FloatImageType > it( filter->GetOutput(),
+                                                               filter->GetOutput()->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const float expected = std::abs( input1->GetPixel( it.GetIndex() ) ) + input2->GetPixel( it.GetIndex() )
+                           + std::abs( input3->GetPixel( it.GetIndex() ) );
+    EXPECT_EQ( expected, it.Get() ) << "at " << it.GetIndex();
+    }
+}
@@ -0,0 +1,240 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDenseLabelTable_h
+#define itkDenseLabelTable_h
+
+#include "itkMultiThreaderBase.h"
+#include "itkImageRegionConstIterator.h"
+#include "itksys/hash_map.hxx"
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace itk
+{
+/** \class DenseLabelTable
+ * \brief Table of values indexed by labels, for per-label accumulations.
+ *
+ * When the labels are integers in a range of at most MaximumDenseRange
+ * values, the values are stored in an array indexed by the labels, so that
+ * the label images with many labels are processed without hash lookups.
+ * The arrays of all the tables accumulated at the same time, one per
+ * thread, must also fit in MaximumDenseMemory bytes. Otherwise, the values
+ * are stored in a hash map, whose size only depends on the labels present.
+ *
+ * The filters accumulate a table per thread, all initialized with the same
+ * range, then merge the tables with Reduce(), which merges pairs of tables
+ * in parallel.
+ *
+ * \sa LabelStatisticsImageFilter, LabelOverlapMeasuresImageFilter
+ * \ingroup ITKImageStatistics
+ */
+template< typename TLabel, typename TValue >
+class DenseLabelTable
+{
+public:
+  using LabelType = TLabel;
+  using ValueType = TValue;
+  using MapType = itksys::hash_map< LabelType, ValueType >;
+
+  /** Largest number of labels stored in an array. */
+  static constexpr SizeValueType MaximumDenseRange = 65536;
+
+  /** Largest memory, in bytes, of the arrays of the tables initialized
+   * with the same range. */
+  static constexpr SizeValueType MaximumDenseMemory = 256 * 1024 * 1024;
+
+  DenseLabelTable():
+    m_Minimum(),
+    m_Dense(false)
+  {}
+
+  /** Clear the table. The values are stored in an array if the labels are
+   * integers, and if the range [minimum, maximum] is small enough for the
+   * arrays of numberOfTables tables, e.g. one per thread. */
+  void Initialize(LabelType minimum, LabelType maximum, const ValueType & initialValue,
+                  SizeValueType numberOfTables = 1)
+  {
+    m_InitialValue = initialValue;
+    m_Minimum = minimum;
+    m_Map.clear();
+    m_Values.clear();
+    m_Used.clear();
+    m_Dense = false;
+    if ( std::is_integral< LabelType >::value && !( maximum < minimum ) )
+      {
+      const double range = static_cast< double >( maximum ) - static_cast< double >( minimum ) + 1.0;
+      const double memory = range * static_cast< double >( numberOfTables )
+                            * static_cast< double >( sizeof( ValueType ) + sizeof( unsigned char ) );
+      m_Dense = range <= MaximumDenseRange && memory <= MaximumDenseMemory;
+      }
+    if ( m_Dense )
+      {
+      const auto range = static_cast< SizeValueType >( maximum - minimum ) + 1;
+      m_Values.assign(range, initialValue);
+      m_Used.assign(range, 0);
+      }
+  }
+
+  /** Whether the values are stored in an array. */
+  bool IsDense() const
+  {
+    return m_Dense;
+  }
+
+  /** Value of a label, inserted with the initial value if the label is not
+   * in the table yet. When the table is dense, the label must be in the
+   * range of the table. */
+  ValueType & operator[](LabelType label)
+  {
+    if ( m_Dense )
+      {
+      const auto i = static_cast< SizeValueType >( label - m_Minimum );
+      m_Used[i] = 1;
+      return m_Values[i];
+      }
+    auto it = m_Map.find(label);
+    if ( it == m_Map.end() )
+      {
+      it = m_Map.insert( typename MapType::value_type(label, m_InitialValue) ).first;
+      }
+    return it->second;
+  }
+
+  /** Call function(label, value) for each label of the table. The labels
+   * of a dense table are visited in increasing order. */
+  template< typename TFunction >
+  void Visit(TFunction function) const
+  {
+    if ( m_Dense )
+      {
+      for ( SizeValueType i = 0; i < m_Values.size(); ++i )
+        {
+        if ( m_Used[i] )
+          {
+          function(static_cast< LabelType >( m_Minimum + static_cast< LabelType >( i ) ), m_Values[i]);
+          }
+        }
+      }
+    else
+      {
+      for ( const auto & entry : m_Map )
+        {
+        function(entry.first, entry.second);
+        }
+      }
+  }
+
+  /** Merge another table, initialized with the same range, with
+   * merge(value, otherValue). */
+  template< typename TMerge >
+  void Merge(const DenseLabelTable & other, TMerge merge)
+  {
+    other.Visit([this, &merge](LabelType label, const ValueType & value)
+                  {
+                  merge( ( *this )[label], value );
+                  });
+  }
+
+  /** Merge all the tables in the first one. Pairs of tables are merged in
+   * parallel, in log2(tables.size()) steps. */
+  template< typename TMerge >
+  static void Reduce(std::vector< DenseLabelTable > & tables, TMerge merge, MultiThreaderBase *multiThreader)
+  {
+    for ( SizeValueType step = 1; step < tables.size(); step *= 2 )
+      {
+      const SizeValueType numberOfPairs = ( tables.size() - step + 2 * step - 1 ) / ( 2 * step );
+      auto mergePair = [&tables, &merge, step](SizeValueType pair)
+        {
+        const SizeValueType first = 2 * step * pair;
+        tables[first].Merge(tables[first + step], merge);
+        tables[first + step].Clear();
+        };
+      if ( multiThreader && numberOfPairs > 1 )
+        {
+        multiThreader->ParallelizeArray(0, numberOfPairs, mergePair, nullptr);
+        }
+      else
+        {
+        for ( SizeValueType pair = 0; pair < numberOfPairs; ++pair )
+          {
+          mergePair(pair);
+          }
+        }
+      }
+  }
+
+  /** Release the memory of the table. */
+  void Clear()
+  {
+    MapType().swap(m_Map);
+    std::vector< ValueType >().swap(m_Values);
+    std::vector< unsigned char >().swap(m_Used);
+  }
+
+  /** Compute the range of the labels of a region of an image. Returns
+   * false if the region is empty. */
+  template< typename TImage >
+  static bool ComputeRange(const TImage *image, const typename TImage::RegionType & region,
+                           MultiThreaderBase *multiThreader, LabelType & minimum, LabelType & maximum)
+  {
+    if ( region.GetNumberOfPixels() == 0 )
+      {
+      return false;
+      }
+    minimum = std::numeric_limits< LabelType >::max();
+    maximum = std::numeric_limits< LabelType >::lowest();
+    std::mutex mutex;
+    auto computeRange = [&](const typename TImage::RegionType & subRegion)
+      {
+      LabelType subMinimum = std::numeric_limits< LabelType >::max();
+      LabelType subMaximum = std::numeric_limits< LabelType >::lowest();
+      for ( ImageRegionConstIterator< TImage > it(image, subRegion); !it.IsAtEnd(); ++it )
+        {
+        const LabelType label = it.Get();
+        subMinimum = std::min(subMinimum, label);
+        subMaximum = std::max(subMaximum, label);
+        }
+      std::lock_guard< std::mutex > lock(mutex);
+      minimum = std::min(minimum, subMinimum);
+      maximum = std::max(maximum, subMaximum);
+      };
+    if ( multiThreader )
+      {
+      multiThreader->template ParallelizeImageRegion< TImage::ImageDimension >(region, computeRange, nullptr);
+      }
+    else
+      {
+      computeRange(region);
+      }
+    return true;
+  }
+
+private:
+  ValueType                    m_InitialValue;
+  LabelType                    m_Minimum;
+  bool                         m_Dense;
+  std::vector< ValueType >     m_Values;
+  std::vector< unsigned char > m_Used;
+  MapType                      m_Map;
+};
+} // end namespace itk
+
+#endif
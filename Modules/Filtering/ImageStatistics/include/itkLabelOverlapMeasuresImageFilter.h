@@ -22,6 +22,7 @@
 #include "itkNumericTraits.h"
 
 #include "itksys/hash_map.hxx"
+#include "itkDenseLabelTable.h"
 
 namespace itk {
 
@@ -35,6 +36,10 @@ namespace itk {
  * https://hdl.handle.net/10380/3141
  * http://www.insight-journal.org/browse/publication/707
  *
+ * The measures are accumulated per thread in a DenseLabelTable, which
+ * stores them in an array indexed by the labels when the labels are
+ * integers in a range small enough for the tables of all the threads.
+ *
  * \author Nicholas J. Tustison
  * \sa LabelOverlapMeasuresImageFilter
  *
@@ -228,8 +233,10 @@ protected:
   void EnlargeOutputRequestedRegion( DataObject *data ) override;
 
 private:
-  std::vector<MapType> m_LabelSetMeasuresPerThread;
-  MapType              m_LabelSetMeasures;
+  using LabelSetMeasuresTableType = DenseLabelTable<LabelType, LabelSetMeasures>;
+
+  std::vector<LabelSetMeasuresTableType> m_LabelSetMeasuresPerThread;
+  MapType                                m_LabelSetMeasures;
 }; // end of class
 
 } // end namespace itk
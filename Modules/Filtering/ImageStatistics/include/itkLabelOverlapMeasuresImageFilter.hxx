@@ -20,8 +20,9 @@
 
 #include "itkLabelOverlapMeasuresImageFilter.h"
 
-#include "itkImageRegionConstIterator.h"
+#include "itkImageScanlineConstIterator.h"
 #include "itkProgressReporter.h"
+#include <algorithm>
 
 namespace itk {
 
@@ -61,13 +62,25 @@ LabelOverlapMeasuresImageFilter<TLabelImage>
 {
   ThreadIdType numberOfThreads = this->GetNumberOfThreads();
 
-  // Resize the thread temporaries
+  // The range of the labels of both images selects the storage of the tables
+  const RegionType & region = this->GetOutput()->GetRequestedRegion();
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  LabelType minimumLabel = NumericTraits<LabelType>::max();
+  LabelType maximumLabel = NumericTraits<LabelType>::NonpositiveMin();
+  LabelType minimumTargetLabel = NumericTraits<LabelType>::max();
+  LabelType maximumTargetLabel = NumericTraits<LabelType>::NonpositiveMin();
+  LabelSetMeasuresTableType::ComputeRange( this->GetSourceImage(), region,
+                                           this->GetMultiThreader(), minimumLabel, maximumLabel );
+  LabelSetMeasuresTableType::ComputeRange( this->GetTargetImage(), region,
+                                           this->GetMultiThreader(), minimumTargetLabel, maximumTargetLabel );
+  minimumLabel = std::min( minimumLabel, minimumTargetLabel );
+  maximumLabel = std::max( maximumLabel, maximumTargetLabel );
+
+  // Resize and initialize the thread temporaries
   this->m_LabelSetMeasuresPerThread.resize( numberOfThreads );
-
-  // Initialize the temporaries
   for( ThreadIdType n = 0; n < numberOfThreads; n++ )
     {
-    this->m_LabelSetMeasuresPerThread[n].clear();
+    this->m_LabelSetMeasuresPerThread[n].Initialize( minimumLabel, maximumLabel, LabelSetMeasures(), numberOfThreads );
     }
 
   // Initialize the final map
@@ -79,36 +92,28 @@ void
 LabelOverlapMeasuresImageFilter<TLabelImage>
 ::AfterThreadedGenerateData()
 {
-  // Run through the map for each thread and accumulate the set measures.
-  for( ThreadIdType n = 0; n < this->GetNumberOfThreads(); n++ )
-    {
-    // Iterate over the map for this thread
-    for( MapConstIterator threadIt = this->m_LabelSetMeasuresPerThread[n].begin();
-         threadIt != this->m_LabelSetMeasuresPerThread[n].end();
-         ++threadIt )
+  // Merge the tables of the threads
+  LabelSetMeasuresTableType::Reduce( this->m_LabelSetMeasuresPerThread,
+    []( LabelSetMeasures & measures, const LabelSetMeasures & other )
       {
-      // Does this label exist in the cumulative structure yet?
-      MapIterator mapIt = this->m_LabelSetMeasures.find( ( *threadIt ).first );
-      if( mapIt == this->m_LabelSetMeasures.end() )
-        {
-        // Create a new entry
-        using MapValueType = typename MapType::value_type;
-        mapIt = this->m_LabelSetMeasures.insert( MapValueType(
-                                                   (*threadIt).first, LabelSetMeasures() ) ).first;
-        }
+      measures.m_Source += other.m_Source;
+      measures.m_Target += other.m_Target;
+      measures.m_Union += other.m_Union;
+      measures.m_Intersection += other.m_Intersection;
+      measures.m_SourceComplement += other.m_SourceComplement;
+      measures.m_TargetComplement += other.m_TargetComplement;
+      },
+    this->GetMultiThreader() );
+
+  this->m_LabelSetMeasuresPerThread[0].Visit(
+    [this]( LabelType label, const LabelSetMeasures & measures )
+      {
+      using MapValueType = typename MapType::value_type;
+      this->m_LabelSetMeasures.insert( MapValueType( label, measures ) );
+      } );
 
-      // Accumulate the information from this thread
-      (*mapIt).second.m_Source += (*threadIt).second.m_Source;
-      (*mapIt).second.m_Target += (*threadIt).second.m_Target;
-      (*mapIt).second.m_Union += (*threadIt).second.m_Union;
-      (*mapIt).second.m_Intersection +=
-        (*threadIt).second.m_Intersection;
-      (*mapIt).second.m_SourceComplement +=
-        (*threadIt).second.m_SourceComplement;
-      (*mapIt).second.m_TargetComplement +=
-        (*threadIt).second.m_TargetComplement;
-      } // end of thread map iterator loop
-    } // end of thread loop
+  // Release the thread temporaries
+  this->m_LabelSetMeasuresPerThread.clear();
 }
 
 template<typename TLabelImage>
@@ -117,59 +122,58 @@ LabelOverlapMeasuresImageFilter<TLabelImage>
 ::ThreadedGenerateData( const RegionType& outputRegionForThread,
                         ThreadIdType threadId )
 {
-  ImageRegionConstIterator<LabelImageType> itS( this->GetSourceImage(),
-                                                outputRegionForThread );
-  ImageRegionConstIterator<LabelImageType> itT( this->GetTargetImage(),
-                                                outputRegionForThread );
+  if( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  ImageScanlineConstIterator<LabelImageType> itS( this->GetSourceImage(),
+                                                  outputRegionForThread );
+  ImageScanlineConstIterator<LabelImageType> itT( this->GetTargetImage(),
+                                                  outputRegionForThread );
+
+  LabelSetMeasuresTableType & table = this->m_LabelSetMeasuresPerThread[threadId];
 
   // Support progress methods/callbacks
   ProgressReporter progress( this, threadId,
-                             2*outputRegionForThread.GetNumberOfPixels() );
+    outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize( 0 ) );
 
-  for( itS.GoToBegin(), itT.GoToBegin(); !itS.IsAtEnd(); ++itS, ++itT )
+  while( !itS.IsAtEnd() )
     {
-    LabelType sourceLabel = itS.Get();
-    LabelType targetLabel = itT.Get();
-
-    // Is the label already in this thread?
-    MapIterator mapItS =
-      this->m_LabelSetMeasuresPerThread[threadId].find( sourceLabel );
-    MapIterator mapItT =
-      this->m_LabelSetMeasuresPerThread[threadId].find( targetLabel );
-
-    if( mapItS == this->m_LabelSetMeasuresPerThread[threadId].end() )
+    while( !itS.IsAtEndOfLine() )
       {
-      // Create a new label set measures object
-      using MapValueType = typename MapType::value_type;
-      mapItS = this->m_LabelSetMeasuresPerThread[threadId].insert(
-        MapValueType( sourceLabel, LabelSetMeasures() ) ).first;
-      }
-
-    if( mapItT == this->m_LabelSetMeasuresPerThread[threadId].end() )
-      {
-      // Create a new label set measures object
-      using MapValueType = typename MapType::value_type;
-      mapItT = this->m_LabelSetMeasuresPerThread[threadId].insert(
-        MapValueType( targetLabel, LabelSetMeasures() ) ).first;
-      }
-
-    (*mapItS).second.m_Source++;
-    (*mapItT).second.m_Target++;
+      // Count the run of pixels with the same pair of labels
+      const LabelType sourceLabel = itS.Get();
+      const LabelType targetLabel = itT.Get();
+      unsigned long count = 0;
+      do
+        {
+        ++count;
+        ++itS;
+        ++itT;
+        }
+      while( !itS.IsAtEndOfLine() && itS.Get() == sourceLabel && itT.Get() == targetLabel );
 
-    if( sourceLabel == targetLabel )
-      {
-      (*mapItS).second.m_Intersection++;
-      (*mapItS).second.m_Union++;
-      }
-    else
-      {
-      (*mapItS).second.m_Union++;
-      (*mapItT).second.m_Union++;
+      LabelSetMeasures & sourceMeasures = table[sourceLabel];
+      sourceMeasures.m_Source += count;
+      sourceMeasures.m_Union += count;
+      if( sourceLabel == targetLabel )
+        {
+        sourceMeasures.m_Target += count;
+        sourceMeasures.m_Intersection += count;
+        }
+      else
+        {
+        sourceMeasures.m_SourceComplement += count;
 
-      (*mapItS).second.m_SourceComplement++;
-      (*mapItT).second.m_TargetComplement++;
+        LabelSetMeasures & targetMeasures = table[targetLabel];
+        targetMeasures.m_Target += count;
+        targetMeasures.m_Union += count;
+        targetMeasures.m_TargetComplement += count;
+        }
       }
-
+    itS.NextLine();
+    itT.NextLine();
     progress.CompletedPixel();
     }
 }
@@ -23,7 +23,7 @@
 #include "itkSimpleDataObjectDecorator.h"
 #include "itksys/hash_map.hxx"
 #include "itkHistogram.h"
-#include "itkFastMutexLock.h"
+#include "itkDenseLabelTable.h"
 #include <vector>
 
 namespace itk
@@ -47,7 +47,13 @@ namespace itk
  *
  * The filter passes its intensity input through unmodified.  The filter is
  * threaded. It computes statistics in each thread then combines them in
- * its AfterThreadedGenerate method.
+ * its AfterThreadedGenerate method. When the labels are integers in a
+ * range of at most DenseLabelTable::MaximumDenseRange values, and the
+ * tables of all the threads fit in DenseLabelTable::MaximumDenseMemory
+ * bytes, the statistics of a thread are stored in an array indexed by the
+ * labels instead of a hash map. The pixels of a run of identical labels along a
+ * line are accumulated together, and the tables of the threads are merged
+ * in parallel.
  *
  * \ingroup MathematicalStatisticsImageFilters
  * \ingroup ITKImageStatistics
@@ -357,17 +363,33 @@ protected:
   void EnlargeOutputRequestedRegion(DataObject *data) override;
 
 private:
-  std::vector< MapType >        m_LabelStatisticsPerThread;
-  MapType                       m_LabelStatistics;
-  ValidLabelValuesContainerType m_ValidLabelValues;
+  // Statistics of a label accumulated by a thread
+  struct LabelAccumulator
+  {
+    IdentifierType m_Count;
+    RealType       m_Sum;
+    RealType       m_SumOfSquares;
+    RealType       m_Minimum;
+    RealType       m_Maximum;
+    IndexType      m_MinimumIndex;
+    IndexType      m_MaximumIndex;
+    std::vector< IdentifierType > m_Frequencies;
+  };
+  using AccumulatorTableType = DenseLabelTable< LabelPixelType, LabelAccumulator >;
+
+  std::vector< AccumulatorTableType > m_LabelStatisticsPerThread;
+  MapType                             m_LabelStatistics;
+  ValidLabelValuesContainerType       m_ValidLabelValues;
 
   bool m_UseHistograms;
 
   typename HistogramType::SizeType m_NumBins;
 
-  RealType            m_LowerBound;
-  RealType            m_UpperBound;
-  SimpleFastMutexLock m_Mutex;
+  RealType m_LowerBound;
+  RealType m_UpperBound;
+
+  // Histogram whose bins are used by all the labels
+  HistogramPointer m_BinHistogram;
 }; // end of class
 } // end namespace itk
 
@@ -19,9 +19,9 @@
 #define itkLabelStatisticsImageFilter_hxx
 #include "itkLabelStatisticsImageFilter.h"
 
-#include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageScanlineConstIterator.h"
 #include "itkProgressReporter.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -80,13 +80,35 @@ LabelStatisticsImageFilter< TInputImage, TLabelImage >
 {
   ThreadIdType numberOfThreads = this->GetNumberOfThreads();
 
-  // Resize the thread temporaries
+  // The range of the labels selects the storage of the tables
+  const LabelImageType *labelImage = this->GetLabelInput();
+  LabelPixelType        minimumLabel = NumericTraits< LabelPixelType >::max();
+  LabelPixelType        maximumLabel = NumericTraits< LabelPixelType >::NonpositiveMin();
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  AccumulatorTableType::ComputeRange( labelImage, this->GetOutput()->GetRequestedRegion(),
+                                      this->GetMultiThreader(), minimumLabel, maximumLabel );
+
+  LabelAccumulator initialAccumulator;
+  initialAccumulator.m_Count = NumericTraits< IdentifierType >::ZeroValue();
+  initialAccumulator.m_Sum = NumericTraits< RealType >::ZeroValue();
+  initialAccumulator.m_SumOfSquares = NumericTraits< RealType >::ZeroValue();
+  initialAccumulator.m_Minimum = NumericTraits< RealType >::max();
+  initialAccumulator.m_Maximum = NumericTraits< RealType >::NonpositiveMin();
+  initialAccumulator.m_MinimumIndex.Fill( NumericTraits< IndexValueType >::max() );
+  initialAccumulator.m_MaximumIndex.Fill( NumericTraits< IndexValueType >::NonpositiveMin() );
+
+  // Resize and initialize the thread temporaries
   m_LabelStatisticsPerThread.resize(numberOfThreads);
-
-  // Initialize the temporaries
   for ( ThreadIdType i = 0; i < numberOfThreads; ++i )
     {
-    m_LabelStatisticsPerThread[i].clear();
+    m_LabelStatisticsPerThread[i].Initialize(minimumLabel, maximumLabel, initialAccumulator, numberOfThreads);
+    }
+
+  // The bins of the histograms of all the labels
+  m_BinHistogram = nullptr;
+  if ( m_UseHistograms )
+    {
+    m_BinHistogram = LabelStatistics(m_NumBins[0], m_LowerBound, m_UpperBound).m_Histogram;
     }
 
   // Initialize the final map
@@ -98,89 +120,75 @@ void
 LabelStatisticsImageFilter< TInputImage, TLabelImage >
 ::AfterThreadedGenerateData()
 {
-  MapIterator      mapIt;
-  MapConstIterator threadIt;
-  ThreadIdType     i;
-  ThreadIdType     numberOfThreads = this->GetNumberOfThreads();
-
-  // Run through the map for each thread and accumulate the count,
-  // sum, and sumofsquares
-  for ( i = 0; i < numberOfThreads; i++ )
+  // Merge the tables of the threads
+  AccumulatorTableType::Reduce(m_LabelStatisticsPerThread,
+                               [](LabelAccumulator & accumulator, const LabelAccumulator & other)
+                                 {
+                                 accumulator.m_Count += other.m_Count;
+                                 accumulator.m_Sum += other.m_Sum;
+                                 accumulator.m_SumOfSquares += other.m_SumOfSquares;
+                                 accumulator.m_Minimum = std::min(accumulator.m_Minimum, other.m_Minimum);
+                                 accumulator.m_Maximum = std::max(accumulator.m_Maximum, other.m_Maximum);
+                                 for ( unsigned int i = 0; i < ImageDimension; ++i )
+                                   {
+                                   accumulator.m_MinimumIndex[i] =
+                                     std::min(accumulator.m_MinimumIndex[i], other.m_MinimumIndex[i]);
+                                   accumulator.m_MaximumIndex[i] =
+                                     std::max(accumulator.m_MaximumIndex[i], other.m_MaximumIndex[i]);
+                                   }
+                                 if ( accumulator.m_Frequencies.empty() )
+                                   {
+                                   accumulator.m_Frequencies = other.m_Frequencies;
+                                   }
+                                 else
+                                   {
+                                   for ( SizeValueType bin = 0; bin < other.m_Frequencies.size(); ++bin )
+                                     {
+                                     accumulator.m_Frequencies[bin] += other.m_Frequencies[bin];
+                                     }
+                                   }
+                                 },
+                               this->GetMultiThreader());
+
+  // compute the remainder of the statistics, and the list of valid labels
+  m_ValidLabelValues.resize(0);
+  m_LabelStatisticsPerThread[0].Visit([this](LabelPixelType label, const LabelAccumulator & accumulator)
     {
-    // iterate over the map for this thread
-    for ( threadIt = m_LabelStatisticsPerThread[i].begin();
-          threadIt != m_LabelStatisticsPerThread[i].end();
-          ++threadIt )
+    using MapValueType = typename MapType::value_type;
+    MapIterator mapIt;
+    if ( m_UseHistograms )
       {
-      // does this label exist in the cumulative structure yet?
-      mapIt = m_LabelStatistics.find( ( *threadIt ).first );
-      if ( mapIt == m_LabelStatistics.end() )
-        {
-        // create a new entry
-        using MapValueType = typename MapType::value_type;
-        if ( m_UseHistograms )
-          {
-          mapIt = m_LabelStatistics.insert( MapValueType( ( *threadIt ).first,
-                                                          LabelStatistics(m_NumBins[0], m_LowerBound,
-                                                                          m_UpperBound) ) ).first;
-          }
-        else
-          {
-          mapIt = m_LabelStatistics.insert( MapValueType( ( *threadIt ).first,
-                                                          LabelStatistics() ) ).first;
-          }
-        }
-
-
-      typename MapType::mapped_type &labelStats = ( *mapIt ).second;
+      mapIt = m_LabelStatistics.insert( MapValueType( label,
+                                                      LabelStatistics(m_NumBins[0], m_LowerBound,
+                                                                      m_UpperBound) ) ).first;
+      }
+    else
+      {
+      mapIt = m_LabelStatistics.insert( MapValueType( label, LabelStatistics() ) ).first;
+      }
+    LabelStatistics & labelStats = mapIt->second;
 
-      // accumulate the information from this thread
-      labelStats.m_Count += ( *threadIt ).second.m_Count;
-      labelStats.m_Sum += ( *threadIt ).second.m_Sum;
-      labelStats.m_SumOfSquares += ( *threadIt ).second.m_SumOfSquares;
+    labelStats.m_Count = accumulator.m_Count;
+    labelStats.m_Sum = accumulator.m_Sum;
+    labelStats.m_SumOfSquares = accumulator.m_SumOfSquares;
+    labelStats.m_Minimum = accumulator.m_Minimum;
+    labelStats.m_Maximum = accumulator.m_Maximum;
 
-      if ( labelStats.m_Minimum > ( *threadIt ).second.m_Minimum )
-        {
-        labelStats.m_Minimum = ( *threadIt ).second.m_Minimum;
-        }
-      if ( labelStats.m_Maximum < ( *threadIt ).second.m_Maximum )
-        {
-        labelStats.m_Maximum = ( *threadIt ).second.m_Maximum;
-        }
+    //bounding box is min,max pairs
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      labelStats.m_BoundingBox[2 * i] = accumulator.m_MinimumIndex[i];
+      labelStats.m_BoundingBox[2 * i + 1] = accumulator.m_MaximumIndex[i];
+      }
 
-      //bounding box is min,max pairs
-      for ( unsigned int ii = 0; ii < ( ImageDimension * 2 ); ii += 2 )
+    // if enabled, update the histogram for this label
+    if ( m_UseHistograms )
+      {
+      for ( SizeValueType bin = 0; bin < accumulator.m_Frequencies.size(); ++bin )
         {
-        if ( labelStats.m_BoundingBox[ii] > ( *threadIt ).second.m_BoundingBox[ii] )
-          {
-          labelStats.m_BoundingBox[ii] = ( *threadIt ).second.m_BoundingBox[ii];
-          }
-        if ( labelStats.m_BoundingBox[ii + 1] < ( *threadIt ).second.m_BoundingBox[ii + 1] )
-          {
-          labelStats.m_BoundingBox[ii + 1] = ( *threadIt ).second.m_BoundingBox[ii + 1];
-          }
+        labelStats.m_Histogram->IncreaseFrequency( bin, accumulator.m_Frequencies[bin] );
         }
-
-      // if enabled, update the histogram for this label
-      if ( m_UseHistograms )
-        {
-        typename HistogramType::IndexType index;
-        index.SetSize(1);
-        for ( unsigned int bin = 0; bin < m_NumBins[0]; bin++ )
-          {
-          index[0] = bin;
-          labelStats.m_Histogram->IncreaseFrequency( bin, ( *threadIt ).second.m_Histogram->GetFrequency(bin) );
-          }
-        }
-      } // end of thread map iterator loop
-    }   // end of thread loop
-
-  // compute the remainder of the statistics
-  for ( mapIt = m_LabelStatistics.begin();
-        mapIt != m_LabelStatistics.end();
-        ++mapIt )
-    {
-    typename MapType::mapped_type &labelStats = ( *mapIt ).second;
+      }
 
     // mean
     labelStats.m_Mean = labelStats.m_Sum
@@ -190,11 +198,10 @@ LabelStatisticsImageFilter< TInputImage, TLabelImage >
     if ( labelStats.m_Count > 1 )
       {
       // unbiased estimate of variance
-      LabelStatistics & ls = mapIt->second;
-      const RealType    sumSquared  = ls.m_Sum * ls.m_Sum;
-      const auto count = static_cast< RealType >( ls.m_Count );
+      const RealType sumSquared  = labelStats.m_Sum * labelStats.m_Sum;
+      const auto     count = static_cast< RealType >( labelStats.m_Count );
 
-      ls.m_Variance = ( ls.m_SumOfSquares - sumSquared / count ) / ( count - 1.0 );
+      labelStats.m_Variance = ( labelStats.m_SumOfSquares - sumSquared / count ) / ( count - 1.0 );
       }
     else
       {
@@ -203,19 +210,13 @@ LabelStatisticsImageFilter< TInputImage, TLabelImage >
 
     // sigma
     labelStats.m_Sigma = std::sqrt( labelStats.m_Variance );
-    }
 
-    {
-    //Now update the cached vector of valid labels.
-    m_ValidLabelValues.resize(0);
-    m_ValidLabelValues.reserve(m_LabelStatistics.size());
-    for ( mapIt = m_LabelStatistics.begin();
-      mapIt != m_LabelStatistics.end();
-      ++mapIt )
-      {
-      m_ValidLabelValues.push_back(mapIt->first);
-      }
-    }
+    m_ValidLabelValues.push_back(label);
+    });
+
+  // Release the thread temporaries
+  m_LabelStatisticsPerThread.clear();
+  m_BinHistogram = nullptr;
 }
 
 template< typename TInputImage, typename TLabelImage >
@@ -224,7 +225,6 @@ LabelStatisticsImageFilter< TInputImage, TLabelImage >
 ::ThreadedGenerateData(const RegionType & outputRegionForThread,
                        ThreadIdType threadId)
 {
-
   typename HistogramType::IndexType histogramIndex(1);
   typename HistogramType::MeasurementVectorType histogramMeasurement(1);
 
@@ -234,13 +234,14 @@ LabelStatisticsImageFilter< TInputImage, TLabelImage >
     return;
     }
 
-  ImageLinearConstIteratorWithIndex< TInputImage > it (this->GetInput(),
-                                                       outputRegionForThread);
+  ImageScanlineConstIterator< TInputImage > it (this->GetInput(),
+                                                outputRegionForThread);
 
   ImageScanlineConstIterator< TLabelImage > labelIt (this->GetLabelInput(),
                                                      outputRegionForThread);
 
-  MapIterator mapIt;
+  AccumulatorTableType & table = m_LabelStatisticsPerThread[threadId];
+  const HistogramType *  binHistogram = m_BinHistogram.GetPointer();
 
   // support progress methods/callbacks
   const size_t numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / size0;
@@ -249,78 +250,68 @@ LabelStatisticsImageFilter< TInputImage, TLabelImage >
   // do the work
   while ( !it.IsAtEnd() )
     {
+    IndexType index = it.GetIndex();
     while ( !it.IsAtEndOfLine() )
       {
-      const RealType & value = static_cast< RealType >( it.Get() );
-
-      const LabelPixelType & label = labelIt.Get();
-
-      // is the label already in this thread?
-      mapIt = m_LabelStatisticsPerThread[threadId].find(label);
-      if ( mapIt == m_LabelStatisticsPerThread[threadId].end() )
+      // accumulate the run of pixels with the same label
+      const LabelPixelType label = labelIt.Get();
+      LabelAccumulator &   labelStats = table[label];
+      if ( binHistogram && labelStats.m_Frequencies.empty() )
         {
-        // create a new statistics object
-        using MapValueType = typename MapType::value_type;
-        if ( m_UseHistograms )
-          {
-          mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
-                                                                             LabelStatistics(m_NumBins[0], m_LowerBound,
-                                                                                             m_UpperBound) ) ).first;
-          }
-        else
-          {
-          mapIt = m_LabelStatisticsPerThread[threadId].insert( MapValueType( label,
-                                                                             LabelStatistics() ) ).first;
-          }
-        }
-
-      typename MapType::mapped_type &labelStats = ( *mapIt ).second;
-
-      // update the values for this label and this thread
-      if ( value < labelStats.m_Minimum )
-        {
-        labelStats.m_Minimum = value;
-        }
-      if ( value > labelStats.m_Maximum )
-        {
-        labelStats.m_Maximum = value;
+        labelStats.m_Frequencies.resize(m_NumBins[0], 0);
         }
 
-      // bounding box is min,max pairs
-      for ( unsigned int i = 0; i < ( 2 * TInputImage::ImageDimension ); i += 2 )
+      const IndexValueType runStart = index[0];
+      IdentifierType       count = 0;
+      RealType             sum = NumericTraits< RealType >::ZeroValue();
+      RealType             sumOfSquares = NumericTraits< RealType >::ZeroValue();
+      RealType             minimum = labelStats.m_Minimum;
+      RealType             maximum = labelStats.m_Maximum;
+      do
         {
-        const IndexType & index = it.GetIndex();
-        if ( labelStats.m_BoundingBox[i] > index[i / 2] )
+        const auto value = static_cast< RealType >( it.Get() );
+        minimum = value < minimum ? value : minimum;
+        maximum = value > maximum ? value : maximum;
+        sum += value;
+        sumOfSquares += value * value;
+        ++count;
+
+        // if enabled, update the histogram for this label
+        if ( binHistogram )
           {
-          labelStats.m_BoundingBox[i] = index[i / 2];
+          histogramMeasurement[0] = value;
+          if ( binHistogram->GetIndex(histogramMeasurement, histogramIndex) )
+            {
+            ++labelStats.m_Frequencies[histogramIndex[0]];
+            }
           }
-        if ( labelStats.m_BoundingBox[i + 1] < index[i / 2] )
-          {
-          labelStats.m_BoundingBox[i + 1] = index[i / 2];
-          }
-        }
 
-      labelStats.m_Sum += value;
-      labelStats.m_SumOfSquares += ( value * value );
-      labelStats.m_Count++;
-
-      // if enabled, update the histogram for this label
-      if ( m_UseHistograms )
+        ++labelIt;
+        ++it;
+        }
+      while ( !it.IsAtEndOfLine() && labelIt.Get() == label );
+
+      labelStats.m_Count += count;
+      labelStats.m_Sum += sum;
+      labelStats.m_SumOfSquares += sumOfSquares;
+      labelStats.m_Minimum = minimum;
+      labelStats.m_Maximum = maximum;
+
+      // bounding box of the run
+      index[0] = runStart + static_cast< IndexValueType >( count ) - 1;
+      labelStats.m_MinimumIndex[0] = std::min(labelStats.m_MinimumIndex[0], runStart);
+      labelStats.m_MaximumIndex[0] = std::max(labelStats.m_MaximumIndex[0], index[0]);
+      for ( unsigned int i = 1; i < ImageDimension; ++i )
         {
-        histogramMeasurement[0] = value;
-        labelStats.m_Histogram->GetIndex(histogramMeasurement, histogramIndex);
-        labelStats.m_Histogram->IncreaseFrequencyOfIndex(histogramIndex, 1);
+        labelStats.m_MinimumIndex[i] = std::min(labelStats.m_MinimumIndex[i], index[i]);
+        labelStats.m_MaximumIndex[i] = std::max(labelStats.m_MaximumIndex[i], index[i]);
         }
-
-
-      ++labelIt;
-      ++it;
+      ++index[0];
       }
     labelIt.NextLine();
     it.NextLine();
     progress.CompletedPixel();
     }
-
 }
 
 template< typename TInputImage, typename TLabelImage >
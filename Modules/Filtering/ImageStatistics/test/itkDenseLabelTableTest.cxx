@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkDenseLabelTable.h"
+#include "itkLabelStatisticsImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+// Check the dense and the hash map storage of the table, and that the
+// statistics of LabelStatisticsImageFilter do not depend on the storage or
+// on the number of threads.
+
+namespace
+{
+
+using TableType = itk::DenseLabelTable< int, unsigned int >;
+
+bool
+TestTable( int minimum, int maximum, bool expectedDense )
+{
+  itk::MultiThreaderBase::Pointer multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->SetNumberOfThreads( 3 );
+
+  std::vector< TableType > tables( 5 );
+  for ( unsigned int i = 0; i < tables.size(); ++i )
+    {
+    tables[i].Initialize( minimum, maximum, 0, tables.size() );
+    if ( tables[i].IsDense() != expectedDense )
+      {
+      std::cerr << "Unexpected storage for range " << minimum << " " << maximum << std::endl;
+      return false;
+      }
+    // table i counts the labels minimum + i * j once, and maximum twice
+    for ( int label = minimum + static_cast< int >( i ); label < maximum; label += 1 + static_cast< int >( i ) )
+      {
+      ++tables[i][label];
+      }
+    tables[i][maximum] += 2;
+    }
+
+  TableType::Reduce( tables, []( unsigned int & value, unsigned int other ) { value += other; }, multiThreader );
+
+  unsigned int numberOfLabels = 0;
+  bool         success = true;
+  int          previousLabel = minimum - 1;
+  tables[0].Visit( [&]( int label, unsigned int count )
+    {
+    unsigned int expected = label == maximum ? 10 : 0;
+    for ( int i = 0; i < 5; ++i )
+      {
+      if ( label != maximum && ( label - minimum - i ) >= 0 && ( label - minimum - i ) % ( 1 + i ) == 0 )
+        {
+        ++expected;
+        }
+      }
+    if ( count != expected || ( expectedDense && label <= previousLabel ) )
+      {
+      std::cerr << "Label " << label << " counted " << count << " times instead of " << expected << std::endl;
+      success = false;
+      }
+    previousLabel = label;
+    ++numberOfLabels;
+    } );
+  if ( numberOfLabels != static_cast< unsigned int >( maximum - minimum + 1 ) )
+    {
+    std::cerr << numberOfLabels << " labels instead of " << maximum - minimum + 1 << std::endl;
+    success = false;
+    }
+  return success;
+}
+
+// Statistics of an image whose labels are offset by labelOffset
+template< typename TFilter >
+typename TFilter::Pointer
+ComputeStatistics( int labelOffset, unsigned int numberOfThreads )
+{
+  using ImageType = itk::Image< short, 3 >;
+  using LabelImageType = itk::Image< int, 3 >;
+
+  ImageType::SizeType size = { { 41, 23, 7 } };
+  ImageType::Pointer  image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  LabelImageType::Pointer labelImage = LabelImageType::New();
+  labelImage->SetRegions( size );
+  labelImage->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< LabelImageType > labelIt( labelImage, labelImage->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it, ++labelIt )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    it.Set( static_cast< short >( ( index[0] * 7 + index[1] * 13 + index[2] * 29 ) % 101 - 20 ) );
+    labelIt.Set( labelOffset * ( index[0] / 5 % 3 ) + index[1] / 4 + index[2] % 2 );
+    }
+
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput( image );
+  filter->SetLabelInput( labelImage );
+  filter->SetNumberOfThreads( numberOfThreads );
+  filter->SetHistogramParameters( 12, -20, 80 );
+  filter->Update();
+  return filter;
+}
+
+}
+
+int itkDenseLabelTableTest( int, char *[] )
+{
+  bool success = true;
+  success &= TestTable( -3, 40, true );
+  success &= TestTable( 7, 7, true );
+  success &= TestTable( -3, 200000, false );
+
+  // The largest range is dense for one table, but not for more tables than
+  // the memory budget allows.
+  TableType table;
+  table.Initialize( 0, TableType::MaximumDenseRange - 1, 0 );
+  TEST_EXPECT_TRUE( table.IsDense() );
+  const itk::SizeValueType tooManyTables =
+    TableType::MaximumDenseMemory / ( TableType::MaximumDenseRange * ( sizeof( unsigned int ) + 1 ) ) + 1;
+  table.Initialize( 0, TableType::MaximumDenseRange - 1, 0, tooManyTables );
+  TEST_EXPECT_TRUE( !table.IsDense() );
+  ++table[12345];
+  TEST_EXPECT_EQUAL( table[12345], 1u );
+
+  // a label offset of 1000 keeps the dense tables, 1000000 does not
+  using FilterType = itk::LabelStatisticsImageFilter< itk::Image< short, 3 >, itk::Image< int, 3 > >;
+  for ( unsigned int numberOfThreads = 1; numberOfThreads <= 3; numberOfThreads += 2 )
+    {
+    FilterType::Pointer dense = ComputeStatistics< FilterType >( 1000, numberOfThreads );
+    FilterType::Pointer sparse = ComputeStatistics< FilterType >( 1000000, numberOfThreads );
+    TEST_EXPECT_EQUAL( dense->GetNumberOfLabels(), sparse->GetNumberOfLabels() );
+    for ( auto label : dense->GetValidLabelValues() )
+      {
+      const int sparseLabel = label % 1000 + ( label / 1000 ) * 1000000;
+      TEST_EXPECT_TRUE( sparse->HasLabel( sparseLabel ) );
+      TEST_EXPECT_EQUAL( dense->GetCount( label ), sparse->GetCount( sparseLabel ) );
+      TEST_EXPECT_EQUAL( dense->GetMinimum( label ), sparse->GetMinimum( sparseLabel ) );
+      TEST_EXPECT_EQUAL( dense->GetMaximum( label ), sparse->GetMaximum( sparseLabel ) );
+      TEST_EXPECT_EQUAL( dense->GetSum( label ), sparse->GetSum( sparseLabel ) );
+      TEST_EXPECT_EQUAL( dense->GetMedian( label ), sparse->GetMedian( sparseLabel ) );
+      TEST_EXPECT_TRUE( itk::Math::FloatAlmostEqual( dense->GetVariance( label ),
+                                                     sparse->GetVariance( sparseLabel ), 4, 1e-9 ) );
+      TEST_EXPECT_TRUE( dense->GetBoundingBox( label ) == sparse->GetBoundingBox( sparseLabel ) );
+      }
+    }
+
+  if ( !success )
+    {
+    std::cout << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
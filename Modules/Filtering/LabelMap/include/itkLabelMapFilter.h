@@ -107,6 +107,10 @@ protected:
 
   void AfterThreadedGenerateData() override;
 
+  /** Run ThreadedProcessLabelObject() for all the label objects, distributed
+   * among the threads by MultiThreaderBase::ParallelizeArray(). */
+  void GenerateData() override;
+
   void DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
 
   //derived classes call this as inherited so we must delegate to DynamicThreadedGenerateData
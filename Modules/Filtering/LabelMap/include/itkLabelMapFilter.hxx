@@ -100,6 +100,36 @@ LabelMapFilter< TInputImage, TOutputImage >
   this->UpdateProgress(1.0);
 }
 
+template< typename TInputImage, typename TOutputImage >
+void
+LabelMapFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  // Call a method that can be overriden by a subclass to allocate
+  // memory for the filter's outputs
+  this->AllocateOutputs();
+
+  this->BeforeThreadedGenerateData();
+
+  // Collect the label objects up front: threads then pick them by index
+  // instead of sharing an iterator protected by a mutex.
+  InputImageType * labelMap = this->GetLabelMap();
+  std::vector< LabelObjectType * > labelObjects;
+  labelObjects.reserve( labelMap->GetNumberOfLabelObjects() );
+  for ( typename InputImageType::Iterator it( labelMap ); !it.IsAtEnd(); ++it )
+    {
+    labelObjects.push_back( it.GetLabelObject() );
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->ParallelizeArray( 0, labelObjects.size(),
+      [this, &labelObjects]( SizeValueType i )
+        { this->ThreadedProcessLabelObject( labelObjects[i] ); }, this );
+  m_NumberOfLabelObjectsProcessed = labelObjects.size();
+
+  this->AfterThreadedGenerateData();
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 LabelMapFilter< TInputImage, TOutputImage >
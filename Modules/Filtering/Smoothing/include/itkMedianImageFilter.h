@@ -20,6 +20,7 @@
 
 #include "itkBoxImageFilter.h"
 #include "itkImage.h"
+#include <type_traits>
 
 namespace itk
 {
@@ -35,6 +36,17 @@ namespace itk
  * This filter requires that the input pixel type provides an operator<()
  * (LessThan Comparable).
  *
+ * For integer pixels, the inner neighborhoods are processed several pixels
+ * at a time: the neighborhoods of consecutive pixels are reduced to their
+ * median by a network of min/max operations, which the compiler can
+ * vectorize. For 8 and 16-bit integer pixels and large radii, the median
+ * is instead found in a histogram of the neighborhood which slides along
+ * the image lines. For 8-bit pixels, the histogram is the sum of column
+ * histograms, as described by Perreault and Hebert, "Median Filtering in
+ * Constant Time", IEEE Transactions on Image Processing, 2007, hence the
+ * cost of the median of a 2D image does not depend on the radius. The
+ * result does not depend on the algorithm.
+ *
  * \sa Image
  * \sa Neighborhood
  * \sa NeighborhoodOperator
@@ -111,6 +123,37 @@ protected:
    *     ImageToImageFilter::GenerateData() */
   void DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
 
+private:
+  /** Whether the pixels are integers stored in images, which are accessed
+   * through their buffers. Compilers vectorize the min/max operations of
+   * integers, but not the ones of floating point values, which depend on
+   * the handling of NaN. */
+  using IntegerPixelTag = std::integral_constant< bool,
+    std::is_integral< InputPixelType >::value && !std::is_same< InputPixelType, bool >::value
+    && std::is_same< InputImageType, Image< InputPixelType, InputImageDimension > >::value
+    && std::is_same< OutputImageType, Image< OutputPixelType, OutputImageDimension > >::value >;
+
+  /** Whether the median may be found in a histogram of the neighborhood. */
+  using HistogramPixelTag = std::integral_constant< bool,
+    IntegerPixelTag::value && sizeof( InputPixelType ) <= 2 >;
+
+  /** Compute the median of the neighborhoods with a neighborhood iterator,
+   * for any pixel type. */
+  void NeighborhoodMedian(const OutputImageRegionType & face);
+
+  /** Compute the median of the neighborhoods with selection networks in
+   * the inner region, and with a neighborhood iterator on the boundary. */
+  void SelectionMedian(const OutputImageRegionType & outputRegionForThread, std::true_type);
+  void SelectionMedian(const OutputImageRegionType & outputRegionForThread, std::false_type);
+
+  /** Compute the median of the neighborhoods in a sliding histogram. */
+  void HistogramMedian(const OutputImageRegionType & outputRegionForThread, std::true_type);
+  void HistogramMedian(const OutputImageRegionType &, std::false_type) {}
+
+  /** The sliding histogram of 8-bit pixels is a sum of column histograms,
+   * the one of 16-bit pixels is updated pixel by pixel. */
+  void ColumnHistogramMedian(const OutputImageRegionType & outputRegionForThread);
+  void PixelHistogramMedian(const OutputImageRegionType & outputRegionForThread);
 };
 } // end namespace itk
 
@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 namespace itk
 {
@@ -43,14 +44,37 @@ void
 MedianImageFilter< TInputImage, TOutputImage >
 ::DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread)
 {
-  // Allocate output
-  typename OutputImageType::Pointer output = this->GetOutput();
-  typename  InputImageType::ConstPointer input  = this->GetInput();
+  SizeValueType neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < InputImageDimension; ++d )
+    {
+    neighborhoodSize *= 2 * this->GetRadius()[d] + 1;
+    }
 
-  // Find the data-set boundary "faces"
-  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType > bC;
-  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType >::FaceListType
-  faceList = bC( input, outputRegionForThread, this->GetRadius() );
+  // The cost of the selection networks grows with the square of the
+  // neighborhood size. Measured on random images, the histograms are faster
+  // above the 3x3x3 and 5x5 neighborhoods, and std::nth_element is about as
+  // fast as the networks of 16-bit pixels for the 5x5x5 neighborhood.
+  if ( HistogramPixelTag::value && neighborhoodSize > 27 )
+    {
+    this->HistogramMedian( outputRegionForThread, HistogramPixelTag() );
+    }
+  else if ( neighborhoodSize <= 125 )
+    {
+    this->SelectionMedian( outputRegionForThread, IntegerPixelTag() );
+    }
+  else
+    {
+    this->SelectionMedian( outputRegionForThread, std::false_type() );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::NeighborhoodMedian(const OutputImageRegionType & face)
+{
+  OutputImageType *    output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
 
   // All of our neighborhoods have an odd number of pixels, so there is
   // always a median index (if there where an even number of pixels
@@ -58,35 +82,494 @@ MedianImageFilter< TInputImage, TOutputImage >
 
   ZeroFluxNeumannBoundaryCondition< InputImageType > nbc;
   std::vector< InputPixelType >                      pixels;
+
+  ImageRegionIterator< OutputImageType > it = ImageRegionIterator< OutputImageType >(output, face);
+
+  ConstNeighborhoodIterator< InputImageType > bit =
+    ConstNeighborhoodIterator< InputImageType >(this->GetRadius(), input, face);
+  bit.OverrideBoundaryCondition(&nbc);
+  bit.GoToBegin();
+  const unsigned int neighborhoodSize = bit.Size();
+  const unsigned int medianPosition = neighborhoodSize / 2;
+  while ( !bit.IsAtEnd() )
+    {
+    // collect all the pixels in the neighborhood, note that we use
+    // GetPixel on the NeighborhoodIterator to honor the boundary conditions
+    pixels.resize(neighborhoodSize);
+    for ( unsigned int i = 0; i < neighborhoodSize; ++i )
+      {
+      pixels[i] = ( bit.GetPixel(i) );
+      }
+
+    // get the median value
+    const typename std::vector< InputPixelType >::iterator medianIterator = pixels.begin() + medianPosition;
+    std::nth_element( pixels.begin(), medianIterator, pixels.end() );
+    it.Set( static_cast< typename OutputImageType::PixelType >( *medianIterator ) );
+
+    ++bit;
+    ++it;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::SelectionMedian(const OutputImageRegionType & outputRegionForThread, std::false_type)
+{
+  // Find the data-set boundary "faces"
+  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType > bC;
+  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType >::FaceListType
+  faceList = bC( this->GetInput(), outputRegionForThread, this->GetRadius() );
+
   // Process each of the boundary faces.  These are N-d regions which border
   // the edge of the buffer.
   for ( auto fit = faceList.begin(); fit != faceList.end(); ++fit )
     {
-    ImageRegionIterator< OutputImageType > it = ImageRegionIterator< OutputImageType >(output, *fit);
+    this->NeighborhoodMedian(*fit);
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::SelectionMedian(const OutputImageRegionType & outputRegionForThread, std::true_type)
+{
+  OutputImageType *    output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
+
+  // The first face is the inner region, where the neighborhoods are inside
+  // the buffer. The other faces are processed with the boundary condition.
+  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType > bC;
+  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType >::FaceListType
+  faceList = bC( input, outputRegionForThread, this->GetRadius() );
+  const OutputImageRegionType inner = faceList.front();
+  for ( auto fit = ++faceList.begin(); fit != faceList.end(); ++fit )
+    {
+    this->NeighborhoodMedian(*fit);
+    }
+  if ( inner.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  // Buffer offsets of the neighbors
+  Neighborhood< InputPixelType, InputImageDimension > neighborhood;
+  neighborhood.SetRadius( this->GetRadius() );
+  const SizeValueType neighborhoodSize = neighborhood.Size();
+  std::vector< OffsetValueType > neighborOffsets( neighborhoodSize, 0 );
+  for ( SizeValueType i = 0; i < neighborhoodSize; ++i )
+    {
+    for ( unsigned int d = 0; d < InputImageDimension; ++d )
+      {
+      neighborOffsets[i] += neighborhood.GetOffset(i)[d] * input->GetOffsetTable()[d];
+      }
+    }
+
+  // The neighborhoods of Lanes consecutive pixels are copied in the rows of
+  // a table, each operation of the network then applies to all the lanes.
+  constexpr SizeValueType Lanes = 16;
+  std::vector< InputPixelType > values( neighborhoodSize * Lanes );
+  auto orderLanes = [](InputPixelType *low, InputPixelType *high)
+    {
+    InputPixelType minima[Lanes];
+    InputPixelType maxima[Lanes];
+    for ( SizeValueType l = 0; l < Lanes; ++l )
+      {
+      minima[l] = high[l] < low[l] ? high[l] : low[l];
+      maxima[l] = high[l] < low[l] ? low[l] : high[l];
+      }
+    std::copy( minima, minima + Lanes, low );
+    std::copy( maxima, maxima + Lanes, high );
+    };
 
-    ConstNeighborhoodIterator< InputImageType > bit =
-      ConstNeighborhoodIterator< InputImageType >(this->GetRadius(), input, *fit);
-    bit.OverrideBoundaryCondition(&nbc);
-    bit.GoToBegin();
-    const unsigned int neighborhoodSize = bit.Size();
-    const unsigned int medianPosition = neighborhoodSize / 2;
-    while ( !bit.IsAtEnd() )
+  const SizeValueType lineLength = inner.GetSize(0);
+  const SizeValueType numberOfLines = inner.GetNumberOfPixels() / lineLength;
+  for ( SizeValueType line = 0; line < numberOfLines; ++line )
+    {
+    typename InputImageType::IndexType index = inner.GetIndex();
+    SizeValueType                      remainder = line;
+    for ( unsigned int d = 1; d < InputImageDimension; ++d )
       {
-      // collect all the pixels in the neighborhood, note that we use
-      // GetPixel on the NeighborhoodIterator to honor the boundary conditions
-      pixels.resize(neighborhoodSize);
-      for ( unsigned int i = 0; i < neighborhoodSize; ++i )
+      index[d] += static_cast< IndexValueType >( remainder % inner.GetSize(d) );
+      remainder /= inner.GetSize(d);
+      }
+    const InputPixelType *inputLine = input->GetBufferPointer() + input->ComputeOffset(index);
+    OutputPixelType *     outputLine = output->GetBufferPointer() + output->ComputeOffset(index);
+
+    for ( SizeValueType x = 0; x < lineLength; x += Lanes )
+      {
+      // The lanes past the end of the line repeat the last pixel.
+      const SizeValueType count = std::min( Lanes, lineLength - x );
+      for ( SizeValueType i = 0; i < neighborhoodSize; ++i )
         {
-        pixels[i] = ( bit.GetPixel(i) );
+        const InputPixelType *neighbors = inputLine + x + neighborOffsets[i];
+        InputPixelType *      row = &values[i * Lanes];
+        std::copy( neighbors, neighbors + count, row );
+        std::fill( row + count, row + Lanes, neighbors[count - 1] );
         }
 
-      // get the median value
-      const typename std::vector< InputPixelType >::iterator medianIterator = pixels.begin() + medianPosition;
-      std::nth_element( pixels.begin(), medianIterator, pixels.end() );
-      it.Set( static_cast< typename OutputImageType::PixelType >( *medianIterator ) );
+      // Forgetful selection: the minimum and the maximum of more than half
+      // of the neighborhood cannot be its median, they are replaced by one
+      // of the remaining neighbors until a single value remains.
+      SizeValueType first = 0;
+      SizeValueType last = std::min( neighborhoodSize / 2 + 2, neighborhoodSize );
+      while ( last - first > 1 )
+        {
+        for ( SizeValueType i = first + 1; i < last; ++i )
+          {
+          orderLanes( &values[first * Lanes], &values[i * Lanes] );
+          }
+        for ( SizeValueType i = first + 2; i < last; ++i )
+          {
+          orderLanes( &values[i * Lanes], &values[( first + 1 ) * Lanes] );
+          }
+        first += 2;
+        if ( last < neighborhoodSize )
+          {
+          ++last;
+          }
+        }
 
-      ++bit;
-      ++it;
+      for ( SizeValueType l = 0; l < count; ++l )
+        {
+        outputLine[x + l] = static_cast< OutputPixelType >( values[first * Lanes + l] );
+        }
+      }
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::HistogramMedian(const OutputImageRegionType & outputRegionForThread, std::true_type)
+{
+  if ( sizeof( InputPixelType ) == 1 && InputImageDimension > 1 )
+    {
+    this->ColumnHistogramMedian(outputRegionForThread);
+    }
+  else
+    {
+    this->PixelHistogramMedian(outputRegionForThread);
+    }
+}
+
+namespace MedianImageFilterDetail
+{
+/** Buffer offsets of the coordinates of a dimension, from the start of a
+ * region minus a radius to its end plus the radius, clamped to a buffer as
+ * done by ZeroFluxNeumannBoundaryCondition. */
+template< typename TImage >
+std::vector< OffsetValueType >
+ClampedOffsets(const TImage *image, const typename TImage::RegionType & region,
+               const typename TImage::SizeType & radius, unsigned int d)
+{
+  const typename TImage::RegionType & buffer = image->GetBufferedRegion();
+  const IndexValueType                bufferEnd = buffer.GetIndex(d) + static_cast< IndexValueType >( buffer.GetSize(d) ) - 1;
+  std::vector< OffsetValueType >      offsets( region.GetSize(d) + 2 * radius[d] );
+  for ( SizeValueType i = 0; i < offsets.size(); ++i )
+    {
+    const IndexValueType c = region.GetIndex(d) - static_cast< IndexValueType >( radius[d] ) + static_cast< IndexValueType >( i );
+    offsets[i] = ( std::min( std::max( c, buffer.GetIndex(d) ), bufferEnd ) - buffer.GetIndex(d) ) * image->GetOffsetTable()[d];
+    }
+  return offsets;
+}
+
+/** Offsets of the pixels of a box around the index \c position of the
+ * dimensions firstDimension and above, in the clamped offsets. */
+template< unsigned int VDimension >
+void
+BoxOffsets(const std::vector< OffsetValueType > *clampedOffsets, const SizeValueType *position,
+           const SizeValueType *radius, unsigned int firstDimension, std::vector< OffsetValueType > & offsets)
+{
+  offsets.assign( 1, 0 );
+  for ( unsigned int d = firstDimension; d < VDimension; ++d )
+    {
+    const SizeValueType            width = 2 * radius[d] + 1;
+    std::vector< OffsetValueType > box;
+    box.reserve( offsets.size() * width );
+    for ( SizeValueType i = 0; i < width; ++i )
+      {
+      for ( OffsetValueType offset : offsets )
+        {
+        box.push_back( offset + clampedOffsets[d][position[d] + i] );
+        }
+      }
+    offsets.swap(box);
+    }
+}
+} // end namespace MedianImageFilterDetail
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::ColumnHistogramMedian(const OutputImageRegionType & outputRegionForThread)
+{
+  OutputImageType *    output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
+  const InputSizeType   radius = this->GetRadius();
+  const OutputImageRegionType & region = outputRegionForThread;
+
+  std::vector< OffsetValueType > clampedOffsets[InputImageDimension];
+  for ( unsigned int d = 0; d < InputImageDimension; ++d )
+    {
+    clampedOffsets[d] = MedianImageFilterDetail::ClampedOffsets( input, region, radius, d );
+    }
+
+  // Histograms of 256 bins, grouped in 16 coarse bins. Each column counts
+  // the pixels of a neighborhood slice orthogonal to the lines.
+  constexpr unsigned int Bins = 256;
+  constexpr unsigned int CoarseBins = 16;
+  constexpr unsigned int HistogramSize = Bins + CoarseBins;
+  const OffsetValueType  minimum = std::numeric_limits< InputPixelType >::min();
+  const SizeValueType    lineLength = region.GetSize(0);
+  const SizeValueType    numberOfColumns = lineLength + 2 * radius[0];
+  std::vector< unsigned int > columns( numberOfColumns * HistogramSize );
+  std::vector< unsigned int > kernel( HistogramSize );
+  std::vector< SizeValueType > fineStart( CoarseBins );
+  const SizeValueType          kernelWidth = 2 * radius[0] + 1;
+  SizeValueType                rank = 1;
+  for ( unsigned int d = 0; d < InputImageDimension; ++d )
+    {
+    rank *= 2 * radius[d] + 1;
+    }
+  rank /= 2;
+
+  const InputPixelType *buffer = input->GetBufferPointer();
+  auto updateColumns = [&](OffsetValueType rowOffset, const std::vector< OffsetValueType > & sliceOffsets,
+                           unsigned int increment)
+    {
+    for ( SizeValueType c = 0; c < numberOfColumns; ++c )
+      {
+      unsigned int *             column = &columns[c * HistogramSize];
+      const InputPixelType *     pixels = buffer + clampedOffsets[0][c] + rowOffset;
+      for ( OffsetValueType offset : sliceOffsets )
+        {
+        const auto bin = static_cast< SizeValueType >( pixels[offset] - minimum );
+        column[bin] += increment;
+        column[Bins + bin / CoarseBins] += increment;
+        }
+      }
+    };
+
+  // The slices orthogonal to the lines and to the rows are constant along
+  // the rows: the columns are updated at each row by the slices leaving and
+  // entering the neighborhood.
+  SizeValueType                  position[InputImageDimension] = {};
+  std::vector< OffsetValueType > sliceOffsets;
+  const SizeValueType            numberOfRows = region.GetSize(1);
+  const SizeValueType            numberOfSlices = region.GetNumberOfPixels() / ( lineLength * numberOfRows );
+  for ( SizeValueType slice = 0; slice < numberOfSlices; ++slice )
+    {
+    SizeValueType remainder = slice;
+    for ( unsigned int d = 2; d < InputImageDimension; ++d )
+      {
+      position[d] = remainder % region.GetSize(d);
+      remainder /= region.GetSize(d);
+      }
+    MedianImageFilterDetail::BoxOffsets< InputImageDimension >( clampedOffsets, position, radius.m_InternalArray,
+                                                                 2, sliceOffsets );
+
+    std::fill( columns.begin(), columns.end(), 0 );
+    for ( SizeValueType y = 0; y < 2 * radius[1] + 1; ++y )
+      {
+      updateColumns( clampedOffsets[1][y], sliceOffsets, 1 );
+      }
+    for ( SizeValueType y = 0; y < numberOfRows; ++y )
+      {
+      if ( y > 0 )
+        {
+        updateColumns( clampedOffsets[1][y - 1], sliceOffsets, -1 );
+        updateColumns( clampedOffsets[1][y + 2 * radius[1]], sliceOffsets, 1 );
+        }
+
+      typename OutputImageType::IndexType index = region.GetIndex();
+      index[1] += static_cast< IndexValueType >( y );
+      for ( unsigned int d = 2; d < InputImageDimension; ++d )
+        {
+        index[d] += static_cast< IndexValueType >( position[d] );
+        }
+      OutputPixelType *outputLine = output->GetBufferPointer() + output->ComputeOffset(index);
+
+      // The coarse bins of the neighborhood are updated at each pixel, its
+      // fine bins only when the median is searched in them: fineStart holds
+      // the first column counted in the fine bins of each coarse bin.
+      std::fill( kernel.begin(), kernel.end(), 0 );
+      std::fill( fineStart.begin(), fineStart.end(), NumericTraits< SizeValueType >::max() );
+      for ( SizeValueType c = 0; c < kernelWidth; ++c )
+        {
+        const unsigned int *column = &columns[c * HistogramSize];
+        for ( unsigned int b = Bins; b < HistogramSize; ++b )
+          {
+          kernel[b] += column[b];
+          }
+        }
+      for ( SizeValueType x = 0; x < lineLength; ++x )
+        {
+        if ( x > 0 )
+          {
+          const unsigned int *leaving = &columns[( x - 1 ) * HistogramSize];
+          const unsigned int *entering = &columns[( x + kernelWidth - 1 ) * HistogramSize];
+          for ( unsigned int b = Bins; b < HistogramSize; ++b )
+            {
+            kernel[b] += entering[b] - leaving[b];
+            }
+          }
+
+        unsigned int count = 0;
+        unsigned int coarse = 0;
+        while ( count + kernel[Bins + coarse] <= rank )
+          {
+          count += kernel[Bins + coarse++];
+          }
+
+        unsigned int *fine = &kernel[coarse * CoarseBins];
+        if ( fineStart[coarse] > x || 2 * ( x - fineStart[coarse] ) > kernelWidth )
+          {
+          std::fill( fine, fine + CoarseBins, 0 );
+          for ( SizeValueType c = x; c < x + kernelWidth; ++c )
+            {
+            const unsigned int *column = &columns[c * HistogramSize + coarse * CoarseBins];
+            for ( unsigned int b = 0; b < CoarseBins; ++b )
+              {
+              fine[b] += column[b];
+              }
+            }
+          }
+        else
+          {
+          for ( SizeValueType c = fineStart[coarse]; c < x; ++c )
+            {
+            const unsigned int *leaving = &columns[c * HistogramSize + coarse * CoarseBins];
+            const unsigned int *entering = &columns[( c + kernelWidth ) * HistogramSize + coarse * CoarseBins];
+            for ( unsigned int b = 0; b < CoarseBins; ++b )
+              {
+              fine[b] += entering[b] - leaving[b];
+              }
+            }
+          }
+        fineStart[coarse] = x;
+
+        unsigned int bin = coarse * CoarseBins;
+        while ( count + kernel[bin] <= rank )
+          {
+          count += kernel[bin++];
+          }
+        outputLine[x] = static_cast< OutputPixelType >( static_cast< InputPixelType >( bin + minimum ) );
+        }
+      }
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::PixelHistogramMedian(const OutputImageRegionType & outputRegionForThread)
+{
+  OutputImageType *    output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
+  const InputSizeType   radius = this->GetRadius();
+  const OutputImageRegionType & region = outputRegionForThread;
+
+  std::vector< OffsetValueType > clampedOffsets[InputImageDimension];
+  for ( unsigned int d = 0; d < InputImageDimension; ++d )
+    {
+    clampedOffsets[d] = MedianImageFilterDetail::ClampedOffsets( input, region, radius, d );
+    }
+
+  // Histogram of all the values, grouped in coarse bins. The median bin
+  // and the number of values below it are tracked as the neighborhood
+  // slides, the coarse bins are used to skip the empty parts of the
+  // histogram.
+  constexpr unsigned int Bits = 8 * sizeof( InputPixelType );
+  constexpr unsigned int CoarseShift = Bits / 2;
+  constexpr unsigned int Bins = 1u << Bits;
+  constexpr unsigned int CoarseMask = ( 1u << CoarseShift ) - 1;
+  const OffsetValueType  minimum = std::numeric_limits< InputPixelType >::min();
+  std::vector< unsigned int > fine( Bins, 0 );
+  std::vector< unsigned int > coarse( Bins >> CoarseShift, 0 );
+  SizeValueType                median = 0;
+  SizeValueType                belowMedian = 0;
+  SizeValueType                rank = 1;
+  for ( unsigned int d = 0; d < InputImageDimension; ++d )
+    {
+    rank *= 2 * radius[d] + 1;
+    }
+  rank /= 2;
+
+  const InputPixelType *buffer = input->GetBufferPointer();
+  auto updateHistogram = [&](const InputPixelType *pixels, const std::vector< OffsetValueType > & sliceOffsets,
+                             int increment)
+    {
+    for ( OffsetValueType offset : sliceOffsets )
+      {
+      const auto bin = static_cast< SizeValueType >( pixels[offset] - minimum );
+      fine[bin] += increment;
+      coarse[bin >> CoarseShift] += increment;
+      belowMedian += static_cast< SizeValueType >( bin < median ) * increment;
+      }
+    };
+
+  SizeValueType                  position[InputImageDimension] = {};
+  std::vector< OffsetValueType > sliceOffsets;
+  const SizeValueType            lineLength = region.GetSize(0);
+  const SizeValueType            numberOfLines = region.GetNumberOfPixels() / lineLength;
+  for ( SizeValueType line = 0; line < numberOfLines; ++line )
+    {
+    typename OutputImageType::IndexType index = region.GetIndex();
+    SizeValueType                       remainder = line;
+    for ( unsigned int d = 1; d < InputImageDimension; ++d )
+      {
+      position[d] = remainder % region.GetSize(d);
+      remainder /= region.GetSize(d);
+      index[d] += static_cast< IndexValueType >( position[d] );
+      }
+    MedianImageFilterDetail::BoxOffsets< InputImageDimension >( clampedOffsets, position, radius.m_InternalArray,
+                                                                 1, sliceOffsets );
+    OutputPixelType *outputLine = output->GetBufferPointer() + output->ComputeOffset(index);
+
+    for ( SizeValueType c = 0; c < 2 * radius[0] + 1; ++c )
+      {
+      updateHistogram( buffer + clampedOffsets[0][c], sliceOffsets, 1 );
+      }
+    for ( SizeValueType x = 0; x < lineLength; ++x )
+      {
+      if ( x > 0 )
+        {
+        updateHistogram( buffer + clampedOffsets[0][x - 1], sliceOffsets, -1 );
+        updateHistogram( buffer + clampedOffsets[0][x + 2 * radius[0]], sliceOffsets, 1 );
+        }
+
+      while ( belowMedian > rank )
+        {
+        if ( ( median & CoarseMask ) == 0 && belowMedian - coarse[( median >> CoarseShift ) - 1] > rank )
+          {
+          belowMedian -= coarse[( median >> CoarseShift ) - 1];
+          median -= CoarseMask + 1;
+          }
+        else
+          {
+          belowMedian -= fine[--median];
+          }
+        }
+      while ( belowMedian + fine[median] <= rank )
+        {
+        if ( ( median & CoarseMask ) == 0 && belowMedian + coarse[median >> CoarseShift] <= rank )
+          {
+          belowMedian += coarse[median >> CoarseShift];
+          median += CoarseMask + 1;
+          }
+        else
+          {
+          belowMedian += fine[median++];
+          }
+        }
+      outputLine[x] = static_cast< OutputPixelType >( static_cast< InputPixelType >( median + minimum ) );
+      }
+
+    // Empty the histogram for the next line.
+    for ( SizeValueType c = lineLength - 1; c < lineLength + 2 * radius[0]; ++c )
+      {
+      updateHistogram( buffer + clampedOffsets[0][c], sliceOffsets, -1 );
       }
     }
 }
@@ -0,0 +1,165 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMedianImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Compare the median filter to a direct computation of the median of the
+// neighborhoods, for the radii and pixel types processed by the selection
+// networks, the sliding histograms and the neighborhood iterator.
+
+namespace
+{
+
+template< typename TImage >
+bool
+TestRadius( const TImage * input, const typename TImage::SizeType & radius, unsigned int numberOfThreads )
+{
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+  using FilterType = itk::MedianImageFilter< ImageType, ImageType >;
+
+  std::cout << "Radius " << radius << ", pixel size " << sizeof( PixelType ) << ", " << numberOfThreads
+            << " threads" << std::endl;
+
+  // Filter a region inside the image, and the whole image.
+  typename ImageType::RegionType inner = input->GetLargestPossibleRegion();
+  inner.ShrinkByRadius( 2 );
+  const typename ImageType::RegionType regions[] = { inner, input->GetLargestPossibleRegion() };
+  for ( const auto & region : regions )
+    {
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( input );
+    filter->SetRadius( radius );
+    filter->SetNumberOfThreads( numberOfThreads );
+    filter->GetOutput()->SetRequestedRegion( region );
+    filter->Update();
+
+    // The boundary condition of the filter repeats the pixels of the edges.
+    const typename ImageType::RegionType & largest = input->GetLargestPossibleRegion();
+    std::vector< PixelType > neighbors;
+    itk::ImageRegionConstIteratorWithIndex< ImageType > it( filter->GetOutput(), region );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      typename ImageType::RegionType neighborhood;
+      for ( unsigned int d = 0; d < ImageType::ImageDimension; ++d )
+        {
+        neighborhood.SetIndex( d, it.GetIndex()[d] - static_cast< itk::IndexValueType >( radius[d] ) );
+        neighborhood.SetSize( d, 2 * radius[d] + 1 );
+        }
+      neighbors.clear();
+      for ( itk::SizeValueType i = 0; i < neighborhood.GetNumberOfPixels(); ++i )
+        {
+        typename ImageType::IndexType index = neighborhood.GetIndex();
+        itk::SizeValueType            remainder = i;
+        for ( unsigned int d = 0; d < ImageType::ImageDimension; ++d )
+          {
+          index[d] += static_cast< itk::IndexValueType >( remainder % neighborhood.GetSize( d ) );
+          remainder /= neighborhood.GetSize( d );
+          const itk::IndexValueType last =
+            largest.GetIndex( d ) + static_cast< itk::IndexValueType >( largest.GetSize( d ) ) - 1;
+          index[d] = std::min( std::max( index[d], largest.GetIndex( d ) ), last );
+          }
+        neighbors.push_back( input->GetPixel( index ) );
+        }
+      std::nth_element( neighbors.begin(), neighbors.begin() + neighbors.size() / 2, neighbors.end() );
+      if ( it.Get() != neighbors[neighbors.size() / 2] )
+        {
+        std::cerr << "Median " << +it.Get() << " instead of " << +neighbors[neighbors.size() / 2] << " at "
+                  << it.GetIndex() << " in region " << region << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+template< typename TPixel, unsigned int VDimension >
+bool
+TestPixelType( unsigned int size, const std::vector< unsigned int > & radii )
+{
+  using ImageType = itk::Image< TPixel, VDimension >;
+
+  typename ImageType::Pointer input = ImageType::New();
+  typename ImageType::IndexType index;
+  typename ImageType::SizeType imageSize;
+  for ( unsigned int d = 0; d < VDimension; ++d )
+    {
+    index[d] = 3 - static_cast< itk::IndexValueType >( d );
+    imageSize[d] = size + 5 * d;
+    }
+  input->SetRegions( typename ImageType::RegionType( index, imageSize ) );
+  input->Allocate();
+
+  // Smooth values with noise, over the whole range of the pixel type.
+  std::mt19937 generator( 7 );
+  std::uniform_real_distribution< double > noise( -0.2, 0.2 );
+  const double minimum = static_cast< double >( itk::NumericTraits< TPixel >::NonpositiveMin() );
+  const double maximum = static_cast< double >( itk::NumericTraits< TPixel >::max() );
+  itk::ImageRegionIteratorWithIndex< ImageType > it( input, input->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    double value = 0.5 + 0.3 * std::sin( 0.3 * it.GetIndex()[0] + 0.2 * it.GetIndex()[1] ) + noise( generator );
+    value = std::min( std::max( value, 0.0 ), 1.0 );
+    it.Set( static_cast< TPixel >( minimum + value * ( maximum - minimum ) ) );
+    }
+
+  bool success = true;
+  for ( unsigned int r : radii )
+    {
+    typename ImageType::SizeType radius;
+    radius.Fill( r );
+    success &= TestRadius( input.GetPointer(), radius, 1 );
+    success &= TestRadius( input.GetPointer(), radius, 3 );
+    }
+  // Anisotropic radius
+  typename ImageType::SizeType radius;
+  for ( unsigned int d = 0; d < VDimension; ++d )
+    {
+    radius[d] = 3 - d;
+    }
+  success &= TestRadius( input.GetPointer(), radius, 2 );
+  return success;
+}
+
+}
+
+int itkMedianImageFilterRadiusTest( int, char * [] )
+{
+  bool success = true;
+  success &= TestPixelType< unsigned char, 2 >( 21, { 0, 1, 2, 4, 9 } );
+  success &= TestPixelType< signed char, 2 >( 21, { 1, 4 } );
+  success &= TestPixelType< short, 2 >( 21, { 1, 2, 4, 9 } );
+  success &= TestPixelType< unsigned short, 2 >( 21, { 1, 4 } );
+  success &= TestPixelType< float, 2 >( 21, { 1, 2, 4 } );
+  success &= TestPixelType< unsigned char, 3 >( 11, { 1, 2, 3 } );
+  success &= TestPixelType< short, 3 >( 11, { 1, 2, 3 } );
+  success &= TestPixelType< double, 3 >( 11, { 1, 3 } );
+  success &= TestPixelType< unsigned short, 1 >( 40, { 2, 20 } );
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
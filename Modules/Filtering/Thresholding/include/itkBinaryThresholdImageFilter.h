@@ -111,6 +111,21 @@ public:
     return m_OutsideValue;
   }
 
+  /** Batch version of operator(), see Functor::UnaryBatchFunctorTraits.
+   * Written without branches, so that it compiles to vector blends. */
+  void ProcessBatch(const TInput * A, TOutput * output, SizeValueType count) const
+  {
+    const TInput  lower = m_LowerThreshold;
+    const TInput  upper = m_UpperThreshold;
+    const TOutput inside = m_InsideValue;
+    const TOutput outside = m_OutsideValue;
+    for ( SizeValueType i = 0; i < count; ++i )
+      {
+      const TInput a = A[i];
+      output[i] = ( lower <= a && a <= upper ) ? inside : outside;
+      }
+  }
+
 private:
   TInput  m_LowerThreshold;
   TInput  m_UpperThreshold;
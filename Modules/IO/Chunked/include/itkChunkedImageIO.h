@@ -0,0 +1,157 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkChunkedImageIO_h
+#define itkChunkedImageIO_h
+#include "ITKIOChunkedExport.h"
+
+#include "itkStreamingImageIOBase.h"
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class ChunkedImageIO
+ *
+ * \brief ImageIO for a chunked image format, which reads and writes any
+ * region of an image without accessing the rest of the image.
+ *
+ * The image is split in a regular grid of chunks, like the Zarr and N5
+ * formats do. The ".cki" file is a small text header describing the
+ * image and the grid. Each chunk is stored, compressed independently,
+ * in its own file of a directory next to the header, named after the
+ * index of the chunk in the grid. A missing chunk file stands for a
+ * chunk of zeros.
+ *
+ * Reading a region only decompresses the chunks intersecting the region,
+ * and writing a region only compresses the chunks it intersects. The
+ * chunks are decompressed and compressed in parallel, using
+ * NumberOfCompressionThreads threads. Streamed writing and pasting are
+ * supported: a chunk partially covered by the written region is read,
+ * updated and written again.
+ *
+ * The chunks are compressed with zlib when UseCompression is on. Their
+ * size is set by ChunkSize when a new file is written; the chunks of an
+ * existing file keep the size stored in its header.
+ *
+ * \sa ImageFileWriter ImageFileReader StreamingImageIOBase
+ * \ingroup ITKIOChunked
+ */
+class ITKIOChunked_EXPORT ChunkedImageIO:public StreamingImageIOBase
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ChunkedImageIO);
+
+  /** Standard class type aliases. */
+  using Self = ChunkedImageIO;
+  using Superclass = StreamingImageIOBase;
+  using Pointer = SmartPointer< Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ChunkedImageIO, StreamingImageIOBase);
+
+  /** Set/Get the number of pixels along each dimension of the chunks of
+   * the files written. It is reduced to the size of the image along the
+   * dimensions where the image is smaller. Default is 64. */
+  itkSetClampMacro(ChunkSize, SizeValueType, 1, NumericTraits< SizeValueType >::max());
+  itkGetConstMacro(ChunkSize, SizeValueType);
+
+  /** Size of the chunks of the file read, or written last. */
+  const std::vector< SizeValueType > & GetChunkDimensions() const
+  {
+    return m_ChunkDimensions;
+  }
+
+  /*-------- This part of the interface deals with reading data. ------ */
+
+  /** Determine if the file can be read with this ImageIO implementation. */
+  bool CanReadFile(const char *) override;
+
+  /** Set the spacing and dimension information for the set filename. */
+  void ReadImageInformation() override;
+
+  /** Reads the data from disk into the memory buffer provided. */
+  void Read(void *buffer) override;
+
+  /*-------- This part of the interfaces deals with writing data. ----- */
+
+  /** Determine if the file can be written with this ImageIO
+   * implementation. */
+  bool CanWriteFile(const char *) override;
+
+  /** Writes the header of a new file, and removes its previous chunks. */
+  void WriteImageInformation() override;
+
+  /** Writes the data of the IORegion to disk from the memory buffer
+   * provided. */
+  void Write(const void *buffer) override;
+
+protected:
+  ChunkedImageIO();
+  ~ChunkedImageIO() override = default;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** The pixels are not stored after the header. */
+  SizeType GetHeaderSize() const override
+  {
+    return 0;
+  }
+
+private:
+  /** Information of the header which is not stored in ImageIOBase. */
+  struct ChunkLayout
+  {
+    std::vector< SizeValueType > chunkDimensions;
+    std::string                  chunkDirectory;
+    ByteOrder                    byteOrder;
+    bool                         compressed;
+  };
+
+  /** Parse a header. Reads the image information in this object if
+   * imageInformation is true, else only the chunk layout. */
+  void ReadHeader(const std::string & fileName, bool imageInformation, ChunkLayout & layout);
+
+  /** Set the chunk layout used to read or write the chunks. */
+  void SetChunkLayout(const ChunkLayout & layout);
+
+  /** Name of the file of a chunk, from its index in the grid. */
+  std::string GetChunkFileName(const std::vector< IndexValueType > & chunkIndex) const;
+
+  /** Read and decompress a chunk of \c size bytes. Returns false if the
+   * chunk file does not exist, and throws if it is corrupted. */
+  bool ReadChunk(const std::string & fileName, char *chunk, SizeValueType size) const;
+
+  /** Compress and write a chunk of \c size bytes. */
+  void WriteChunk(const std::string & fileName, const char *chunk, SizeValueType size) const;
+
+  /** Read or write the chunks intersecting the IORegion. */
+  void ProcessChunks(char *buffer, bool write);
+
+  SizeValueType m_ChunkSize;
+
+  std::vector< SizeValueType > m_ChunkDimensions;
+  std::string                  m_ChunkDirectory;
+  bool                         m_SwapChunkBytes;
+  bool                         m_CompressedChunks;
+};
+} // end namespace itk
+
+#endif // itkChunkedImageIO_h
@@ -0,0 +1,18 @@
+set(DOCUMENTATION "This module contains an ImageIO for a chunked image format.
+The image is split in a regular grid of chunks, each compressed
+independently in its own file, which allows to read and write any region
+of the image without accessing the rest of it.")
+
+itk_module(ITKIOChunked
+  ENABLE_SHARED
+  PRIVATE_DEPENDS
+    ITKIOImageBase
+    ITKZLIB
+  TEST_DEPENDS
+    ITKTestKernel
+    ITKImageFilterBase
+  FACTORY_NAMES
+    ImageIO::Chunked
+  DESCRIPTION
+    "${DOCUMENTATION}"
+)
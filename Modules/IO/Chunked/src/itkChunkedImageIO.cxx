@@ -0,0 +1,609 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkChunkedImageIO.h"
+#include "itkByteSwapper.h"
+#include "itkMultiThreaderBase.h"
+#include "itksys/SystemTools.hxx"
+#include "itk_zlib.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace itk
+{
+namespace
+{
+const char * const ChunkedImageSignature = "ITKChunkedImage 1";
+
+// A box of pixels, such as a chunk or a region, and a buffer holding it.
+struct PixelBox
+{
+  std::vector< IndexValueType > index;
+  std::vector< SizeValueType >  size;
+
+  SizeValueType GetNumberOfPixels() const
+  {
+    SizeValueType numberOfPixels = 1;
+    for ( auto s : size )
+      {
+      numberOfPixels *= s;
+      }
+    return numberOfPixels;
+  }
+
+  // Offset in pixels of a position in a buffer holding the box
+  SizeValueType GetOffset(const std::vector< IndexValueType > & position) const
+  {
+    SizeValueType offset = 0;
+    SizeValueType stride = 1;
+    for ( unsigned int i = 0; i < size.size(); ++i )
+      {
+      offset += static_cast< SizeValueType >( position[i] - index[i] ) * stride;
+      stride *= size[i];
+      }
+    return offset;
+  }
+};
+
+// Copy the pixels of a box between the buffers of two boxes containing it,
+// one line at a time.
+void CopyBox(const char *source, const PixelBox & sourceBox,
+             char *destination, const PixelBox & destinationBox,
+             const PixelBox & box, SizeValueType pixelSize)
+{
+  if ( box.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+  const auto                    dimension = static_cast< unsigned int >( box.size.size() );
+  const SizeValueType           lineSize = box.size[0] * pixelSize;
+  std::vector< IndexValueType > position = box.index;
+  for (;; )
+    {
+    std::memcpy(destination + destinationBox.GetOffset(position) * pixelSize,
+                source + sourceBox.GetOffset(position) * pixelSize, lineSize);
+    unsigned int i = 1;
+    for (; i < dimension; ++i )
+      {
+      if ( ++position[i] < box.index[i] + static_cast< IndexValueType >( box.size[i] ) )
+        {
+        break;
+        }
+      position[i] = box.index[i];
+      }
+    if ( i >= dimension )
+      {
+      return;
+      }
+    }
+}
+
+void SwapComponentBytes(char *data, SizeValueType size, SizeValueType componentSize)
+{
+  if ( componentSize < 2 )
+    {
+    return;
+    }
+  for ( char *component = data; component < data + size; component += componentSize )
+    {
+    std::reverse(component, component + componentSize);
+    }
+}
+
+std::string Trim(const std::string & text)
+{
+  const std::string::size_type first = text.find_first_not_of(" \t\r");
+  if ( first == std::string::npos )
+    {
+    return std::string();
+    }
+  return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// Parse exactly count values.
+template< typename T >
+bool ParseValues(const std::string & text, std::vector< T > & values, unsigned int count)
+{
+  std::istringstream stream(text);
+  values.resize(count);
+  for ( unsigned int i = 0; i < count; ++i )
+    {
+    if ( !( stream >> values[i] ) )
+      {
+      return false;
+      }
+    }
+  std::string remaining;
+  return !( stream >> remaining );
+}
+
+template< typename T >
+void WriteValues(std::ostream & os, const char *key, const std::vector< T > & values)
+{
+  os << key << " =";
+  for ( const auto & value : values )
+    {
+    os << ' ' << value;
+    }
+  os << '\n';
+}
+}
+
+ChunkedImageIO::ChunkedImageIO():
+  m_ChunkSize(64),
+  m_SwapChunkBytes(false),
+  m_CompressedChunks(false)
+{
+  this->AddSupportedReadExtension(".cki");
+  this->AddSupportedWriteExtension(".cki");
+}
+
+bool
+ChunkedImageIO::CanReadFile(const char *fileName)
+{
+  const std::string name = fileName;
+  if ( itksys::SystemTools::GetFilenameLastExtension(name) != ".cki" )
+    {
+    return false;
+    }
+  std::ifstream file(name.c_str());
+  std::string   line;
+  return std::getline(file, line) && Trim(line) == ChunkedImageSignature;
+}
+
+bool
+ChunkedImageIO::CanWriteFile(const char *fileName)
+{
+  return itksys::SystemTools::GetFilenameLastExtension(fileName) == ".cki";
+}
+
+void
+ChunkedImageIO::ReadHeader(const std::string & fileName, bool imageInformation, ChunkLayout & layout)
+{
+  std::ifstream file(fileName.c_str());
+  if ( !file )
+    {
+    itkExceptionMacro("Unable to open file: " << fileName);
+    }
+  std::string line;
+  if ( !std::getline(file, line) || Trim(line) != ChunkedImageSignature )
+    {
+    itkExceptionMacro("Not a chunked image file: " << fileName);
+    }
+  std::map< std::string, std::string > fields;
+  while ( std::getline(file, line) )
+    {
+    const std::string::size_type equal = line.find('=');
+    if ( equal != std::string::npos )
+      {
+      fields[Trim(line.substr(0, equal))] = Trim(line.substr(equal + 1));
+      }
+    }
+
+  std::vector< unsigned int > numberOfDimensions;
+  if ( !ParseValues(fields["NDims"], numberOfDimensions, 1) || numberOfDimensions[0] == 0 )
+    {
+    itkExceptionMacro("Invalid NDims in " << fileName);
+    }
+  const unsigned int dimension = numberOfDimensions[0];
+
+  std::vector< SizeValueType > dimensions;
+  if ( !ParseValues(fields["DimSize"], dimensions, dimension)
+       || !ParseValues(fields["ChunkSize"], layout.chunkDimensions, dimension)
+       || std::find(layout.chunkDimensions.begin(), layout.chunkDimensions.end(), 0)
+       != layout.chunkDimensions.end() )
+    {
+    itkExceptionMacro("Invalid DimSize or ChunkSize in " << fileName);
+    }
+
+  const std::string & byteOrder = fields["ByteOrder"];
+  if ( byteOrder != "BigEndian" && byteOrder != "LittleEndian" )
+    {
+    itkExceptionMacro("Invalid ByteOrder in " << fileName);
+    }
+  layout.byteOrder = byteOrder == "BigEndian" ? BigEndian : LittleEndian;
+  layout.compressed = fields["CompressedData"] == "True";
+
+  const std::string & chunkDirectory = fields["ChunkDirectory"];
+  if ( chunkDirectory.empty() )
+    {
+    itkExceptionMacro("Missing ChunkDirectory in " << fileName);
+    }
+  const std::string path = itksys::SystemTools::GetFilenamePath(fileName);
+  layout.chunkDirectory = path.empty() ? chunkDirectory : path + "/" + chunkDirectory;
+
+  if ( !imageInformation )
+    {
+    return;
+    }
+
+  const IOComponentType componentType = GetComponentTypeFromString(fields["ComponentType"]);
+  std::vector< unsigned int > numberOfComponents;
+  if ( componentType == UNKNOWNCOMPONENTTYPE
+       || !ParseValues(fields["NumberOfComponents"], numberOfComponents, 1) || numberOfComponents[0] == 0 )
+    {
+    itkExceptionMacro("Invalid ComponentType or NumberOfComponents in " << fileName);
+    }
+  std::vector< double > spacing;
+  std::vector< double > origin;
+  std::vector< double > direction;
+  if ( !ParseValues(fields["Spacing"], spacing, dimension)
+       || !ParseValues(fields["Origin"], origin, dimension)
+       || !ParseValues(fields["Direction"], direction, dimension * dimension) )
+    {
+    itkExceptionMacro("Invalid Spacing, Origin or Direction in " << fileName);
+    }
+
+  this->SetNumberOfDimensions(dimension);
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    this->SetDimensions(i, dimensions[i]);
+    this->SetSpacing(i, spacing[i]);
+    this->SetOrigin(i, origin[i]);
+    this->SetDirection(i, std::vector< double >(direction.begin() + i * dimension,
+                                                direction.begin() + ( i + 1 ) * dimension));
+    }
+  this->SetComponentType(componentType);
+  this->SetPixelType(GetPixelTypeFromString(fields["PixelType"]));
+  this->SetNumberOfComponents(numberOfComponents[0]);
+  this->SetByteOrder(layout.byteOrder);
+}
+
+void
+ChunkedImageIO::SetChunkLayout(const ChunkLayout & layout)
+{
+  const ByteOrder systemByteOrder = ByteSwapper< int >::SystemIsBigEndian() ? BigEndian : LittleEndian;
+
+  m_ChunkDimensions = layout.chunkDimensions;
+  m_ChunkDirectory = layout.chunkDirectory;
+  m_SwapChunkBytes = layout.byteOrder != systemByteOrder;
+  m_CompressedChunks = layout.compressed;
+}
+
+void
+ChunkedImageIO::ReadImageInformation()
+{
+  ChunkLayout layout;
+  this->ReadHeader(m_FileName, true, layout);
+  this->SetChunkLayout(layout);
+}
+
+void
+ChunkedImageIO::WriteImageInformation()
+{
+  const unsigned int dimension = this->GetNumberOfDimensions();
+
+  ChunkLayout layout;
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    layout.chunkDimensions.push_back(std::max< SizeValueType >(std::min< SizeValueType >(m_ChunkSize,
+                                                                                        this->GetDimensions(i)), 1));
+    }
+  const std::string chunkDirectory = itksys::SystemTools::GetFilenameWithoutLastExtension(m_FileName) + ".chunks";
+  const std::string path = itksys::SystemTools::GetFilenamePath(m_FileName);
+  layout.chunkDirectory = path.empty() ? chunkDirectory : path + "/" + chunkDirectory;
+  layout.byteOrder = ByteSwapper< int >::SystemIsBigEndian() ? BigEndian : LittleEndian;
+  layout.compressed = m_UseCompression;
+
+  // The chunks of a previous file would be read as part of the new one.
+  if ( itksys::SystemTools::FileIsDirectory(layout.chunkDirectory)
+       && !itksys::SystemTools::RemoveADirectory(layout.chunkDirectory) )
+    {
+    itkExceptionMacro("Unable to remove directory: " << layout.chunkDirectory);
+    }
+  if ( !itksys::SystemTools::MakeDirectory(layout.chunkDirectory) )
+    {
+    itkExceptionMacro("Unable to create directory: " << layout.chunkDirectory);
+    }
+
+  std::ofstream file(m_FileName.c_str());
+  if ( !file )
+    {
+    itkExceptionMacro("Unable to open file for writing: " << m_FileName);
+    }
+  std::vector< SizeValueType > dimensions;
+  std::vector< double >        spacing;
+  std::vector< double >        origin;
+  std::vector< double >        direction;
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    dimensions.push_back(this->GetDimensions(i));
+    spacing.push_back(this->GetSpacing(i));
+    origin.push_back(this->GetOrigin(i));
+    const std::vector< double > axis = this->GetDirection(i);
+    direction.insert(direction.end(), axis.begin(), axis.end());
+    }
+  file << std::setprecision(17);
+  file << ChunkedImageSignature << '\n';
+  file << "NDims = " << dimension << '\n';
+  WriteValues(file, "DimSize", dimensions);
+  WriteValues(file, "ChunkSize", layout.chunkDimensions);
+  file << "ComponentType = " << GetComponentTypeAsString(this->GetComponentType()) << '\n';
+  file << "PixelType = " << GetPixelTypeAsString(this->GetPixelType()) << '\n';
+  file << "NumberOfComponents = " << this->GetNumberOfComponents() << '\n';
+  file << "ByteOrder = " << ( layout.byteOrder == BigEndian ? "BigEndian" : "LittleEndian" ) << '\n';
+  file << "CompressedData = " << ( layout.compressed ? "True" : "False" ) << '\n';
+  WriteValues(file, "Spacing", spacing);
+  WriteValues(file, "Origin", origin);
+  WriteValues(file, "Direction", direction);
+  file << "ChunkDirectory = " << itksys::SystemTools::GetFilenameName(layout.chunkDirectory) << '\n';
+  file.close();
+  if ( file.fail() )
+    {
+    itkExceptionMacro("Unable to write file: " << m_FileName);
+    }
+
+  this->SetChunkLayout(layout);
+}
+
+void
+ChunkedImageIO::Read(void *buffer)
+{
+  ChunkLayout layout;
+  this->ReadHeader(m_FileName, false, layout);
+  this->SetChunkLayout(layout);
+
+  this->ProcessChunks(static_cast< char * >( buffer ), false);
+}
+
+void
+ChunkedImageIO::Write(const void *buffer)
+{
+  if ( !itksys::SystemTools::FileExists(m_FileName) || !this->RequestedToStream() )
+    {
+    this->WriteImageInformation();
+    }
+  else
+    {
+    // Streaming or pasting into an existing file, which
+    // GetActualNumberOfSplitsForWriting checked is compatible.
+    ChunkLayout layout;
+    this->ReadHeader(m_FileName, false, layout);
+    this->SetChunkLayout(layout);
+    }
+
+  this->ProcessChunks(static_cast< char * >( const_cast< void * >( buffer ) ), true);
+}
+
+std::string
+ChunkedImageIO::GetChunkFileName(const std::vector< IndexValueType > & chunkIndex) const
+{
+  std::ostringstream name;
+  name << m_ChunkDirectory << '/';
+  for ( unsigned int i = 0; i < chunkIndex.size(); ++i )
+    {
+    name << ( i > 0 ? "." : "" ) << chunkIndex[i];
+    }
+  return name.str();
+}
+
+bool
+ChunkedImageIO::ReadChunk(const std::string & fileName, char *chunk, SizeValueType size) const
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  if ( !file )
+    {
+    return false;
+    }
+  if ( m_CompressedChunks )
+    {
+    file.seekg(0, std::ios::end);
+    const auto compressedSize = static_cast< SizeValueType >( file.tellg() );
+    file.seekg(0, std::ios::beg);
+    std::vector< char > compressed(compressedSize);
+    file.read(compressed.data(), compressedSize);
+    uLongf decompressedSize = size;
+    if ( file.fail()
+         || uncompress(reinterpret_cast< Bytef * >( chunk ), &decompressedSize,
+                       reinterpret_cast< const Bytef * >( compressed.data() ), compressedSize) != Z_OK
+         || decompressedSize != size )
+      {
+      itkExceptionMacro("Corrupted chunk file: " << fileName);
+      }
+    }
+  else
+    {
+    file.read(chunk, size);
+    if ( file.fail() || static_cast< SizeValueType >( file.gcount() ) != size )
+      {
+      itkExceptionMacro("Corrupted chunk file: " << fileName);
+      }
+    }
+  if ( m_SwapChunkBytes )
+    {
+    SwapComponentBytes(chunk, size, this->GetComponentSize());
+    }
+  return true;
+}
+
+void
+ChunkedImageIO::WriteChunk(const std::string & fileName, const char *chunk, SizeValueType size) const
+{
+  // A chunk of zeros is not stored.
+  if ( std::all_of(chunk, chunk + size, [](char c) { return c == 0; }) )
+    {
+    if ( itksys::SystemTools::FileExists(fileName) && !itksys::SystemTools::RemoveFile(fileName) )
+      {
+      itkExceptionMacro("Unable to remove chunk file: " << fileName);
+      }
+    return;
+    }
+
+  std::vector< char > swapped;
+  if ( m_SwapChunkBytes )
+    {
+    swapped.assign(chunk, chunk + size);
+    SwapComponentBytes(swapped.data(), size, this->GetComponentSize());
+    chunk = swapped.data();
+    }
+
+  std::vector< char > compressed;
+  if ( m_CompressedChunks )
+    {
+    uLongf compressedSize = compressBound(size);
+    compressed.resize(compressedSize);
+    if ( compress2(reinterpret_cast< Bytef * >( compressed.data() ), &compressedSize,
+                   reinterpret_cast< const Bytef * >( chunk ), size, m_CompressionLevel) != Z_OK )
+      {
+      itkExceptionMacro("Unable to compress chunk: " << fileName);
+      }
+    compressed.resize(compressedSize);
+    chunk = compressed.data();
+    size = compressedSize;
+    }
+
+  std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  file.write(chunk, size);
+  file.close();
+  if ( file.fail() )
+    {
+    itkExceptionMacro("Unable to write chunk file: " << fileName);
+    }
+}
+
+void
+ChunkedImageIO::ProcessChunks(char *buffer, bool write)
+{
+  const unsigned int  dimension = this->GetNumberOfDimensions();
+  const SizeValueType pixelSize = this->GetPixelSize();
+
+  // The IORegion may have fewer dimensions than the image, e.g. when a
+  // slice of a volume is read.
+  PixelBox region;
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    const bool inRegion = i < m_IORegion.GetImageDimension();
+    region.index.push_back(inRegion ? m_IORegion.GetIndex(i) : 0);
+    region.size.push_back(inRegion ? m_IORegion.GetSize(i) : 1);
+    }
+  if ( region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  // Range of chunks intersecting the region
+  std::vector< IndexValueType > firstChunk(dimension);
+  std::vector< SizeValueType >  numberOfChunks(dimension);
+  SizeValueType                 totalNumberOfChunks = 1;
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    const auto chunkSize = static_cast< IndexValueType >( m_ChunkDimensions[i] );
+    firstChunk[i] = region.index[i] / chunkSize;
+    const IndexValueType lastChunk =
+      ( region.index[i] + static_cast< IndexValueType >( region.size[i] ) - 1 ) / chunkSize;
+    numberOfChunks[i] = static_cast< SizeValueType >( lastChunk - firstChunk[i] + 1 );
+    totalNumberOfChunks *= numberOfChunks[i];
+    }
+
+  std::vector< std::string > errors(totalNumberOfChunks);
+  auto processChunk = [&](SizeValueType chunkNumber)
+    {
+    std::vector< IndexValueType > chunkIndex(dimension);
+    PixelBox                      chunkBox;
+    PixelBox                      box;
+    SizeValueType                 remainder = chunkNumber;
+    for ( unsigned int i = 0; i < dimension; ++i )
+      {
+      chunkIndex[i] = firstChunk[i] + static_cast< IndexValueType >( remainder % numberOfChunks[i] );
+      remainder /= numberOfChunks[i];
+
+      // Chunks are truncated at the end of the image.
+      const IndexValueType chunkStart = chunkIndex[i] * static_cast< IndexValueType >( m_ChunkDimensions[i] );
+      const IndexValueType chunkEnd = std::min(chunkStart + static_cast< IndexValueType >( m_ChunkDimensions[i] ),
+                                               static_cast< IndexValueType >( this->GetDimensions(i) ));
+      chunkBox.index.push_back(chunkStart);
+      chunkBox.size.push_back(static_cast< SizeValueType >( chunkEnd - chunkStart ));
+
+      const IndexValueType start = std::max(chunkStart, region.index[i]);
+      const IndexValueType end = std::min(chunkEnd, region.index[i] + static_cast< IndexValueType >( region.size[i] ));
+      box.index.push_back(start);
+      box.size.push_back(static_cast< SizeValueType >( end - start ));
+      }
+
+    const SizeValueType chunkSize = chunkBox.GetNumberOfPixels() * pixelSize;
+    const std::string   fileName = this->GetChunkFileName(chunkIndex);
+    try
+      {
+      // A missing chunk is made of zeros.
+      std::vector< char > chunk(chunkSize, 0);
+      if ( !write || box.size != chunkBox.size )
+        {
+        this->ReadChunk(fileName, chunk.data(), chunkSize);
+        }
+      if ( write )
+        {
+        CopyBox(buffer, region, chunk.data(), chunkBox, box, pixelSize);
+        this->WriteChunk(fileName, chunk.data(), chunkSize);
+        }
+      else
+        {
+        CopyBox(chunk.data(), chunkBox, buffer, region, box, pixelSize);
+        }
+      }
+    catch ( ExceptionObject & exception )
+      {
+      errors[chunkNumber] = exception.GetDescription();
+      }
+    };
+
+  const ThreadIdType numberOfThreads =
+    static_cast< ThreadIdType >( std::min< SizeValueType >(m_NumberOfCompressionThreads, totalNumberOfChunks) );
+  if ( numberOfThreads <= 1 )
+    {
+    for ( SizeValueType chunkNumber = 0; chunkNumber < totalNumberOfChunks; ++chunkNumber )
+      {
+      processChunk(chunkNumber);
+      }
+    }
+  else
+    {
+    MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetArrayGrainSize(1);
+    threader->ParallelizeArray(0, totalNumberOfChunks, processChunk, nullptr);
+    }
+
+  for ( const auto & error : errors )
+    {
+    if ( !error.empty() )
+      {
+      itkExceptionMacro(<< error);
+      }
+    }
+}
+
+void
+ChunkedImageIO::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ChunkSize: " << m_ChunkSize << std::endl;
+  os << indent << "ChunkDimensions:";
+  for ( auto size : m_ChunkDimensions )
+    {
+    os << ' ' << size;
+    }
+  os << std::endl;
+  os << indent << "ChunkDirectory: " << m_ChunkDirectory << std::endl;
+  os << indent << "CompressedChunks: " << m_CompressedChunks << std::endl;
+}
+} // end namespace itk
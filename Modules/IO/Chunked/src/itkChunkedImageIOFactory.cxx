@@ -0,0 +1,59 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkChunkedImageIOFactory.h"
+#include "itkChunkedImageIO.h"
+#include "itkVersion.h"
+
+namespace itk
+{
+ChunkedImageIOFactory::ChunkedImageIOFactory()
+{
+  this->RegisterOverride( "itkImageIOBase",
+                          "itkChunkedImageIO",
+                          "Chunked Image IO",
+                          1,
+                          CreateObjectFunction< ChunkedImageIO >::New() );
+}
+
+const char *
+ChunkedImageIOFactory::GetITKSourceVersion() const
+{
+  return ITK_SOURCE_VERSION;
+}
+
+const char *
+ChunkedImageIOFactory::GetDescription() const
+{
+  return "Chunked ImageIO Factory, allows the loading of chunked images into ITK";
+}
+
+// Undocumented API used to register during static initialization.
+// DO NOT CALL DIRECTLY.
+
+static bool ChunkedImageIOFactoryHasBeenRegistered;
+
+void ITKIOChunked_EXPORT ChunkedImageIOFactoryRegister__Private()
+{
+  if( !ChunkedImageIOFactoryHasBeenRegistered )
+    {
+    ChunkedImageIOFactoryHasBeenRegistered = true;
+    ChunkedImageIOFactory::RegisterOneFactory();
+    }
+}
+
+} // end namespace itk
@@ -0,0 +1,244 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkChunkedImageIO.h"
+#include "itkChunkedImageIOFactory.h"
+#include "itkCastImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include "itksys/SystemTools.hxx"
+
+// Write a chunked image with streaming, read it back as a whole and by
+// regions, and paste a region into it. The images are written through a
+// filter, which generates only the requested regions.
+
+namespace
+{
+
+using ImageType = itk::Image< short, 3 >;
+
+ImageType::Pointer
+CreateImage( short offset )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size = { { 70, 45, 9 } };
+  image->SetRegions( size );
+  image->Allocate();
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 1.25;
+  spacing[2] = 3.0;
+  image->SetSpacing( spacing );
+  ImageType::PointType origin;
+  origin[0] = -10.0;
+  origin[1] = 0.1;
+  origin[2] = 7.0;
+  image->SetOrigin( origin );
+  ImageType::DirectionType direction;
+  direction.Fill( 0.0 );
+  direction[0][1] = 1.0;
+  direction[1][0] = -1.0;
+  direction[2][2] = 1.0;
+  image->SetDirection( direction );
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    // The last column of chunks is made of zeros.
+    it.Set( index[0] >= 64 ? 0 : static_cast< short >( offset + index[0] + 3 * index[1] - 200 * index[2] ) );
+    }
+  return image;
+}
+
+bool
+SamePixels( const ImageType * expected, const ImageType * image, const ImageType::RegionType & region )
+{
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( image, region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != expected->GetPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Different pixel at " << it.GetIndex() << ": " << it.Get() << " instead of "
+                << expected->GetPixel( it.GetIndex() ) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+ImageType::Pointer
+Read( const std::string & fileName, const ImageType::RegionType * region = nullptr )
+{
+  using ReaderType = itk::ImageFileReader< ImageType >;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  if ( region )
+    {
+    reader->GetOutput()->SetRequestedRegion( *region );
+    reader->Update();
+    }
+  else
+    {
+    reader->UpdateLargestPossibleRegion();
+    }
+  ImageType::Pointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+}
+
+bool
+TestFile( const std::string & fileName, bool compress, unsigned int numberOfThreads )
+{
+  std::cout << "Testing " << fileName << " with " << numberOfThreads << " threads" << std::endl;
+
+  ImageType::Pointer image = CreateImage( 0 );
+  itk::ChunkedImageIO::Pointer imageIO = itk::ChunkedImageIO::New();
+  imageIO->SetChunkSize( 16 );
+  imageIO->SetNumberOfCompressionThreads( numberOfThreads );
+
+  using CastType = itk::CastImageFilter< ImageType, ImageType >;
+  CastType::Pointer cast = CastType::New();
+  cast->SetInput( image );
+
+  // Stream divisions are not aligned on the chunks.
+  using WriterType = itk::ImageFileWriter< ImageType >;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( cast->GetOutput() );
+  writer->SetImageIO( imageIO );
+  writer->SetUseCompression( compress );
+  writer->SetNumberOfStreamDivisions( 4 );
+  writer->Update();
+
+  const std::string chunkDirectory = itksys::SystemTools::GetFilenamePath( fileName ) + "/"
+    + itksys::SystemTools::GetFilenameWithoutLastExtension( fileName ) + ".chunks";
+  if ( !itksys::SystemTools::FileExists( chunkDirectory + "/0.0.0" )
+       || itksys::SystemTools::FileExists( chunkDirectory + "/4.0.0" ) )
+    {
+    std::cerr << "Unexpected chunk files in " << chunkDirectory << std::endl;
+    return false;
+    }
+
+  ImageType::Pointer read = Read( fileName );
+  if ( !SamePixels( image, read, image->GetLargestPossibleRegion() )
+       || read->GetSpacing() != image->GetSpacing()
+       || read->GetOrigin() != image->GetOrigin()
+       || read->GetDirection() != image->GetDirection() )
+    {
+    std::cerr << "The image read differs from the image written" << std::endl;
+    return false;
+    }
+
+  // Only the requested region is read.
+  ImageType::RegionType region;
+  region.SetIndex( 0, 13 );
+  region.SetIndex( 1, 30 );
+  region.SetIndex( 2, 2 );
+  region.SetSize( 0, 40 );
+  region.SetSize( 1, 15 );
+  region.SetSize( 2, 5 );
+  ImageType::Pointer regionImage = Read( fileName, &region );
+  if ( regionImage->GetBufferedRegion() != region || !SamePixels( image, regionImage, region ) )
+    {
+    std::cerr << "Reading region " << region << " failed" << std::endl;
+    return false;
+    }
+
+  // Paste a region of another image, not aligned on the chunks.
+  ImageType::Pointer pasted = CreateImage( 1000 );
+  itk::ImageIORegion ioRegion( 3 );
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    ioRegion.SetIndex( i, region.GetIndex( i ) );
+    ioRegion.SetSize( i, region.GetSize( i ) );
+    }
+  cast->SetInput( pasted );
+  writer->SetNumberOfStreamDivisions( 1 );
+  writer->SetIORegion( ioRegion );
+  writer->Update();
+
+  read = Read( fileName );
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( region.IsInside( it.GetIndex() ) )
+      {
+      it.Set( pasted->GetPixel( it.GetIndex() ) );
+      }
+    }
+  if ( !SamePixels( image, read, image->GetLargestPossibleRegion() ) )
+    {
+    std::cerr << "Pasting region " << region << " failed" << std::endl;
+    return false;
+    }
+
+  // A slice of the volume
+  using SliceType = itk::Image< short, 2 >;
+  using SliceReaderType = itk::ImageFileReader< SliceType >;
+  SliceReaderType::Pointer sliceReader = SliceReaderType::New();
+  sliceReader->SetFileName( fileName );
+  sliceReader->Update();
+  itk::ImageRegionConstIteratorWithIndex< SliceType > sliceIt( sliceReader->GetOutput(),
+                                                               sliceReader->GetOutput()->GetBufferedRegion() );
+  for ( ; !sliceIt.IsAtEnd(); ++sliceIt )
+    {
+    const ImageType::IndexType index = { { sliceIt.GetIndex()[0], sliceIt.GetIndex()[1], 0 } };
+    if ( sliceIt.Get() != image->GetPixel( index ) )
+      {
+      std::cerr << "Different pixel in slice at " << index << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkChunkedImageIOTest( int argc, char * argv[] )
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string( argv[1] ) + "/";
+
+  itk::ObjectFactoryBase::RegisterFactory( itk::ChunkedImageIOFactory::New() );
+
+  itk::ChunkedImageIO::Pointer imageIO = itk::ChunkedImageIO::New();
+  EXERCISE_BASIC_OBJECT_METHODS( imageIO, ChunkedImageIO, StreamingImageIOBase );
+  TEST_SET_GET_VALUE( 64, imageIO->GetChunkSize() );
+  TEST_EXPECT_TRUE( imageIO->CanStreamRead() );
+  TEST_EXPECT_TRUE( imageIO->CanStreamWrite() );
+  TEST_EXPECT_TRUE( imageIO->CanWriteFile( "image.cki" ) );
+  TEST_EXPECT_TRUE( !imageIO->CanWriteFile( "image.mha" ) );
+
+  bool success = true;
+  success &= TestFile( directory + "ChunkedImageIOTest.cki", false, 1 );
+  success &= TestFile( directory + "ChunkedImageIOTestCompressed.cki", true, 3 );
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
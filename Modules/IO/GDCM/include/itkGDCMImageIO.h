@@ -265,6 +265,9 @@ protected:
   ~GDCMImageIO() override;
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** Copy the reading and writing settings of this ImageIO. */
+  LightObject::Pointer InternalClone() const override;
+
   void InternalReadImageInformation();
 
   double m_RescaleSlope;
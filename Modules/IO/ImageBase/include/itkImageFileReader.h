@@ -118,6 +118,25 @@ public:
   itkGetConstReferenceMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
 
+  /** Set/Get whether the pixel data may be memory mapped instead of read.
+   * When the pixels are stored in the file uncompressed, in the byte order
+   * of this machine and with the pixel type of the output image (e.g. raw
+   * MetaImage, NRRD or NIfTI files), the file is mapped copy-on-write and
+   * the output image uses the mapped memory as its buffer: no buffer is
+   * allocated, and the pixels are loaded lazily from the operating system
+   * file cache, which processes reading the same file share. Modifications
+   * of the output, e.g. by a filter running in place, are never written to
+   * the file. The file must not be modified while the output image exists.
+   * The pixels must also start at an offset of the file aligned on the
+   * size of their components, which may not be the case of files with a
+   * header of arbitrary length, like .mha files. Otherwise, the file is
+   * read as usual. Default is off.
+   *
+   * \sa ImageIOBase::CanMemoryMapPixelData MemoryMappedFile */
+  itkSetMacro(UseMemoryMapping, bool);
+  itkGetConstMacro(UseMemoryMapping, bool);
+  itkBooleanMacro(UseMemoryMapping);
+
 protected:
   ImageFileReader();
   ~ImageFileReader() override;
@@ -155,6 +174,12 @@ protected:
   bool m_UseStreaming;
 
 private:
+  /** Use the mapped pixel data of the file as the buffer of the output,
+   * if possible. Returns false when the pixels have to be read. */
+  bool MapPixelData();
+
+  bool m_UseMemoryMapping;
+
   std::string m_ExceptionMessage;
 
   // The region that the ImageIO class will return when we ask to
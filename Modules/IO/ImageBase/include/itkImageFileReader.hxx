@@ -24,6 +24,8 @@
 #include "itkConvertPixelBuffer.h"
 #include "itkPixelTraits.h"
 #include "itkVectorImage.h"
+#include "itkMemoryMappedFile.h"
+#include "itkBatchFunctorTraits.h"
 
 #include "itksys/SystemTools.hxx"
 #include <fstream>
@@ -38,6 +40,7 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
   this->SetFileName("");
   m_UserSpecifiedImageIO = false;
   m_UseStreaming = true;
+  m_UseMemoryMapping = false;
 }
 
 template< typename TOutputImage, typename ConvertPixelTraits >
@@ -55,6 +58,7 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 
   os << indent << "UserSpecifiedImageIO flag: " << m_UserSpecifiedImageIO << "\n";
   os << indent << "m_UseStreaming: " << m_UseStreaming << "\n";
+  os << indent << "UseMemoryMapping: " << m_UseMemoryMapping << "\n";
 }
 
 template< typename TOutputImage, typename ConvertPixelTraits >
@@ -370,9 +374,6 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
                  << "Allocating the buffer with the EnlargedRequestedRegion \n"
                  << output->GetRequestedRegion() << "\n");
 
-  // allocated the output image to the size of the enlarge requested region
-  this->AllocateOutputs();
-
   // Test if the file exists and if it can be opened.
   // An exception will be thrown otherwise, since we can't
   // successfully read the file. We catch the exception because some
@@ -395,6 +396,15 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   itkDebugMacro (<< "Setting imageIO IORegion to: " << m_ActualIORegion);
   m_ImageIO->SetIORegion(m_ActualIORegion);
 
+  if ( m_UseMemoryMapping && this->MapPixelData() )
+    {
+    this->UpdateProgress( 1.0f );
+    return;
+    }
+
+  // allocated the output image to the size of the enlarge requested region
+  this->AllocateOutputs();
+
   char *loadBuffer = nullptr;
   // the size of the buffer is computed based on the actual number of
   // pixels to be read and the actual size of the pixels to be read
@@ -478,6 +488,57 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   loadBuffer = nullptr;
 }
 
+template< typename TOutputImage, typename ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::MapPixelData()
+{
+  using PixelContainerType = typename TOutputImage::PixelContainer;
+  using MappedContainerType = MemoryMappedImportImageContainer< typename PixelContainerType::ElementIdentifier,
+                                                                typename PixelContainerType::Element >;
+
+  // Only for images whose buffer is an array of pixels, when the file holds
+  // exactly these pixels, without any conversion.
+  typename TOutputImage::Pointer output = this->GetOutput();
+  const ImageIOBase::IOComponentType ioType =
+    ImageIOBase::MapPixelType< typename ConvertPixelTraits::ComponentType >::CType;
+  const SizeValueType numberOfPixels = output->GetRequestedRegion().GetNumberOfPixels();
+  const ImageIOBase::SizeType sizeOfActualIORegion =
+    static_cast< ImageIOBase::SizeType >( m_ActualIORegion.GetNumberOfPixels() )
+    * m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents();
+  if ( !ImageHasContiguousPixels< TOutputImage >::Value
+       || m_ImageIO->GetComponentType() != ioType
+       || m_ImageIO->GetNumberOfComponents() != ConvertPixelTraits::GetNumberOfComponents()
+       || m_ActualIORegion.GetNumberOfPixels() != numberOfPixels
+       || sizeOfActualIORegion != static_cast< ImageIOBase::SizeType >( numberOfPixels * sizeof( OutputImagePixelType ) ) )
+    {
+    return false;
+    }
+
+  std::string          dataFileName;
+  ImageIOBase::SizeType offset = 0;
+  if ( !m_ImageIO->CanMemoryMapPixelData(dataFileName, offset)
+       || offset % m_ImageIO->GetComponentSize() != 0 )
+    {
+    return false;
+    }
+
+  MemoryMappedFile::Pointer mappedFile = MemoryMappedFile::New();
+  if ( !mappedFile->Map(dataFileName, offset, sizeOfActualIORegion) )
+    {
+    itkDebugMacro(<< "Memory mapping of " << dataFileName << " failed, reading it instead.");
+    return false;
+    }
+
+  itkDebugMacro(<< "Memory mapping " << sizeOfActualIORegion << " bytes of " << dataFileName
+                << " at offset " << offset);
+  typename MappedContainerType::Pointer container = MappedContainerType::New();
+  container->SetMappedFile(mappedFile, numberOfPixels);
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->SetPixelContainer(container);
+  return true;
+}
+
 template< typename TOutputImage, typename ConvertPixelTraits >
 void
 ImageFileReader< TOutputImage, ConvertPixelTraits >
@@ -30,6 +30,7 @@
 #include "itkSymmetricSecondRankTensor.h"
 #include "itkDiffusionTensor3D.h"
 #include "itkImageRegionSplitterBase.h"
+#include "itkMultiThreaderBase.h"
 
 #include "vnl/vnl_vector.h"
 #include "vcl_compiler.h"
@@ -83,6 +84,13 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(ImageIOBase, Superclass);
 
+  /** Create an ImageIO of the same type, with the same settings, such as
+   * the compression and streaming settings, but without the information
+   * of the last file read. This allows to read several files concurrently
+   * with the same settings. Subclasses with additional settings override
+   * InternalClone(). */
+  itkCloneMacro(Self);
+
   /** Set/Get the name of the file to be read. */
   itkSetStringMacro(FileName);
   itkGetStringMacro(FileName);
@@ -200,6 +208,20 @@ public:
   itkGetConstMacro(UseCompression, bool);
   itkBooleanMacro(UseCompression);
 
+  /** Set/Get the zlib compression level, from 0 (no compression, fastest)
+   * to 9 (best compression, slowest), used by the ImageIOs writing deflate
+   * compressed data. Default is 6, the zlib default. */
+  itkSetClampMacro(CompressionLevel, int, 0, 9);
+  itkGetConstMacro(CompressionLevel, int);
+
+  /** Set/Get the number of threads compressing the data in parallel, for
+   * the ImageIOs which support it. The compressed data does not depend on
+   * the number of threads. Default is the global default number of
+   * threads of MultiThreaderBase.
+   * \sa ParallelDeflateCompressor */
+  itkSetClampMacro(NumberOfCompressionThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfCompressionThreads, ThreadIdType);
+
   /** Set/Get a boolean to use streaming while reading or not. */
   itkSetMacro(UseStreamedReading, bool);
   itkGetConstMacro(UseStreamedReading, bool);
@@ -337,6 +359,16 @@ public:
     return false;
   }
 
+  /** Determine if several instances of this ImageIO can read files at the
+      same time, from different threads. Default is false: an ImageIO whose
+      library keeps global state, such as error handlers or reading flags,
+      must read one file at a time. ImageSeriesReader reads the files of a
+      series concurrently only when this is true. */
+  virtual bool CanReadFilesConcurrently() const
+  {
+    return false;
+  }
+
   /** Read the spacing and dimensions of the image.
    * Assumes SetFileName has been called with a valid file name. */
   virtual void ReadImageInformation() = 0;
@@ -344,6 +376,15 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer) = 0;
 
+  /** Determine whether the pixels of the current IORegion are stored in a
+   * single file, uncompressed, contiguously and in the byte order of this
+   * machine, exactly as Read() would return them. In that case, the name of
+   * that file and the position in bytes of the first pixel of the IORegion
+   * are returned, so that ImageFileReader can memory map the pixel data
+   * instead of reading it. Assumes ReadImageInformation() and SetIORegion()
+   * have been called. The default implementation returns false. */
+  virtual bool CanMemoryMapPixelData(std::string & dataFileName, SizeType & offset);
+
   /*-------- This part of the interfaces deals with writing data ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -545,6 +586,8 @@ protected:
   ~ImageIOBase() override;
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
+  LightObject::Pointer InternalClone() const override;
+
   virtual const ImageRegionSplitterBase* GetImageRegionSplitter() const;
 
   /** Used internally to keep track of the type of the pixel. */
@@ -575,6 +618,12 @@ protected:
   /** Should we compress the data? */
   bool m_UseCompression;
 
+  /** zlib compression level */
+  int m_CompressionLevel;
+
+  /** Number of threads compressing the data */
+  ThreadIdType m_NumberOfCompressionThreads;
+
   /** Should we use streaming for reading */
   bool m_UseStreamedReading;
 
@@ -640,6 +689,12 @@ protected:
    * next slice. Returns m_Strides[3]. */
   SizeType GetSliceStride() const;
 
+  /** Determine whether the pixels of the IORegion form a single contiguous
+   * block of the pixel data of the whole image. If so, \c offset is set to
+   * the number of bytes from the first pixel of the image to the first pixel
+   * of the IORegion. Used by implementations of CanMemoryMapPixelData(). */
+  bool GetContiguousIORegionOffset(SizeType & offset) const;
+
   /** \brief Opens a file for reading and random access
    *
    * \param[out] inputStream is an istream presumed to be opened for reading
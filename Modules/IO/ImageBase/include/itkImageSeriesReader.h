@@ -35,6 +35,18 @@ namespace itk
  * the files, but the image data must have the same Size for all
  * dimensions.
  *
+ * The files are read and decoded concurrently, by up to NumberOfThreads
+ * readers writing directly into the output buffer, when the ImageIO can
+ * read concurrently (see ImageIOBase::CanReadFilesConcurrently()).
+ * Otherwise they are read one after the other, until the first failure.
+ * Each concurrent reader has its own ImageIO: when an ImageIO is set, the
+ * last file is read with it, and the other files with clones of it, as
+ * created by ImageIOBase::Clone(). When no ImageIO is set, the
+ * ImageIOFactory creates one for the first file, which is cloned in the
+ * same way, so all the files must then have the same format. The
+ * MetaDataDictionaryArray is in the order of the files, whatever the order
+ * in which they are read. Progress is reported after each file.
+ *
  * \sa GDCMSeriesFileNames
  * \sa NumericSeriesFileNames
  * \ingroup IOFilters
@@ -21,10 +21,15 @@
 #include "itkImageSeriesReader.h"
 
 #include "itkImageAlgorithm.h"
+#include "itkImageIOFactory.h"
 #include "itkArray.h"
 #include "itkMath.h"
-#include "itkProgressReporter.h"
 #include "itkMetaDataObject.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
 
 namespace itk
 {
@@ -296,11 +301,6 @@ void ImageSeriesReader< TOutputImage >
   output->SetBufferedRegion(requestedRegion);
   output->Allocate();
 
-  // progress reported on a per slice basis
-  ProgressReporter progress(this, 0,
-                            requestedRegion.GetSize(TOutputImage::ImageDimension-1),
-                            100);
-
   // We utilize the modified time of the output information to
   // know when the meta array needs to be updated, when the output
   // information is updated so should the meta array.
@@ -311,140 +311,243 @@ void ImageSeriesReader< TOutputImage >
     && m_MetaDataDictionaryArrayUpdate;
 
   typename  TOutputImage::InternalPixelType *outputBuffer = output->GetBufferPointer();
-  IndexType                           sliceStartIndex = requestedRegion.GetIndex();
   const auto numberOfFiles = static_cast< int >( m_FileNames.size() );
 
+  // The slices to read, or whose meta data is needed
+  std::vector< int > slices;
   for ( int i = 0; i != numberOfFiles; ++i )
     {
+    IndexType sliceStartIndex = requestedRegion.GetIndex();
     if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
       {
       sliceStartIndex[this->m_NumberOfDimensionsInImage] = i;
       }
-
-    const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
-    const int  iFileName = ( m_ReverseOrder ? numberOfFiles - i - 1 : i );
-
-    // check if we need this slice
-    if ( !insideRequestedRegion && !needToUpdateMetaDataDictionaryArray )
+    if ( requestedRegion.IsInside(sliceStartIndex) || needToUpdateMetaDataDictionaryArray )
       {
-      continue;
+      slices.push_back(i);
       }
+    }
 
-    // configure reader
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( m_FileNames[iFileName].c_str() );
-
-    TOutputImage * readerOutput = reader->GetOutput();
+  // The ImageIO of each slice. ImageIOs are not thread safe: the ImageIO
+  // set by the user reads the last slice, as it did when the slices were
+  // read in sequence, and the other slices are read by clones of it.
+  // Otherwise, the factory probes the first file once, and the ImageIO it
+  // creates is cloned in the same way.
+  const auto numberOfSlices = static_cast< SizeValueType >( slices.size() );
+  std::vector< ImageIOBase::Pointer > sliceImageIOs(numberOfSlices);
+  bool readConcurrently = this->GetNumberOfThreads() > 1 && numberOfSlices > 1;
+  if ( readConcurrently )
+    {
+    ImageIOBase::Pointer imageIO = m_ImageIO;
+    if ( !imageIO )
+      {
+      const int iFileName = ( m_ReverseOrder ? numberOfFiles - slices[0] - 1 : slices[0] );
+      imageIO = ImageIOFactory::CreateImageIO( m_FileNames[iFileName].c_str(), ImageIOFactory::ReadMode );
+      }
+    // The files are read one at a time unless the ImageIO can read
+    // concurrently. The readers then report the errors as usual.
+    readConcurrently = imageIO && imageIO->CanReadFilesConcurrently();
+    for ( SizeValueType n = 0; n < numberOfSlices && readConcurrently; ++n )
+      {
+      sliceImageIOs[n] = ( n + 1 == numberOfSlices ) ? imageIO : imageIO->Clone();
+      }
+    }
+  if ( !readConcurrently )
+    {
+    std::fill( sliceImageIOs.begin(), sliceImageIOs.end(), m_ImageIO );
+    }
 
-    if ( m_ImageIO )
+  // The slices are read, each by its own reader, directly into the output
+  // buffer when possible. The dictionaries and exceptions are kept per
+  // slice, so that the result does not depend on the order in which the
+  // slices are read.
+  std::vector< std::unique_ptr< DictionaryType > > sliceDictionaries(slices.size());
+  std::vector< std::exception_ptr >                sliceExceptions(slices.size());
+  std::atomic< SizeValueType >                     numberOfCompletedSlices(0);
+  std::atomic< bool >                              readFailed(false);
+  const std::thread::id                            callingThread = std::this_thread::get_id();
+
+  auto readSlice = [&](SizeValueType n)
+    {
+    // The remaining slices are not read after a failure
+    if ( readFailed )
       {
-      reader->SetImageIO(m_ImageIO);
+      return;
       }
-    reader->SetUseStreaming(m_UseStreaming);
-    readerOutput->SetRequestedRegion(sliceRegionToRequest);
 
-    // update the data or info
-    if ( !insideRequestedRegion )
+    const int i = slices[n];
+    IndexType sliceStartIndex = requestedRegion.GetIndex();
+    if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
       {
-      reader->UpdateOutputInformation();
+      sliceStartIndex[this->m_NumberOfDimensionsInImage] = i;
       }
-    else
+
+    const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
+    const int  iFileName = ( m_ReverseOrder ? numberOfFiles - i - 1 : i );
+
+    try
       {
-      // read the meta data information
-      readerOutput->UpdateOutputInformation();
+      // configure reader
+      typename ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName( m_FileNames[iFileName].c_str() );
 
-      // propagate the requested region to determin what the region
-      // will actually be read
-      readerOutput->PropagateRequestedRegion();
+      TOutputImage * readerOutput = reader->GetOutput();
 
-      // check that the size of each slice is the same
-      if ( readerOutput->GetLargestPossibleRegion().GetSize() != validSize )
+      if ( sliceImageIOs[n] )
         {
-        itkExceptionMacro( << "Size mismatch! The size of  "
-                           << m_FileNames[iFileName].c_str()
-                           << " is "
-                           << readerOutput->GetLargestPossibleRegion().GetSize()
-                           << " and does not match the required size "
-                           << validSize
-                           << " from file "
-                           << m_FileNames[m_ReverseOrder ? m_FileNames.size() - 1 : 0].c_str() );
+        reader->SetImageIO(sliceImageIOs[n]);
         }
+      reader->SetUseStreaming(m_UseStreaming);
+      readerOutput->SetRequestedRegion(sliceRegionToRequest);
 
-      // get the size of the region to be read
-      SizeType readSize = readerOutput->GetRequestedRegion().GetSize();
-
-      if( readSize == sliceRegionToRequest.GetSize() )
+      // update the data or info
+      if ( !insideRequestedRegion )
         {
-        // if the buffer of the ImageReader is going to match that of
-        // ourselves, then set the ImageReader's buffer to a section
-        // of ours
-
-        const size_t  numberOfPixelsInSlice = sliceRegionToRequest.GetNumberOfPixels();
-
-        using AccessorFunctorType = typename TOutputImage::AccessorFunctorType;
-        const size_t      numberOfInternalComponentsPerPixel =  AccessorFunctorType::GetVectorLength( output );
-
+        reader->UpdateOutputInformation();
+        }
+      else
+        {
+        // read the meta data information
+        readerOutput->UpdateOutputInformation();
 
-        const ptrdiff_t   sliceOffset = ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage ) ?
-          ( i - requestedRegion.GetIndex(this->m_NumberOfDimensionsInImage)) : 0;
+        // propagate the requested region to determin what the region
+        // will actually be read
+        readerOutput->PropagateRequestedRegion();
 
-        const ptrdiff_t  numberOfPixelComponentsUpToSlice =  numberOfPixelsInSlice * numberOfInternalComponentsPerPixel * sliceOffset;
-        const bool       bufferDelete = false;
+        // check that the size of each slice is the same
+        if ( readerOutput->GetLargestPossibleRegion().GetSize() != validSize )
+          {
+          itkExceptionMacro( << "Size mismatch! The size of  "
+                             << m_FileNames[iFileName].c_str()
+                             << " is "
+                             << readerOutput->GetLargestPossibleRegion().GetSize()
+                             << " and does not match the required size "
+                             << validSize
+                             << " from file "
+                             << m_FileNames[m_ReverseOrder ? m_FileNames.size() - 1 : 0].c_str() );
+          }
 
-        typename  TOutputImage::InternalPixelType * outputSliceBuffer = outputBuffer + numberOfPixelComponentsUpToSlice;
+        // get the size of the region to be read
+        SizeType readSize = readerOutput->GetRequestedRegion().GetSize();
 
-        if ( strcmp(output->GetNameOfClass(), "VectorImage") == 0 )
+        if( readSize == sliceRegionToRequest.GetSize() )
           {
-          // if the input image type is a vector image then the number
-          // of components needs to be set for the size
-          readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer,
-                                                               static_cast<unsigned long>( numberOfPixelsInSlice*numberOfInternalComponentsPerPixel ),
-                                                               bufferDelete );
+          // if the buffer of the ImageReader is going to match that of
+          // ourselves, then set the ImageReader's buffer to a section
+          // of ours
+
+          const size_t  numberOfPixelsInSlice = sliceRegionToRequest.GetNumberOfPixels();
+
+          using AccessorFunctorType = typename TOutputImage::AccessorFunctorType;
+          const size_t      numberOfInternalComponentsPerPixel =  AccessorFunctorType::GetVectorLength( output );
+
+
+          const ptrdiff_t   sliceOffset = ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage ) ?
+            ( i - requestedRegion.GetIndex(this->m_NumberOfDimensionsInImage)) : 0;
+
+          const ptrdiff_t  numberOfPixelComponentsUpToSlice =  numberOfPixelsInSlice * numberOfInternalComponentsPerPixel * sliceOffset;
+          const bool       bufferDelete = false;
+
+          typename  TOutputImage::InternalPixelType * outputSliceBuffer = outputBuffer + numberOfPixelComponentsUpToSlice;
+
+          if ( strcmp(output->GetNameOfClass(), "VectorImage") == 0 )
+            {
+            // if the input image type is a vector image then the number
+            // of components needs to be set for the size
+            readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer,
+                                                                 static_cast<unsigned long>( numberOfPixelsInSlice*numberOfInternalComponentsPerPixel ),
+                                                                 bufferDelete );
+            }
+          else
+            {
+            // otherwise the actual number of pixels needs to be passed
+            readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer,
+                                                                 static_cast<unsigned long>( numberOfPixelsInSlice ),
+                                                                 bufferDelete );
+            }
+          readerOutput->UpdateOutputData();
           }
         else
           {
-          // otherwise the actual number of pixels needs to be passed
-          readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer,
-                                                               static_cast<unsigned long>( numberOfPixelsInSlice ),
-                                                               bufferDelete );
-          }
-        readerOutput->UpdateOutputData();
-        }
-      else
-        {
-        // the read region isn't going to match exactly what we need
-        // to update to buffer created by the reader, then copy
+          // the read region isn't going to match exactly what we need
+          // to update to buffer created by the reader, then copy
 
-        reader->Update();
+          reader->Update();
 
-        // output of buffer copy
-        ImageRegionType outRegion = requestedRegion;
-        outRegion.SetIndex( sliceStartIndex );
+          // output of buffer copy
+          ImageRegionType outRegion = requestedRegion;
+          outRegion.SetIndex( sliceStartIndex );
 
-        // set the moving dimension to a size of 1
-        if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
-          {
-          outRegion.SetSize(this->m_NumberOfDimensionsInImage, 1);
-          }
+          // set the moving dimension to a size of 1
+          if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
+            {
+            outRegion.SetSize(this->m_NumberOfDimensionsInImage, 1);
+            }
+
+          ImageAlgorithm::Copy( readerOutput, output, sliceRegionToRequest, outRegion );
 
-        ImageAlgorithm::Copy( readerOutput, output, sliceRegionToRequest, outRegion );
+          }
+        } // end !insidedRequestedRegion
 
+      // Deep copy the MetaDataDictionary
+      if ( reader->GetImageIO() &&  needToUpdateMetaDataDictionaryArray )
+        {
+        sliceDictionaries[n].reset( new DictionaryType( reader->GetImageIO()->GetMetaDataDictionary() ) );
         }
+      }
+    catch ( ... )
+      {
+      sliceExceptions[n] = std::current_exception();
+      readFailed = true;
+      }
 
-      // report progress for read slices
-      progress.CompletedPixel();
+    // progress reported on a per slice basis, from the thread which
+    // invoked Update()
+    const SizeValueType completedSlices = ++numberOfCompletedSlices;
+    if ( std::this_thread::get_id() == callingThread )
+      {
+      this->UpdateProgress( static_cast< float >( completedSlices ) / numberOfSlices );
+      }
+    };
 
-     } // end !insidedRequestedRegion
+  this->UpdateProgress(0.0f);
+  if ( readConcurrently )
+    {
+    this->GetMultiThreader()->SetNumberOfThreads(
+      static_cast< ThreadIdType >( std::min< SizeValueType >(this->GetNumberOfThreads(), numberOfSlices) ) );
+    this->GetMultiThreader()->SetArrayGrainSize(1);
+    this->GetMultiThreader()->ParallelizeArray(0, numberOfSlices, readSlice, nullptr);
+    }
+  else
+    {
+    for ( SizeValueType n = 0; n < numberOfSlices; ++n )
+      {
+      readSlice(n);
+      if ( sliceExceptions[n] )
+        {
+        std::rethrow_exception(sliceExceptions[n]);
+        }
+      }
+    }
+  this->UpdateProgress(1.0f);
 
-    // Deep copy the MetaDataDictionary into the array
-    if ( reader->GetImageIO() &&  needToUpdateMetaDataDictionaryArray )
+  // Report the error of the first slice which failed among those read
+  for ( const auto & exception : sliceExceptions )
+    {
+    if ( exception )
       {
-      auto newDictionary = new DictionaryType;
-      *newDictionary = reader->GetImageIO()->GetMetaDataDictionary();
-      m_MetaDataDictionaryArray.push_back(newDictionary);
+      std::rethrow_exception(exception);
       }
+    }
 
-    } // end per slice loop
+  // Store the dictionaries in the order of the slices
+  for ( auto & dictionary : sliceDictionaries )
+    {
+    if ( dictionary )
+      {
+      m_MetaDataDictionaryArray.push_back( dictionary.release() );
+      }
+    }
 
   // update the time if we modified the meta array
   if ( needToUpdateMetaDataDictionaryArray )
@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMemoryMappedFile_h
+#define itkMemoryMappedFile_h
+
+#include "ITKIOImageBaseExport.h"
+
+#include "itkImageIOBase.h"
+#include "itkImportImageContainer.h"
+
+namespace itk
+{
+/** \class MemoryMappedFile
+ * \brief A range of bytes of a file mapped into memory.
+ *
+ * The pages are mapped copy-on-write: the mapped memory can be modified,
+ * e.g. by a filter running in place, but the modifications are private to
+ * the process and are never written to the file. Pages which are not
+ * modified are shared with the operating system file cache, and hence with
+ * other processes mapping or reading the same file. They are only read from
+ * disk when first accessed.
+ *
+ * The mapping is released when the object is destroyed.
+ *
+ * \sa MemoryMappedImportImageContainer
+ * \ingroup ITKIOImageBase
+ */
+class ITKIOImageBase_EXPORT MemoryMappedFile: public LightObject
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(MemoryMappedFile);
+
+  /** Standard class type aliases. */
+  using Self = MemoryMappedFile;
+  using Superclass = LightObject;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MemoryMappedFile, LightObject);
+
+  using SizeType = ImageIOBase::SizeType;
+
+  /** Map \c length bytes of the file, starting at byte \c offset. Any
+   * previous mapping is released first. Returns false, without throwing,
+   * if the file cannot be mapped, e.g. because the platform or the file
+   * system does not support it, so that the caller can fall back to
+   * reading the file. */
+  bool Map(const std::string & fileName, SizeType offset, SizeType length);
+
+  /** Release the mapping. */
+  void Unmap();
+
+  /** Address of the byte at \c offset in the file, or nullptr when nothing
+   * is mapped. */
+  void * GetPointer() const
+  {
+    return m_Pointer;
+  }
+
+  /** Number of bytes mapped, from GetPointer(). */
+  SizeType GetLength() const
+  {
+    return m_Length;
+  }
+
+protected:
+  MemoryMappedFile();
+  ~MemoryMappedFile() override;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  // The mapping starts at a page boundary, at or before the requested offset.
+  void *      m_MappedAddress;
+  std::size_t m_MappedLength;
+  void *      m_Pointer;
+  SizeType    m_Length;
+};
+
+/** \class MemoryMappedImportImageContainer
+ * \brief Image pixel container whose elements are stored in a
+ * MemoryMappedFile.
+ *
+ * The container keeps the file mapped as long as it exists. It does not
+ * manage the memory: operations which reallocate the buffer, like
+ * Reserve() with a larger size, copy the elements to newly allocated memory
+ * as with any imported buffer.
+ *
+ * \sa ImageFileReader::SetUseMemoryMapping
+ * \ingroup ITKIOImageBase
+ */
+template< typename TElementIdentifier, typename TElement >
+class ITK_TEMPLATE_EXPORT MemoryMappedImportImageContainer:
+  public ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(MemoryMappedImportImageContainer);
+
+  /** Standard class type aliases. */
+  using Self = MemoryMappedImportImageContainer;
+  using Superclass = ImportImageContainer< TElementIdentifier, TElement >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  using ElementIdentifier = typename Superclass::ElementIdentifier;
+  using Element = typename Superclass::Element;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MemoryMappedImportImageContainer, ImportImageContainer);
+
+  /** Use the \c size first elements of the mapped file as the buffer of
+   * the container. */
+  void SetMappedFile(MemoryMappedFile * file, ElementIdentifier size)
+  {
+    m_MappedFile = file;
+    this->SetImportPointer( static_cast< Element * >( file->GetPointer() ), size, false );
+  }
+
+  const MemoryMappedFile * GetMappedFile() const
+  {
+    return m_MappedFile.GetPointer();
+  }
+
+protected:
+  MemoryMappedImportImageContainer() = default;
+  ~MemoryMappedImportImageContainer() override = default;
+
+private:
+  MemoryMappedFile::Pointer m_MappedFile;
+};
+} // end namespace itk
+
+#endif // itkMemoryMappedFile_h
@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParallelDeflateCompressor_h
+#define itkParallelDeflateCompressor_h
+
+#include "ITKIOImageBaseExport.h"
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkIntTypes.h"
+#include "itkThreadSupport.h"
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/** \class ParallelDeflateCompressor
+ * \brief Compress data in a zlib or gzip stream using multiple threads.
+ *
+ * The data is split in blocks which are deflated in parallel, as done by
+ * pigz. Each block but the last one ends with a sync flush, so that the
+ * compressed blocks concatenate into a single standard deflate stream,
+ * which any zlib or gzip reader can decompress. Each block is primed with
+ * the last 32 KiB of data of the previous block, hence the compression
+ * ratio is close to the one of a single-threaded deflate.
+ *
+ * The compressed data depends on the compression level and on the block
+ * size, but not on the number of threads.
+ *
+ * \ingroup ITKIOImageBase
+ */
+class ITKIOImageBase_EXPORT ParallelDeflateCompressor: public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ParallelDeflateCompressor);
+
+  /** Standard class type aliases. */
+  using Self = ParallelDeflateCompressor;
+  using Superclass = Object;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ParallelDeflateCompressor, Object);
+
+  /** Format of the compressed stream: zlib (RFC 1950) or gzip (RFC 1952). */
+  typedef enum { ZLIB, GZIP } StreamFormatType;
+
+  /** A buffer of data to compress: its address and its size in bytes. */
+  using BufferType = std::pair< const void *, SizeValueType >;
+
+  /** Set/Get the format of the compressed stream. Default is ZLIB. */
+  itkSetEnumMacro(StreamFormat, StreamFormatType);
+  itkGetEnumMacro(StreamFormat, StreamFormatType);
+
+  /** Set/Get the zlib compression level, from 0 to 9. Default is 6. */
+  itkSetClampMacro(CompressionLevel, int, 0, 9);
+  itkGetConstMacro(CompressionLevel, int);
+
+  /** Set/Get the number of threads. Default is the global default number
+   * of threads of MultiThreaderBase. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
+  /** Set/Get the number of bytes of data compressed as one block. Default
+   * is 128 KiB, like pigz. */
+  itkSetClampMacro(BlockSize, SizeValueType, 32768, 1 << 30);
+  itkGetConstMacro(BlockSize, SizeValueType);
+
+  /** Compress the concatenation of the buffers, which must remain valid
+   * until the method returns. Throws an exception if zlib fails. */
+  void Compress(const std::vector< BufferType > & buffers);
+
+  /** Compress \c size bytes of data. */
+  void Compress(const void *data, SizeValueType size);
+
+  /** Size in bytes of the compressed stream, including the header and the
+   * trailer of the format. */
+  SizeValueType GetCompressedSize() const;
+
+  /** Copy the compressed stream to a buffer of GetCompressedSize() bytes. */
+  void CopyCompressedData(void *buffer) const;
+
+  /** Write the compressed stream. Returns false if the stream fails. */
+  bool WriteCompressedData(std::ostream & os) const;
+
+  /** Release the compressed stream. */
+  void ReleaseCompressedData();
+
+protected:
+  ParallelDeflateCompressor();
+  ~ParallelDeflateCompressor() override = default;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  using ByteArrayType = std::vector< unsigned char >;
+
+  StreamFormatType m_StreamFormat;
+  int              m_CompressionLevel;
+  ThreadIdType     m_NumberOfThreads;
+  SizeValueType    m_BlockSize;
+
+  // Format header, compressed blocks and format trailer
+  std::vector< ByteArrayType > m_CompressedData;
+};
+} // end namespace itk
+
+#endif // itkParallelDeflateCompressor_h
@@ -11,10 +11,13 @@ itk_module(ITKIOImageBase
   ENABLE_SHARED
   DEPENDS
     ITKCommon
+  PRIVATE_DEPENDS
+    ITKZLIB
   TEST_DEPENDS
     ITKTestKernel
     ITKGDCM
     ITKImageIntensity
+    ITKZLIB
   DESCRIPTION
     "${DOCUMENTATION}"
 )
@@ -22,6 +22,7 @@
 #include "itkMutexLockHolder.h"
 
 #include "itksys/SystemTools.hxx"
+#include <algorithm>
 
 namespace itk
 {
@@ -30,7 +31,9 @@ ImageIOBase::ImageIOBase():
   m_ComponentType(UNKNOWNCOMPONENTTYPE),
   m_ByteOrder(OrderNotApplicable),
   m_FileType(TypeNotApplicable),
-  m_NumberOfDimensions(0)
+  m_NumberOfDimensions(0),
+  m_CompressionLevel(6),
+  m_NumberOfCompressionThreads(MultiThreaderBase::GetGlobalDefaultNumberOfThreads())
 {
   Reset(false);
 }
@@ -277,6 +280,44 @@ ImageIOBase
   return m_Strides[3];
 }
 
+bool
+ImageIOBase
+::GetContiguousIORegionOffset(SizeType & offset) const
+{
+  const unsigned int regionDimension = m_IORegion.GetImageDimension();
+  SizeType stride = static_cast< SizeType >( this->GetComponentSize() ) * this->GetNumberOfComponents();
+  bool     partial = false;
+
+  offset = 0;
+  for ( unsigned int i = 0; i < std::max( m_NumberOfDimensions, regionDimension ); ++i )
+    {
+    const SizeType index = i < regionDimension ? m_IORegion.GetIndex(i) : 0;
+    const SizeType size = i < regionDimension ? m_IORegion.GetSize(i) : 1;
+    const SizeType dimension = i < m_NumberOfDimensions ? m_Dimensions[i] : 1;
+
+    // Once the region does not span a whole dimension, it can only be
+    // contiguous if it is a single line/slice/... in the higher ones.
+    if ( partial && size != 1 )
+      {
+      return false;
+      }
+    if ( size != dimension )
+      {
+      partial = true;
+      }
+    offset += index * stride;
+    stride *= dimension;
+    }
+  return true;
+}
+
+bool
+ImageIOBase
+::CanMemoryMapPixelData(std::string &, SizeType &)
+{
+  return false;
+}
+
 void ImageIOBase::SetNumberOfDimensions(unsigned int dim)
 {
   if ( dim != m_NumberOfDimensions )
@@ -1070,6 +1111,25 @@ ImageIOBase
   return axis;
 }
 
+LightObject::Pointer
+ImageIOBase::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self::Pointer rval = dynamic_cast< Self * >( loPtr.GetPointer() );
+  if ( rval.IsNull() )
+    {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+  rval->m_UseCompression = m_UseCompression;
+  rval->m_CompressionLevel = m_CompressionLevel;
+  rval->m_NumberOfCompressionThreads = m_NumberOfCompressionThreads;
+  rval->m_UseStreamedReading = m_UseStreamedReading;
+  rval->m_UseStreamedWriting = m_UseStreamedWriting;
+  rval->m_ExpandRGBPalette = m_ExpandRGBPalette;
+  return loPtr;
+}
+
 void ImageIOBase::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
@@ -1104,6 +1164,8 @@ void ImageIOBase::PrintSelf(std::ostream & os, Indent indent) const
     {
     os << indent << "UseCompression: Off" << std::endl;
     }
+  os << indent << "CompressionLevel: " << m_CompressionLevel << std::endl;
+  os << indent << "NumberOfCompressionThreads: " << m_NumberOfCompressionThreads << std::endl;
   if( m_UseStreamedReading )
     {
     os << indent << "UseStreamedReading: On" << std::endl;
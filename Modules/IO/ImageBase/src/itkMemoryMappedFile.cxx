@@ -0,0 +1,157 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkMemoryMappedFile.h"
+#include <cstdint>
+
+#if defined( _WIN32 )
+  #include "itksys/Encoding.hxx"
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace itk
+{
+MemoryMappedFile::MemoryMappedFile():
+  m_MappedAddress(nullptr),
+  m_MappedLength(0),
+  m_Pointer(nullptr),
+  m_Length(0)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Unmap();
+}
+
+bool
+MemoryMappedFile::Map(const std::string & fileName, SizeType offset, SizeType length)
+{
+  this->Unmap();
+
+  if ( length <= 0 || offset < 0 )
+    {
+    return false;
+    }
+
+#if defined( _WIN32 )
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  const SizeType mapOffset = offset - offset % systemInfo.dwAllocationGranularity;
+  const SizeType mapLength = length + ( offset - mapOffset );
+  if ( static_cast< unsigned long long >( mapLength ) > static_cast< unsigned long long >( SIZE_MAX ) )
+    {
+    return false;
+    }
+
+  HANDLE file = CreateFileW(itksys::Encoding::ToWide(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if ( file == INVALID_HANDLE_VALUE )
+    {
+    return false;
+    }
+  LARGE_INTEGER fileSize;
+  if ( !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < offset + length )
+    {
+    CloseHandle(file);
+    return false;
+    }
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+  if ( mapping == nullptr )
+    {
+    return false;
+    }
+  void *address = MapViewOfFile(mapping, FILE_MAP_COPY,
+                                static_cast< DWORD >( static_cast< unsigned long long >( mapOffset ) >> 32 ),
+                                static_cast< DWORD >( mapOffset & 0xFFFFFFFF ),
+                                static_cast< SIZE_T >( mapLength ));
+  // The view keeps the mapping object alive.
+  CloseHandle(mapping);
+  if ( address == nullptr )
+    {
+    return false;
+    }
+#else
+  const auto pageSize = static_cast< SizeType >( sysconf(_SC_PAGESIZE) );
+  const SizeType mapOffset = offset - offset % pageSize;
+  const SizeType mapLength = length + ( offset - mapOffset );
+  if ( static_cast< unsigned long long >( mapLength ) > static_cast< unsigned long long >( SIZE_MAX ) )
+    {
+    return false;
+    }
+
+  const int file = open(fileName.c_str(), O_RDONLY);
+  if ( file < 0 )
+    {
+    return false;
+    }
+  struct stat fileStatus;
+  if ( fstat(file, &fileStatus) != 0 || static_cast< SizeType >( fileStatus.st_size ) < offset + length )
+    {
+    close(file);
+    return false;
+    }
+  void *address = mmap(nullptr, static_cast< std::size_t >( mapLength ), PROT_READ | PROT_WRITE, MAP_PRIVATE, file,
+                       static_cast< off_t >( mapOffset ));
+  // The mapping stays valid after the file is closed.
+  close(file);
+  if ( address == MAP_FAILED )
+    {
+    return false;
+    }
+#endif
+
+  m_MappedAddress = address;
+  m_MappedLength = static_cast< std::size_t >( mapLength );
+  m_Pointer = static_cast< char * >( address ) + ( offset - mapOffset );
+  m_Length = length;
+  return true;
+}
+
+void
+MemoryMappedFile::Unmap()
+{
+  if ( m_MappedAddress == nullptr )
+    {
+    return;
+    }
+#if defined( _WIN32 )
+  UnmapViewOfFile(m_MappedAddress);
+#else
+  munmap(m_MappedAddress, m_MappedLength);
+#endif
+  m_MappedAddress = nullptr;
+  m_MappedLength = 0;
+  m_Pointer = nullptr;
+  m_Length = 0;
+}
+
+void
+MemoryMappedFile::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Pointer: " << m_Pointer << std::endl;
+  os << indent << "Length: " << m_Length << std::endl;
+}
+} // end namespace itk
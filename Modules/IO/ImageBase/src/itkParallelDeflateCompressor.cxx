@@ -0,0 +1,291 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkParallelDeflateCompressor.h"
+#include "itkMultiThreaderBase.h"
+#include "itk_zlib.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace itk
+{
+namespace
+{
+// Size of the deflate window, and of the dictionary priming each block.
+constexpr SizeValueType DeflateWindowSize = 32768;
+
+// A block of data to compress, its compressed bytes and its checksum.
+struct DeflateBlock
+{
+  const unsigned char *data;
+  SizeValueType        size;
+  const unsigned char *dictionary;
+  SizeValueType        dictionarySize;
+  bool                 last;
+  std::vector< unsigned char > compressed;
+  uLong                checksum;
+  bool                 failed;
+};
+
+void DeflateBlockData(DeflateBlock & block, int level, bool gzip)
+{
+  z_stream stream;
+  std::memset(&stream, 0, sizeof( stream ));
+  // Raw deflate: the format header and trailer are added once for all blocks.
+  if ( deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK )
+    {
+    block.failed = true;
+    return;
+    }
+  if ( block.dictionarySize > 0
+       && deflateSetDictionary(&stream, block.dictionary, static_cast< uInt >( block.dictionarySize )) != Z_OK )
+    {
+    deflateEnd(&stream);
+    block.failed = true;
+    return;
+    }
+
+  // A sync flush ends the block on a byte boundary, without marking the end
+  // of the deflate stream, so that the next block can be appended.
+  const int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+  block.compressed.resize(deflateBound(&stream, static_cast< uLong >( block.size )) + 16);
+  stream.next_in = const_cast< Bytef * >( block.data );
+  stream.avail_in = static_cast< uInt >( block.size );
+  stream.next_out = block.compressed.data();
+  stream.avail_out = static_cast< uInt >( block.compressed.size() );
+  int status;
+  for (;; )
+    {
+    status = deflate(&stream, flush);
+    const bool done = flush == Z_FINISH ? status == Z_STREAM_END : stream.avail_out > 0;
+    if ( done || ( status != Z_OK && status != Z_BUF_ERROR ) )
+      {
+      break;
+      }
+    const SizeValueType used = block.compressed.size();
+    block.compressed.resize(2 * used);
+    stream.next_out = block.compressed.data() + used;
+    stream.avail_out = static_cast< uInt >( used );
+    }
+  block.failed = flush == Z_FINISH ? status != Z_STREAM_END : status != Z_OK;
+  block.compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  block.checksum = gzip ? crc32(0L, Z_NULL, 0) : adler32(0L, Z_NULL, 0);
+  block.checksum = gzip
+                   ? crc32(block.checksum, block.data, static_cast< uInt >( block.size ))
+                   : adler32(block.checksum, block.data, static_cast< uInt >( block.size ));
+}
+
+void AppendBigEndian32(std::vector< unsigned char > & bytes, uLong value)
+{
+  for ( int shift = 24; shift >= 0; shift -= 8 )
+    {
+    bytes.push_back(static_cast< unsigned char >( ( value >> shift ) & 0xFF ));
+    }
+}
+
+void AppendLittleEndian32(std::vector< unsigned char > & bytes, uLong value)
+{
+  for ( int shift = 0; shift <= 24; shift += 8 )
+    {
+    bytes.push_back(static_cast< unsigned char >( ( value >> shift ) & 0xFF ));
+    }
+}
+}
+
+ParallelDeflateCompressor::ParallelDeflateCompressor():
+  m_StreamFormat(ZLIB),
+  m_CompressionLevel(6),
+  m_NumberOfThreads(MultiThreaderBase::GetGlobalDefaultNumberOfThreads()),
+  m_BlockSize(131072)
+{
+}
+
+void
+ParallelDeflateCompressor::Compress(const void *data, SizeValueType size)
+{
+  this->Compress(std::vector< BufferType >( 1, BufferType(data, size) ));
+}
+
+void
+ParallelDeflateCompressor::Compress(const std::vector< BufferType > & buffers)
+{
+  m_CompressedData.clear();
+
+  // Split the buffers in blocks. Each block is primed with the end of the
+  // previous block.
+  std::vector< DeflateBlock > blocks;
+  SizeValueType               totalSize = 0;
+  for ( const auto & buffer : buffers )
+    {
+    const auto *data = static_cast< const unsigned char * >( buffer.first );
+    for ( SizeValueType start = 0; start < buffer.second; start += m_BlockSize )
+      {
+      DeflateBlock block;
+      block.data = data + start;
+      block.size = std::min(m_BlockSize, buffer.second - start);
+      block.dictionary = nullptr;
+      block.dictionarySize = 0;
+      if ( !blocks.empty() )
+        {
+        const DeflateBlock & previous = blocks.back();
+        block.dictionarySize = std::min(previous.size, DeflateWindowSize);
+        block.dictionary = previous.data + previous.size - block.dictionarySize;
+        }
+      block.last = false;
+      block.checksum = 0;
+      block.failed = false;
+      blocks.push_back(block);
+      }
+    totalSize += buffer.second;
+    }
+  if ( blocks.empty() )
+    {
+    DeflateBlock block;
+    block.data = nullptr;
+    block.size = 0;
+    block.dictionary = nullptr;
+    block.dictionarySize = 0;
+    block.checksum = 0;
+    block.failed = false;
+    blocks.push_back(block);
+    }
+  blocks.back().last = true;
+
+  const bool gzip = m_StreamFormat == GZIP;
+  const int  level = m_CompressionLevel;
+  if ( blocks.size() == 1 || m_NumberOfThreads == 1 )
+    {
+    for ( auto & block : blocks )
+      {
+      DeflateBlockData(block, level, gzip);
+      }
+    }
+  else
+    {
+    MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+    threader->SetNumberOfThreads(m_NumberOfThreads);
+    threader->SetArrayGrainSize(1);
+    threader->ParallelizeArray(0, blocks.size(),
+                               [&blocks, level, gzip](SizeValueType i)
+                                 {
+                                 DeflateBlockData(blocks[i], level, gzip);
+                                 },
+                               nullptr);
+    }
+
+  // Header
+  ByteArrayType header;
+  if ( gzip )
+    {
+    // Magic, deflate, no flags, no modification time, extra flags, unknown OS
+    const unsigned char extraFlags = level == 9 ? 2 : ( level == 1 ? 4 : 0 );
+    const unsigned char gzipHeader[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, extraFlags, 255 };
+    header.assign(gzipHeader, gzipHeader + 10);
+    }
+  else
+    {
+    // Deflate with a 32 KiB window, and the level hint zlib would write.
+    const unsigned int levelFlags = level < 2 ? 0 : ( level < 6 ? 1 : ( level == 6 ? 2 : 3 ) );
+    unsigned int       zlibHeader = ( 0x78 << 8 ) | ( levelFlags << 6 );
+    zlibHeader += 31 - zlibHeader % 31;
+    header.push_back(static_cast< unsigned char >( zlibHeader >> 8 ));
+    header.push_back(static_cast< unsigned char >( zlibHeader & 0xFF ));
+    }
+  m_CompressedData.push_back(std::move(header));
+
+  // Blocks, and the checksum of the whole data
+  uLong checksum = gzip ? crc32(0L, Z_NULL, 0) : adler32(0L, Z_NULL, 0);
+  for ( auto & block : blocks )
+    {
+    if ( block.failed )
+      {
+      m_CompressedData.clear();
+      itkExceptionMacro("Deflate compression failed");
+      }
+    checksum = gzip
+               ? crc32_combine(checksum, block.checksum, static_cast< z_off_t >( block.size ))
+               : adler32_combine(checksum, block.checksum, static_cast< z_off_t >( block.size ));
+    m_CompressedData.push_back(std::move(block.compressed));
+    }
+
+  // Trailer
+  ByteArrayType trailer;
+  if ( gzip )
+    {
+    AppendLittleEndian32(trailer, checksum);
+    AppendLittleEndian32(trailer, static_cast< uLong >( totalSize & 0xFFFFFFFF ));
+    }
+  else
+    {
+    AppendBigEndian32(trailer, checksum);
+    }
+  m_CompressedData.push_back(std::move(trailer));
+}
+
+SizeValueType
+ParallelDeflateCompressor::GetCompressedSize() const
+{
+  SizeValueType size = 0;
+  for ( const auto & bytes : m_CompressedData )
+    {
+    size += bytes.size();
+    }
+  return size;
+}
+
+void
+ParallelDeflateCompressor::CopyCompressedData(void *buffer) const
+{
+  auto *output = static_cast< unsigned char * >( buffer );
+  for ( const auto & bytes : m_CompressedData )
+    {
+    std::copy(bytes.begin(), bytes.end(), output);
+    output += bytes.size();
+    }
+}
+
+bool
+ParallelDeflateCompressor::WriteCompressedData(std::ostream & os) const
+{
+  for ( const auto & bytes : m_CompressedData )
+    {
+    os.write(reinterpret_cast< const char * >( bytes.data() ), bytes.size());
+    }
+  return !os.fail();
+}
+
+void
+ParallelDeflateCompressor::ReleaseCompressedData()
+{
+  std::vector< ByteArrayType >().swap(m_CompressedData);
+}
+
+void
+ParallelDeflateCompressor::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "StreamFormat: " << ( m_StreamFormat == GZIP ? "GZIP" : "ZLIB" ) << std::endl;
+  os << indent << "CompressionLevel: " << m_CompressionLevel << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "BlockSize: " << m_BlockSize << std::endl;
+  os << indent << "CompressedSize: " << this->GetCompressedSize() << std::endl;
+}
+} // end namespace itk
@@ -0,0 +1,218 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkMemoryMappedFile.h"
+#include "itkRGBPixel.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+// Read images with and without memory mapping, and check that the mapped
+// images have the same pixels, that writing to them does not modify the
+// files, and that the reader falls back to reading when the pixels cannot
+// be mapped.
+
+namespace
+{
+
+template< typename TImage >
+typename TImage::Pointer
+CreateImage()
+{
+  using PixelType = typename TImage::PixelType;
+
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size;
+  size.Fill( 5 );
+  size[0] = 17;
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( unsigned int i = 0; !it.IsAtEnd(); ++it, ++i )
+    {
+    it.Set( static_cast< PixelType >( ( i * 37 ) % 251 ) );
+    }
+  return image;
+}
+
+template< typename TImage >
+bool
+SameImage( const TImage * image1, const TImage * image2 )
+{
+  if ( image1->GetBufferedRegion() != image2->GetBufferedRegion() )
+    {
+    std::cerr << "Different regions: " << image1->GetBufferedRegion() << " and " << image2->GetBufferedRegion()
+              << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image1, image1->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != image2->GetPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Different pixels at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< typename TImage >
+bool
+IsMapped( const TImage * image )
+{
+  using ContainerType = itk::MemoryMappedImportImageContainer< itk::SizeValueType, typename TImage::PixelType >;
+  return dynamic_cast< const ContainerType * >( image->GetPixelContainer() ) != nullptr;
+}
+
+template< typename TImage >
+typename TImage::Pointer
+Read( const std::string & fileName, bool useMemoryMapping, const typename TImage::RegionType * region = nullptr )
+{
+  using ReaderType = itk::ImageFileReader< TImage >;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  reader->SetUseMemoryMapping( useMemoryMapping );
+  if ( region )
+    {
+    reader->GetOutput()->SetRequestedRegion( *region );
+    reader->Update();
+    }
+  else
+    {
+    reader->UpdateLargestPossibleRegion();
+    }
+  typename TImage::Pointer image = reader->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+}
+
+// Write an image, and check whether it is read mapped or not.
+template< typename TImage >
+bool
+TestFile( const std::string & fileName, bool expectMapped, bool compress = false )
+{
+  std::cout << "Testing " << fileName << std::endl;
+
+  typename TImage::Pointer image = CreateImage< TImage >();
+  using WriterType = itk::ImageFileWriter< TImage >;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( image );
+  writer->SetUseCompression( compress );
+  writer->Update();
+
+  typename TImage::Pointer read = Read< TImage >( fileName, false );
+  typename TImage::Pointer mapped = Read< TImage >( fileName, true );
+  if ( IsMapped( read.GetPointer() ) || IsMapped( mapped.GetPointer() ) != expectMapped )
+    {
+    std::cerr << fileName << ( expectMapped ? " was not" : " was" ) << " memory mapped" << std::endl;
+    return false;
+    }
+  if ( !SameImage( image.GetPointer(), read.GetPointer() ) || !SameImage( image.GetPointer(), mapped.GetPointer() ) )
+    {
+    return false;
+    }
+
+  // Modifying the mapped image does not modify the file.
+  mapped->FillBuffer( typename TImage::PixelType() );
+  mapped = nullptr;
+  typename TImage::Pointer reread = Read< TImage >( fileName, true );
+  if ( !SameImage( image.GetPointer(), reread.GetPointer() ) )
+    {
+    std::cerr << "The file was modified through the mapping" << std::endl;
+    return false;
+    }
+
+  // Contiguous requested region: slices 1 and 2.
+  typename TImage::RegionType region = image->GetLargestPossibleRegion();
+  region.SetIndex( TImage::ImageDimension - 1, 1 );
+  region.SetSize( TImage::ImageDimension - 1, 2 );
+  typename TImage::Pointer slices = Read< TImage >( fileName, true, &region );
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( slices, region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != image->GetPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Different pixels at " << it.GetIndex() << " in region " << region << std::endl;
+      return false;
+      }
+    }
+  if ( slices->GetBufferedRegion() == region && IsMapped( slices.GetPointer() ) != expectMapped )
+    {
+    std::cerr << "The requested region of " << fileName << ( expectMapped ? " was not" : " was" )
+              << " memory mapped" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
+
+int itkImageFileReaderMemoryMappingTest( int argc, char * argv[] )
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string( argv[1] ) + "/";
+
+  using ShortImageType = itk::Image< short, 3 >;
+  using FloatImageType = itk::Image< float, 2 >;
+  using UCharImageType = itk::Image< unsigned char, 3 >;
+  using RGBImageType = itk::Image< itk::RGBPixel< unsigned char >, 3 >;
+
+  using ReaderType = itk::ImageFileReader< ShortImageType >;
+  ReaderType::Pointer reader = ReaderType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( reader, ImageFileReader, ImageSource );
+  TEST_SET_GET_BOOLEAN( reader, UseMemoryMapping, true );
+
+  bool success = true;
+  // The pixels of .mha files follow a header of arbitrary length: they are
+  // only mapped when aligned.
+  success &= TestFile< UCharImageType >( directory + "MemoryMappingTest.mha", true );
+  success &= TestFile< ShortImageType >( directory + "MemoryMappingTest.mhd", true );
+  success &= TestFile< FloatImageType >( directory + "MemoryMappingTestFloat.mhd", true );
+  success &= TestFile< RGBImageType >( directory + "MemoryMappingTestRGB.mha", true );
+  success &= TestFile< ShortImageType >( directory + "MemoryMappingTest.nrrd", true );
+  success &= TestFile< ShortImageType >( directory + "MemoryMappingTest.nhdr", true );
+  success &= TestFile< ShortImageType >( directory + "MemoryMappingTest.nii", true );
+  success &= TestFile< RGBImageType >( directory + "MemoryMappingTestRGB.nii", true );
+
+  // Compressed pixels are read.
+  success &= TestFile< ShortImageType >( directory + "MemoryMappingTestCompressed.mha", false, true );
+  success &= TestFile< ShortImageType >( directory + "MemoryMappingTest.nii.gz", false );
+
+  // Pixels converted by the reader are read.
+  UCharImageType::Pointer converted = Read< UCharImageType >( directory + "MemoryMappingTest.mhd", true );
+  if ( IsMapped( converted.GetPointer() ) )
+    {
+    std::cerr << "Converted pixels were memory mapped" << std::endl;
+    success = false;
+    }
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,308 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageSeriesReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMetaDataObject.h"
+#include "itkMetaImageIO.h"
+#include "itkPNGImageIO.h"
+#include "itkTIFFImageIO.h"
+#include "itkJPEGImageIO.h"
+#include "itkTestingMacros.h"
+
+// Read a series of slices with several threads, and check that the
+// volume and the MetaDataDictionaryArray are the ones read with one
+// thread, in the order of the files, and that progress is reported for
+// each slice. The MetaImage and PNG slices are read concurrently, and the
+// TIFF slices one after the other, until the first failure.
+
+namespace
+{
+
+using SliceType = itk::Image< unsigned short, 2 >;
+using VolumeType = itk::Image< unsigned short, 3 >;
+using ReaderType = itk::ImageSeriesReader< VolumeType >;
+
+class ProgressObserver : public itk::Command
+{
+public:
+  using Self = ProgressObserver;
+  using Superclass = itk::Command;
+  using Pointer = itk::SmartPointer< Self >;
+  itkNewMacro( Self );
+
+  void Execute( itk::Object * caller, const itk::EventObject & event ) override
+  {
+    Execute( (const itk::Object *)caller, event );
+  }
+
+  void Execute( const itk::Object * caller, const itk::EventObject & event ) override
+  {
+    if ( itk::ProgressEvent().CheckEvent( &event ) )
+      {
+      const auto * process = static_cast< const itk::ProcessObject * >( caller );
+      if ( process->GetProgress() < m_LastProgress )
+        {
+        m_Monotonic = false;
+        }
+      m_LastProgress = process->GetProgress();
+      ++m_NumberOfEvents;
+      }
+  }
+
+  unsigned int m_NumberOfEvents{ 0 };
+  float        m_LastProgress{ 0.0f };
+  bool         m_Monotonic{ true };
+};
+
+VolumeType::Pointer
+Read( const ReaderType::FileNamesContainer & fileNames, unsigned int numberOfThreads, bool reverseOrder,
+      itk::ImageIOBase * imageIO, std::vector< std::string > & sliceNumbers,
+      ProgressObserver * progress = nullptr )
+{
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileNames( fileNames );
+  reader->SetNumberOfThreads( numberOfThreads );
+  reader->SetReverseOrder( reverseOrder );
+  if ( imageIO )
+    {
+    reader->SetImageIO( imageIO );
+    }
+  if ( progress )
+    {
+    reader->AddObserver( itk::ProgressEvent(), progress );
+    }
+  reader->Update();
+
+  sliceNumbers.clear();
+  const ReaderType::DictionaryArrayType & dictionaries = *reader->GetMetaDataDictionaryArray();
+  for ( auto dictionary : dictionaries )
+    {
+    std::string sliceNumber;
+    itk::ExposeMetaData< std::string >( *dictionary, "SliceNumber", sliceNumber );
+    sliceNumbers.push_back( sliceNumber );
+    }
+
+  VolumeType::Pointer volume = reader->GetOutput();
+  volume->DisconnectPipeline();
+  return volume;
+}
+
+bool
+SameImage( const VolumeType * image1, const VolumeType * image2 )
+{
+  if ( image1->GetBufferedRegion() != image2->GetBufferedRegion() )
+    {
+    std::cerr << "Different regions" << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIteratorWithIndex< VolumeType > it( image1, image1->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != image2->GetPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Different pixels at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+itk::ImageIOBase::Pointer
+CreateImageIO( const std::string & extension )
+{
+  if ( extension == ".png" )
+    {
+    return itk::PNGImageIO::New().GetPointer();
+    }
+  if ( extension == ".tif" )
+    {
+    return itk::TIFFImageIO::New().GetPointer();
+    }
+  return itk::MetaImageIO::New().GetPointer();
+}
+
+// Read the series written in the format of the extension.
+bool
+TestFormat( const std::string & directory, const std::string & extension )
+{
+  std::cout << "Format " << extension << std::endl;
+
+  // Write the slices, each with its number in its meta data.
+  constexpr unsigned int numberOfSlices = 23;
+  ReaderType::FileNamesContainer fileNames;
+  for ( unsigned int slice = 0; slice < numberOfSlices; ++slice )
+    {
+    SliceType::Pointer image = SliceType::New();
+    SliceType::SizeType size = { { 37, 29 } };
+    image->SetRegions( size );
+    image->Allocate();
+    itk::ImageRegionIteratorWithIndex< SliceType > it( image, image->GetBufferedRegion() );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      it.Set( static_cast< unsigned short >( it.GetIndex()[0] + 40 * it.GetIndex()[1] + 1000 * slice ) );
+      }
+    itk::EncapsulateMetaData< std::string >( image->GetMetaDataDictionary(), "SliceNumber", std::to_string( slice ) );
+
+    std::ostringstream fileName;
+    fileName << directory << "ImageSeriesReaderParallelTest" << slice << extension;
+    fileNames.push_back( fileName.str() );
+
+    using WriterType = itk::ImageFileWriter< SliceType >;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( fileNames.back() );
+    writer->SetInput( image );
+    writer->Update();
+    }
+
+  // Only MetaImage stores the meta data of the slices.
+  const bool checkMetaData = ( extension == ".mha" );
+
+  bool success = true;
+  for ( bool reverseOrder : { false, true } )
+    {
+    std::vector< std::string > referenceSliceNumbers;
+    ProgressObserver::Pointer referenceProgress = ProgressObserver::New();
+    VolumeType::Pointer reference = Read( fileNames, 1, reverseOrder, nullptr, referenceSliceNumbers, referenceProgress );
+    for ( unsigned int slice = 0; slice < numberOfSlices; ++slice )
+      {
+      const unsigned int file = reverseOrder ? numberOfSlices - 1 - slice : slice;
+      const VolumeType::IndexType index = { { 5, 7, slice } };
+      if ( ( checkMetaData && referenceSliceNumbers[slice] != std::to_string( file ) )
+           || reference->GetPixel( index ) != static_cast< unsigned short >( 5 + 280 + 1000 * file ) )
+        {
+        std::cerr << "Wrong slice " << slice << " with reverse order " << reverseOrder << std::endl;
+        success = false;
+        }
+      }
+    // Progress is reported for each slice.
+    if ( referenceProgress->m_NumberOfEvents < numberOfSlices || !referenceProgress->m_Monotonic
+         || referenceProgress->m_LastProgress != 1.0f )
+      {
+      std::cerr << "Wrong progress: " << referenceProgress->m_NumberOfEvents << " events, last progress "
+                << referenceProgress->m_LastProgress << std::endl;
+      success = false;
+      }
+
+    for ( unsigned int numberOfThreads = 2; numberOfThreads <= 8; numberOfThreads *= 2 )
+      {
+      for ( bool setImageIO : { false, true } )
+        {
+        itk::ImageIOBase::Pointer imageIO = CreateImageIO( extension );
+        std::vector< std::string > sliceNumbers;
+        ProgressObserver::Pointer progress = ProgressObserver::New();
+        VolumeType::Pointer volume =
+          Read( fileNames, numberOfThreads, reverseOrder, setImageIO ? imageIO.GetPointer() : nullptr, sliceNumbers,
+                progress );
+        if ( !SameImage( reference, volume ) || sliceNumbers != referenceSliceNumbers )
+          {
+          std::cerr << "Reading with " << numberOfThreads << " threads differs, reverse order: " << reverseOrder
+                    << ", ImageIO set: " << setImageIO << std::endl;
+          success = false;
+          }
+        if ( !progress->m_Monotonic || progress->m_LastProgress != 1.0f
+             || ( !imageIO->CanReadFilesConcurrently() && progress->m_NumberOfEvents < numberOfSlices ) )
+          {
+          std::cerr << "Wrong progress with " << numberOfThreads << " threads: " << progress->m_NumberOfEvents
+                    << " events, last progress " << progress->m_LastProgress << std::endl;
+          success = false;
+          }
+        // The ImageIO set holds the information of the last file.
+        if ( setImageIO && imageIO->GetFileName() != fileNames[reverseOrder ? 0 : numberOfSlices - 1] )
+          {
+          std::cerr << "The ImageIO set read " << imageIO->GetFileName() << std::endl;
+          success = false;
+          }
+        }
+      }
+    }
+
+  // The error of a slice is reported.
+  fileNames[numberOfSlices / 2] = directory + "ImageSeriesReaderParallelTestMissing" + extension;
+  std::vector< std::string > sliceNumbers;
+  TRY_EXPECT_EXCEPTION( Read( fileNames, 4, false, nullptr, sliceNumbers ) );
+
+  // The files after the one which failed are not read one after the other.
+  ProgressObserver::Pointer failureProgress = ProgressObserver::New();
+  TRY_EXPECT_EXCEPTION( Read( fileNames, 1, false, nullptr, sliceNumbers, failureProgress ) );
+  if ( failureProgress->m_LastProgress * numberOfSlices > numberOfSlices / 2 + 1 )
+    {
+    std::cerr << "Read after the failure, last progress " << failureProgress->m_LastProgress << std::endl;
+    success = false;
+    }
+
+  return success;
+}
+
+}
+
+int itkImageSeriesReaderParallelTest( int argc, char * argv[] )
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string( argv[1] ) + "/";
+
+  bool success = true;
+  for ( const char * extension : { ".mha", ".png", ".tif" } )
+    {
+    success &= TestFormat( directory, extension );
+    }
+
+  // The clones of the ImageIOs used to read the slices concurrently keep
+  // the reading and writing settings.
+  itk::MetaImageIO::Pointer metaImageIO = itk::MetaImageIO::New();
+  metaImageIO->SetSubSamplingFactor( 3 );
+  metaImageIO->SetUseCompression( true );
+  TEST_EXPECT_TRUE( metaImageIO->CanReadFilesConcurrently() );
+  itk::ImageIOBase::Pointer metaImageIOBaseClone = metaImageIO->Clone();
+  auto * metaImageIOClone = dynamic_cast< itk::MetaImageIO * >( metaImageIOBaseClone.GetPointer() );
+  TEST_EXPECT_TRUE( metaImageIOClone != nullptr );
+  TEST_SET_GET_VALUE( 3u, metaImageIOClone->GetSubSamplingFactor() );
+  TEST_SET_GET_VALUE( true, metaImageIOClone->GetUseCompression() );
+
+  itk::JPEGImageIO::Pointer jpegImageIO = itk::JPEGImageIO::New();
+  jpegImageIO->SetQuality( 42 );
+  jpegImageIO->SetProgressive( false );
+  itk::ImageIOBase::Pointer jpegImageIOBaseClone = jpegImageIO->Clone();
+  auto * jpegImageIOClone = dynamic_cast< itk::JPEGImageIO * >( jpegImageIOBaseClone.GetPointer() );
+  TEST_EXPECT_TRUE( jpegImageIOClone != nullptr );
+  TEST_SET_GET_VALUE( 42, jpegImageIOClone->GetQuality() );
+  TEST_SET_GET_VALUE( false, jpegImageIOClone->GetProgressive() );
+
+  // libtiff has global error handlers: TIFF files are read one at a time.
+  itk::TIFFImageIO::Pointer tiffImageIO = itk::TIFFImageIO::New();
+  tiffImageIO->SetCompressionToJPEG();
+  tiffImageIO->SetJPEGQuality( 42 );
+  TEST_EXPECT_TRUE( !tiffImageIO->CanReadFilesConcurrently() );
+  itk::ImageIOBase::Pointer tiffImageIOBaseClone = tiffImageIO->Clone();
+  auto * tiffImageIOClone = dynamic_cast< itk::TIFFImageIO * >( tiffImageIOBaseClone.GetPointer() );
+  TEST_EXPECT_TRUE( tiffImageIOClone != nullptr );
+  TEST_SET_GET_VALUE( true, tiffImageIOClone->GetUseCompression() );
+  TEST_SET_GET_VALUE( 42, tiffImageIOClone->GetJPEGQuality() );
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
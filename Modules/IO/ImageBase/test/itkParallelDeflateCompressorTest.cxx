@@ -0,0 +1,192 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkParallelDeflateCompressor.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include "itk_zlib.h"
+#include "itksys/SystemTools.hxx"
+#include <algorithm>
+#include <cstring>
+
+// Compress data in parallel, check that zlib decompresses it as a single
+// stream, and that the result does not depend on the number of threads.
+// Then write and read compressed MetaImage and NIfTI files.
+
+namespace
+{
+
+// Decompress a single zlib or gzip stream of data.size() bytes.
+bool
+Inflate( const std::vector< unsigned char > & compressed, bool gzip, std::vector< unsigned char > & data )
+{
+  z_stream stream;
+  std::memset( &stream, 0, sizeof( stream ) );
+  if ( inflateInit2( &stream, gzip ? 16 + MAX_WBITS : MAX_WBITS ) != Z_OK )
+    {
+    return false;
+    }
+  // One more byte, to check that the stream does not contain more data.
+  std::vector< unsigned char > output( data.size() + 1 );
+  stream.next_in = const_cast< Bytef * >( compressed.data() );
+  stream.avail_in = static_cast< uInt >( compressed.size() );
+  stream.next_out = output.data();
+  stream.avail_out = static_cast< uInt >( output.size() );
+  const int status = inflate( &stream, Z_FINISH );
+  const bool success = status == Z_STREAM_END && stream.avail_in == 0 && stream.total_out == data.size();
+  inflateEnd( &stream );
+  std::copy( output.begin(), output.begin() + data.size(), data.begin() );
+  return success;
+}
+
+template< typename TImage >
+bool
+TestFile( const std::string & fileName, unsigned int numberOfThreads )
+{
+  std::cout << "Testing " << fileName << " with " << numberOfThreads << " threads" << std::endl;
+
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size = { { 301, 203, 11 } };
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType index = it.GetIndex();
+    it.Set( static_cast< typename TImage::PixelType >( ( index[0] / 7 + index[1] / 5 + index[2] * 3 ) % 40 ) );
+    }
+
+  itk::ImageIOBase::Pointer imageIO =
+    itk::ImageIOFactory::CreateImageIO( fileName.c_str(), itk::ImageIOFactory::WriteMode );
+  imageIO->SetNumberOfCompressionThreads( numberOfThreads );
+  imageIO->SetCompressionLevel( 3 );
+
+  using WriterType = itk::ImageFileWriter< TImage >;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( image );
+  writer->UseCompressionOn();
+  writer->SetImageIO( imageIO );
+  writer->Update();
+
+  using ReaderType = itk::ImageFileReader< TImage >;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  reader->Update();
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != reader->GetOutput()->GetPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Different pixel in " << fileName << " at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkParallelDeflateCompressorTest( int argc, char * argv[] )
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string( argv[1] ) + "/";
+
+  itk::ParallelDeflateCompressor::Pointer compressor = itk::ParallelDeflateCompressor::New();
+  EXERCISE_BASIC_OBJECT_METHODS( compressor, ParallelDeflateCompressor, Object );
+  TEST_SET_GET_VALUE( 6, compressor->GetCompressionLevel() );
+  compressor->SetBlockSize( 40000 );
+  TEST_SET_GET_VALUE( 40000, compressor->GetBlockSize() );
+
+  // Compressible data, in several buffers not aligned on the blocks.
+  std::vector< unsigned char > data( 500000 );
+  for ( size_t i = 0; i < data.size(); ++i )
+    {
+    data[i] = static_cast< unsigned char >( ( i / 13 ) * ( i % 7 ) + i / 1000 );
+    }
+  std::vector< itk::ParallelDeflateCompressor::BufferType > buffers;
+  buffers.emplace_back( data.data(), 352 );
+  buffers.emplace_back( data.data() + 352, 0 );
+  buffers.emplace_back( data.data() + 352, 100000 );
+  buffers.emplace_back( data.data() + 100352, data.size() - 100352 );
+
+  const itk::ParallelDeflateCompressor::StreamFormatType formats[] =
+    { itk::ParallelDeflateCompressor::ZLIB, itk::ParallelDeflateCompressor::GZIP };
+  for ( auto format : formats )
+    {
+    const bool gzip = format == itk::ParallelDeflateCompressor::GZIP;
+    compressor->SetStreamFormat( format );
+    TEST_SET_GET_VALUE( format, compressor->GetStreamFormat() );
+
+    std::vector< unsigned char > reference;
+    for ( unsigned int numberOfThreads = 1; numberOfThreads <= 4; ++numberOfThreads )
+      {
+      compressor->SetNumberOfThreads( numberOfThreads );
+      compressor->Compress( buffers );
+      std::vector< unsigned char > compressed( compressor->GetCompressedSize() );
+      compressor->CopyCompressedData( compressed.data() );
+
+      std::vector< unsigned char > decompressed( data.size() );
+      if ( !Inflate( compressed, gzip, decompressed ) || decompressed != data )
+        {
+        std::cerr << "Decompression failed with " << numberOfThreads << " threads, gzip: " << gzip << std::endl;
+        return EXIT_FAILURE;
+        }
+      if ( reference.empty() )
+        {
+        reference = compressed;
+        std::cout << "Compressed " << data.size() << " bytes to " << compressed.size() << std::endl;
+        }
+      else if ( compressed != reference )
+        {
+        std::cerr << "The compressed data depends on the number of threads" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Empty data.
+  compressor->Compress( nullptr, 0 );
+  std::vector< unsigned char > compressed( compressor->GetCompressedSize() );
+  compressor->CopyCompressedData( compressed.data() );
+  std::vector< unsigned char > decompressed;
+  TEST_EXPECT_TRUE( Inflate( compressed, true, decompressed ) );
+
+  using ImageType = itk::Image< short, 3 >;
+  bool success = true;
+  for ( unsigned int numberOfThreads = 1; numberOfThreads <= 3; numberOfThreads += 2 )
+    {
+    success &= TestFile< ImageType >( directory + "ParallelDeflateCompressorTest.mha", numberOfThreads );
+    success &= TestFile< ImageType >( directory + "ParallelDeflateCompressorTest.mhd", numberOfThreads );
+    success &= TestFile< ImageType >( directory + "ParallelDeflateCompressorTest.nii.gz", numberOfThreads );
+    }
+  // The pixel data of the .mhd header are in a compressed data file.
+  TEST_EXPECT_TRUE( itksys::SystemTools::FileExists( directory + "ParallelDeflateCompressorTest.zraw" ) );
+
+  if ( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -62,6 +62,13 @@ public:
    * file specified. */
   bool CanReadFile(const char *) override;
 
+  /** libjpeg keeps no global state, so several instances can read files
+   * concurrently. */
+  bool CanReadFilesConcurrently() const override
+  {
+    return true;
+  }
+
   /** Set the spacing and diemention information for the set filename. */
   void ReadImageInformation() override;
 
@@ -90,6 +97,9 @@ protected:
   ~JPEGImageIO() override;
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** Copy the quality and progressive settings of this ImageIO. */
+  LightObject::Pointer InternalClone() const override;
+
   void WriteSlice(std::string & fileName, const void *buffer);
 
   /** Determines the quality of compression for written files.
@@ -298,6 +298,21 @@ JPEGImageIO::JPEGImageIO()
 JPEGImageIO::~JPEGImageIO()
 {}
 
+LightObject::Pointer
+JPEGImageIO::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self::Pointer rval = dynamic_cast< Self * >( loPtr.GetPointer() );
+  if ( rval.IsNull() )
+    {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+  rval->m_Quality = m_Quality;
+  rval->m_Progressive = m_Progressive;
+  return loPtr;
+}
+
 void JPEGImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
@@ -27,6 +27,8 @@
 
 namespace itk
 {
+class ParallelDeflateCompressor;
+
 /** \class MetaImageIO
  *
  *  \brief Read MetaImage file format.
@@ -69,12 +71,23 @@ public:
    * file specified. */
   bool CanReadFile(const char *) override;
 
+  /** MetaIO keeps no global state, so several instances can read files
+   * concurrently. */
+  bool CanReadFilesConcurrently() const override
+  {
+    return true;
+  }
+
   /** Set the spacing and dimension information for the set filename. */
   void ReadImageInformation() override;
 
   /** Reads the data from disk into the memory buffer provided. */
   void Read(void *buffer) override;
 
+  /** Raw pixel data, stored locally or in a single data file, can be
+   * memory mapped. */
+  bool CanMemoryMapPixelData(std::string & dataFileName, SizeType & offset) override;
+
   MetaImage * GetMetaImagePointer();
 
   /*-------- This part of the interfaces deals with writing data. ----- */
@@ -170,9 +183,37 @@ protected:
   ~MetaImageIO() override;
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** Copy the subsampling factor of this ImageIO. */
+  LightObject::Pointer InternalClone() const override;
+
 private:
 
-  MetaImage m_MetaImage;
+  /** MetaImage writing pixel data compressed by the ImageIO, so that they
+   * can be compressed in parallel: MetaIO compresses them in a single
+   * thread. */
+  class PrecompressedMetaImage: public MetaImage
+  {
+  public:
+    PrecompressedMetaImage():
+      m_Compressor(nullptr)
+    {}
+
+    /** Write the header and the pixel data compressed by \c compressor, as
+     * Write() does with the pixel data it compresses. The compressed blocks
+     * are written one after the other, without copying them. */
+    bool WritePrecompressed(const char *headName,
+                            const ParallelDeflateCompressor *compressor);
+
+  protected:
+    void M_SetupWriteFields() override;
+
+    bool M_Write() override;
+
+  private:
+    const ParallelDeflateCompressor *m_Compressor;
+  };
+
+  PrecompressedMetaImage m_MetaImage;
 
   unsigned int m_SubSamplingFactor;
 
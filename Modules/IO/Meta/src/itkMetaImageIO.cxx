@@ -20,8 +20,13 @@
 #include "itkSpatialOrientationAdapter.h"
 #include "itkMetaDataObject.h"
 #include "itkIOCommon.h"
+#include "itkParallelDeflateCompressor.h"
 #include "itksys/SystemTools.hxx"
 #include "itkMath.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
 
 namespace itk
 {
@@ -54,6 +59,20 @@ MetaImageIO::MetaImageIO()
 MetaImageIO::~MetaImageIO()
 {}
 
+LightObject::Pointer
+MetaImageIO::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self::Pointer rval = dynamic_cast< Self * >( loPtr.GetPointer() );
+  if ( rval.IsNull() )
+    {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+  rval->m_SubSamplingFactor = m_SubSamplingFactor;
+  return loPtr;
+}
+
 void MetaImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
@@ -496,6 +515,158 @@ void MetaImageIO::Read(void *buffer)
     }
 }
 
+bool MetaImageIO::CanMemoryMapPixelData(std::string & dataFileName, SizeType & offset)
+{
+  if ( m_SubSamplingFactor != 1
+       || !m_MetaImage.BinaryData()
+       || m_MetaImage.CompressedData()
+       || ( this->GetComponentSize() > 1
+            && m_MetaImage.BinaryDataByteOrderMSB() != MET_SystemByteOrderMSB() ) )
+    {
+    return false;
+    }
+
+  int elementSize = 0;
+  MET_SizeOfType(m_MetaImage.ElementType(), &elementSize);
+  if ( static_cast< SizeType >( elementSize ) * m_MetaImage.ElementNumberOfChannels()
+       != static_cast< SizeType >( this->GetPixelSize() ) )
+    {
+    return false;
+    }
+
+  SizeType regionOffset = 0;
+  if ( !this->GetContiguousIORegionOffset(regionOffset) )
+    {
+    return false;
+    }
+
+  // Lists and patterns of slice files cannot be mapped at once.
+  const std::string elementDataFileName = m_MetaImage.ElementDataFileName();
+  const bool        local = itksys::SystemTools::LowerCase(elementDataFileName) == "local";
+  if ( elementDataFileName.compare(0, 4, "LIST") == 0
+       || elementDataFileName.find('%') != std::string::npos )
+    {
+    return false;
+    }
+  if ( local )
+    {
+    dataFileName = m_FileName;
+    }
+  else if ( itksys::SystemTools::FileIsFullPath(elementDataFileName) )
+    {
+    dataFileName = elementDataFileName;
+    }
+  else
+    {
+    const std::string path = itksys::SystemTools::GetFilenamePath(m_FileName);
+    dataFileName = path.empty() ? elementDataFileName : path + "/" + elementDataFileName;
+    }
+
+  const SizeType imageSizeInBytes = this->GetImageSizeInBytes();
+  const auto     fileLength = static_cast< SizeType >( itksys::SystemTools::FileLength(dataFileName) );
+  SizeType       dataOffset = 0;
+  if ( m_MetaImage.HeaderSize() > 0 )
+    {
+    dataOffset = m_MetaImage.HeaderSize();
+    }
+  else if ( m_MetaImage.HeaderSize() == -1 )
+    {
+    dataOffset = fileLength - imageSizeInBytes;
+    }
+  else if ( local )
+    {
+    // The pixels follow the header, which ends with the ElementDataFile
+    // line, and end the file. Check the header actually ends there.
+    dataOffset = fileLength - imageSizeInBytes;
+    const SizeType tailLength = std::min< SizeType >( dataOffset, 16 );
+    std::string    tail( static_cast< std::size_t >( tailLength ), '\0' );
+    std::ifstream  stream;
+    this->OpenFileForReading(stream, dataFileName);
+    stream.seekg(dataOffset - tailLength);
+    stream.read(&tail[0], tailLength);
+    tail = itksys::SystemTools::LowerCase(tail);
+    const std::string::size_type end = tail.find_last_not_of("\r\n");
+    if ( !stream || end == std::string::npos || end + 1 == tail.size()
+         || end < 4 || tail.compare(end - 4, 5, "local") != 0 )
+      {
+      return false;
+      }
+    }
+  if ( dataOffset < 0 || fileLength < dataOffset + imageSizeInBytes )
+    {
+    return false;
+    }
+
+  offset = dataOffset + regionOffset;
+  return true;
+}
+
+bool
+MetaImageIO::PrecompressedMetaImage::WritePrecompressed(const char *headName,
+                                                        const ParallelDeflateCompressor *compressor)
+{
+  // Name the data file as Write() does for compressed data: MetaIO names it
+  // after the compression setting, which is off while writing.
+  std::vector< char > dataName;
+  int suffixPosition = 0;
+  MET_GetFileSuffixPtr(headName, &suffixPosition);
+  if ( strlen( this->ElementDataFileName() ) == 0 && strcmp(&headName[suffixPosition], "mha") != 0 )
+    {
+    dataName.resize(strlen(headName) + 6);
+    strcpy(dataName.data(), headName);
+    MET_SetFileSuffix(dataName.data(), "zraw");
+    }
+
+  // The pixel data are not compressed again, and are written by M_Write()
+  // right after the header, with the compression fields set by
+  // M_SetupWriteFields().
+  m_Compressor = compressor;
+  this->CompressedData(false);
+  const bool result = this->Write(headName, dataName.empty() ? nullptr : dataName.data(), false);
+  this->CompressedData(true);
+  m_CompressedDataSize = 0;
+  m_Compressor = nullptr;
+  return result;
+}
+
+void
+MetaImageIO::PrecompressedMetaImage::M_SetupWriteFields()
+{
+  if ( m_Compressor )
+    {
+    m_CompressedData = true;
+    m_CompressedDataSize = static_cast< std::streamoff >( m_Compressor->GetCompressedSize() );
+    }
+  MetaImage::M_SetupWriteFields();
+}
+
+bool
+MetaImageIO::PrecompressedMetaImage::M_Write()
+{
+  if ( !MetaImage::M_Write() )
+    {
+    return false;
+    }
+  if ( !m_Compressor )
+    {
+    return true;
+    }
+  if ( !strcmp(m_ElementDataFileName, "LOCAL") )
+    {
+    return m_Compressor->WriteCompressedData(*m_WriteStream);
+    }
+
+  // The data file is next to the header, as in M_WriteElements().
+  std::string dataFileName = m_ElementDataFileName;
+  char pathName[sizeof( m_FileName )];
+  if ( MET_GetFilePath(m_FileName, pathName) && !this->FileIsFullPath(m_ElementDataFileName) )
+    {
+    dataFileName = std::string(pathName) + m_ElementDataFileName;
+    }
+  std::ofstream dataStream(dataFileName.c_str(), std::ios::binary | std::ios::out);
+  return dataStream.is_open() && m_Compressor->WriteCompressedData(dataStream);
+}
+
 MetaImage * MetaImageIO::GetMetaImagePointer(void)
 {
   return &m_MetaImage;
@@ -1117,7 +1288,22 @@ MetaImageIO
     }
   else
     {
-    if ( !m_MetaImage.Write( m_FileName.c_str() ) )
+    bool written;
+    if ( m_UseCompression && binaryData && !strchr( m_MetaImage.ElementDataFileName(), '%' ) )
+      {
+      // Compress the pixel data in parallel, instead of letting MetaIO
+      // compress them with a single thread.
+      ParallelDeflateCompressor::Pointer compressor = ParallelDeflateCompressor::New();
+      compressor->SetCompressionLevel( this->GetCompressionLevel() );
+      compressor->SetNumberOfThreads( this->GetNumberOfCompressionThreads() );
+      compressor->Compress( buffer, static_cast< SizeValueType >( this->GetImageSizeInBytes() ) );
+      written = m_MetaImage.WritePrecompressed( m_FileName.c_str(), compressor );
+      }
+    else
+      {
+      written = m_MetaImage.Write( m_FileName.c_str() );
+      }
+    if ( !written )
       {
       delete[] dSize;
       delete[] eSpacing;
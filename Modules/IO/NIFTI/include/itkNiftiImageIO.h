@@ -95,6 +95,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   void Read(void *buffer) override;
 
+  /** Uncompressed scalar, complex and RGB(A) pixel data in native byte
+   * order and without intensity rescaling can be memory mapped. */
+  bool CanMemoryMapPixelData(std::string & dataFileName, SizeType & offset) override;
+
   //-------- This part of the interfaces deals with writing data. -----
 
   /** Determine if the file can be written with this ImageIO implementation.
@@ -152,6 +156,10 @@ private:
 
   void  SetImageIOMetadataFromNIfTI();
 
+  /** Write the header and the data of the NIfTI image. Single gzip
+   * compressed files are deflated in parallel. */
+  void  WriteNiftiImage();
+
   //This proxy class provides a nifti_image pointer interface to the internal implementation
   //of itk::NiftiImageIO, while hiding the niftilib interface from the external ITK interface.
   class NiftiImageProxy;
@@ -17,6 +17,7 @@
  *=========================================================================*/
 #include "itkNiftiImageIO.h"
 #include "itkIOCommon.h"
+#include "itkParallelDeflateCompressor.h"
 #include "itkMetaDataObject.h"
 #include "itkSpatialOrientationAdapter.h"
 #include <nifti1_io.h>
@@ -797,6 +798,45 @@ void NiftiImageIO::Read(void *buffer)
     }
 }
 
+bool
+NiftiImageIO
+::CanMemoryMapPixelData(std::string & dataFileName, SizeType & offset)
+{
+  // Other pixel types are stored component by component, and rescaled
+  // pixels are computed.
+  if ( ( this->GetNumberOfComponents() != 1
+         && this->GetPixelType() != COMPLEX
+         && this->GetPixelType() != RGB
+         && this->GetPixelType() != RGBA )
+       || this->MustRescale() )
+    {
+    return false;
+    }
+
+  SizeType regionOffset = 0;
+  if ( !this->GetContiguousIORegionOffset(regionOffset) )
+    {
+    return false;
+    }
+
+  nifti_image *header = nifti_image_read(this->GetFileName(), false);
+  if ( header == nullptr )
+    {
+    return false;
+    }
+  const bool canMap = header->iname != nullptr
+                      && !nifti_is_gzfile(header->iname)
+                      && ( header->nbyper == 1 || header->byteorder == nifti_short_order() )
+                      && static_cast< SizeType >( header->nvox ) * header->nbyper == this->GetImageSizeInBytes();
+  if ( canMap )
+    {
+    dataFileName = header->iname;
+    offset = static_cast< SizeType >( header->iname_offset ) + regionOffset;
+    }
+  nifti_image_free(header);
+  return canMap;
+}
+
 NiftiImageIO::FileType
 NiftiImageIO::DetermineFileType(const char *FileNameToRead)
 {
@@ -1963,6 +2003,44 @@ NiftiImageIO::SetNIfTIOrientationFromImageIO(unsigned short int origdims, unsign
   //  this->m_NiftiImage->sform_code = 0;
 }
 
+void
+NiftiImageIO
+::WriteNiftiImage()
+{
+  nifti_image *nim = this->m_NiftiImage;
+  if ( nim->nifti_type != NIFTI_FTYPE_NIFTI1_1
+       || nim->num_ext != 0
+       || !nifti_is_gzfile(nim->fname) )
+    {
+    nifti_image_write(nim);
+    return;
+    }
+
+  // The header, an empty extender and the padding to the data offset,
+  // followed by the data, compressed as a single gzip stream.
+  nifti_set_iname_offset(nim);
+  const nifti_1_header header = nifti_convert_nim2nhdr(nim);
+  std::vector< char >  prefix(static_cast< size_t >( nim->iname_offset ), 0);
+  memcpy(prefix.data(), &header, sizeof( header ));
+
+  std::vector< ParallelDeflateCompressor::BufferType > buffers;
+  buffers.emplace_back(prefix.data(), prefix.size());
+  buffers.emplace_back(nim->data, nifti_get_volsize(nim));
+
+  ParallelDeflateCompressor::Pointer compressor = ParallelDeflateCompressor::New();
+  compressor->SetStreamFormat(ParallelDeflateCompressor::GZIP);
+  compressor->SetCompressionLevel( this->GetCompressionLevel() );
+  compressor->SetNumberOfThreads( this->GetNumberOfCompressionThreads() );
+  compressor->Compress(buffers);
+
+  std::ofstream file;
+  this->OpenFileForWriting(file, nim->fname);
+  if ( !compressor->WriteCompressedData(file) )
+    {
+    itkExceptionMacro( << "Could not write file: " << nim->fname );
+    }
+}
+
 void
 NiftiImageIO
 ::Write(const void *buffer)
@@ -1978,7 +2056,7 @@ NiftiImageIO
     // Need a const cast here so that we don't have to copy the memory
     // for writing.
     this->m_NiftiImage->data = const_cast< void * >( buffer );
-    nifti_image_write(this->m_NiftiImage);
+    this->WriteNiftiImage();
     this->m_NiftiImage->data = nullptr; // if left pointing to data buffer
     // nifti_image_free will try and free this memory
     }
@@ -2063,7 +2141,7 @@ NiftiImageIO
     //Need a const cast here so that we don't have to copy the memory for
     //writing.
     this->m_NiftiImage->data = static_cast<void *>(nifti_buf);
-    nifti_image_write(this->m_NiftiImage);
+    this->WriteNiftiImage();
     this->m_NiftiImage->data = nullptr; // if left pointing to data buffer
     delete[] nifti_buf;
     }
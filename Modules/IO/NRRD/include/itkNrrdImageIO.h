@@ -67,6 +67,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   void Read(void *buffer) override;
 
+  /** Raw pixel data in native byte order, attached or in a single
+   * detached data file, can be memory mapped. */
+  bool CanMemoryMapPixelData(std::string & dataFileName, SizeType & offset) override;
+
   /** Determine the file type. Returns true if this ImageIO can write the
    * file specified. */
   bool CanWriteFile(const char *) override;
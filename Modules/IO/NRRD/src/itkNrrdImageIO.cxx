@@ -833,6 +833,88 @@ void NrrdImageIO::Read(void *buffer)
     }
 }
 
+bool NrrdImageIO::CanMemoryMapPixelData(std::string & dataFileName, SizeType & offset)
+{
+  SizeType regionOffset = 0;
+  if ( !this->GetContiguousIORegionOffset(regionOffset) )
+    {
+    return false;
+    }
+
+  Nrrd *       nrrd = nrrdNew();
+  NrrdIoState *nio = nrrdIoStateNew();
+
+#if !defined(__MINGW32__) && (defined(ITK_HAS_FEENABLEEXCEPT) || defined(_MSC_VER))
+  // nrrd causes exceptions on purpose, so mask them
+  bool saveFPEState(FloatingPointExceptions::GetExceptionAction() );
+  FloatingPointExceptions::Disable();
+#endif
+
+  // Read the header again, keeping the data file open: it is then
+  // positioned at the first byte of the pixel data, after any line or byte
+  // skipping.
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  nrrdIoStateSet(nio, nrrdIoStateKeepNrrdDataFileOpen, 1);
+  bool canMap = nrrdLoad(nrrd, this->GetFileName(), nio) == 0;
+  if ( !canMap )
+    {
+    free( biffGetDone(NRRD) );
+    }
+
+#if !defined(__MINGW32__) && (defined(ITK_HAS_FEENABLEEXCEPT) || defined(_MSC_VER))
+  // restore state
+  FloatingPointExceptions::SetEnabled(saveFPEState);
+#endif
+
+  // The pixels must be stored as they are in memory, in a single file, with
+  // the components, if any, on the fastest axis.
+  unsigned int rangeAxisIdx[NRRD_DIM_MAX];
+  const unsigned int rangeAxisNum = canMap ? nrrdRangeAxesGet(nrrd, rangeAxisIdx) : 0;
+  canMap = canMap
+           && nio->dataFile != nullptr
+           && nio->format == nrrdFormatNRRD
+           && nio->encoding == nrrdEncodingRaw
+           && ( nrrdElementSize(nrrd) == 1 || nio->endian == airMyEndian() )
+           && nio->dataFNFormat == nullptr
+           && nio->dataFNArr->len <= 1
+           && ( rangeAxisNum == 0 || ( rangeAxisNum == 1 && rangeAxisIdx[0] == 0 ) )
+           && nrrdElementNumber(nrrd) * nrrdElementSize(nrrd) == this->GetImageSizeInBytes();
+
+  if ( canMap )
+    {
+    const long dataOffset = ftell(nio->dataFile);
+    canMap = dataOffset >= 0;
+    offset = static_cast< SizeType >( dataOffset ) + regionOffset;
+    if ( nio->dataFNArr->len == 0 )
+      {
+      // Attached data
+      dataFileName = this->GetFileName();
+      }
+    else
+      {
+      // Detached data, possibly relative to the header
+      const char *dataFN = nio->dataFN[0];
+      canMap = canMap && strcmp("-", dataFN) != 0;
+      if ( dataFN[0] != '/' && dataFN[0] != '\0' && dataFN[1] != ':' && airStrlen(nio->path) )
+        {
+        dataFileName = std::string(nio->path) + "/" + dataFN;
+        }
+      else
+        {
+        dataFileName = dataFN;
+        }
+      }
+    }
+
+  if ( nio->dataFile != nullptr )
+    {
+    nio->dataFile = airFclose(nio->dataFile);
+    }
+  nrrdNix(nrrd);
+  nrrdIoStateNix(nio);
+  return canMap;
+}
+
 bool NrrdImageIO::CanWriteFile(const char *name)
 {
   std::string filename = name;
@@ -67,6 +67,13 @@ public:
    * file specified. */
   bool CanReadFile(const char *) override;
 
+  /** libpng keeps no global state, so several instances can read files
+   * concurrently. */
+  bool CanReadFilesConcurrently() const override
+  {
+    return true;
+  }
+
   /** Set the spacing and dimension information for the set filename. */
   void ReadImageInformation() override;
 
@@ -95,6 +102,9 @@ protected:
   ~PNGImageIO() override;
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** Copy the compression level of this ImageIO. */
+  LightObject::Pointer InternalClone() const override;
+
   void WriteSlice(const std::string & fileName, const void *buffer);
 
   /** Determines the level of compression for written files.
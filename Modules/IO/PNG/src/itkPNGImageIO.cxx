@@ -304,6 +304,20 @@ PNGImageIO::PNGImageIO() :
 PNGImageIO::~PNGImageIO()
 {}
 
+LightObject::Pointer
+PNGImageIO::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self::Pointer rval = dynamic_cast< Self * >( loPtr.GetPointer() );
+  if ( rval.IsNull() )
+    {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+  rval->m_CompressionLevel = m_CompressionLevel;
+  return loPtr;
+}
+
 void PNGImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
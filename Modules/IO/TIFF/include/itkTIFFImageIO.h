@@ -144,6 +144,9 @@ protected:
   ~TIFFImageIO() override;
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** Copy the compression settings of this ImageIO. */
+  LightObject::Pointer InternalClone() const override;
+
   void InternalWrite(const void *buffer);
 
   void InitializeColors();
@@ -249,6 +249,21 @@ TIFFImageIO::~TIFFImageIO()
   delete m_InternalImage;
 }
 
+LightObject::Pointer
+TIFFImageIO::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self::Pointer rval = dynamic_cast< Self * >( loPtr.GetPointer() );
+  if ( rval.IsNull() )
+    {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+  rval->m_Compression = m_Compression;
+  rval->m_JPEGQuality = m_JPEGQuality;
+  return loPtr;
+}
+
 void TIFFImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
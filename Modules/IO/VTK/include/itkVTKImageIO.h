@@ -81,6 +81,13 @@ public:
    * file specified. */
   bool CanReadFile(const char *) override;
 
+  /** VTKImageIO keeps no global state, so several instances can read files
+   * concurrently. */
+  bool CanReadFilesConcurrently() const override
+  {
+    return true;
+  }
+
   /** Set the spacing and dimesion information for the current filename. */
   void ReadImageInformation() override;
 
@@ -155,14 +155,14 @@ protected:
    * dense and sparse cases differently. The helper class IdentityHelper allows for correct overloading
    * these methods when substituting different type of the threaded partitioner
    *
-   * 1) Dense threader: through its own \c ThreadedExecution. \c ProcessVirtualPoint and
+   * 1) Dense threader: through its own \c ThreadedExecution. \c ProcessVirtualPoints and
    * \c ProcessPoint of the base class are thus not used.
    *
-   * 2) Sparse threader: through its own \c ProcessVirtualPoint. \c ThreadedExecution still invokes (mostly)
-   * from the base class.
+   * 2) Sparse threader: through its own \c ProcessVirtualPoints, which calls \c ProcessVirtualPoint_impl
+   * on each point. \c ThreadedExecution still invokes (mostly) from the base class.
    *
    * In order to invoke different \c ThreadedExecution by different threader, we use function overloading
-   * techniques to resolve which version of  \c ThreadedExecution and \c ProcessVirtualPoint by
+   * techniques to resolve which version of  \c ThreadedExecution and \c ProcessVirtualPoints by
    * the type of the domain partitioner.
    *
    * Specifically, a helper class \c IdentityHelper is used as a function parameter, with the sole purpose
@@ -177,32 +177,49 @@ protected:
    *
    * */
 
-  /** Method called by the threaders to process the given virtual point.  This
-   * in turn calls \c TransformAndEvaluateFixedPoint, \c
-   * TransformAndEvaluateMovingPoint, and \c ProcessPoint.
-   * And adds entries to m_MeasurePerThread and m_LocalDerivativesPerThread,
-   * m_NumberOfValidPointsPerThread. */
-  bool ProcessVirtualPoint( const VirtualIndexType & virtualIndex,
-                                    const VirtualPointType & virtualPoint,
-                                    const ThreadIdType threadId ) override {
-    return ProcessVirtualPoint_impl(IdentityHelper<TDomainPartitioner>(), virtualIndex, virtualPoint, threadId );
-  }
-
-  /* specific overloading for sparse CC metric */
+  /* specific overloading for sparse CC metric: process a single virtual point */
   bool ProcessVirtualPoint_impl(
                              IdentityHelper<ThreadedIndexedContainerPartitioner> itkNotUsed(self),
                              const VirtualIndexType & virtualIndex,
                              const VirtualPointType & virtualPoint,
                              const ThreadIdType threadId );
 
+  /** The sparse threader processes the points of a batch one by one, with
+   * its own \c ProcessVirtualPoint_impl. */
+  SizeValueType ProcessVirtualPoints( const VirtualIndexType * virtualIndices,
+                                      const VirtualPointType * virtualPoints,
+                                      const SizeValueType numberOfPoints,
+                                      const ThreadIdType threadId ) override {
+    return ProcessVirtualPoints_impl(IdentityHelper<TDomainPartitioner>(), virtualIndices, virtualPoints, numberOfPoints, threadId );
+  }
+
+  /* specific overloading for sparse CC metric */
+  SizeValueType ProcessVirtualPoints_impl(
+                             IdentityHelper<ThreadedIndexedContainerPartitioner> self,
+                             const VirtualIndexType * virtualIndices,
+                             const VirtualPointType * virtualPoints,
+                             const SizeValueType numberOfPoints,
+                             const ThreadIdType threadId ) {
+    SizeValueType numberOfValidPoints = 0;
+    for( SizeValueType i = 0; i < numberOfPoints; ++i )
+      {
+      if( ProcessVirtualPoint_impl(self, virtualIndices[i], virtualPoints[i], threadId ) )
+        {
+        ++numberOfValidPoints;
+        }
+      }
+    return numberOfValidPoints;
+  }
+
   /* for other default case */
   template<typename T>
-  bool ProcessVirtualPoint_impl(
+  SizeValueType ProcessVirtualPoints_impl(
                              IdentityHelper<T> itkNotUsed(self),
-                             const VirtualIndexType & virtualIndex,
-                             const VirtualPointType & virtualPoint,
+                             const VirtualIndexType * virtualIndices,
+                             const VirtualPointType * virtualPoints,
+                             const SizeValueType numberOfPoints,
                              const ThreadIdType threadId ) {
-    return Superclass::ProcessVirtualPoint(virtualIndex, virtualPoint, threadId);
+    return Superclass::ProcessVirtualPoints(virtualIndices, virtualPoints, numberOfPoints, threadId);
   }
 
 
@@ -92,12 +92,13 @@ protected:
 
   /** Overload to avoid execution of adding entries to m_MeasurePerThread
    * StorePointDerivativeResult() after this function calls ProcessPoint().
-   * Method called by the threaders to process the given virtual point.  This
-   * in turn calls \c TransformAndEvaluateFixedPoint, \c
-   * TransformAndEvaluateMovingPoint, and \c ProcessPoint. */
-  bool ProcessVirtualPoint( const VirtualIndexType & virtualIndex,
-                                    const VirtualPointType & virtualPoint,
-                                    const ThreadIdType threadId ) override;
+   * Method called by the threaders to process the given batch of virtual
+   * points.  This in turn calls \c TransformAndEvaluateVirtualPoints, and
+   * \c ProcessPoint on each valid point. */
+  SizeValueType ProcessVirtualPoints( const VirtualIndexType * virtualIndices,
+                                      const VirtualPointType * virtualPoints,
+                                      const SizeValueType numberOfPoints,
+                                      const ThreadIdType threadId ) override;
 
   /** This function computes the local voxel-wise contribution of
    *  the metric to the global integral of the metric/derivative.
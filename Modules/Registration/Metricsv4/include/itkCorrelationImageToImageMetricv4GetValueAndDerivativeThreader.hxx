@@ -162,96 +162,53 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner,
 }
 
 template<typename TDomainPartitioner, typename TImageToImageMetric, typename TCorrelationMetric>
-bool
+SizeValueType
 CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner, TImageToImageMetric, TCorrelationMetric>
-::ProcessVirtualPoint( const VirtualIndexType & virtualIndex, const VirtualPointType & virtualPoint, const ThreadIdType threadId )
+::ProcessVirtualPoints( const VirtualIndexType * virtualIndices, const VirtualPointType * virtualPoints,
+                        const SizeValueType numberOfPoints, const ThreadIdType threadId )
 {
-  FixedImagePointType         mappedFixedPoint;
-  FixedImagePixelType         mappedFixedPixelValue;
-  FixedImageGradientType      mappedFixedImageGradient;
-  MovingImagePointType        mappedMovingPoint;
-  MovingImagePixelType        mappedMovingPixelValue;
-  MovingImageGradientType     mappedMovingImageGradient;
-  bool                        pointIsValid = false;
-  MeasureType                 metricValueResult;
-
-  /* Transform the point into fixed and moving spaces, and evaluate.
-   * Different behavior with pre-warping enabled is handled transparently.
-   * Do this in a try block to catch exceptions and print more useful info
-   * then we otherwise get when exceptions are caught in MultiThreaderBase. */
-  try
-    {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue );
-    if( pointIsValid &&
-        this->m_CorrelationAssociate->GetComputeDerivative() &&
-        this->m_CorrelationAssociate->GetGradientSourceIncludesFixed() )
-      {
-      this->m_CorrelationAssociate->ComputeFixedImageGradientAtPoint( mappedFixedPoint, mappedFixedImageGradient );
-      }
-    }
-  catch( ExceptionObject & exc )
-    {
-    //NOTE: there must be a cleaner way to do this:
-    std::string msg("Caught exception: \n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
-    }
-  if( !pointIsValid )
-    {
-    return pointIsValid;
-    }
+  /* Transform the points into fixed and moving spaces, and evaluate.
+   * Different behavior with pre-warping enabled is handled transparently. */
+  this->TransformAndEvaluateVirtualPoints( virtualPoints, numberOfPoints, true, threadId );
 
-  try
-    {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
-    if( pointIsValid &&
-        this->m_CorrelationAssociate->GetComputeDerivative() &&
-        this->m_CorrelationAssociate->GetGradientSourceIncludesMoving() )
-      {
-      this->m_CorrelationAssociate->ComputeMovingImageGradientAtPoint( mappedMovingPoint, mappedMovingImageGradient );
-      }
-    }
-  catch( ExceptionObject & exc )
-    {
-    std::string msg("Caught exception: \n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
-    }
-  if( !pointIsValid )
-    {
-    return pointIsValid;
-    }
+  const auto & batch = this->m_GetValueAndDerivativePerThreadVariables[threadId].PointBatch;
+  SizeValueType numberOfValidPoints = 0;
+  MeasureType   metricValueResult;
 
   /* Call the user method in derived classes to do the specific
    * calculations for value and derivative. */
-  try
-    {
-    pointIsValid = this->ProcessPoint(
-                                   virtualIndex,
-                                   virtualPoint,
-                                   mappedFixedPoint, mappedFixedPixelValue,
-                                   mappedFixedImageGradient,
-                                   mappedMovingPoint, mappedMovingPixelValue,
-                                   mappedMovingImageGradient,
-                                   metricValueResult, this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives,
-                                   threadId );
-    }
-  catch( ExceptionObject & exc )
-    {
-    //NOTE: there must be a cleaner way to do this:
-    std::string msg("Exception in GetValueAndDerivativeProcessPoint:\n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
-    }
-  if( pointIsValid )
+  for( SizeValueType v = 0; v < batch.NumberOfValidPoints; ++v )
     {
-    this->m_GetValueAndDerivativePerThreadVariables[threadId].NumberOfValidPoints++;
+    const SizeValueType i = batch.ValidPoints[v];
+    bool pointIsValid = false;
+    try
+      {
+      pointIsValid = this->ProcessPoint(
+                                     virtualIndices[i],
+                                     virtualPoints[i],
+                                     batch.MappedFixedPoints[i], batch.MappedFixedPixelValues[i],
+                                     batch.MappedFixedImageGradients[i],
+                                     batch.MappedMovingPoints[i], batch.MappedMovingPixelValues[i],
+                                     batch.MappedMovingImageGradients[i],
+                                     metricValueResult, this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives,
+                                     threadId );
+      }
+    catch( ExceptionObject & exc )
+      {
+      //NOTE: there must be a cleaner way to do this:
+      std::string msg("Exception in GetValueAndDerivativeProcessPoint:\n");
+      msg += exc.what();
+      ExceptionObject err(__FILE__, __LINE__, msg);
+      throw err;
+      }
+    if( pointIsValid )
+      {
+      ++numberOfValidPoints;
+      }
     }
+  this->m_GetValueAndDerivativePerThreadVariables[threadId].NumberOfValidPoints += numberOfValidPoints;
 
-  return pointIsValid;
+  return numberOfValidPoints;
 }
 
 template<typename TDomainPartitioner, typename TImageToImageMetric, typename TCorrelationMetric>
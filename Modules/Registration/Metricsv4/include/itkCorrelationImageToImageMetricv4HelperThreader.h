@@ -90,17 +90,18 @@ protected:
 
   /* Overload: don't need to compute the image gradients and store derivatives
    *
-   * Method called by the threaders to process the given virtual point.  This
-   * in turn calls \c TransformAndEvaluateFixedPoint, \c
-   * TransformAndEvaluateMovingPoint, and \c ProcessPoint.
+   * Method called by the threaders to process the given batch of virtual
+   * points.  This in turn calls \c TransformAndEvaluateVirtualPoints, and
+   * sums the pixel values of the valid points.
    */
-  bool ProcessVirtualPoint( const VirtualIndexType & virtualIndex,
-                                    const VirtualPointType & virtualPoint,
-                                    const ThreadIdType threadId ) override;
+  SizeValueType ProcessVirtualPoints( const VirtualIndexType * virtualIndices,
+                                      const VirtualPointType * virtualPoints,
+                                      const SizeValueType numberOfPoints,
+                                      const ThreadIdType threadId ) override;
 
 
   /**
-   * Not using. All processing is done in ProcessVirtualPoint.
+   * Not using. All processing is done in ProcessVirtualPoints.
    */
   bool ProcessPoint(
         const VirtualIndexType &          ,
@@ -100,73 +100,27 @@ CorrelationImageToImageMetricv4HelperThreader<TDomainPartitioner,
 }
 
 template<typename TDomainPartitioner, typename TImageToImageMetric, typename TCorrelationMetric>
-bool
+SizeValueType
 CorrelationImageToImageMetricv4HelperThreader<TDomainPartitioner,
 TImageToImageMetric, TCorrelationMetric>
-::ProcessVirtualPoint( const VirtualIndexType & itkNotUsed(virtualIndex), const VirtualPointType & virtualPoint, const ThreadIdType threadId )
+::ProcessVirtualPoints( const VirtualIndexType * itkNotUsed(virtualIndices), const VirtualPointType * virtualPoints,
+                        const SizeValueType numberOfPoints, const ThreadIdType threadId )
 {
-  FixedImagePointType         mappedFixedPoint;
-  FixedImagePixelType         mappedFixedPixelValue;
-  MovingImagePointType        mappedMovingPoint;
-  MovingImagePixelType        mappedMovingPixelValue;
-  bool                        pointIsValid = false;
-
-  /* Transform the point into fixed and moving spaces, and evaluate.
-   * Different behavior with pre-warping enabled is handled transparently.
-   * Do this in a try block to catch exceptions and print more useful info
-   * then we otherwise get when exceptions are caught in MultiThreaderBase. */
-  try
-    {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue );
-    }
-  catch( ExceptionObject & exc )
-    {
-    //NOTE: there must be a cleaner way to do this:
-    std::string msg("Caught exception: \n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
-    }
-  if( !pointIsValid )
-    {
-    return pointIsValid;
-    }
-
-  try
-    {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
-    }
-  catch( ExceptionObject & exc )
-    {
-    std::string msg("Caught exception: \n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
-    }
-  if( !pointIsValid )
-    {
-    return pointIsValid;
-    }
+  /* Transform the points into fixed and moving spaces, and evaluate.
+   * Different behavior with pre-warping enabled is handled transparently. */
+  this->TransformAndEvaluateVirtualPoints( virtualPoints, numberOfPoints, false, threadId );
 
   /* Do the specific calculations for values */
-  try
-    {
-    this->m_CorrelationMetricPerThreadVariables[threadId].FixSum += mappedFixedPixelValue;
-    this->m_CorrelationMetricPerThreadVariables[threadId].MovSum += mappedMovingPixelValue;
-    }
-  catch( ExceptionObject & exc )
-    {
-    std::string msg("Exception in ProcessVirtualPoint:\n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
-    }
-  if( pointIsValid )
+  const auto & batch = this->m_GetValueAndDerivativePerThreadVariables[threadId].PointBatch;
+  for( SizeValueType v = 0; v < batch.NumberOfValidPoints; ++v )
     {
-    this->m_GetValueAndDerivativePerThreadVariables[threadId].NumberOfValidPoints++;
+    const SizeValueType i = batch.ValidPoints[v];
+    this->m_CorrelationMetricPerThreadVariables[threadId].FixSum += batch.MappedFixedPixelValues[i];
+    this->m_CorrelationMetricPerThreadVariables[threadId].MovSum += batch.MappedMovingPixelValues[i];
     }
+  this->m_GetValueAndDerivativePerThreadVariables[threadId].NumberOfValidPoints += batch.NumberOfValidPoints;
 
-  return pointIsValid;
+  return batch.NumberOfValidPoints;
 }
 
 } // end namespace itk
@@ -31,6 +31,7 @@
 #include "itkPointSet.h"
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkDefaultImageToImageMetricTraitsv4.h"
+#include "itkImageToImageMetricv4FixedDataCache.h"
 
 namespace itk
 {
@@ -99,13 +100,16 @@ namespace itk
  * Point sets are set via SetFixedSampledPointSet, and the point set is enabled
  * for use by calling SetUseFixedSampledPointSet.
  * \note If the point set is sparse, the option SetUse[Fixed|Moving]ImageGradientFilter
- * typically should be disabled to avoid excessive computation. However,
- * the gradient values of the fixed image are not cached
- * when using a point set (there are plans for this in the future), so
- * depending on the number of iterations (when used during optimization)
- * and the level of sparsity, it may be more efficient to
- * use a gradient image filter for it because it will only be
- * calculated once.
+ * typically should be disabled to avoid excessive computation.
+ * The mapped fixed points, the fixed pixel values and the fixed image
+ * gradients of the sampled points can be cached by calling
+ * SetUseFixedSampledPointCache, so that each evaluation only transforms
+ * and evaluates the points in the moving space. The cache is rebuilt
+ * at the first evaluation after \c Initialize, and whenever the fixed
+ * transform, the fixed image, the fixed mask, the fixed interpolator or
+ * the fixed image gradient calculator is modified. It is not rebuilt if
+ * the buffer of the fixed image or of a displacement field fixed
+ * transform is changed in place without calling Modified.
  *
  * Vector Images
  *
@@ -285,6 +289,10 @@ public:
                                     CoordinateRepresentationType >;
   using FixedInterpolatorPointer = typename FixedInterpolatorType::Pointer;
   using MovingInterpolatorPointer = typename MovingInterpolatorType::Pointer;
+  using FixedInterpolatorContinuousIndexType = typename FixedInterpolatorType::ContinuousIndexType;
+  using MovingInterpolatorContinuousIndexType = typename MovingInterpolatorType::ContinuousIndexType;
+  using FixedInterpolatorOutputType = typename FixedInterpolatorType::OutputType;
+  using MovingInterpolatorOutputType = typename MovingInterpolatorType::OutputType;
 
   /** Image derivatives types */
   using FixedImageGradientType = typename MetricTraits::FixedImageGradientType;
@@ -337,6 +345,22 @@ public:
   using FixedImageGradientCalculatorPointer = typename FixedImageGradientCalculatorType::Pointer;
   using MovingImageGradientCalculatorPointer = typename MovingImageGradientCalculatorType::Pointer;
 
+  /** Mapped point, pixel value and image gradient of a sampled point in
+   * the fixed space. The gradient is only set when the gradient source
+   * includes the fixed image. */
+  struct FixedSampledPointCacheElementType
+    {
+    FixedImagePointType    MappedPoint;
+    FixedImagePixelType    PixelValue;
+    FixedImageGradientType Gradient;
+    bool                   IsValid;
+    };
+  using FixedSampledPointCacheType = std::vector< FixedSampledPointCacheElementType >;
+  using FixedSampledPointCacheConstPointer = std::shared_ptr< const FixedSampledPointCacheType >;
+
+  /** Type of the cache of fixed side data shared between metrics. */
+  using FixedDataCacheType = ImageToImageMetricv4FixedDataCache< Self >;
+
   /** Default image gradient calculator types */
   using DefaultFixedImageGradientCalculator = typename MetricTraits::DefaultFixedImageGradientCalculator;
   using DefaultMovingImageGradientCalculator = typename MetricTraits::DefaultMovingImageGradientCalculator;
@@ -420,9 +444,24 @@ public:
   itkGetConstReferenceMacro(UseFixedSampledPointSet, bool);
   itkBooleanMacro(UseFixedSampledPointSet);
 
+  /** Set/Get flag to cache the fixed side of the sampled point set, when
+   * \c UseFixedSampledPointSet is on. Default is false. */
+  itkSetMacro(UseFixedSampledPointCache, bool);
+  itkGetConstReferenceMacro(UseFixedSampledPointCache, bool);
+  itkBooleanMacro(UseFixedSampledPointCache);
+
   /** Get the virtual domain sampling point set */
   itkGetModifiableObjectMacro(VirtualSampledPointSet, VirtualPointSetType);
 
+  /** Set/Get a cache of fixed side data shared with other metrics
+   * evaluating the same fixed image. When it is set, the fixed image
+   * gradient image computed by the default fixed image gradient filter and
+   * the fixed sampled point cache are read from it, or computed and stored
+   * in it. Default is nullptr: the metric computes its own data.
+   * \sa ImageToImageMetricv4FixedDataCache */
+  itkSetObjectMacro(FixedDataCache, FixedDataCacheType);
+  itkGetModifiableObjectMacro(FixedDataCache, FixedDataCacheType);
+
   /** Set/Get the gradient filter */
   itkSetObjectMacro( FixedImageGradientFilter, FixedImageGradientFilterType );
   itkGetModifiableObjectMacro(FixedImageGradientFilter, FixedImageGradientFilterType );
@@ -592,6 +631,40 @@ protected:
                          MovingImagePointType & mappedMovingPoint,
                          MovingImagePixelType & mappedMovingPixelValue ) const;
 
+  /**
+   * Transform a batch of points from VirtualImage domain to FixedImage domain
+   * and evaluate them with a single call to the interpolator.
+   * Only the points of the batch listed in \c pointIdentifiers are processed.
+   * The list is compacted to the points that are within the mask if one is
+   * set, and within the fixed image buffer, and its new length is returned.
+   * Results are written at the positions of the points in the batch.
+   * \c continuousIndices and \c interpolatedValues are work buffers of at
+   * least \c numberOfPoints elements.
+   */
+  SizeValueType TransformAndEvaluateFixedPoints(
+                         const VirtualPointType * virtualPoints,
+                         SizeValueType * pointIdentifiers,
+                         const SizeValueType numberOfPoints,
+                         FixedImagePointType * mappedFixedPoints,
+                         FixedImagePixelType * mappedFixedPixelValues,
+                         FixedInterpolatorContinuousIndexType * continuousIndices,
+                         FixedInterpolatorOutputType * interpolatedValues ) const;
+
+  /** Transform and evaluate a batch of points from VirtualImage domain to
+   * MovingImage domain. \sa TransformAndEvaluateFixedPoints */
+  SizeValueType TransformAndEvaluateMovingPoints(
+                         const VirtualPointType * virtualPoints,
+                         SizeValueType * pointIdentifiers,
+                         const SizeValueType numberOfPoints,
+                         MovingImagePointType * mappedMovingPoints,
+                         MovingImagePixelType * mappedMovingPixelValues,
+                         MovingInterpolatorContinuousIndexType * continuousIndices,
+                         MovingInterpolatorOutputType * interpolatedValues ) const;
+
+  /** Rebuild the cache of the fixed side of the sampled points if it is
+   * enabled and out of date, or release it if it is disabled. */
+  void UpdateFixedSampledPointCache() const;
+
   /** Compute image derivatives for a Fixed point. */
   virtual void ComputeFixedImageGradientAtPoint( const FixedImagePointType & mappedPoint, FixedImageGradientType & gradient ) const;
 
@@ -683,6 +756,16 @@ protected:
   /** Flag to use FixedSampledPointSet, i.e. Sparse sampling. */
   bool                                    m_UseFixedSampledPointSet;
 
+  /** Cache of the fixed side of the sampled points, in the order of
+   * m_VirtualSampledPointSet. Null when the cache is not in use. It may be
+   * shared with other metrics through m_FixedDataCache. */
+  bool                                                    m_UseFixedSampledPointCache;
+  mutable FixedSampledPointCacheConstPointer              m_FixedSampledPointCache;
+  mutable ModifiedTimeType                                m_FixedSampledPointCacheMTime;
+
+  /** Cache of fixed side data shared with other metrics. */
+  SmartPointer< FixedDataCacheType >                      m_FixedDataCache;
+
   ImageToImageMetricv4();
   ~ImageToImageMetricv4() override;
 
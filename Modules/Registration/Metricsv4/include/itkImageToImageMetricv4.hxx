@@ -24,6 +24,8 @@
 #include "itkCompositeTransform.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "itkIdentityTransform.h"
+#include "itkMultiThreaderBase.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -64,6 +66,8 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   this->m_UseFixedImageGradientFilter  = true;
   this->m_UseMovingImageGradientFilter = true;
   this->m_UseFixedSampledPointSet      = false;
+  this->m_UseFixedSampledPointCache    = false;
+  this->m_FixedSampledPointCacheMTime  = 0;
 
   this->m_FloatingPointCorrectionResolution = 1e6;
   this->m_UseFloatingPointCorrection = false;
@@ -149,6 +153,7 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
     {
     this->MapFixedSampledPointSetToVirtual();
     }
+  this->m_FixedSampledPointCache.reset();
 
   /* Inititialize interpolators. */
   itkDebugMacro("Initialize Interpolators");
@@ -278,6 +283,100 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
     /* Clear derivative final result. */
     this->m_DerivativeResult->Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
     }
+
+  this->UpdateFixedSampledPointCache();
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::UpdateFixedSampledPointCache() const
+{
+  if( !this->m_UseFixedSampledPointSet || !this->m_UseFixedSampledPointCache )
+    {
+    this->m_FixedSampledPointCache.reset();
+    return;
+    }
+
+  /* The cache depends on everything that is used to transform and evaluate
+   * the sampled points in the fixed space. */
+  const bool computeGradients = this->GetGradientSourceIncludesFixed();
+  ModifiedTimeType fixedMTime = std::max( this->m_VirtualSampledPointSet->GetMTime(), this->m_FixedTransform->GetMTime() );
+  fixedMTime = std::max( fixedMTime, this->m_FixedImage->GetMTime() );
+  fixedMTime = std::max( fixedMTime, this->m_FixedInterpolator->GetMTime() );
+  if( this->m_FixedImageMask )
+    {
+    fixedMTime = std::max( fixedMTime, this->m_FixedImageMask->GetMTime() );
+    }
+  if( computeGradients )
+    {
+    fixedMTime = std::max( fixedMTime, this->m_UseFixedImageGradientFilter
+                           ? this->m_FixedImageGradientInterpolator->GetMTime()
+                           : this->m_FixedImageGradientCalculator->GetMTime() );
+    }
+
+  const SizeValueType numberOfPoints = this->m_VirtualSampledPointSet->GetNumberOfPoints();
+  if( this->m_FixedSampledPointCache && this->m_FixedSampledPointCache->size() == numberOfPoints &&
+      this->m_FixedSampledPointCacheMTime >= fixedMTime )
+    {
+    return;
+    }
+
+  auto computeFixedSampledPointCache = [this, computeGradients, numberOfPoints]()
+    {
+    auto cache = std::make_shared< FixedSampledPointCacheType >( numberOfPoints );
+    MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+    threader->SetNumberOfThreads( this->GetMaximumNumberOfThreads() );
+    threader->ParallelizeArray( 0, numberOfPoints,
+      [this, computeGradients, &cache]( SizeValueType i )
+        {
+        FixedSampledPointCacheElementType & element = ( *cache )[i];
+        element.IsValid = this->TransformAndEvaluateFixedPoint( this->m_VirtualSampledPointSet->GetPoint( i ),
+                                                                element.MappedPoint, element.PixelValue );
+        if( element.IsValid && computeGradients )
+          {
+          this->ComputeFixedImageGradientAtPoint( element.MappedPoint, element.Gradient );
+          }
+        },
+      nullptr );
+    return FixedSampledPointCacheConstPointer( cache );
+    };
+
+  if( this->m_FixedDataCache )
+    {
+    /* Metrics with the same fixed side share their cache. */
+    typename FixedDataCacheType::FixedSampledPointCacheKeyType key;
+    key.FixedSampledPointSet = this->m_FixedSampledPointSet;
+    key.FixedImage = typename FixedDataCacheType::FixedImageKeyType( this->m_FixedImage.GetPointer() );
+    key.VirtualDomain.Region = this->GetVirtualRegion();
+    key.VirtualDomain.Spacing = this->GetVirtualSpacing();
+    key.VirtualDomain.Origin = this->GetVirtualOrigin();
+    key.VirtualDomain.Direction = this->GetVirtualDirection();
+    key.FixedTransformClass = this->m_FixedTransform->GetNameOfClass();
+    key.FixedTransformParameters = this->m_FixedTransform->GetParameters();
+    key.FixedTransformFixedParameters = this->m_FixedTransform->GetFixedParameters();
+    key.FixedImageMask = this->m_FixedImageMask;
+    key.FixedInterpolatorClass = this->m_FixedInterpolator->GetNameOfClass();
+    key.ComputeGradients = computeGradients;
+    key.FixedImageGradientImage = nullptr;
+    if( computeGradients )
+      {
+      if( this->m_UseFixedImageGradientFilter )
+        {
+        key.FixedImageGradientImage = this->m_FixedImageGradientImage;
+        }
+      else
+        {
+        key.FixedImageGradientCalculatorClass = this->m_FixedImageGradientCalculator->GetNameOfClass();
+        }
+      }
+    this->m_FixedSampledPointCache = this->m_FixedDataCache->GetFixedSampledPointCache( key, computeFixedSampledPointCache );
+    }
+  else
+    {
+    this->m_FixedSampledPointCache = computeFixedSampledPointCache();
+    }
+  this->m_FixedSampledPointCacheMTime = fixedMTime;
 }
 
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
@@ -366,6 +465,97 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   return pointIsValid;
 }
 
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+SizeValueType
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::TransformAndEvaluateFixedPoints(
+                         const VirtualPointType * virtualPoints,
+                         SizeValueType * pointIdentifiers,
+                         const SizeValueType numberOfPoints,
+                         FixedImagePointType * mappedFixedPoints,
+                         FixedImagePixelType * mappedFixedPixelValues,
+                         FixedInterpolatorContinuousIndexType * continuousIndices,
+                         FixedInterpolatorOutputType * interpolatedValues ) const
+{
+  // map the points into fixed space, and keep those within the mask
+  // and the image buffer. The list is compacted in place.
+  SizeValueType numberOfValidPoints = 0;
+  for( SizeValueType p = 0; p < numberOfPoints; ++p )
+    {
+    const SizeValueType i = pointIdentifiers[p];
+    mappedFixedPixelValues[i] = NumericTraits<FixedImagePixelType>::ZeroValue();
+    this->LocalTransformPoint( virtualPoints[i], mappedFixedPoints[i] );
+
+    if ( this->m_FixedImageMask && ! this->m_FixedImageMask->IsInside( mappedFixedPoints[i] ) )
+      {
+      continue;
+      }
+
+    this->m_FixedInterpolator->ConvertPointToContinuousIndex( mappedFixedPoints[i], continuousIndices[numberOfValidPoints] );
+    if( this->m_FixedInterpolator->IsInsideBuffer( continuousIndices[numberOfValidPoints] ) )
+      {
+      pointIdentifiers[numberOfValidPoints++] = i;
+      }
+    }
+
+  // Evaluate
+  this->m_FixedInterpolator->EvaluateAtContinuousIndices( continuousIndices, interpolatedValues, numberOfValidPoints );
+  for( SizeValueType v = 0; v < numberOfValidPoints; ++v )
+    {
+    mappedFixedPixelValues[pointIdentifiers[v]] = interpolatedValues[v];
+    }
+
+  return numberOfValidPoints;
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+SizeValueType
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::TransformAndEvaluateMovingPoints(
+                         const VirtualPointType * virtualPoints,
+                         SizeValueType * pointIdentifiers,
+                         const SizeValueType numberOfPoints,
+                         MovingImagePointType * mappedMovingPoints,
+                         MovingImagePixelType * mappedMovingPixelValues,
+                         MovingInterpolatorContinuousIndexType * continuousIndices,
+                         MovingInterpolatorOutputType * interpolatedValues ) const
+{
+  typename MovingTransformType::OutputPointType localVirtualPoint;
+  typename MovingTransformType::OutputPointType localMappedMovingPoint;
+
+  SizeValueType numberOfValidPoints = 0;
+  for( SizeValueType p = 0; p < numberOfPoints; ++p )
+    {
+    const SizeValueType i = pointIdentifiers[p];
+    mappedMovingPixelValues[i] = NumericTraits<MovingImagePixelType>::ZeroValue();
+
+    // map the point into moving space
+    localVirtualPoint.CastFrom( virtualPoints[i] );
+    localMappedMovingPoint = this->m_MovingTransform->TransformPoint( localVirtualPoint );
+    mappedMovingPoints[i].CastFrom( localMappedMovingPoint );
+
+    if ( this->m_MovingImageMask && ! this->m_MovingImageMask->IsInside( mappedMovingPoints[i] ) )
+      {
+      continue;
+      }
+
+    this->m_MovingInterpolator->ConvertPointToContinuousIndex( mappedMovingPoints[i], continuousIndices[numberOfValidPoints] );
+    if( this->m_MovingInterpolator->IsInsideBuffer( continuousIndices[numberOfValidPoints] ) )
+      {
+      pointIdentifiers[numberOfValidPoints++] = i;
+      }
+    }
+
+  // Evaluate
+  this->m_MovingInterpolator->EvaluateAtContinuousIndices( continuousIndices, interpolatedValues, numberOfValidPoints );
+  for( SizeValueType v = 0; v < numberOfValidPoints; ++v )
+    {
+    mappedMovingPixelValues[pointIdentifiers[v]] = interpolatedValues[v];
+    }
+
+  return numberOfValidPoints;
+}
+
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
 void
 ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
@@ -413,9 +603,31 @@ void
 ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::ComputeFixedImageGradientFilterImage()
 {
-  this->m_FixedImageGradientFilter->SetInput( this->m_FixedImage );
-  this->m_FixedImageGradientFilter->Update();
-  this->m_FixedImageGradientImage = this->m_FixedImageGradientFilter->GetOutput();
+  auto computeFixedImageGradientImage = [this]()
+    {
+    this->m_FixedImageGradientFilter->SetInput( this->m_FixedImage );
+    this->m_FixedImageGradientFilter->Update();
+    FixedImageGradientImagePointer gradientImage = this->m_FixedImageGradientFilter->GetOutput();
+    return gradientImage;
+    };
+
+  if( this->m_FixedDataCache &&
+      this->m_FixedImageGradientFilter.GetPointer() == this->m_DefaultFixedImageGradientFilter.GetPointer() )
+    {
+    /* The gradient image is shared with the other metrics of the cache, and
+     * must not be modified by a later update of the filter. */
+    this->m_FixedImageGradientImage = this->m_FixedDataCache->GetFixedImageGradientImage( this->m_FixedImage,
+      [&computeFixedImageGradientImage]()
+        {
+        FixedImageGradientImagePointer gradientImage = computeFixedImageGradientImage();
+        gradientImage->DisconnectPipeline();
+        return gradientImage;
+        } );
+    }
+  else
+    {
+    this->m_FixedImageGradientImage = computeFixedImageGradientImage();
+    }
   this->m_FixedImageGradientInterpolator->SetInputImage( this->m_FixedImageGradientImage );
 }
 
@@ -594,6 +806,8 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   os << indent << "ImageToImageMetricv4: " << std::endl
      << indent << "GetUseFixedImageGradientFilter: " << this->GetUseFixedImageGradientFilter() << std::endl
      << indent << "GetUseMovingImageGradientFilter: " << this->GetUseMovingImageGradientFilter() << std::endl
+     << indent << "UseFixedSampledPointCache: " << this->GetUseFixedSampledPointCache() << std::endl
+     << indent << "FixedDataCache: " << this->m_FixedDataCache.GetPointer() << std::endl
      << indent << "UseFloatingPointCorrection: " << this->GetUseFloatingPointCorrection() << std::endl
      << indent << "FloatingPointCorrectionResolution: " << this->GetFloatingPointCorrectionResolution() << std::endl;
 
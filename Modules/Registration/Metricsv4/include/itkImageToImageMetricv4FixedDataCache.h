@@ -0,0 +1,202 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkImageToImageMetricv4FixedDataCache_h
+#define itkImageToImageMetricv4FixedDataCache_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class ImageToImageMetricv4FixedDataCache
+ * \brief Thread safe cache of the fixed side data of image metrics v4,
+ * shared by several metrics.
+ *
+ * Metrics which evaluate the same fixed image, e.g. the metrics of the
+ * registrations of many subjects to one template, can share a cache so that
+ * the data which only depend on the fixed side are computed once instead of
+ * once per metric:
+ * - the gradient image of the fixed image, when it is computed by the
+ *   default fixed image gradient filter;
+ * - the sampled point sets, when they are sampled with the same settings and
+ *   random seed;
+ * - the fixed side of the sampled points (mapped point, pixel value and
+ *   gradient), as cached by ImageToImageMetricv4::SetUseFixedSampledPointCache.
+ *
+ * The data are identified by the pixel container and the geometry of the
+ * fixed image, and by the settings they depend on, listed in the keys below.
+ * The fixed interpolators and gradient calculators are identified by their
+ * class only: the metrics sharing a cache must configure them identically.
+ * The cache is not updated when the pixels of an image are modified in
+ * place; call ReleaseData() in that case.
+ *
+ * The data are computed once: a thread requesting data which are being
+ * computed by another thread waits for them. The returned data are shared,
+ * and must not be modified.
+ *
+ * \sa ImageToImageMetricv4
+ *
+ * \ingroup ITKMetricsv4
+ */
+template<typename TMetric>
+class ITK_TEMPLATE_EXPORT ImageToImageMetricv4FixedDataCache : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ImageToImageMetricv4FixedDataCache);
+
+  /** Standard class type aliases. */
+  using Self = ImageToImageMetricv4FixedDataCache;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImageToImageMetricv4FixedDataCache, Object );
+
+  using MetricType = TMetric;
+  using FixedImageType = typename MetricType::FixedImageType;
+  using VirtualImageType = typename MetricType::VirtualImageType;
+  using FixedImageMaskType = typename MetricType::FixedImageMaskType;
+  using FixedImageGradientImageType = typename MetricType::FixedImageGradientImageType;
+  using FixedImageGradientImagePointer = typename MetricType::FixedImageGradientImagePointer;
+  using FixedSampledPointSetType = typename MetricType::FixedSampledPointSetType;
+  using FixedSampledPointSetPointer = typename MetricType::FixedSampledPointSetPointer;
+  using FixedSampledPointCacheType = typename MetricType::FixedSampledPointCacheType;
+  using FixedSampledPointCacheConstPointer = typename MetricType::FixedSampledPointCacheConstPointer;
+  using FixedTransformParametersType = typename MetricType::FixedTransformType::ParametersType;
+  using FixedTransformFixedParametersType = typename MetricType::FixedTransformType::FixedParametersType;
+
+  /** Pixel container and geometry of an image. The pixel container is null
+   * for an image used as a domain only. */
+  template<typename TImage>
+  struct ImageKeyType
+    {
+    ImageKeyType() : PixelContainer( nullptr ) {}
+    explicit ImageKeyType( const TImage * image, bool withPixels = true );
+    bool operator==( const ImageKeyType & other ) const;
+
+    const LightObject *              PixelContainer;
+    typename TImage::RegionType      Region;
+    typename TImage::SpacingType     Spacing;
+    typename TImage::PointType       Origin;
+    typename TImage::DirectionType   Direction;
+    };
+  using FixedImageKeyType = ImageKeyType<FixedImageType>;
+  using VirtualDomainKeyType = ImageKeyType<VirtualImageType>;
+
+  /** Settings of the sampling of a point set in a virtual domain. */
+  struct SampledPointSetKeyType
+    {
+    bool operator==( const SampledPointSetKeyType & other ) const;
+
+    VirtualDomainKeyType         VirtualDomain;
+    const FixedImageMaskType *   FixedImageMask;
+    unsigned int                 SamplingStrategy;
+    double                       SamplingPercentage;
+    int                          RandomSeed;
+    };
+
+  /** Everything the fixed side of the sampled points of a metric depends on. */
+  struct FixedSampledPointCacheKeyType
+    {
+    bool operator==( const FixedSampledPointCacheKeyType & other ) const;
+
+    const FixedSampledPointSetType *     FixedSampledPointSet;
+    FixedImageKeyType                    FixedImage;
+    VirtualDomainKeyType                 VirtualDomain;
+    std::string                          FixedTransformClass;
+    FixedTransformParametersType         FixedTransformParameters;
+    FixedTransformFixedParametersType    FixedTransformFixedParameters;
+    const FixedImageMaskType *           FixedImageMask;
+    std::string                          FixedInterpolatorClass;
+    bool                                 ComputeGradients;
+    const FixedImageGradientImageType *  FixedImageGradientImage;
+    std::string                          FixedImageGradientCalculatorClass;
+    };
+
+  using FixedImageGradientImageCreatorType = std::function<FixedImageGradientImagePointer()>;
+  using SampledPointSetCreatorType = std::function<FixedSampledPointSetPointer()>;
+  using FixedSampledPointCacheCreatorType = std::function<FixedSampledPointCacheConstPointer()>;
+
+  /** Return the gradient image of \c image computed by the default fixed
+   * image gradient filter, calling \c create if it is not cached. */
+  FixedImageGradientImagePointer GetFixedImageGradientImage( const FixedImageType * image,
+                                                             const FixedImageGradientImageCreatorType & create );
+
+  /** Return the point set sampled with the settings of \c key, calling
+   * \c create if it is not cached. */
+  FixedSampledPointSetPointer GetSampledPointSet( const SampledPointSetKeyType & key,
+                                                  const SampledPointSetCreatorType & create );
+
+  /** Return the fixed side of the sampled points identified by \c key,
+   * calling \c create if it is not cached. */
+  FixedSampledPointCacheConstPointer GetFixedSampledPointCache( const FixedSampledPointCacheKeyType & key,
+                                                                const FixedSampledPointCacheCreatorType & create );
+
+  /** Number of cached data of each kind. */
+  SizeValueType GetNumberOfFixedImageGradientImages() const;
+  SizeValueType GetNumberOfSampledPointSets() const;
+  SizeValueType GetNumberOfFixedSampledPointCaches() const;
+
+  /** Release the cached data. */
+  void ReleaseData();
+
+protected:
+  ImageToImageMetricv4FixedDataCache() = default;
+  ~ImageToImageMetricv4FixedDataCache() override = default;
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+  template<typename TKey, typename TValue>
+  struct EntryType
+    {
+    TKey                        Key;
+    std::shared_future<TValue>  Value;
+    };
+
+  /** Return the value of the entry of \c key, computing it with \c create
+   * if there is none. */
+  template<typename TKey, typename TValue>
+  TValue GetOrCreate( std::vector<EntryType<TKey, TValue> > & entries, const TKey & key,
+                      const std::function<TValue()> & create );
+
+  std::vector<EntryType<FixedImageKeyType, FixedImageGradientImagePointer> >
+                                          m_FixedImageGradientImages;
+  std::vector<EntryType<SampledPointSetKeyType, FixedSampledPointSetPointer> >
+                                          m_SampledPointSets;
+  std::vector<EntryType<FixedSampledPointCacheKeyType, FixedSampledPointCacheConstPointer> >
+                                          m_FixedSampledPointCaches;
+  mutable std::mutex                      m_Mutex;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageToImageMetricv4FixedDataCache.hxx"
+#endif
+
+#endif
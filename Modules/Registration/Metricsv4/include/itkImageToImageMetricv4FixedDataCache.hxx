@@ -0,0 +1,215 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkImageToImageMetricv4FixedDataCache_hxx
+#define itkImageToImageMetricv4FixedDataCache_hxx
+
+#include "itkImageToImageMetricv4FixedDataCache.h"
+#include "itkMath.h"
+
+namespace itk
+{
+
+template<typename TMetric>
+template<typename TImage>
+ImageToImageMetricv4FixedDataCache<TMetric>::ImageKeyType<TImage>
+::ImageKeyType( const TImage * image, bool withPixels ) :
+  PixelContainer( withPixels ? image->GetPixelContainer() : nullptr ),
+  Region( image->GetLargestPossibleRegion() ),
+  Spacing( image->GetSpacing() ),
+  Origin( image->GetOrigin() ),
+  Direction( image->GetDirection() )
+{
+}
+
+template<typename TMetric>
+template<typename TImage>
+bool
+ImageToImageMetricv4FixedDataCache<TMetric>::ImageKeyType<TImage>
+::operator==( const ImageKeyType & other ) const
+{
+  return this->PixelContainer == other.PixelContainer &&
+         this->Region == other.Region &&
+         this->Spacing == other.Spacing &&
+         this->Origin == other.Origin &&
+         this->Direction == other.Direction;
+}
+
+template<typename TMetric>
+bool
+ImageToImageMetricv4FixedDataCache<TMetric>::SampledPointSetKeyType
+::operator==( const SampledPointSetKeyType & other ) const
+{
+  return this->VirtualDomain == other.VirtualDomain &&
+         this->FixedImageMask == other.FixedImageMask &&
+         this->SamplingStrategy == other.SamplingStrategy &&
+         Math::ExactlyEquals( this->SamplingPercentage, other.SamplingPercentage ) &&
+         this->RandomSeed == other.RandomSeed;
+}
+
+template<typename TMetric>
+bool
+ImageToImageMetricv4FixedDataCache<TMetric>::FixedSampledPointCacheKeyType
+::operator==( const FixedSampledPointCacheKeyType & other ) const
+{
+  return this->FixedSampledPointSet == other.FixedSampledPointSet &&
+         this->FixedImage == other.FixedImage &&
+         this->VirtualDomain == other.VirtualDomain &&
+         this->FixedTransformClass == other.FixedTransformClass &&
+         this->FixedTransformParameters == other.FixedTransformParameters &&
+         this->FixedTransformFixedParameters == other.FixedTransformFixedParameters &&
+         this->FixedImageMask == other.FixedImageMask &&
+         this->FixedInterpolatorClass == other.FixedInterpolatorClass &&
+         this->ComputeGradients == other.ComputeGradients &&
+         this->FixedImageGradientImage == other.FixedImageGradientImage &&
+         this->FixedImageGradientCalculatorClass == other.FixedImageGradientCalculatorClass;
+}
+
+template<typename TMetric>
+typename ImageToImageMetricv4FixedDataCache<TMetric>::FixedImageGradientImagePointer
+ImageToImageMetricv4FixedDataCache<TMetric>
+::GetFixedImageGradientImage( const FixedImageType * image, const FixedImageGradientImageCreatorType & create )
+{
+  return this->GetOrCreate( this->m_FixedImageGradientImages, FixedImageKeyType( image ), create );
+}
+
+template<typename TMetric>
+typename ImageToImageMetricv4FixedDataCache<TMetric>::FixedSampledPointSetPointer
+ImageToImageMetricv4FixedDataCache<TMetric>
+::GetSampledPointSet( const SampledPointSetKeyType & key, const SampledPointSetCreatorType & create )
+{
+  return this->GetOrCreate( this->m_SampledPointSets, key, create );
+}
+
+template<typename TMetric>
+typename ImageToImageMetricv4FixedDataCache<TMetric>::FixedSampledPointCacheConstPointer
+ImageToImageMetricv4FixedDataCache<TMetric>
+::GetFixedSampledPointCache( const FixedSampledPointCacheKeyType & key, const FixedSampledPointCacheCreatorType & create )
+{
+  return this->GetOrCreate( this->m_FixedSampledPointCaches, key, create );
+}
+
+template<typename TMetric>
+template<typename TKey, typename TValue>
+TValue
+ImageToImageMetricv4FixedDataCache<TMetric>
+::GetOrCreate( std::vector<EntryType<TKey, TValue> > & entries, const TKey & key,
+               const std::function<TValue()> & create )
+{
+  std::promise<TValue> promise;
+  std::shared_future<TValue> value;
+  bool isCreator = false;
+  {
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  for( const auto & entry : entries )
+    {
+    if( entry.Key == key )
+      {
+      value = entry.Value;
+      break;
+      }
+    }
+  if( !value.valid() )
+    {
+    value = promise.get_future().share();
+    entries.push_back( EntryType<TKey, TValue>{ key, value } );
+    isCreator = true;
+    }
+  }
+  if( !isCreator )
+    {
+    return value.get();
+    }
+
+  // Create the value without holding the lock, so that the other data can
+  // be requested meanwhile.
+  try
+    {
+    promise.set_value( create() );
+    }
+  catch( ... )
+    {
+    // Forget the failed entry, and report the failure to the waiting threads.
+    {
+    std::lock_guard<std::mutex> lock( this->m_Mutex );
+    for( auto it = entries.begin(); it != entries.end(); ++it )
+      {
+      if( it->Key == key )
+        {
+        entries.erase( it );
+        break;
+        }
+      }
+    }
+    promise.set_exception( std::current_exception() );
+    }
+  return value.get();
+}
+
+template<typename TMetric>
+SizeValueType
+ImageToImageMetricv4FixedDataCache<TMetric>
+::GetNumberOfFixedImageGradientImages() const
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  return this->m_FixedImageGradientImages.size();
+}
+
+template<typename TMetric>
+SizeValueType
+ImageToImageMetricv4FixedDataCache<TMetric>
+::GetNumberOfSampledPointSets() const
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  return this->m_SampledPointSets.size();
+}
+
+template<typename TMetric>
+SizeValueType
+ImageToImageMetricv4FixedDataCache<TMetric>
+::GetNumberOfFixedSampledPointCaches() const
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  return this->m_FixedSampledPointCaches.size();
+}
+
+template<typename TMetric>
+void
+ImageToImageMetricv4FixedDataCache<TMetric>
+::ReleaseData()
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  this->m_FixedImageGradientImages.clear();
+  this->m_SampledPointSets.clear();
+  this->m_FixedSampledPointCaches.clear();
+}
+
+template<typename TMetric>
+void
+ImageToImageMetricv4FixedDataCache<TMetric>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfFixedImageGradientImages: " << this->GetNumberOfFixedImageGradientImages() << std::endl;
+  os << indent << "NumberOfSampledPointSets: " << this->GetNumberOfSampledPointSets() << std::endl;
+  os << indent << "NumberOfFixedSampledPointCaches: " << this->GetNumberOfFixedSampledPointCaches() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -98,8 +98,8 @@ protected:
   /** Constructor. */
   ImageToImageMetricv4GetValueAndDerivativeThreader() {}
 
-  /** Walk through the given virtual image domain, and call \c ProcessVirtualPoint on every
-   * point. */
+  /** Walk through the given virtual image domain, and call \c ProcessVirtualPoints on
+   * every batch of \c PointBatchSize points. */
   void ThreadedExecution( const DomainType & subdomain,
                                   const ThreadIdType threadId ) override;
 
@@ -169,8 +169,8 @@ protected:
   /** Constructor. */
   ImageToImageMetricv4GetValueAndDerivativeThreader() {}
 
-  /** Walk through the given virtual image domain, and call \c ProcessVirtualPoint on every
-   * point. */
+  /** Walk through the given virtual image domain, and call \c ProcessVirtualPoints on
+   * every batch of \c PointBatchSize points. */
   void ThreadedExecution( const DomainType & subdomain,
                                   const ThreadIdType threadId ) override;
 
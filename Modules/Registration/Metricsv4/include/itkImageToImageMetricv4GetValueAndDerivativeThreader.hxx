@@ -32,12 +32,22 @@ ImageToImageMetricv4GetValueAndDerivativeThreader< ThreadedImageRegionPartitione
 {
   typename VirtualImageType::ConstPointer virtualImage = this->m_Associate->GetVirtualImage();
   using IteratorType = ImageRegionConstIteratorWithIndex< VirtualImageType >;
-  VirtualPointType virtualPoint;
+  VirtualIndexType virtualIndices[Superclass::PointBatchSize];
+  VirtualPointType virtualPoints[Superclass::PointBatchSize];
+  SizeValueType numberOfPoints = 0;
   for( IteratorType it( virtualImage, imageSubRegion ); !it.IsAtEnd(); ++it )
     {
-    const VirtualIndexType & virtualIndex = it.GetIndex();
-    virtualImage->TransformIndexToPhysicalPoint( virtualIndex, virtualPoint );
-    this->ProcessVirtualPoint( virtualIndex, virtualPoint, threadId );
+    virtualIndices[numberOfPoints] = it.GetIndex();
+    virtualImage->TransformIndexToPhysicalPoint( virtualIndices[numberOfPoints], virtualPoints[numberOfPoints] );
+    if( ++numberOfPoints == Superclass::PointBatchSize )
+      {
+      this->ProcessVirtualPoints( virtualIndices, virtualPoints, numberOfPoints, threadId );
+      numberOfPoints = 0;
+      }
+    }
+  if( numberOfPoints > 0 )
+    {
+    this->ProcessVirtualPoints( virtualIndices, virtualPoints, numberOfPoints, threadId );
     }
   //Finalize per thread actions
   this->m_Associate->FinalizeThread( threadId );
@@ -53,14 +63,30 @@ ImageToImageMetricv4GetValueAndDerivativeThreader< ThreadedIndexedContainerParti
   using ElementIdentifierType = typename TImageToImageMetricv4::VirtualPointSetType::MeshTraits::PointIdentifier;
   const ElementIdentifierType begin = indexSubRange[0];
   const ElementIdentifierType end   = indexSubRange[1];
-  VirtualIndexType virtualIndex;
   typename VirtualImageType::ConstPointer virtualImage = this->m_Associate->GetVirtualImage();
+  VirtualIndexType virtualIndices[Superclass::PointBatchSize];
+  VirtualPointType virtualPoints[Superclass::PointBatchSize];
+  SizeValueType numberOfPoints = 0;
+  /* The batches hold consecutive sampled points, so that the fixed sampled
+   * point cache of the metric can be used. */
+  auto & batch = this->m_GetValueAndDerivativePerThreadVariables[threadId].PointBatch;
+  batch.SampledPointIdentifier = begin;
   for( ElementIdentifierType i = begin; i <= end; ++i )
     {
-    const VirtualPointType & virtualPoint = virtualSampledPointSet->GetPoint( i );
-    virtualImage->TransformPhysicalPointToIndex( virtualPoint, virtualIndex );
-    this->ProcessVirtualPoint( virtualIndex, virtualPoint, threadId );
+    virtualPoints[numberOfPoints] = virtualSampledPointSet->GetPoint( i );
+    virtualImage->TransformPhysicalPointToIndex( virtualPoints[numberOfPoints], virtualIndices[numberOfPoints] );
+    if( ++numberOfPoints == Superclass::PointBatchSize )
+      {
+      this->ProcessVirtualPoints( virtualIndices, virtualPoints, numberOfPoints, threadId );
+      numberOfPoints = 0;
+      batch.SampledPointIdentifier = i + 1;
+      }
+    }
+  if( numberOfPoints > 0 )
+    {
+    this->ProcessVirtualPoints( virtualIndices, virtualPoints, numberOfPoints, threadId );
     }
+  batch.SampledPointIdentifier = -1;
   //Finalize per thread actions
   this->m_Associate->FinalizeThread( threadId );
 }
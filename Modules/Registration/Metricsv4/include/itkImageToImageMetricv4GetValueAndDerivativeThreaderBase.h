@@ -20,6 +20,7 @@
 
 #include "itkDomainThreader.h"
 #include "itkCompensatedSummation.h"
+#include <vector>
 
 namespace itk
 {
@@ -35,9 +36,12 @@ namespace itk
  *  AfterThreadedExecution.
  *
  *  The \c ThreadedExecution in
- *  ImageToImageMetricv4GetValueAndDerivativeThreader calls \c
- *  ProcessVirtualPoint on every point in the virtual image domain.  \c
- *  ProcessVirtualPoint calls \c ProcessPoint on each point.
+ *  ImageToImageMetricv4GetValueAndDerivativeThreader collects the points of
+ *  the virtual image domain in batches of \c PointBatchSize points, and
+ *  calls \c ProcessVirtualPoints on each batch.  \c ProcessVirtualPoints
+ *  transforms and evaluates the whole batch in each space before calling
+ *  \c ProcessPoint on each valid point, which keeps the loops over the
+ *  transforms, the interpolators and the gradient calculators tight.
  *
  * \ingroup ITKMetricsv4 */
 template < typename TDomainPartitioner, typename TImageToImageMetricv4 >
@@ -71,6 +75,10 @@ public:
   using MovingImagePointType = typename ImageToImageMetricv4Type::MovingImagePointType;
   using MovingImagePixelType = typename ImageToImageMetricv4Type::MovingImagePixelType;
   using MovingImageGradientType = typename ImageToImageMetricv4Type::MovingImageGradientType;
+  using FixedInterpolatorContinuousIndexType = typename ImageToImageMetricv4Type::FixedInterpolatorContinuousIndexType;
+  using FixedInterpolatorOutputType = typename ImageToImageMetricv4Type::FixedInterpolatorOutputType;
+  using MovingInterpolatorContinuousIndexType = typename ImageToImageMetricv4Type::MovingInterpolatorContinuousIndexType;
+  using MovingInterpolatorOutputType = typename ImageToImageMetricv4Type::MovingInterpolatorOutputType;
 
   using FixedTransformType = typename ImageToImageMetricv4Type::FixedTransformType;
   using FixedOutputPointType = typename FixedTransformType::OutputPointType;
@@ -89,6 +97,9 @@ public:
   using CompensatedDerivativeValueType = CompensatedSummation<DerivativeValueType>;
   using CompensatedDerivativeType = std::vector<CompensatedDerivativeValueType>;
 
+  /** Number of virtual points processed together by \c ProcessVirtualPoints. */
+  static constexpr SizeValueType PointBatchSize = 64;
+
   /** Access the GetValueAndDerivative() accesor in image metric base. */
   virtual bool GetComputeDerivative() const;
 
@@ -107,15 +118,50 @@ protected:
    * support).  */
   void AfterThreadedExecution() override;
 
-  /** Method called by the threaders to process the given virtual point.  This
-   * in turn calls \c TransformAndEvaluateFixedPoint, \c
-   * TransformAndEvaluateMovingPoint, and \c ProcessPoint.
+  /** Method called by the threaders to process a batch of virtual points.
+   * This in turn calls \c TransformAndEvaluateVirtualPoints, and \c
+   * ProcessPoint on each valid point of the batch, in the order of the batch.
    * And adds entries to m_MeasurePerThread and m_LocalDerivativesPerThread,
-   * m_NumberOfValidPointsPerThread. */
+   * m_NumberOfValidPointsPerThread.
+   * Returns the number of valid points of the batch. */
+  virtual SizeValueType ProcessVirtualPoints( const VirtualIndexType * virtualIndices,
+                                              const VirtualPointType * virtualPoints,
+                                              const SizeValueType numberOfPoints,
+                                              const ThreadIdType threadId );
+
+  /** Process a single virtual point, as a batch of one point.
+   * When a derived class overrides this method, \c ProcessVirtualPoints
+   * calls it on each point of the batch instead of processing the batch at
+   * once. An override that calls this implementation is not detected.
+   * \deprecated Derived classes should override \c ProcessVirtualPoints
+   * instead. */
   virtual bool ProcessVirtualPoint( const VirtualIndexType & virtualIndex,
                                     const VirtualPointType & virtualPoint,
                                     const ThreadIdType threadId );
 
+  /** Transform and evaluate a batch of virtual points with \c
+   * TransformAndEvaluateVirtualPoints, and call \c ProcessPoint on each
+   * valid point. This is the batched implementation of \c
+   * ProcessVirtualPoints. */
+  SizeValueType TransformEvaluateAndProcessVirtualPoints( const VirtualIndexType * virtualIndices,
+                                                          const VirtualPointType * virtualPoints,
+                                                          const SizeValueType numberOfPoints,
+                                                          const ThreadIdType threadId );
+
+  /** Transform a batch of at most \c PointBatchSize virtual points into the
+   * fixed and moving spaces, and evaluate the images, one space after the
+   * other, with one call to each interpolator. The image gradients are
+   * computed as well when \c computeImageGradients is true and the
+   * derivative is computed. The fixed space results are read from the fixed
+   * sampled point cache of the metric when it is in use and the batch holds
+   * sampled points. The results are stored in the point batch of the
+   * thread, which lists the positions in the batch of the points valid in
+   * both spaces. */
+  void TransformAndEvaluateVirtualPoints( const VirtualPointType * virtualPoints,
+                                          const SizeValueType numberOfPoints,
+                                          const bool computeImageGradients,
+                                          const ThreadIdType threadId );
+
   /** Method to calculate the metric value and derivative
    * given a point, value and image derivative for both fixed and moving
    * spaces. The provided values have been calculated from \c virtualPoint,
@@ -164,6 +210,34 @@ protected:
   virtual void StorePointDerivativeResult( const VirtualIndexType & virtualIndex,
                                            const ThreadIdType threadId );
 
+  /** Structure of arrays holding the mapped points, pixel values and image
+   * gradients of a batch of virtual points. */
+  struct PointBatchStruct
+    {
+    PointBatchStruct():
+      NumberOfValidPoints( 0 ),
+      SampledPointIdentifier( -1 )
+      {}
+    std::vector< FixedImagePointType >      MappedFixedPoints;
+    std::vector< FixedImagePixelType >      MappedFixedPixelValues;
+    std::vector< FixedImageGradientType >   MappedFixedImageGradients;
+    std::vector< MovingImagePointType >     MappedMovingPoints;
+    std::vector< MovingImagePixelType >     MappedMovingPixelValues;
+    std::vector< MovingImageGradientType >  MappedMovingImageGradients;
+    /** Work buffers of the batch evaluation of the interpolators. */
+    std::vector< FixedInterpolatorContinuousIndexType >   FixedContinuousIndices;
+    std::vector< FixedInterpolatorOutputType >            FixedInterpolatedValues;
+    std::vector< MovingInterpolatorContinuousIndexType >  MovingContinuousIndices;
+    std::vector< MovingInterpolatorOutputType >           MovingInterpolatedValues;
+    /** Positions in the batch of the valid points, in increasing order. */
+    std::vector< SizeValueType >            ValidPoints;
+    SizeValueType                           NumberOfValidPoints;
+    /** Identifier in the virtual sampled point set of the first point of
+     * the batch, when the batch holds consecutive sampled points, or -1.
+     * Used to read the fixed sampled point cache of the metric. */
+    OffsetValueType                         SampledPointIdentifier;
+    };
+
   struct GetValueAndDerivativePerThreadStruct
     {
     /** Intermediary threaded metric value storage. */
@@ -180,6 +254,13 @@ protected:
      * classes for efficiency. */
     JacobianType                 MovingTransformJacobian;
     JacobianType                 MovingTransformJacobianPositional;
+    /** Mapped points, pixel values and image gradients of the batch of
+     * points being processed. */
+    PointBatchStruct             PointBatch;
+    /** Whether \c ProcessVirtualPoint was checked for an override by the
+     * thread, and whether it is overridden by a derived class. */
+    bool                         ProcessVirtualPointChecked;
+    bool                         ProcessVirtualPointIsOverridden;
     };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, GetValueAndDerivativePerThreadStruct,
                                             PaddedGetValueAndDerivativePerThreadStruct);
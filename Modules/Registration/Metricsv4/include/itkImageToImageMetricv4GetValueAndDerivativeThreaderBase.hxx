@@ -20,10 +20,16 @@
 
 #include "itkImageToImageMetricv4GetValueAndDerivativeThreaderBase.h"
 #include "itkNumericTraits.h"
+#include <algorithm>
 
 namespace itk
 {
 
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+constexpr SizeValueType
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::PointBatchSize;
+
 template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
 ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
 ::ImageToImageMetricv4GetValueAndDerivativeThreaderBase():
@@ -99,6 +105,8 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
     {
     this->m_GetValueAndDerivativePerThreadVariables[thread].NumberOfValidPoints = NumericTraits< SizeValueType >::ZeroValue();
     this->m_GetValueAndDerivativePerThreadVariables[thread].Measure = NumericTraits< InternalComputationValueType >::ZeroValue();
+    this->m_GetValueAndDerivativePerThreadVariables[thread].ProcessVirtualPointChecked = false;
+    this->m_GetValueAndDerivativePerThreadVariables[thread].ProcessVirtualPointIsOverridden = false;
     if( this->m_Associate->GetComputeDerivative() )
       {
       if ( this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField )
@@ -174,55 +182,104 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
 }
 
 template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
-bool
+void
 ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
-::ProcessVirtualPoint( const VirtualIndexType & virtualIndex,
-                       const VirtualPointType & virtualPoint,
-                       const ThreadIdType threadId )
+::TransformAndEvaluateVirtualPoints( const VirtualPointType * virtualPoints,
+                                     const SizeValueType numberOfPoints,
+                                     const bool computeImageGradients,
+                                     const ThreadIdType threadId )
 {
-  FixedImagePointType         mappedFixedPoint;
-  FixedImagePixelType         mappedFixedPixelValue;
-  FixedImageGradientType      mappedFixedImageGradient;
-  MovingImagePointType        mappedMovingPoint;
-  MovingImagePixelType        mappedMovingPixelValue;
-  MovingImageGradientType     mappedMovingImageGradient;
-  bool                        pointIsValid = false;
-  MeasureType                 metricValueResult;
-
-  /* Transform the point into fixed and moving spaces, and evaluate.
-   * Do this in a try block to catch exceptions and print more useful info
-   * then we otherwise get when exceptions are caught in MultiThreaderBase. */
-  try
+  PointBatchStruct & batch = this->m_GetValueAndDerivativePerThreadVariables[threadId].PointBatch;
+  if( batch.ValidPoints.size() < numberOfPoints )
     {
-    pointIsValid = this->m_Associate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue);
-    if( pointIsValid &&
-        this->m_Associate->GetComputeDerivative() &&
-        this->m_Associate->GetGradientSourceIncludesFixed() )
-      {
-      this->m_Associate->ComputeFixedImageGradientAtPoint( mappedFixedPoint, mappedFixedImageGradient );
-      }
+    const SizeValueType batchSize = std::max( numberOfPoints, PointBatchSize );
+    batch.MappedFixedPoints.resize( batchSize );
+    batch.MappedFixedPixelValues.resize( batchSize );
+    batch.MappedFixedImageGradients.resize( batchSize );
+    batch.MappedMovingPoints.resize( batchSize );
+    batch.MappedMovingPixelValues.resize( batchSize );
+    batch.MappedMovingImageGradients.resize( batchSize );
+    batch.ValidPoints.resize( batchSize );
+    batch.FixedContinuousIndices.resize( batchSize );
+    batch.FixedInterpolatedValues.resize( batchSize );
+    batch.MovingContinuousIndices.resize( batchSize );
+    batch.MovingInterpolatedValues.resize( batchSize );
     }
-  catch( ExceptionObject & exc )
+
+  const bool computeDerivative = computeImageGradients && this->m_Associate->GetComputeDerivative();
+  const bool computeFixedGradients = computeDerivative && this->m_Associate->GetGradientSourceIncludesFixed();
+  SizeValueType * validPoints = batch.ValidPoints.data();
+  SizeValueType numberOfValidPoints = 0;
+
+  const auto & fixedSampledPointCache = this->m_Associate->m_FixedSampledPointCache;
+  if( batch.SampledPointIdentifier >= 0 && fixedSampledPointCache && !fixedSampledPointCache->empty() )
     {
-    //NOTE: there must be a cleaner way to do this:
-    std::string msg("Caught exception: \n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
+    /* The points were already transformed and evaluated in the fixed space. */
+    const auto * cachedPoints = fixedSampledPointCache->data() + batch.SampledPointIdentifier;
+    for( SizeValueType i = 0; i < numberOfPoints; ++i )
+      {
+      if( cachedPoints[i].IsValid )
+        {
+        batch.MappedFixedPoints[i] = cachedPoints[i].MappedPoint;
+        batch.MappedFixedPixelValues[i] = cachedPoints[i].PixelValue;
+        if( computeFixedGradients )
+          {
+          batch.MappedFixedImageGradients[i] = cachedPoints[i].Gradient;
+          }
+        validPoints[numberOfValidPoints++] = i;
+        }
+      }
     }
-  if( !pointIsValid )
+  else
     {
-    return pointIsValid;
+    /* Transform the points into the fixed space, and evaluate.
+     * Do this in a try block to catch exceptions and print more useful info
+     * then we otherwise get when exceptions are caught in MultiThreaderBase. */
+    try
+      {
+      for( SizeValueType i = 0; i < numberOfPoints; ++i )
+        {
+        validPoints[i] = i;
+        }
+      numberOfValidPoints = this->m_Associate->TransformAndEvaluateFixedPoints( virtualPoints, validPoints, numberOfPoints,
+                                                                                batch.MappedFixedPoints.data(),
+                                                                                batch.MappedFixedPixelValues.data(),
+                                                                                batch.FixedContinuousIndices.data(),
+                                                                                batch.FixedInterpolatedValues.data() );
+      if( computeFixedGradients )
+        {
+        for( SizeValueType v = 0; v < numberOfValidPoints; ++v )
+          {
+          const SizeValueType i = validPoints[v];
+          this->m_Associate->ComputeFixedImageGradientAtPoint( batch.MappedFixedPoints[i], batch.MappedFixedImageGradients[i] );
+          }
+        }
+      }
+    catch( ExceptionObject & exc )
+      {
+      //NOTE: there must be a cleaner way to do this:
+      std::string msg("Caught exception: \n");
+      msg += exc.what();
+      ExceptionObject err(__FILE__, __LINE__, msg);
+      throw err;
+      }
     }
 
+  /* Then into the moving space, the points that are valid in the fixed space. */
   try
     {
-    pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
-    if( pointIsValid &&
-        this->m_Associate->GetComputeDerivative() &&
-        this->m_Associate->GetGradientSourceIncludesMoving() )
+    numberOfValidPoints = this->m_Associate->TransformAndEvaluateMovingPoints( virtualPoints, validPoints, numberOfValidPoints,
+                                                                               batch.MappedMovingPoints.data(),
+                                                                               batch.MappedMovingPixelValues.data(),
+                                                                               batch.MovingContinuousIndices.data(),
+                                                                               batch.MovingInterpolatedValues.data() );
+    if( computeDerivative && this->m_Associate->GetGradientSourceIncludesMoving() )
       {
-      this->m_Associate->ComputeMovingImageGradientAtPoint( mappedMovingPoint, mappedMovingImageGradient );
+      for( SizeValueType v = 0; v < numberOfValidPoints; ++v )
+        {
+        const SizeValueType i = validPoints[v];
+        this->m_Associate->ComputeMovingImageGradientAtPoint( batch.MappedMovingPoints[i], batch.MappedMovingImageGradients[i] );
+        }
       }
     }
   catch( ExceptionObject & exc )
@@ -232,44 +289,134 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
     ExceptionObject err(__FILE__, __LINE__, msg);
     throw err;
     }
-  if( !pointIsValid )
+  batch.NumberOfValidPoints = numberOfValidPoints;
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+SizeValueType
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ProcessVirtualPoints( const VirtualIndexType * virtualIndices,
+                        const VirtualPointType * virtualPoints,
+                        const SizeValueType numberOfPoints,
+                        const ThreadIdType threadId )
+{
+  AlignedGetValueAndDerivativePerThreadStruct & perThread = this->m_GetValueAndDerivativePerThreadVariables[threadId];
+  if( numberOfPoints == 0 )
     {
-    return pointIsValid;
+    return 0;
     }
 
-  /* Call the user method in derived classes to do the specific
-   * calculations for value and derivative. */
-  try
+  if( !perThread.ProcessVirtualPointChecked )
     {
-    pointIsValid = this->ProcessPoint(
-                                   virtualIndex,
-                                   virtualPoint,
-                                   mappedFixedPoint, mappedFixedPixelValue,
-                                   mappedFixedImageGradient,
-                                   mappedMovingPoint, mappedMovingPixelValue,
-                                   mappedMovingImageGradient,
-                                   metricValueResult,
-                                   this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives,
-                                   threadId );
+    /* Process the first point with ProcessVirtualPoint to find out whether
+     * a derived class overrides it: the implementation of this class clears
+     * the flag. */
+    perThread.ProcessVirtualPointChecked = true;
+    perThread.ProcessVirtualPointIsOverridden = true;
+    SizeValueType numberOfValidPoints = this->ProcessVirtualPoint( virtualIndices[0], virtualPoints[0], threadId ) ? 1 : 0;
+
+    PointBatchStruct & batch = perThread.PointBatch;
+    const OffsetValueType sampledPointIdentifier = batch.SampledPointIdentifier;
+    if( sampledPointIdentifier >= 0 )
+      {
+      batch.SampledPointIdentifier = sampledPointIdentifier + 1;
+      }
+    numberOfValidPoints += this->Self::ProcessVirtualPoints( virtualIndices + 1, virtualPoints + 1, numberOfPoints - 1, threadId );
+    batch.SampledPointIdentifier = sampledPointIdentifier;
+    return numberOfValidPoints;
     }
-  catch( ExceptionObject & exc )
+
+  if( perThread.ProcessVirtualPointIsOverridden )
     {
-    //NOTE: there must be a cleaner way to do this:
-    std::string msg("Exception in GetValueAndDerivativeProcessPoint:\n");
-    msg += exc.what();
-    ExceptionObject err(__FILE__, __LINE__, msg);
-    throw err;
+    SizeValueType numberOfValidPoints = 0;
+    for( SizeValueType i = 0; i < numberOfPoints; ++i )
+      {
+      if( this->ProcessVirtualPoint( virtualIndices[i], virtualPoints[i], threadId ) )
+        {
+        ++numberOfValidPoints;
+        }
+      }
+    return numberOfValidPoints;
     }
-  if( pointIsValid )
+
+  return this->TransformEvaluateAndProcessVirtualPoints( virtualIndices, virtualPoints, numberOfPoints, threadId );
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+SizeValueType
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::TransformEvaluateAndProcessVirtualPoints( const VirtualIndexType * virtualIndices,
+                                            const VirtualPointType * virtualPoints,
+                                            const SizeValueType numberOfPoints,
+                                            const ThreadIdType threadId )
+{
+  this->TransformAndEvaluateVirtualPoints( virtualPoints, numberOfPoints, true, threadId );
+
+  AlignedGetValueAndDerivativePerThreadStruct & perThread = this->m_GetValueAndDerivativePerThreadVariables[threadId];
+  const PointBatchStruct & batch = perThread.PointBatch;
+  const bool computeDerivative = this->m_Associate->GetComputeDerivative();
+  SizeValueType numberOfValidPoints = 0;
+  MeasureType metricValueResult;
+
+  /* Call the user method in derived classes to do the specific
+   * calculations for value and derivative. */
+  for( SizeValueType v = 0; v < batch.NumberOfValidPoints; ++v )
     {
-    this->m_GetValueAndDerivativePerThreadVariables[threadId].NumberOfValidPoints++;
-    this->m_GetValueAndDerivativePerThreadVariables[threadId].Measure += metricValueResult;
-    if( this->m_Associate->GetComputeDerivative() )
+    const SizeValueType i = batch.ValidPoints[v];
+    bool pointIsValid = false;
+    try
+      {
+      pointIsValid = this->ProcessPoint(
+                                     virtualIndices[i],
+                                     virtualPoints[i],
+                                     batch.MappedFixedPoints[i], batch.MappedFixedPixelValues[i],
+                                     batch.MappedFixedImageGradients[i],
+                                     batch.MappedMovingPoints[i], batch.MappedMovingPixelValues[i],
+                                     batch.MappedMovingImageGradients[i],
+                                     metricValueResult,
+                                     perThread.LocalDerivatives,
+                                     threadId );
+      }
+    catch( ExceptionObject & exc )
       {
-      this->StorePointDerivativeResult( virtualIndex, threadId );
+      //NOTE: there must be a cleaner way to do this:
+      std::string msg("Exception in GetValueAndDerivativeProcessPoint:\n");
+      msg += exc.what();
+      ExceptionObject err(__FILE__, __LINE__, msg);
+      throw err;
+      }
+    if( pointIsValid )
+      {
+      ++numberOfValidPoints;
+      perThread.Measure += metricValueResult;
+      if( computeDerivative )
+        {
+        this->StorePointDerivativeResult( virtualIndices[i], threadId );
+        }
       }
     }
+  perThread.NumberOfValidPoints += numberOfValidPoints;
+
+  return numberOfValidPoints;
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+bool
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ProcessVirtualPoint( const VirtualIndexType & virtualIndex,
+                       const VirtualPointType & virtualPoint,
+                       const ThreadIdType threadId )
+{
+  AlignedGetValueAndDerivativePerThreadStruct & perThread = this->m_GetValueAndDerivativePerThreadVariables[threadId];
+  perThread.ProcessVirtualPointIsOverridden = false;
 
+  /* The point is not read from the fixed sampled point cache: it may not be
+   * the first point of the batch. */
+  PointBatchStruct & batch = perThread.PointBatch;
+  const OffsetValueType sampledPointIdentifier = batch.SampledPointIdentifier;
+  batch.SampledPointIdentifier = -1;
+  const bool pointIsValid = this->TransformEvaluateAndProcessVirtualPoints( &virtualIndex, &virtualPoint, 1, threadId ) > 0;
+  batch.SampledPointIdentifier = sampledPointIdentifier;
   return pointIsValid;
 }
 
@@ -28,6 +28,8 @@
 #include "itkMutexLockHolder.h"
 #include "itkSimpleFastMutexLock.h"
 
+#include <memory>
+
 namespace itk
 {
 
@@ -65,10 +67,15 @@ namespace itk
  * \warning Local-support transforms are not yet supported. If used,
  * an exception is thrown during Initialize().
  *
- * \note The per-iteration post-processing code is not multi-threaded, but could be
- * readily be made so for a small performance gain.
- * See GetValueCommonAfterThreadedExecution(), GetValueAndDerivative()
- * and threader::AfterThreadedExecution().
+ * With global-support transforms, the derivatives of the joint PDF are
+ * accumulated by each thread in its own buffer, without locking, and the
+ * buffers are summed in parallel after the threaded execution. When a
+ * buffer per thread does not fit in MaximumJointPDFDerivativesBufferSize,
+ * the threads share fewer buffers, each one protected by a lock.
+ *
+ * \note The post-processing of the joint PDF is not multi-threaded, but
+ * could be readily be made so for a small performance gain.
+ * See GetValueCommonAfterThreadedExecution() and ComputeResults().
  *
  * The algorithm and much of the code was copied from the previous
  * Mattes MI metric, i.e. itkMattesMutualInformationImageToImageMetric.
@@ -156,6 +163,14 @@ public:
   itkSetClampMacro( NumberOfHistogramBins, SizeValueType, 5, NumericTraits<SizeValueType>::max() );
   itkGetConstReferenceMacro(NumberOfHistogramBins, SizeValueType);
 
+  /** Set/Get the maximum total size, in bytes, of the per-thread buffers of
+   * joint PDF derivatives used with global-support transforms. Each buffer
+   * holds NumberOfParameters * NumberOfHistogramBins^2 values. If a buffer
+   * per thread does not fit, fewer buffers are shared by the threads, at
+   * the cost of locking. At least one buffer is used. Default is 256 MiB. */
+  itkSetMacro(MaximumJointPDFDerivativesBufferSize, SizeValueType);
+  itkGetConstMacro(MaximumJointPDFDerivativesBufferSize, SizeValueType);
+
   void Initialize(void) override;
 
   /** The marginal PDFs are stored as std::vector. */
@@ -227,6 +242,7 @@ protected:
 
   /** Variables to define the marginal and joint histograms. */
   SizeValueType m_NumberOfHistogramBins;
+  SizeValueType m_MaximumJointPDFDerivativesBufferSize;
   PDFValueType  m_MovingImageNormalizedMin;
   PDFValueType  m_FixedImageNormalizedMin;
   PDFValueType  m_FixedImageTrueMin;
@@ -262,6 +278,9 @@ protected:
    * needs for mattes mutual information derivative computations
    * per thread.
    *
+   * It is only used when the threads share the buffers of joint PDF
+   * derivatives, see m_ThreaderJointPDFDerivatives.
+   *
    * Thread safety note:
    * A seperate object is used locally per each thread. Only the members
    * m_ParentJointPDFDerivativesLockPtr and m_ParentJointPDFDerivatives
@@ -340,7 +359,16 @@ private:
   };
 
   std::vector<DerivativeBufferManager>      m_ThreaderDerivativeManager;
-  SimpleFastMutexLock                       m_JointPDFDerivativesLock;
+
+  /** Buffers of joint PDF derivatives, for global-support transforms.
+   * Thread t accumulates in the buffer t modulo the number of buffers. With
+   * a buffer per thread, the threads write directly in their buffer and
+   * m_ThreaderDerivativeManager is empty. Otherwise the threads reduce
+   * their DerivativeBufferManager in the shared buffer, under its lock. */
+  std::vector<typename JointPDFDerivativesType::Pointer> m_ThreaderJointPDFDerivatives;
+  std::unique_ptr<SimpleFastMutexLock[]>                 m_ThreaderJointPDFDerivativesLocks;
+
+  /** Sum of the buffers of joint PDF derivatives, i.e. the first buffer. */
   typename JointPDFDerivativesType::Pointer m_JointPDFDerivatives;
 
   PDFValueType m_JointPDFSum;
@@ -30,6 +30,7 @@ template <typename TFixedImage, typename TMovingImage, typename TVirtualImage, t
 MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::MattesMutualInformationImageToImageMetricv4() :
   m_NumberOfHistogramBins(50),
+  m_MaximumJointPDFDerivativesBufferSize(256 * 1024 * 1024),
   m_MovingImageNormalizedMin(0.0),
   m_FixedImageNormalizedMin(0.0),
   m_FixedImageTrueMin(0.0),
@@ -50,6 +51,7 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 
   // For multi-threading the metric
   m_ThreaderJointPDF(0),
+  m_ThreaderJointPDFDerivatives(0),
   m_JointPDFDerivatives(nullptr),
   m_JointPDFSum(0.0)
 {
@@ -188,7 +190,7 @@ void
 MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::FinalizeThread( const ThreadIdType threadId )
 {
-  if( this->GetComputeDerivative() && ( !this->HasLocalSupport() ) )
+  if( this->GetComputeDerivative() && ( !this->HasLocalSupport() ) && !this->m_ThreaderDerivativeManager.empty() )
     {
     this->m_ThreaderDerivativeManager[threadId].BlockAndReduce();
     }
@@ -378,6 +380,8 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+
+  os << indent << "MaximumJointPDFDerivativesBufferSize: " << this->m_MaximumJointPDFDerivativesBufferSize << std::endl;
 }
 
 template <typename TFixedImage, typename TMovingImage, typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
@@ -429,7 +433,7 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
   // Allocate and initialize to zero (note the () at the end of the new
   // operator)
   // the memory as a single block
-  m_MemoryBlock.resize(m_MemoryBlockSize, 0.0);
+  m_MemoryBlock.assign(m_MemoryBlockSize, 0.0);
   for( size_t index = 0; index < maxBufferLength; ++index )
     {
     this->m_BufferPDFValuesContainer[index] = &(this->m_MemoryBlock[0]) + index * m_CachedNumberOfLocalParameters;
@@ -148,6 +148,7 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
     this->m_MattesAssociate->m_PRatioArray.resize(0);
     this->m_MattesAssociate->m_JointPdfIndex1DArray.resize(0);
     this->m_MattesAssociate->m_LocalDerivativeByParzenBin.resize(0);
+    this->m_MattesAssociate->m_ThreaderJointPDFDerivatives.clear();
     this->m_MattesAssociate->m_JointPDFDerivatives = nullptr;
     }
 
@@ -156,6 +157,7 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
     this->m_MattesAssociate->m_PRatioArray.assign( this->m_MattesAssociate->m_NumberOfHistogramBins * this->m_MattesAssociate->m_NumberOfHistogramBins, 0.0);
     this->m_MattesAssociate->m_JointPdfIndex1DArray.assign( this->m_MattesAssociate->GetNumberOfParameters(), 0 );
     // Don't need this with local-support
+    this->m_MattesAssociate->m_ThreaderJointPDFDerivatives.clear();
     this->m_MattesAssociate->m_JointPDFDerivatives = nullptr;
     // This always has four entries because the parzen window size is fixed.
     this->m_MattesAssociate->m_LocalDerivativeByParzenBin.resize(4);
@@ -198,39 +200,66 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
       jointPDFDerivativesRegion.SetSize(jointPDFDerivativesSize);
       }
 
+    // Use a buffer per thread if they fit in the allowed memory, so that
+    // the threads accumulate without locking.
+    const SizeValueType bufferSize = sizeof( JointPDFDerivativesValueType ) * jointPDFDerivativesRegion.GetNumberOfPixels();
+    const SizeValueType numberOfBuffers = std::max< SizeValueType >( 1,
+      std::min< SizeValueType >( localNumberOfThreadsUsed,
+                                 this->m_MattesAssociate->m_MaximumJointPDFDerivativesBufferSize / bufferSize ) );
+
     // Set the regions and allocate
-    if( this->m_MattesAssociate->m_JointPDFDerivatives.IsNull() ||
-        ( this->m_MattesAssociate->m_JointPDFDerivatives->GetBufferedRegion() != jointPDFDerivativesRegion )
-        )
-      {
-      this->m_MattesAssociate->m_JointPDFDerivatives = JointPDFDerivativesType::New();
-      this->m_MattesAssociate->m_JointPDFDerivatives->SetRegions( jointPDFDerivativesRegion);
-      this->m_MattesAssociate->m_JointPDFDerivatives->Allocate(true);
-      }
-    else
+    std::vector< typename JointPDFDerivativesType::Pointer > & buffers =
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivatives;
+    if( buffers.size() != numberOfBuffers ||
+        buffers[0]->GetBufferedRegion() != jointPDFDerivativesRegion )
       {
-      // Initialize to zero for accumulation
-      this->m_MattesAssociate->m_JointPDFDerivatives->FillBuffer(0.0F);
+      buffers.resize( numberOfBuffers );
+      for( SizeValueType b = 0; b < numberOfBuffers; ++b )
+        {
+        if( buffers[b].IsNull() || buffers[b]->GetBufferedRegion() != jointPDFDerivativesRegion )
+          {
+          buffers[b] = JointPDFDerivativesType::New();
+          buffers[b]->SetRegions( jointPDFDerivativesRegion );
+          buffers[b]->Allocate();
+          }
+        }
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivativesLocks.reset( new SimpleFastMutexLock[numberOfBuffers] );
       }
-    if( ( this->m_MattesAssociate->m_ThreaderDerivativeManager.size() != localNumberOfThreadsUsed ) )
+    // Initialize to zero for accumulation
+    this->GetMultiThreader()->ParallelizeArray( 0, numberOfBuffers,
+      [&buffers]( SizeValueType b )
+        {
+        buffers[b]->FillBuffer( 0.0 );
+        },
+      nullptr );
+    this->m_MattesAssociate->m_JointPDFDerivatives = buffers[0];
+
+    if( numberOfBuffers == localNumberOfThreadsUsed )
       {
-      this->m_MattesAssociate->m_ThreaderDerivativeManager.resize(localNumberOfThreadsUsed);
+      this->m_MattesAssociate->m_ThreaderDerivativeManager.clear();
       }
-    for( ThreadIdType threadId = 0; threadId < localNumberOfThreadsUsed; ++threadId )
+    else
       {
-      this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].Initialize(
-        // A heuristic that assumues memory for 2x size of
-        // m_JointPDFDerivati efficient and easy to make, so
-        // split it accross all the threads.  A work unit of at least 400 is needed
-        // when the thread size approaches the number of histograms so that the
-        // there is enough work to be done between thread lockings.
-        std::max<size_t>(500,
-        this->m_MattesAssociate->m_NumberOfHistogramBins * this->m_MattesAssociate->m_NumberOfHistogramBins / localNumberOfThreadsUsed),
-        this->GetCachedNumberOfLocalParameters(),
-        // Need address of the lock
-        &this->m_MattesAssociate->m_JointPDFDerivativesLock,
-        this->m_MattesAssociate->m_JointPDFDerivatives
-        );
+      if( ( this->m_MattesAssociate->m_ThreaderDerivativeManager.size() != localNumberOfThreadsUsed ) )
+        {
+        this->m_MattesAssociate->m_ThreaderDerivativeManager.resize(localNumberOfThreadsUsed);
+        }
+      for( ThreadIdType threadId = 0; threadId < localNumberOfThreadsUsed; ++threadId )
+        {
+        this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].Initialize(
+          // A heuristic that assumues memory for 2x size of
+          // m_JointPDFDerivati efficient and easy to make, so
+          // split it accross all the threads.  A work unit of at least 400 is needed
+          // when the thread size approaches the number of histograms so that the
+          // there is enough work to be done between thread lockings.
+          std::max<size_t>(500,
+          this->m_MattesAssociate->m_NumberOfHistogramBins * this->m_MattesAssociate->m_NumberOfHistogramBins / localNumberOfThreadsUsed),
+          this->GetCachedNumberOfLocalParameters(),
+          // Need address of the lock
+          &this->m_MattesAssociate->m_ThreaderJointPDFDerivativesLocks[threadId % numberOfBuffers],
+          buffers[threadId % numberOfBuffers]
+          );
+        }
       }
     }
 }
@@ -374,8 +403,12 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
           ( fixedImageParzenWindowIndex  * this->m_MattesAssociate->m_JointPDFDerivatives->GetOffsetTable()[2] )
           + ( pdfMovingIndex * this->m_MattesAssociate->m_JointPDFDerivatives->GetOffsetTable()[1] );
 
-        PDFValueType * derivativeContributionPtr =
-          this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].GetNextElementAndAddOffset(ThisIndexOffset);
+        // Accumulate in the buffer of the thread, or in the derivative
+        // buffer manager, which is reset to zero after each reduction.
+        const bool useDerivativeManager = !this->m_MattesAssociate->m_ThreaderDerivativeManager.empty();
+        PDFValueType * derivativeContributionPtr = useDerivativeManager
+          ? this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].GetNextElementAndAddOffset(ThisIndexOffset)
+          : this->m_MattesAssociate->m_ThreaderJointPDFDerivatives[threadId]->GetBufferPointer() + ThisIndexOffset;
         for( NumberOfParametersType mu = 0, maxElement = this->GetCachedNumberOfLocalParameters(); mu < maxElement;
              ++mu )
           {
@@ -385,10 +418,13 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
             innerProduct += jacobian[dim][mu] * movingImageGradient[dim];
             }
 
-          *(derivativeContributionPtr) = innerProduct * cubicBSplineDerivativeValue;
+          *(derivativeContributionPtr) += innerProduct * cubicBSplineDerivativeValue;
           ++derivativeContributionPtr;
           }
-        this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].CheckAndReduceIfNecessary();
+        if( useDerivativeManager )
+          {
+          this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].CheckAndReduceIfNecessary();
+          }
         }
       }
 
@@ -449,27 +485,39 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
 
   if( this->m_MattesAssociate->GetComputeDerivative() && ( !this->m_MattesAssociate->HasLocalSupport() ) )
     {
-    // This entire block of code is used to accumulate the per-thread buffers
-    // into 1 thread.
-    // For this thread, how many histogram elements are there?
+    // Sum the buffers in the first one and normalize, in parallel over
+    // the fixed image bins.
     const NumberOfParametersType rowSize = this->GetCachedNumberOfLocalParameters()
       * this->m_MattesAssociate->m_NumberOfHistogramBins;
-    const SizeValueType histogramTotalElementsSize = rowSize
-      * this->m_MattesAssociate->m_NumberOfHistogramBins;
 
     // NOTE:  Negative 1 so that accumulators can all be positive accumulators
     const PDFValueType nFactor = -1.0
       / ( this->m_MattesAssociate->m_MovingImageBinSize * this->m_MattesAssociate->GetNumberOfValidPoints() );
 
-    JointPDFDerivativesValueType *const accumulatorPdfDPtrStart =
-      this->m_MattesAssociate->m_JointPDFDerivatives->GetBufferPointer();
-    JointPDFDerivativesValueType *             accumulatorPdfDPtr = accumulatorPdfDPtrStart;
-    JointPDFDerivativesValueType const * const tempThreadPdfDPtrEnd = accumulatorPdfDPtrStart
-      + histogramTotalElementsSize;
-    while( accumulatorPdfDPtr < tempThreadPdfDPtrEnd )
-      {
-      *( accumulatorPdfDPtr++ ) *= nFactor;
-      }
+    const std::vector< typename JointPDFDerivativesType::Pointer > & buffers =
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivatives;
+    this->GetMultiThreader()->ParallelizeArray( 0, this->m_MattesAssociate->m_NumberOfHistogramBins,
+      [&buffers, rowSize, nFactor]( SizeValueType fixedIndex )
+        {
+        JointPDFDerivativesValueType * const accumulatorPdfDPtrStart =
+          buffers[0]->GetBufferPointer() + fixedIndex * rowSize;
+        JointPDFDerivativesValueType const * const accumulatorPdfDPtrEnd = accumulatorPdfDPtrStart + rowSize;
+        for( SizeValueType b = 1; b < buffers.size(); ++b )
+          {
+          JointPDFDerivativesValueType *       accumulatorPdfDPtr = accumulatorPdfDPtrStart;
+          JointPDFDerivativesValueType const * tempThreadPdfDPtr = buffers[b]->GetBufferPointer() + fixedIndex * rowSize;
+          while( accumulatorPdfDPtr < accumulatorPdfDPtrEnd )
+            {
+            *( accumulatorPdfDPtr++ ) += *( tempThreadPdfDPtr++ );
+            }
+          }
+        JointPDFDerivativesValueType * accumulatorPdfDPtr = accumulatorPdfDPtrStart;
+        while( accumulatorPdfDPtr < accumulatorPdfDPtrEnd )
+          {
+          *( accumulatorPdfDPtr++ ) *= nFactor;
+          }
+        },
+      nullptr );
     }
 
   // Collect and compute results.
@@ -21,6 +21,7 @@
 
 #include "itkObjectToObjectMetric.h"
 #include "itkArray.h"
+#include "itkMultiThreaderBase.h"
 #include <deque>
 
 namespace itk
@@ -210,6 +211,20 @@ private:
   MetricQueueType               m_MetricQueue;
   WeightsArrayType              m_MetricWeights;
   mutable MetricValueArrayType  m_MetricValueArray;
+
+  /** Used to combine the derivatives of the metrics in parallel, which
+   * matters for high-dimensional transforms such as displacement fields. */
+  MultiThreaderBase::Pointer    m_MultiThreader;
+
+  /** Smallest number of parameters per chunk of the derivatives combined in
+   * parallel. Fewer parameters, e.g. those of linear transforms, are
+   * combined serially, since a parallel dispatch costs more than the loop. */
+  static constexpr SizeValueType DerivativeCombinationGrainSize = 32768;
+
+  /** Call function(first, lastPlus1) on the ranges of the parameters, in
+   * parallel if there are enough parameters. */
+  template< typename TFunction >
+  void ParallelizeOverParameters( const TFunction & function ) const;
 };
 
 } //end namespace itk
@@ -33,6 +33,9 @@ ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TI
 
   //We want the moving transform to be nullptr by default
   this->m_MovingTransform = nullptr;
+
+  this->m_MultiThreader = MultiThreaderBase::New();
+  this->m_MultiThreader->SetArrayGrainSize( DerivativeCombinationGrainSize );
 }
 
 /** Destructor */
@@ -283,26 +286,51 @@ ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TI
       weightOverMagnitude = this->m_MetricWeights[j] / magnitude;
       }
     // derivative = \sum_j w_j * (dM_j / ||dM_j||)
-    for( NumberOfParametersType p = 0; p < this->GetNumberOfParameters(); p++ )
-      {
-      // roll our own loop to avoid temporary variable that could be large when using displacement fields.
-      derivativeResult[p] += ( metricDerivative[p] * weightOverMagnitude );
-      }
+    this->ParallelizeOverParameters(
+      [&derivativeResult, &metricDerivative, weightOverMagnitude]( SizeValueType first, SizeValueType lastPlus1 )
+        {
+        // roll our own loop to avoid temporary variable that could be large when using displacement fields.
+        for( NumberOfParametersType p = first; p < lastPlus1; p++ )
+          {
+          derivativeResult[p] += ( metricDerivative[p] * weightOverMagnitude );
+          }
+        } );
     }
 
   // Scale by totalMagnitude to prevent what amounts to implicit step estimation from magnitude scaling.
   // This keeps the behavior of this metric the same as a regular metric, with respect to derivative
   // magnitudes.
   totalMagnitude /= this->GetNumberOfMetrics();
-  for( NumberOfParametersType p = 0; p < this->GetNumberOfParameters(); p++ )
-    {
-    derivativeResult[p] *= totalMagnitude;
-    }
+  this->ParallelizeOverParameters(
+    [&derivativeResult, totalMagnitude]( SizeValueType first, SizeValueType lastPlus1 )
+      {
+      for( NumberOfParametersType p = first; p < lastPlus1; p++ )
+        {
+        derivativeResult[p] *= totalMagnitude;
+        }
+      } );
 
   firstValue = this->m_MetricValueArray[0];
   this->m_Value = firstValue;
 }
 
+template<unsigned int TFixedDimension, unsigned int TMovingDimension, typename TVirtualImage, typename TInternalComputationValueType>
+template<typename TFunction>
+void
+ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TInternalComputationValueType>
+::ParallelizeOverParameters( const TFunction & function ) const
+{
+  const SizeValueType numberOfParameters = this->GetNumberOfParameters();
+  if( numberOfParameters < 2 * DerivativeCombinationGrainSize )
+    {
+    function( 0, numberOfParameters );
+    }
+  else
+    {
+    this->m_MultiThreader->ParallelizeArrayRange( 0, numberOfParameters, function, nullptr );
+    }
+}
+
 template<unsigned int TFixedDimension, unsigned int TMovingDimension, typename TVirtualImage, typename TInternalComputationValueType>
 typename ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TInternalComputationValueType>::MetricValueArrayType
 ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TInternalComputationValueType>
@@ -0,0 +1,260 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkAffineTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+#include "itkTestingMacros.h"
+#include <atomic>
+
+/*
+ * Time GetValueAndDerivative of a metric whose threaders evaluate the
+ * interpolators once per batch of virtual points, against the same metric
+ * with interpolators that evaluate the points of a batch one by one, through
+ * EvaluateAtContinuousIndex. The values and derivatives must be the same.
+ * So must they be for a metric whose threader overrides ProcessVirtualPoint,
+ * which must then be called on every virtual point.
+ */
+
+namespace
+{
+
+/** Linear interpolator without the batch evaluation. */
+template< typename TInputImage >
+class PointwiseLinearInterpolateImageFunction:
+  public itk::LinearInterpolateImageFunction< TInputImage, double >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PointwiseLinearInterpolateImageFunction);
+
+  using Self = PointwiseLinearInterpolateImageFunction;
+  using Superclass = itk::LinearInterpolateImageFunction< TInputImage, double >;
+  using Pointer = itk::SmartPointer< Self >;
+  using ContinuousIndexType = typename Superclass::ContinuousIndexType;
+  using OutputType = typename Superclass::OutputType;
+
+  itkNewMacro( Self );
+
+  void EvaluateAtContinuousIndices(const ContinuousIndexType *indices,
+                                   OutputType *values,
+                                   itk::SizeValueType numberOfIndices) const override
+  {
+    for ( itk::SizeValueType i = 0; i < numberOfIndices; ++i )
+      {
+      values[i] = this->EvaluateAtContinuousIndex(indices[i]);
+      }
+  }
+
+protected:
+  PointwiseLinearInterpolateImageFunction() = default;
+  ~PointwiseLinearInterpolateImageFunction() override = default;
+};
+
+/** Mean squares metric whose dense threader overrides ProcessVirtualPoint,
+ * and counts the calls. */
+template< typename TImage >
+class PointwiseMeanSquaresImageToImageMetricv4:
+  public itk::MeanSquaresImageToImageMetricv4< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PointwiseMeanSquaresImageToImageMetricv4);
+
+  using Self = PointwiseMeanSquaresImageToImageMetricv4;
+  using Superclass = itk::MeanSquaresImageToImageMetricv4< TImage, TImage >;
+  using Pointer = itk::SmartPointer< Self >;
+
+  itkNewMacro( Self );
+
+  class ThreaderType: public Superclass::MeanSquaresDenseGetValueAndDerivativeThreaderType
+  {
+  public:
+    ITK_DISALLOW_COPY_AND_ASSIGN(ThreaderType);
+
+    using Self = ThreaderType;
+    using Superclass = typename PointwiseMeanSquaresImageToImageMetricv4::MeanSquaresDenseGetValueAndDerivativeThreaderType;
+    using Pointer = itk::SmartPointer< Self >;
+    using VirtualIndexType = typename Superclass::VirtualIndexType;
+    using VirtualPointType = typename Superclass::VirtualPointType;
+
+    itkNewMacro( Self );
+
+    std::atomic< itk::SizeValueType > m_NumberOfCalls;
+
+  protected:
+    ThreaderType(): m_NumberOfCalls( 0 ) {}
+
+    bool ProcessVirtualPoint( const VirtualIndexType & virtualIndex,
+                              const VirtualPointType & virtualPoint,
+                              const itk::ThreadIdType threadId ) override
+    {
+      ++m_NumberOfCalls;
+      return this->TransformEvaluateAndProcessVirtualPoints( &virtualIndex, &virtualPoint, 1, threadId ) > 0;
+    }
+  };
+
+  ThreaderType * GetThreader()
+  {
+    return static_cast< ThreaderType * >( this->m_DenseGetValueAndDerivativeThreader.GetPointer() );
+  }
+
+protected:
+  PointwiseMeanSquaresImageToImageMetricv4()
+  {
+    this->m_DenseGetValueAndDerivativeThreader = ThreaderType::New();
+  }
+  ~PointwiseMeanSquaresImageToImageMetricv4() override = default;
+};
+
+}
+
+int itkImageToImageMetricv4BatchEvaluationTimingTest(int argc, char *argv[] )
+{
+  if( argc < 3 )
+    {
+    std::cerr << "usage: " << argv[0] << ": image-size number-of-reps" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int imageSize = atoi( argv[1] );
+  const int numberOfReps = atoi( argv[2] );
+
+  constexpr unsigned int Dimension = 3;
+  using ImageType = itk::Image< float, Dimension >;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+  ImageType::RegionType region;
+  region.SetSize( size );
+
+  ImageType::Pointer fixedImage = ImageType::New();
+  fixedImage->SetRegions( region );
+  fixedImage->Allocate();
+
+  ImageType::Pointer movingImage = ImageType::New();
+  movingImage->SetRegions( region );
+  movingImage->Allocate();
+
+  /* Fill images with smooth patterns, shifted from each other. */
+  itk::ImageRegionIteratorWithIndex< ImageType > it( fixedImage, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    it.Set( static_cast< float >( std::sin( 0.2 * index[0] ) + std::cos( 0.15 * index[1] ) + 0.01 * index[2] ) );
+    movingImage->SetPixel( index,
+      static_cast< float >( std::sin( 0.2 * index[0] + 0.3 ) + std::cos( 0.15 * index[1] - 0.2 ) + 0.01 * index[2] ) );
+    }
+
+  using TransformType = itk::AffineTransform< double, Dimension >;
+  TransformType::Pointer movingTransform = TransformType::New();
+  TransformType::ParametersType parameters = movingTransform->GetParameters();
+  parameters[0] = 1.02;
+  parameters[1] = 0.03;
+  parameters[9] = 0.4;
+  parameters[10] = -0.7;
+  movingTransform->SetParameters( parameters );
+
+  using MetricType = itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >;
+  using BatchInterpolatorType = itk::LinearInterpolateImageFunction< ImageType, double >;
+  using PointwiseInterpolatorType = PointwiseLinearInterpolateImageFunction< ImageType >;
+
+  MetricType::Pointer batchMetric = MetricType::New();
+  batchMetric->SetFixedInterpolator( BatchInterpolatorType::New() );
+  batchMetric->SetMovingInterpolator( BatchInterpolatorType::New() );
+
+  MetricType::Pointer pointwiseMetric = MetricType::New();
+  pointwiseMetric->SetFixedInterpolator( PointwiseInterpolatorType::New() );
+  pointwiseMetric->SetMovingInterpolator( PointwiseInterpolatorType::New() );
+
+  using PointwiseMetricType = PointwiseMeanSquaresImageToImageMetricv4< ImageType >;
+  PointwiseMetricType::Pointer overridingMetric = PointwiseMetricType::New();
+  overridingMetric->SetFixedInterpolator( BatchInterpolatorType::New() );
+  overridingMetric->SetMovingInterpolator( BatchInterpolatorType::New() );
+
+  MetricType::Pointer metrics[3] = { batchMetric, pointwiseMetric, overridingMetric.GetPointer() };
+  for( auto & metric : metrics )
+    {
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    metric->SetMovingTransform( movingTransform );
+    TRY_EXPECT_NO_EXCEPTION( metric->Initialize() );
+    }
+
+  MetricType::MeasureType batchValue = 0.0;
+  MetricType::MeasureType pointwiseValue = 0.0;
+  MetricType::DerivativeType batchDerivative;
+  MetricType::DerivativeType pointwiseDerivative;
+
+  itk::TimeProbe batchTime;
+  itk::TimeProbe pointwiseTime;
+  for( int r = 0; r < numberOfReps; ++r )
+    {
+    batchTime.Start();
+    batchMetric->GetValueAndDerivative( batchValue, batchDerivative );
+    batchTime.Stop();
+
+    pointwiseTime.Start();
+    pointwiseMetric->GetValueAndDerivative( pointwiseValue, pointwiseDerivative );
+    pointwiseTime.Stop();
+    }
+
+  std::cout << "Batch evaluation:     " << batchTime.GetMean() << " " << batchTime.GetUnit() << std::endl;
+  std::cout << "Pointwise evaluation: " << pointwiseTime.GetMean() << " " << pointwiseTime.GetUnit() << std::endl;
+  std::cout << "Value: " << batchValue << " " << pointwiseValue << std::endl;
+
+  bool testPassed = true;
+  if( batchValue != pointwiseValue
+      || batchMetric->GetNumberOfValidPoints() != pointwiseMetric->GetNumberOfValidPoints() )
+    {
+    std::cerr << "Value mismatch: " << batchValue << " vs " << pointwiseValue << std::endl;
+    testPassed = false;
+    }
+  for( unsigned int p = 0; p < batchDerivative.GetSize(); ++p )
+    {
+    if( batchDerivative[p] != pointwiseDerivative[p] )
+      {
+      std::cerr << "Derivative mismatch at " << p << ": "
+                << batchDerivative[p] << " vs " << pointwiseDerivative[p] << std::endl;
+      testPassed = false;
+      }
+    }
+
+  MetricType::MeasureType overridingValue = 0.0;
+  MetricType::DerivativeType overridingDerivative;
+  overridingMetric->GetValueAndDerivative( overridingValue, overridingDerivative );
+  if( overridingMetric->GetThreader()->m_NumberOfCalls != fixedImage->GetBufferedRegion().GetNumberOfPixels() )
+    {
+    std::cerr << "ProcessVirtualPoint called " << overridingMetric->GetThreader()->m_NumberOfCalls
+              << " times instead of " << fixedImage->GetBufferedRegion().GetNumberOfPixels() << std::endl;
+    testPassed = false;
+    }
+  if( overridingValue != batchValue || overridingDerivative != batchDerivative )
+    {
+    std::cerr << "Mismatch of the metric overriding ProcessVirtualPoint: " << overridingValue << " vs "
+              << batchValue << std::endl;
+    testPassed = false;
+    }
+
+  if( !testPassed )
+    {
+    std::cerr << "Test failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkCorrelationImageToImageMetricv4.h"
+#include "itkMattesMutualInformationImageToImageMetricv4.h"
+#include "itkAffineTransform.h"
+#include "itkTranslationTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Evaluate metrics over a sampled point set, with and without the cache of
+ * the fixed side of the sampled points. The values and derivatives must be
+ * the same when the moving transform changes, and when the fixed transform
+ * is modified after the cache was built. Metrics sharing a fixed data cache
+ * must compute the fixed side once, and evaluate the same values.
+ */
+
+namespace
+{
+
+using ImageType = itk::Image< double, 2 >;
+using PointSetType = itk::PointSet< double, 2 >;
+
+ImageType::Pointer
+CreateImage( double centerX, double centerY )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size = { { 64, 64 } };
+  image->SetRegions( size );
+  ImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  image->SetSpacing( spacing );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    const double dx = point[0] - centerX;
+    const double dy = point[1] - centerY;
+    it.Set( 100.0 * std::exp( -( dx * dx + dy * dy ) / 300.0 ) + 0.1 * point[0] );
+    }
+  return image;
+}
+
+template< typename TMetric >
+bool
+TestMetric( const char * name, PointSetType * pointSet, itk::ThreadIdType numberOfThreads )
+{
+  std::cout << name << std::endl;
+
+  using TranslationType = itk::TranslationTransform< double, 2 >;
+  using AffineType = itk::AffineTransform< double, 2 >;
+
+  typename TMetric::Pointer metrics[2];
+  TranslationType::Pointer fixedTransforms[2];
+  AffineType::Pointer movingTransforms[2];
+  for( unsigned int m = 0; m < 2; ++m )
+    {
+    metrics[m] = TMetric::New();
+    fixedTransforms[m] = TranslationType::New();
+    fixedTransforms[m]->SetIdentity();
+    movingTransforms[m] = AffineType::New();
+    movingTransforms[m]->SetIdentity();
+    metrics[m]->SetFixedImage( CreateImage( 30.0, 45.0 ) );
+    metrics[m]->SetMovingImage( CreateImage( 33.0, 42.0 ) );
+    metrics[m]->SetFixedTransform( fixedTransforms[m] );
+    metrics[m]->SetMovingTransform( movingTransforms[m] );
+    metrics[m]->SetFixedSampledPointSet( pointSet );
+    metrics[m]->SetUseFixedSampledPointSet( true );
+    metrics[m]->SetUseFixedImageGradientFilter( false );
+    metrics[m]->SetUseMovingImageGradientFilter( false );
+    metrics[m]->SetMaximumNumberOfThreads( numberOfThreads );
+    }
+  metrics[1]->UseFixedSampledPointCacheOn();
+  TEST_SET_GET_VALUE( true, metrics[1]->GetUseFixedSampledPointCache() );
+  metrics[0]->Initialize();
+  metrics[1]->Initialize();
+
+  for( unsigned int iteration = 0; iteration < 4; ++iteration )
+    {
+    AffineType::ParametersType parameters = movingTransforms[0]->GetParameters();
+    parameters[0] = 1.0 + 0.01 * iteration;
+    parameters[3] = 1.0 - 0.02 * iteration;
+    parameters[4] = 0.5 * iteration;
+    parameters[5] = -0.3 * iteration;
+    if( iteration == 2 )
+      {
+      // Changing the fixed transform invalidates the cache.
+      TranslationType::ParametersType fixedParameters( 2 );
+      fixedParameters[0] = 1.5;
+      fixedParameters[1] = -2.0;
+      fixedTransforms[0]->SetParameters( fixedParameters );
+      fixedTransforms[1]->SetParameters( fixedParameters );
+      }
+
+    typename TMetric::MeasureType values[2];
+    typename TMetric::DerivativeType derivatives[2];
+    for( unsigned int m = 0; m < 2; ++m )
+      {
+      movingTransforms[m]->SetParameters( parameters );
+      if( iteration == 3 )
+        {
+        values[m] = metrics[m]->GetValue();
+        }
+      metrics[m]->GetValueAndDerivative( values[m], derivatives[m] );
+      }
+    std::cout << "  iteration " << iteration << ": " << metrics[1]->GetNumberOfValidPoints()
+              << " valid points, value " << values[1] << std::endl;
+    if( metrics[0]->GetNumberOfValidPoints() != metrics[1]->GetNumberOfValidPoints()
+        || std::abs( values[0] - values[1] ) > 1e-12 * std::abs( values[0] ) )
+      {
+      std::cerr << "Different values: " << values[0] << " without cache, " << values[1] << " with cache" << std::endl;
+      return false;
+      }
+    for( unsigned int p = 0; p < derivatives[0].Size(); ++p )
+      {
+      if( std::abs( derivatives[0][p] - derivatives[1][p] ) > 1e-12 * ( 1.0 + std::abs( derivatives[0][p] ) ) )
+        {
+        std::cerr << "Different derivatives: " << derivatives[0] << " without cache, "
+                  << derivatives[1] << " with cache" << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+
+bool
+TestSharedFixedDataCache( PointSetType * pointSet )
+{
+  std::cout << "Shared fixed data cache" << std::endl;
+
+  using MetricType = itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >;
+  using TranslationType = itk::TranslationTransform< double, 2 >;
+
+  MetricType::FixedDataCacheType::Pointer fixedDataCache = MetricType::FixedDataCacheType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( fixedDataCache, ImageToImageMetricv4FixedDataCache, Object );
+
+  // The third metric does not use the shared cache, as a reference.
+  ImageType::Pointer fixedImage = CreateImage( 30.0, 45.0 );
+  MetricType::Pointer metrics[3];
+  for( unsigned int m = 0; m < 3; ++m )
+    {
+    metrics[m] = MetricType::New();
+    TranslationType::Pointer movingTransform = TranslationType::New();
+    TranslationType::ParametersType parameters( 2 );
+    parameters[0] = 0.5;
+    parameters[1] = -1.0;
+    movingTransform->SetParameters( parameters );
+    metrics[m]->SetFixedImage( fixedImage );
+    metrics[m]->SetMovingImage( CreateImage( 33.0, 42.0 ) );
+    metrics[m]->SetMovingTransform( movingTransform );
+    metrics[m]->SetFixedSampledPointSet( pointSet );
+    metrics[m]->SetUseFixedSampledPointSet( true );
+    metrics[m]->SetGradientSource( MetricType::GRADIENT_SOURCE_BOTH );
+    metrics[m]->UseFixedSampledPointCacheOn();
+    if( m < 2 )
+      {
+      metrics[m]->SetFixedDataCache( fixedDataCache );
+      TEST_SET_GET_VALUE( fixedDataCache.GetPointer(), metrics[m]->GetModifiableFixedDataCache() );
+      }
+    metrics[m]->Initialize();
+    }
+
+  MetricType::MeasureType values[3];
+  MetricType::DerivativeType derivatives[3];
+  for( unsigned int m = 0; m < 3; ++m )
+    {
+    metrics[m]->GetValueAndDerivative( values[m], derivatives[m] );
+    }
+  std::cout << "  value " << values[0] << ", derivative " << derivatives[0] << std::endl;
+
+  TEST_SET_GET_VALUE( 1, fixedDataCache->GetNumberOfFixedImageGradientImages() );
+  TEST_SET_GET_VALUE( 1, fixedDataCache->GetNumberOfFixedSampledPointCaches() );
+  TEST_SET_GET_VALUE( 0, fixedDataCache->GetNumberOfSampledPointSets() );
+  TEST_EXPECT_TRUE( metrics[0]->GetModifiableFixedImageGradientImage() == metrics[1]->GetModifiableFixedImageGradientImage() );
+  TEST_EXPECT_TRUE( metrics[0]->GetModifiableFixedImageGradientImage() != metrics[2]->GetModifiableFixedImageGradientImage() );
+
+  for( unsigned int m = 0; m < 2; ++m )
+    {
+    if( values[m] != values[2] || derivatives[m] != derivatives[2] )
+      {
+      std::cerr << "Different values with the shared cache: " << values[m] << ", " << derivatives[m]
+                << " instead of " << values[2] << ", " << derivatives[2] << std::endl;
+      return false;
+      }
+    }
+
+  fixedDataCache->ReleaseData();
+  TEST_SET_GET_VALUE( 0, fixedDataCache->GetNumberOfFixedImageGradientImages() );
+  TEST_SET_GET_VALUE( 0, fixedDataCache->GetNumberOfFixedSampledPointCaches() );
+  return true;
+}
+}
+
+int itkImageToImageMetricv4FixedSampledPointCacheTest( int, char *[] )
+{
+  // Random points, some of them outside of the images, in a number which
+  // is not a multiple of the size of the batches of the threaders.
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+  PointSetType::Pointer pointSet = PointSetType::New();
+  for( unsigned int i = 0; i < 1001; ++i )
+    {
+    PointSetType::PointType point;
+    point[0] = generator->GetUniformVariate( -5.0, 68.0 );
+    point[1] = generator->GetUniformVariate( -5.0, 100.0 );
+    pointSet->SetPoint( i, point );
+    }
+
+  bool success = true;
+  for( itk::ThreadIdType numberOfThreads = 1; numberOfThreads <= 3; numberOfThreads += 2 )
+    {
+    std::cout << numberOfThreads << " threads" << std::endl;
+    success &= TestMetric< itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType > >(
+      "MeanSquares", pointSet, numberOfThreads );
+    success &= TestMetric< itk::CorrelationImageToImageMetricv4< ImageType, ImageType > >(
+      "Correlation", pointSet, numberOfThreads );
+    success &= TestMetric< itk::MattesMutualInformationImageToImageMetricv4< ImageType, ImageType > >(
+      "MattesMutualInformation", pointSet, numberOfThreads );
+    }
+  success &= TestSharedFixedDataCache( pointSet );
+
+  if( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMattesMutualInformationImageToImageMetricv4.h"
+#include "itkAffineTransform.h"
+#include "itkBSplineTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+/*
+ * Speed test of the Mattes mutual information derivative with an affine
+ * and a B-spline transform, for an increasing number of threads. The
+ * derivatives must not depend on the number of threads, nor on the
+ * number of buffers of joint PDF derivatives shared by the threads.
+ */
+
+namespace
+{
+
+using ImageType = itk::Image< double, 3 >;
+using MetricType = itk::MattesMutualInformationImageToImageMetricv4< ImageType, ImageType >;
+
+bool
+CompareDerivatives( const MetricType::DerivativeType & derivative, const MetricType::DerivativeType & reference )
+{
+  double maximum = 0.0;
+  double difference = 0.0;
+  for( itk::SizeValueType i = 0; i < reference.Size(); ++i )
+    {
+    maximum = std::max( maximum, std::abs( reference[i] ) );
+    difference = std::max( difference, std::abs( derivative[i] - reference[i] ) );
+    }
+  if( difference > 1e-9 * maximum )
+    {
+    std::cerr << "The derivative differs by " << difference << " from the reference, of magnitude "
+              << maximum << std::endl;
+    return false;
+    }
+  return true;
+}
+
+bool
+TestTransform( MetricType * metric, MetricType::MovingTransformType * transform,
+               itk::ThreadIdType maximumNumberOfThreads, int numberOfReps )
+{
+  std::cout << transform->GetNameOfClass() << ", " << transform->GetNumberOfParameters() << " parameters" << std::endl;
+  metric->SetMovingTransform( transform );
+  metric->SetMaximumJointPDFDerivativesBufferSize( 256 * 1024 * 1024 );
+  metric->Initialize();
+
+  MetricType::MeasureType    value;
+  MetricType::DerivativeType reference;
+  MetricType::DerivativeType derivative;
+  double                     singleThreadTime = 0.0;
+  for( itk::ThreadIdType numberOfThreads = 1; numberOfThreads <= maximumNumberOfThreads; numberOfThreads *= 2 )
+    {
+    metric->SetMaximumNumberOfThreads( numberOfThreads );
+    itk::TimeProbe timer;
+    for( int r = 0; r < numberOfReps; ++r )
+      {
+      timer.Start();
+      metric->GetValueAndDerivative( value, derivative );
+      timer.Stop();
+      }
+    if( numberOfThreads == 1 )
+      {
+      reference = derivative;
+      singleThreadTime = timer.GetMean();
+      }
+    else if( !CompareDerivatives( derivative, reference ) )
+      {
+      return false;
+      }
+    std::cout << "  " << metric->GetNumberOfThreadsUsed() << " threads: " << timer.GetMean()
+              << " s, speedup " << singleThreadTime / timer.GetMean() << std::endl;
+    }
+
+  // Two buffers shared by the threads.
+  const itk::SizeValueType bufferSize = sizeof( double ) * transform->GetNumberOfParameters()
+    * metric->GetNumberOfHistogramBins() * metric->GetNumberOfHistogramBins();
+  metric->SetMaximumJointPDFDerivativesBufferSize( 2 * bufferSize );
+  metric->SetMaximumNumberOfThreads( 4 );
+  metric->GetValueAndDerivative( value, derivative );
+  if( !CompareDerivatives( derivative, reference ) )
+    {
+    std::cerr << "Wrong derivative with shared buffers" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
+
+int itkMattesMutualInformationImageToImageMetricv4SpeedTest( int argc, char *argv[] )
+{
+  if( argc < 4 )
+    {
+    std::cerr << "usage: " << argv[0] << ": image-size number-of-reps maximum-number-of-threads" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int               imageSize = atoi( argv[1] );
+  const int               numberOfReps = atoi( argv[2] );
+  const itk::ThreadIdType maximumNumberOfThreads = atoi( argv[3] );
+
+  std::cout << "image size: " << imageSize << ", reps: " << numberOfReps
+            << ", maximum number of threads: " << maximumNumberOfThreads << std::endl;
+
+  ImageType::SizeType size;
+  size.Fill( imageSize );
+  ImageType::Pointer fixedImage = ImageType::New();
+  fixedImage->SetRegions( size );
+  fixedImage->Allocate();
+  ImageType::Pointer movingImage = ImageType::New();
+  movingImage->SetRegions( size );
+  movingImage->Allocate();
+
+  /* Fill the images with shifted blobs. */
+  itk::ImageRegionIteratorWithIndex< ImageType > itFixed( fixedImage, fixedImage->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > itMoving( movingImage, movingImage->GetBufferedRegion() );
+  const double center = 0.5 * imageSize;
+  const double sigma2 = 0.08 * imageSize * imageSize;
+  for( ; !itFixed.IsAtEnd(); ++itFixed, ++itMoving )
+    {
+    const ImageType::IndexType index = itFixed.GetIndex();
+    double                     fixedDistance2 = 0.0;
+    double                     movingDistance2 = 0.0;
+    for( unsigned int d = 0; d < 3; ++d )
+      {
+      fixedDistance2 += ( index[d] - center ) * ( index[d] - center );
+      movingDistance2 += ( index[d] - center - 1.5 ) * ( index[d] - center - 1.5 ) * ( d + 1 ) / 2.0;
+      }
+    itFixed.Set( 100.0 * std::exp( -fixedDistance2 / sigma2 ) + index[0] % 3 );
+    itMoving.Set( 80.0 * std::exp( -movingDistance2 / sigma2 ) + 0.5 * ( index[1] % 4 ) );
+    }
+
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( fixedImage );
+  metric->SetMovingImage( movingImage );
+  metric->SetNumberOfHistogramBins( 32 );
+
+  using AffineTransformType = itk::AffineTransform< double, 3 >;
+  AffineTransformType::Pointer affineTransform = AffineTransformType::New();
+  AffineTransformType::OutputVectorType translation;
+  translation.Fill( 0.7 );
+  affineTransform->SetTranslation( translation );
+
+  using BSplineTransformType = itk::BSplineTransform< double, 3, 3 >;
+  BSplineTransformType::Pointer bsplineTransform = BSplineTransformType::New();
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  for( unsigned int d = 0; d < 3; ++d )
+    {
+    dimensions[d] = imageSize - 1;
+    }
+  BSplineTransformType::MeshSizeType meshSize;
+  meshSize.Fill( 4 );
+  bsplineTransform->SetTransformDomainOrigin( fixedImage->GetOrigin() );
+  bsplineTransform->SetTransformDomainPhysicalDimensions( dimensions );
+  bsplineTransform->SetTransformDomainMeshSize( meshSize );
+  bsplineTransform->SetTransformDomainDirection( fixedImage->GetDirection() );
+  BSplineTransformType::ParametersType parameters( bsplineTransform->GetNumberOfParameters() );
+  for( itk::SizeValueType i = 0; i < parameters.Size(); ++i )
+    {
+    parameters[i] = 0.3 * std::sin( 0.7 * i );
+    }
+  bsplineTransform->SetParameters( parameters );
+
+  if( !TestTransform( metric, affineTransform, maximumNumberOfThreads, numberOfReps )
+      || !TestTransform( metric, bsplineTransform, maximumNumberOfThreads, numberOfReps ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
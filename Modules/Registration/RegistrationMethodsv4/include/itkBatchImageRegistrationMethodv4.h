@@ -0,0 +1,214 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBatchImageRegistrationMethodv4_h
+#define itkBatchImageRegistrationMethodv4_h
+
+#include "itkImageRegistrationMethodv4.h"
+#include <functional>
+#include <string>
+
+namespace itk
+{
+/** \class BatchImageRegistrationMethodv4
+ * \brief Register many moving images to one fixed image concurrently.
+ *
+ * Each moving image (subject) is registered to the fixed image by its own
+ * registration method, returned by the registration method creator. The
+ * creator sets up the metric, the optimizer, the transform and the levels,
+ * as for a single registration. The batch sets the fixed and moving images
+ * of all the image metrics of each registration method.
+ *
+ * The fixed side is shared by the registrations:
+ * - the smoothed fixed images of all the levels are computed once, with all
+ *   the threads, before the registrations start, and are then shared through
+ *   a SmoothedImageCache;
+ * - the fixed side data of the image metrics are computed by the first
+ *   registration needing them, and are then shared through an
+ *   ImageToImageMetricv4FixedDataCache: the gradient images of the smoothed
+ *   fixed images, the sample points of the metric sampling strategy, as long
+ *   as the registrations use the same random seed, and the fixed side of the
+ *   sample points (mapped point, pixel value and gradient);
+ * - the registrations only share the pixels of the images, each one using
+ *   its own image objects, so that they do not modify the pipeline
+ *   information of each other's inputs.
+ *
+ * The registrations are scheduled on the work-stealing thread pool, running
+ * up to NumberOfThreads of them at the same time. Each registration runs its
+ * metric and optimizer with NumberOfThreadsPerRegistration threads, by
+ * default one, since there is usually more parallelism across the subjects
+ * than within a registration. The nested parallel sections of the filters
+ * used by a registration do not deadlock the pool.
+ *
+ * An exception thrown by the registration of a subject does not stop the
+ * other registrations; it is reported in the result of the subject.
+ *
+ * \sa ImageRegistrationMethodv4
+ * \sa WorkStealingMultiThreader
+ *
+ * \ingroup ITKRegistrationMethodsv4
+ */
+template<typename TRegistrationMethod>
+class ITK_TEMPLATE_EXPORT BatchImageRegistrationMethodv4 : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(BatchImageRegistrationMethodv4);
+
+  /** Standard class type aliases. */
+  using Self = BatchImageRegistrationMethodv4;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( BatchImageRegistrationMethodv4, Object );
+
+  /** Registration method type alias. */
+  using RegistrationMethodType = TRegistrationMethod;
+  using RegistrationMethodPointer = typename RegistrationMethodType::Pointer;
+  using FixedImageType = typename RegistrationMethodType::FixedImageType;
+  using MovingImageType = typename RegistrationMethodType::MovingImageType;
+  using MovingImageConstPointer = typename MovingImageType::ConstPointer;
+  using OutputTransformType = typename RegistrationMethodType::OutputTransformType;
+  using OutputTransformPointer = typename OutputTransformType::Pointer;
+  using RealType = typename RegistrationMethodType::RealType;
+  using FixedSmoothedImageCacheType = typename RegistrationMethodType::FixedSmoothedImageCacheType;
+  using MetricFixedDataCacheType = typename RegistrationMethodType::MetricFixedDataCacheType;
+
+  /** Function returning the registration method of a subject, given its
+   * index. It is called from the thread calling Update(), once per subject.
+   * If it is not set, the registration methods are created with their
+   * default settings. */
+  using RegistrationMethodCreatorType = std::function<RegistrationMethodPointer( SizeValueType )>;
+
+  /** Result of the registration of a subject. */
+  struct RegistrationResultType
+    {
+    RegistrationResultType() : MetricValue( 0.0 ), ElapsedTime( 0.0 ), Succeeded( false ) {}
+
+    /** Transform resulting from the registration. */
+    OutputTransformPointer Transform;
+    /** Metric value at the end of the optimization of the last level. */
+    RealType               MetricValue;
+    /** Stop condition of the optimizer at the last level. */
+    std::string            StopConditionDescription;
+    /** Time spent in the registration of the subject, in seconds. */
+    double                 ElapsedTime;
+    /** False if the registration threw an exception. */
+    bool                   Succeeded;
+    /** Description of the exception thrown by the registration. */
+    std::string            ErrorDescription;
+    };
+
+  /** Set/Get the fixed image, shared by all the subjects. */
+  itkSetConstObjectMacro( FixedImage, FixedImageType );
+  itkGetConstObjectMacro( FixedImage, FixedImageType );
+
+  /** Add the moving image of a subject. */
+  void AddMovingImage( const MovingImageType * image );
+
+  /** Get the moving image of a subject. */
+  const MovingImageType * GetMovingImage( SizeValueType subject ) const;
+
+  /** Number of subjects. */
+  SizeValueType GetNumberOfMovingImages() const;
+
+  /** Remove the moving images of all the subjects. */
+  void RemoveAllMovingImages();
+
+  /** Set the function creating the registration method of a subject. */
+  void SetRegistrationMethodCreator( const RegistrationMethodCreatorType & creator );
+
+  /** Set/Get the maximum number of registrations running at the same time.
+   * Default is the global default number of threads. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Set/Get the number of threads of the metric and of the optimizer of
+   * each registration. Default is 1. */
+  itkSetClampMacro( NumberOfThreadsPerRegistration, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreadsPerRegistration, ThreadIdType );
+
+  /** Get the cache of the smoothed fixed images. It is kept from one update
+   * to the next one, as long as the fixed image is not changed. */
+  itkGetModifiableObjectMacro( FixedSmoothedImageCache, FixedSmoothedImageCacheType );
+
+  /** Get the cache of the fixed side data of the image metrics. It is kept
+   * from one update to the next one, as long as the fixed image is not
+   * changed. */
+  itkGetModifiableObjectMacro( MetricFixedDataCache, MetricFixedDataCacheType );
+
+  /** Register all the subjects. Throws an exception if the inputs are
+   * missing or if a registration method cannot be set up, but not if the
+   * registration of a subject fails. */
+  void Update();
+
+  /** Result of the registration of a subject, available after Update(). */
+  const RegistrationResultType & GetRegistrationResult( SizeValueType subject ) const;
+
+  /** Number of subjects whose registration failed. */
+  SizeValueType GetNumberOfFailedRegistrations() const;
+
+  /** Wall clock time of the last Update(), in seconds, including the time
+   * spent computing the shared fixed images. */
+  itkGetConstMacro( ElapsedTime, double );
+
+  /** Wall clock time spent setting up the registration methods and
+   * computing the shared fixed images, before the registrations run. */
+  itkGetConstMacro( FixedImagePrecomputationTime, double );
+
+  /** Number of subjects registered per second by the last Update(). */
+  double GetThroughput() const;
+
+protected:
+  BatchImageRegistrationMethodv4();
+  ~BatchImageRegistrationMethodv4() override = default;
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Set the inputs, the shared caches and the threads of the registration
+   * method of a subject, and compute the smoothed fixed images it needs. */
+  virtual void InitializeRegistrationMethod( SizeValueType subject, RegistrationMethodType * registration );
+
+  /** Run the registration of a subject and fill its result. */
+  virtual void RegisterSubject( SizeValueType subject, RegistrationMethodType * registration );
+
+private:
+  typename FixedImageType::ConstPointer          m_FixedImage;
+  std::vector<MovingImageConstPointer>           m_MovingImages;
+  RegistrationMethodCreatorType                  m_RegistrationMethodCreator;
+  ThreadIdType                                   m_NumberOfThreads;
+  ThreadIdType                                   m_NumberOfThreadsPerRegistration;
+
+  typename FixedSmoothedImageCacheType::Pointer  m_FixedSmoothedImageCache;
+  typename MetricFixedDataCacheType::Pointer     m_MetricFixedDataCache;
+  const FixedImageType *                         m_CachedFixedImage;
+
+  std::vector<RegistrationResultType>            m_RegistrationResults;
+  double                                         m_ElapsedTime;
+  double                                         m_FixedImagePrecomputationTime;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBatchImageRegistrationMethodv4.hxx"
+#endif
+
+#endif
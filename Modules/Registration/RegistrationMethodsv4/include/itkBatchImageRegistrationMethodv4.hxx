@@ -0,0 +1,311 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBatchImageRegistrationMethodv4_hxx
+#define itkBatchImageRegistrationMethodv4_hxx
+
+#include "itkBatchImageRegistrationMethodv4.h"
+#include "itkTimeProbe.h"
+#include "itkWorkStealingMultiThreader.h"
+
+namespace itk
+{
+
+template<typename TRegistrationMethod>
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::BatchImageRegistrationMethodv4() :
+  m_NumberOfThreads( MultiThreaderBase::GetGlobalDefaultNumberOfThreads() ),
+  m_NumberOfThreadsPerRegistration( 1 ),
+  m_FixedSmoothedImageCache( FixedSmoothedImageCacheType::New() ),
+  m_MetricFixedDataCache( MetricFixedDataCacheType::New() ),
+  m_CachedFixedImage( nullptr ),
+  m_ElapsedTime( 0.0 ),
+  m_FixedImagePrecomputationTime( 0.0 )
+{
+}
+
+template<typename TRegistrationMethod>
+void
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::AddMovingImage( const MovingImageType * image )
+{
+  if( image == nullptr )
+    {
+    itkExceptionMacro( "The moving image is null." );
+    }
+  this->m_MovingImages.push_back( image );
+  this->Modified();
+}
+
+template<typename TRegistrationMethod>
+const typename BatchImageRegistrationMethodv4<TRegistrationMethod>::MovingImageType *
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::GetMovingImage( SizeValueType subject ) const
+{
+  if( subject >= this->m_MovingImages.size() )
+    {
+    itkExceptionMacro( "There is no moving image " << subject << "." );
+    }
+  return this->m_MovingImages[subject];
+}
+
+template<typename TRegistrationMethod>
+SizeValueType
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::GetNumberOfMovingImages() const
+{
+  return this->m_MovingImages.size();
+}
+
+template<typename TRegistrationMethod>
+void
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::RemoveAllMovingImages()
+{
+  this->m_MovingImages.clear();
+  this->m_RegistrationResults.clear();
+  this->Modified();
+}
+
+template<typename TRegistrationMethod>
+void
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::SetRegistrationMethodCreator( const RegistrationMethodCreatorType & creator )
+{
+  this->m_RegistrationMethodCreator = creator;
+  this->Modified();
+}
+
+template<typename TRegistrationMethod>
+void
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::Update()
+{
+  if( this->m_FixedImage.IsNull() )
+    {
+    itkExceptionMacro( "The fixed image is not present." );
+    }
+
+  TimeProbe updateTimeProbe;
+  updateTimeProbe.Start();
+
+  if( this->m_CachedFixedImage != this->m_FixedImage.GetPointer() )
+    {
+    this->m_FixedSmoothedImageCache->ReleaseImages();
+    this->m_MetricFixedDataCache->ReleaseData();
+    this->m_CachedFixedImage = this->m_FixedImage.GetPointer();
+    }
+
+  // Create and set up the registration methods, and smooth the fixed image
+  // for all their levels, before the registrations run concurrently.
+
+  const SizeValueType numberOfSubjects = this->m_MovingImages.size();
+  std::vector<RegistrationMethodPointer> registrations( numberOfSubjects );
+  this->m_RegistrationResults.assign( numberOfSubjects, RegistrationResultType() );
+
+  TimeProbe precomputationTimeProbe;
+  precomputationTimeProbe.Start();
+  for( SizeValueType subject = 0; subject < numberOfSubjects; subject++ )
+    {
+    if( this->m_RegistrationMethodCreator )
+      {
+      registrations[subject] = this->m_RegistrationMethodCreator( subject );
+      }
+    else
+      {
+      registrations[subject] = RegistrationMethodType::New();
+      }
+    if( registrations[subject].IsNull() )
+      {
+      itkExceptionMacro( "No registration method was created for subject " << subject << "." );
+      }
+    this->InitializeRegistrationMethod( subject, registrations[subject] );
+    }
+  precomputationTimeProbe.Stop();
+  this->m_FixedImagePrecomputationTime = precomputationTimeProbe.GetTotal();
+
+  // Each registration is a task of the work-stealing pool. A thread waiting
+  // for the filters of a registration executes other pending tasks.
+
+  WorkStealingMultiThreader::Pointer threader = WorkStealingMultiThreader::New();
+  threader->SetNumberOfThreads( this->m_NumberOfThreads );
+  threader->SetArrayGrainSize( 1 );
+  threader->ParallelizeArray( 0, numberOfSubjects,
+    [this, &registrations]( SizeValueType subject )
+      {
+      this->RegisterSubject( subject, registrations[subject] );
+      // Release the images of the registration as soon as it is done
+      registrations[subject] = nullptr;
+      },
+    nullptr );
+
+  updateTimeProbe.Stop();
+  this->m_ElapsedTime = updateTimeProbe.GetTotal();
+}
+
+template<typename TRegistrationMethod>
+void
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::InitializeRegistrationMethod( SizeValueType subject, RegistrationMethodType * registration )
+{
+  using MetricType = typename RegistrationMethodType::MetricType;
+  using MultiMetricType = typename RegistrationMethodType::MultiMetricType;
+  using ImageMetricType = typename RegistrationMethodType::ImageMetricType;
+
+  // Find the image metrics
+  std::vector<ImageMetricType *> imageMetrics;
+  MetricType * metric = registration->GetModifiableMetric();
+  if( metric != nullptr && metric->GetMetricCategory() == MetricType::MULTI_METRIC )
+    {
+    auto * multiMetric = dynamic_cast<MultiMetricType *>( metric );
+    for( SizeValueType n = 0; multiMetric != nullptr && n < multiMetric->GetNumberOfMetrics(); n++ )
+      {
+      imageMetrics.push_back( dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() ) );
+      }
+    }
+  else
+    {
+    imageMetrics.push_back( dynamic_cast<ImageMetricType *>( metric ) );
+    }
+  for( auto * imageMetric : imageMetrics )
+    {
+    if( imageMetric == nullptr )
+      {
+      itkExceptionMacro( "The registration method of subject " << subject << " has a metric which is not an image metric." );
+      }
+    imageMetric->SetMaximumNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+    }
+
+  // Each registration gets its own image objects, grafted from the shared images.
+  typename FixedImageType::Pointer fixedImage = FixedImageType::New();
+  fixedImage->Graft( this->m_FixedImage );
+  typename MovingImageType::Pointer movingImage = MovingImageType::New();
+  movingImage->Graft( this->m_MovingImages[subject] );
+  for( SizeValueType n = 0; n < imageMetrics.size(); n++ )
+    {
+    registration->SetFixedImage( n, fixedImage );
+    registration->SetMovingImage( n, movingImage );
+    }
+
+  registration->SetFixedSmoothedImageCache( this->m_FixedSmoothedImageCache );
+  registration->SetMetricFixedDataCache( this->m_MetricFixedDataCache );
+  registration->SetUseAsynchronousSmoothing( false );
+  registration->SetNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+  if( registration->GetModifiableOptimizer() != nullptr )
+    {
+    registration->GetModifiableOptimizer()->SetNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+    }
+
+  for( SizeValueType level = 0; level < registration->GetNumberOfLevels(); level++ )
+    {
+    const RealType sigma = registration->GetSmoothingSigmasPerLevel()[level];
+    const bool sigmaIsSpecifiedInPhysicalUnits = registration->GetSmoothingSigmasAreSpecifiedInPhysicalUnits();
+    this->m_FixedSmoothedImageCache->GetSmoothedImage( this->m_FixedImage, sigma, sigmaIsSpecifiedInPhysicalUnits );
+    }
+}
+
+template<typename TRegistrationMethod>
+void
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::RegisterSubject( SizeValueType subject, RegistrationMethodType * registration )
+{
+  RegistrationResultType & result = this->m_RegistrationResults[subject];
+
+  TimeProbe timeProbe;
+  timeProbe.Start();
+  try
+    {
+    registration->Update();
+    result.Transform = registration->GetModifiableTransform();
+    result.MetricValue = static_cast<RealType>( registration->GetModifiableOptimizer()->GetValue() );
+    result.StopConditionDescription = registration->GetModifiableOptimizer()->GetStopConditionDescription();
+    result.Succeeded = true;
+    }
+  catch( ExceptionObject & e )
+    {
+    result.ErrorDescription = e.GetDescription();
+    }
+  catch( std::exception & e )
+    {
+    result.ErrorDescription = e.what();
+    }
+  timeProbe.Stop();
+  result.ElapsedTime = timeProbe.GetTotal();
+}
+
+template<typename TRegistrationMethod>
+const typename BatchImageRegistrationMethodv4<TRegistrationMethod>::RegistrationResultType &
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::GetRegistrationResult( SizeValueType subject ) const
+{
+  if( subject >= this->m_RegistrationResults.size() )
+    {
+    itkExceptionMacro( "There is no result for subject " << subject << "." );
+    }
+  return this->m_RegistrationResults[subject];
+}
+
+template<typename TRegistrationMethod>
+SizeValueType
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::GetNumberOfFailedRegistrations() const
+{
+  SizeValueType numberOfFailedRegistrations = 0;
+  for( const auto & result : this->m_RegistrationResults )
+    {
+    if( !result.Succeeded )
+      {
+      numberOfFailedRegistrations++;
+      }
+    }
+  return numberOfFailedRegistrations;
+}
+
+template<typename TRegistrationMethod>
+double
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::GetThroughput() const
+{
+  if( this->m_ElapsedTime <= 0.0 )
+    {
+    return 0.0;
+    }
+  return this->m_RegistrationResults.size() / this->m_ElapsedTime;
+}
+
+template<typename TRegistrationMethod>
+void
+BatchImageRegistrationMethodv4<TRegistrationMethod>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  itkPrintSelfObjectMacro( FixedImage );
+  os << indent << "NumberOfMovingImages: " << this->m_MovingImages.size() << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfThreadsPerRegistration: " << this->m_NumberOfThreadsPerRegistration << std::endl;
+  itkPrintSelfObjectMacro( FixedSmoothedImageCache );
+  itkPrintSelfObjectMacro( MetricFixedDataCache );
+  os << indent << "NumberOfFailedRegistrations: " << this->GetNumberOfFailedRegistrations() << std::endl;
+  os << indent << "ElapsedTime: " << this->m_ElapsedTime << std::endl;
+  os << indent << "FixedImagePrecomputationTime: " << this->m_FixedImagePrecomputationTime << std::endl;
+  os << indent << "Throughput: " << this->GetThroughput() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
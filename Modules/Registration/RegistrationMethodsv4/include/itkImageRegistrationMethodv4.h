@@ -28,9 +28,11 @@
 #include "itkImageToImageMetricv4.h"
 #include "itkPointSetToPointSetMetricv4.h"
 #include "itkShrinkImageFilter.h"
+#include "itkSmoothedImageCache.h"
 #include "itkIdentityTransform.h"
 #include "itkTransformParametersAdaptorBase.h"
 
+#include <future>
 #include <vector>
 
 namespace itk
@@ -263,6 +265,42 @@ public:
   itkSetMacro( MetricSamplingStrategy, MetricSamplingStrategyType );
   itkGetConstMacro( MetricSamplingStrategy, MetricSamplingStrategyType );
 
+  /** Set/Get whether the image metrics cache the fixed side of the sample
+   * points set by the metric sampling strategy, see
+   * ImageToImageMetricv4::SetUseFixedSampledPointCache. The sample points
+   * are only transformed and evaluated in the fixed space once per level.
+   * Default is true. Methods which modify the fixed transform at each
+   * iteration turn it off. */
+  itkSetMacro( UseFixedSampledPointCache, bool );
+  itkGetConstMacro( UseFixedSampledPointCache, bool );
+  itkBooleanMacro( UseFixedSampledPointCache );
+
+  /** Set/Get whether the smoothed fixed and moving images of the next level
+   * are computed in a separate thread while the current level is optimized.
+   * The separate thread smooths images grafted from the input images, which
+   * must not be modified during the registration. The registration result
+   * does not depend on it. Default is false. */
+  itkSetMacro( UseAsynchronousSmoothing, bool );
+  itkGetConstMacro( UseAsynchronousSmoothing, bool );
+  itkBooleanMacro( UseAsynchronousSmoothing );
+
+  /** Set/Get a cache of the smoothed fixed images, which can be shared by
+   * several registrations of the same fixed image. Default is null: the
+   * fixed images are smoothed by each registration. */
+  using FixedSmoothedImageCacheType = SmoothedImageCache<FixedImageType>;
+  itkSetObjectMacro( FixedSmoothedImageCache, FixedSmoothedImageCacheType );
+  itkGetModifiableObjectMacro( FixedSmoothedImageCache, FixedSmoothedImageCacheType );
+
+  /** Set/Get a cache of the fixed side data of the image metrics, which can
+   * be shared by several registrations of the same fixed image, see
+   * ImageToImageMetricv4FixedDataCache. The sample points are taken from the
+   * cache when they are sampled with the same settings and random seed, i.e.
+   * unless the iterator is reseeded. Default is null: the fixed side data
+   * are computed by each registration. */
+  using MetricFixedDataCacheType = typename ImageMetricType::FixedDataCacheType;
+  itkSetObjectMacro( MetricFixedDataCache, MetricFixedDataCacheType );
+  itkGetModifiableObjectMacro( MetricFixedDataCache, MetricFixedDataCacheType );
+
   /** Reinitialize the seed for the random number generators that
    * select the samples for some metric sampling strategies.
    *
@@ -458,6 +496,25 @@ protected:
   /** Get metric samples. */
   virtual void SetMetricSamplePoints();
 
+  /** Input images of the metrics at one level, null for the point set
+   * metrics, and the smoothed images computed from them. */
+  struct SmoothImagesType
+    {
+    std::vector<typename FixedImageType::ConstPointer>  FixedInputs;
+    std::vector<typename MovingImageType::ConstPointer> MovingInputs;
+    RealType                                            SmoothingSigma;
+    bool                                                SmoothingSigmaIsSpecifiedInPhysicalUnits;
+    typename FixedSmoothedImageCacheType::Pointer       FixedSmoothedImageCache;
+    FixedImagesContainerType                            FixedImages;
+    MovingImagesContainerType                           MovingImages;
+    };
+
+  /** Smooth the input images of \c smoothImages. An input image shared by
+   * several metrics is smoothed once, and its smoothed image is shared by
+   * these metrics. Only its argument is used, so that the images of the next
+   * level can be smoothed in a separate thread. */
+  static void SmoothImages( SmoothImagesType & smoothImages );
+
   SizeValueType                                                   m_CurrentLevel;
   SizeValueType                                                   m_NumberOfLevels;
   SizeValueType                                                   m_CurrentIteration;
@@ -482,6 +539,10 @@ protected:
   MetricPointer                                                   m_Metric;
   MetricSamplingStrategyType                                      m_MetricSamplingStrategy;
   MetricSamplingPercentageArrayType                               m_MetricSamplingPercentagePerLevel;
+  bool                                                            m_UseFixedSampledPointCache;
+  bool                                                            m_UseAsynchronousSmoothing;
+  typename FixedSmoothedImageCacheType::Pointer                   m_FixedSmoothedImageCache;
+  typename MetricFixedDataCacheType::Pointer                      m_MetricFixedDataCache;
   SizeValueType                                                   m_NumberOfMetrics;
   int                                                             m_FirstImageMetricIndex;
   std::vector<ShrinkFactorsPerDimensionContainerType>             m_ShrinkFactorsPerLevel;
@@ -503,6 +564,9 @@ protected:
 
 
 private:
+  // Smoothed images of the next level, computed while the current level is optimized
+  std::future<SmoothImagesType>                                   m_NextLevelSmoothImages;
+
   bool                                                            m_InPlace;
 
   bool                                                            m_InitializeCenterOfLinearOutputTransform;
@@ -128,6 +128,8 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   this->m_MetricSamplingStrategy = NONE;
   this->m_MetricSamplingPercentagePerLevel.SetSize( this->m_NumberOfLevels );
   this->m_MetricSamplingPercentagePerLevel.Fill( 1.0 );
+  this->m_UseFixedSampledPointCache = true;
+  this->m_UseAsynchronousSmoothing = false;
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
@@ -582,6 +584,52 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   // Although this isn't necessary, we want to leave the option for
   // changing the point sets per level.
 
+  // The smoothed images of this level may have been computed while the
+  // previous level was optimized.
+
+  SmoothImagesType smoothImages;
+  smoothImages.FixedInputs.resize( this->m_NumberOfMetrics );
+  smoothImages.MovingInputs.resize( this->m_NumberOfMetrics );
+  for( SizeValueType n = 0; n < this->m_NumberOfMetrics; n++ )
+    {
+    if( this->m_Metric->GetMetricCategory() == MetricType::IMAGE_METRIC ||
+        ( this->m_Metric->GetMetricCategory() == MetricType::MULTI_METRIC &&
+          multiMetric->GetMetricQueue()[n]->GetMetricCategory() == MetricType::IMAGE_METRIC ) )
+      {
+      smoothImages.FixedInputs[n] = this->GetFixedImage( n );
+      smoothImages.MovingInputs[n] = this->GetMovingImage( n );
+      }
+    }
+  smoothImages.SmoothingSigma = this->m_SmoothingSigmasPerLevel[level];
+  smoothImages.SmoothingSigmaIsSpecifiedInPhysicalUnits = this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits;
+  smoothImages.FixedSmoothedImageCache = this->m_FixedSmoothedImageCache;
+
+  if( this->m_NextLevelSmoothImages.valid() )
+    {
+    if( level == 0 )
+      {
+      // Left over by a previous update which did not complete
+      this->m_NextLevelSmoothImages.wait();
+      this->m_NextLevelSmoothImages = std::future<SmoothImagesType>();
+      }
+    else
+      {
+      const SmoothImagesType nextLevelSmoothImages = this->m_NextLevelSmoothImages.get();
+      if( nextLevelSmoothImages.FixedInputs == smoothImages.FixedInputs &&
+          nextLevelSmoothImages.MovingInputs == smoothImages.MovingInputs &&
+          Math::ExactlyEquals( nextLevelSmoothImages.SmoothingSigma, smoothImages.SmoothingSigma ) &&
+          nextLevelSmoothImages.SmoothingSigmaIsSpecifiedInPhysicalUnits == smoothImages.SmoothingSigmaIsSpecifiedInPhysicalUnits &&
+          nextLevelSmoothImages.FixedSmoothedImageCache == smoothImages.FixedSmoothedImageCache )
+        {
+        smoothImages = nextLevelSmoothImages;
+        }
+      }
+    }
+  if( smoothImages.FixedImages.empty() )
+    {
+    Self::SmoothImages( smoothImages );
+    }
+
   this->m_FixedSmoothImages.clear();
   this->m_FixedSmoothImages.resize( this->m_NumberOfMetrics );
   this->m_MovingSmoothImages.clear();
@@ -602,41 +650,8 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
         ( this->m_Metric->GetMetricCategory() == MetricType::MULTI_METRIC &&
           multiMetric->GetMetricQueue()[n]->GetMetricCategory() == MetricType::IMAGE_METRIC ) )
       {
-      using FixedImageSmoothingFilterType = DiscreteGaussianImageFilter<FixedImageType, FixedImageType>;
-      typename FixedImageSmoothingFilterType::Pointer fixedImageSmoothingFilter = FixedImageSmoothingFilterType::New();
-      if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
-        {
-        fixedImageSmoothingFilter->SetUseImageSpacingOn();
-        }
-      else
-        {
-        fixedImageSmoothingFilter->SetUseImageSpacingOff();
-        }
-      fixedImageSmoothingFilter->SetVariance( itk::Math::sqr( this->m_SmoothingSigmasPerLevel[level] ) );
-      fixedImageSmoothingFilter->SetMaximumError( 0.01 );
-      fixedImageSmoothingFilter->SetInput( this->GetFixedImage( n ) );
-
-      this->m_FixedSmoothImages[n] = fixedImageSmoothingFilter->GetOutput();
-      this->m_FixedSmoothImages[n]->Update();
-      this->m_FixedSmoothImages[n]->DisconnectPipeline();
-
-      using MovingImageSmoothingFilterType = DiscreteGaussianImageFilter<MovingImageType, MovingImageType>;
-      typename MovingImageSmoothingFilterType::Pointer movingImageSmoothingFilter = MovingImageSmoothingFilterType::New();
-      if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
-        {
-        movingImageSmoothingFilter->SetUseImageSpacingOn();
-        }
-      else
-        {
-        movingImageSmoothingFilter->SetUseImageSpacingOff();
-        }
-      movingImageSmoothingFilter->SetVariance( itk::Math::sqr( this->m_SmoothingSigmasPerLevel[level] ) );
-      movingImageSmoothingFilter->SetMaximumError( 0.01 );
-      movingImageSmoothingFilter->SetInput( this->GetMovingImage( n ) );
-
-      this->m_MovingSmoothImages[n] = movingImageSmoothingFilter->GetOutput();
-      this->m_MovingSmoothImages[n]->Update();
-      this->m_MovingSmoothImages[n]->DisconnectPipeline();
+      this->m_FixedSmoothImages[n] = smoothImages.FixedImages[n];
+      this->m_MovingSmoothImages[n] = smoothImages.MovingImages[n];
 
       // Update the image metric
 
@@ -647,6 +662,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
         dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetFixedImageMask( this->m_FixedImageMasks[n] );
         dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetMovingImageMask( this->m_MovingImageMasks[n] );
+        dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetFixedDataCache( this->m_MetricFixedDataCache );
         }
       else if( this->m_Metric->GetMetricCategory() == MetricType::IMAGE_METRIC )
         {
@@ -655,6 +671,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
         dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetFixedImageMask( this->m_FixedImageMasks[n] );
         dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetMovingImageMask( this->m_MovingImageMasks[n] );
+        dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetFixedDataCache( this->m_MetricFixedDataCache );
         }
       else
         {
@@ -708,8 +725,126 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     scales.Fill( NumericTraits<typename ScalesType::ValueType>::OneValue() );
     this->m_Optimizer->SetScales( scales );
     }
+
+  // Smooth the images of the next level while this level is optimized
+
+  if( this->m_UseAsynchronousSmoothing && level + 1 < this->m_NumberOfLevels )
+    {
+    SmoothImagesType nextLevelSmoothImages = smoothImages;
+    nextLevelSmoothImages.SmoothingSigma = this->m_SmoothingSigmasPerLevel[level + 1];
+    if( Math::ExactlyEquals( nextLevelSmoothImages.SmoothingSigma, smoothImages.SmoothingSigma ) )
+      {
+      // The images of this level are reused.
+      this->m_NextLevelSmoothImages = std::async( std::launch::deferred,
+        [nextLevelSmoothImages]() { return nextLevelSmoothImages; } );
+      }
+    else
+      {
+      nextLevelSmoothImages.FixedImages.clear();
+      nextLevelSmoothImages.MovingImages.clear();
+
+      // The input images may be the outputs of pipelines, which must not be
+      // updated by another thread: smooth images grafted from them instead.
+      const std::vector<typename FixedImageType::ConstPointer> fixedInputs = nextLevelSmoothImages.FixedInputs;
+      const std::vector<typename MovingImageType::ConstPointer> movingInputs = nextLevelSmoothImages.MovingInputs;
+      for( SizeValueType n = 0; n < this->m_NumberOfMetrics; n++ )
+        {
+        if( fixedInputs[n].IsNull() )
+          {
+          continue;
+          }
+        nextLevelSmoothImages.FixedInputs[n] = nullptr;
+        nextLevelSmoothImages.MovingInputs[n] = nullptr;
+        for( SizeValueType m = 0; m < n; m++ )
+          {
+          if( fixedInputs[m] == fixedInputs[n] )
+            {
+            nextLevelSmoothImages.FixedInputs[n] = nextLevelSmoothImages.FixedInputs[m];
+            }
+          if( movingInputs[m] == movingInputs[n] )
+            {
+            nextLevelSmoothImages.MovingInputs[n] = nextLevelSmoothImages.MovingInputs[m];
+            }
+          }
+        if( nextLevelSmoothImages.FixedInputs[n].IsNull() )
+          {
+          typename FixedImageType::Pointer fixedInput = FixedImageType::New();
+          fixedInput->Graft( fixedInputs[n] );
+          nextLevelSmoothImages.FixedInputs[n] = fixedInput;
+          }
+        if( nextLevelSmoothImages.MovingInputs[n].IsNull() )
+          {
+          typename MovingImageType::Pointer movingInput = MovingImageType::New();
+          movingInput->Graft( movingInputs[n] );
+          nextLevelSmoothImages.MovingInputs[n] = movingInput;
+          }
+        }
+
+      this->m_NextLevelSmoothImages = std::async( std::launch::async,
+        [nextLevelSmoothImages, fixedInputs, movingInputs]() mutable
+          {
+          Self::SmoothImages( nextLevelSmoothImages );
+          nextLevelSmoothImages.FixedInputs = fixedInputs;
+          nextLevelSmoothImages.MovingInputs = movingInputs;
+          return nextLevelSmoothImages;
+          } );
+      }
+    }
 }
 
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::SmoothImages( SmoothImagesType & smoothImages )
+{
+  const SizeValueType numberOfMetrics = smoothImages.FixedInputs.size();
+  smoothImages.FixedImages.assign( numberOfMetrics, nullptr );
+  smoothImages.MovingImages.assign( numberOfMetrics, nullptr );
+
+  for( SizeValueType n = 0; n < numberOfMetrics; n++ )
+    {
+    if( smoothImages.FixedInputs[n].IsNull() )
+      {
+      continue;
+      }
+
+    // Look for a previous metric with the same input image
+    for( SizeValueType m = 0; m < n && smoothImages.FixedImages[n].IsNull(); m++ )
+      {
+      if( smoothImages.FixedInputs[m] == smoothImages.FixedInputs[n] )
+        {
+        smoothImages.FixedImages[n] = smoothImages.FixedImages[m];
+        }
+      }
+    if( smoothImages.FixedImages[n].IsNull() )
+      {
+      if( smoothImages.FixedSmoothedImageCache )
+        {
+        smoothImages.FixedImages[n] = smoothImages.FixedSmoothedImageCache->GetSmoothedImage(
+          smoothImages.FixedInputs[n].GetPointer(), smoothImages.SmoothingSigma,
+          smoothImages.SmoothingSigmaIsSpecifiedInPhysicalUnits );
+        }
+      else
+        {
+        smoothImages.FixedImages[n] = FixedSmoothedImageCacheType::SmoothImage( smoothImages.FixedInputs[n].GetPointer(),
+          smoothImages.SmoothingSigma, smoothImages.SmoothingSigmaIsSpecifiedInPhysicalUnits );
+        }
+      }
+
+    for( SizeValueType m = 0; m < n && smoothImages.MovingImages[n].IsNull(); m++ )
+      {
+      if( smoothImages.MovingInputs[m] == smoothImages.MovingInputs[n] )
+        {
+        smoothImages.MovingImages[n] = smoothImages.MovingImages[m];
+        }
+      }
+    if( smoothImages.MovingImages[n].IsNull() )
+      {
+      smoothImages.MovingImages[n] = SmoothedImageCache<MovingImageType>::SmoothImage( smoothImages.MovingInputs[n].GetPointer(),
+        smoothImages.SmoothingSigma, smoothImages.SmoothingSigmaIsSpecifiedInPhysicalUnits );
+      }
+    }
+}
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
 void
@@ -932,43 +1067,89 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
   for( SizeValueType n = 0; n < numberOfLocalMetrics; n++ )
     {
-    typename MetricSamplePointSetType::Pointer samplePointSet = MetricSamplePointSetType::New();
-    samplePointSet->Initialize();
-
-    using SamplePointType = typename MetricSamplePointSetType::PointType;
-
-    using RandomizerType = Statistics::MersenneTwisterRandomVariateGenerator;
-    typename RandomizerType::Pointer randomizer = RandomizerType::New();
-    if (m_ReseedIterator)
+    // The seeds of the random generators are reserved up front, so that the
+    // sample points only depend on the seed, and can be shared through the
+    // metric fixed data cache.
+    const bool reseedIterator = this->m_ReseedIterator;
+    const int seed = this->m_CurrentRandomSeed;
+    if( !reseedIterator )
       {
-      randomizer->SetSeed( );
+      this->m_CurrentRandomSeed += ( this->m_MetricSamplingStrategy == RANDOM ) ? 2 : 1;
       }
-    else
+    const RealType samplingPercentage = this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel];
+
+    auto samplePoints = [&]() -> typename MetricSamplePointSetType::Pointer
       {
-      randomizer->SetSeed( m_CurrentRandomSeed++ );
-      }
+      typename MetricSamplePointSetType::Pointer samplePointSet = MetricSamplePointSetType::New();
+      samplePointSet->Initialize();
 
+      using SamplePointType = typename MetricSamplePointSetType::PointType;
 
-    unsigned long index = 0;
+      using RandomizerType = Statistics::MersenneTwisterRandomVariateGenerator;
+      typename RandomizerType::Pointer randomizer = RandomizerType::New();
+      if( reseedIterator )
+        {
+        randomizer->SetSeed( );
+        }
+      else
+        {
+        randomizer->SetSeed( seed );
+        }
 
-    switch( this->m_MetricSamplingStrategy )
-      {
-      case REGULAR:
+      unsigned long index = 0;
+
+      switch( this->m_MetricSamplingStrategy )
         {
-        const auto sampleCount = static_cast<unsigned long>(
-          std::ceil( 1.0 / this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] ) );
-        unsigned long count = sampleCount; //Start at sampleCount to keep behavior backwards identical, using first element.
-        ImageRegionConstIteratorWithIndex<VirtualDomainImageType> It( virtualImage, virtualDomainRegion );
-        for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+        case REGULAR:
+          {
+          const auto sampleCount = static_cast<unsigned long>( std::ceil( 1.0 / samplingPercentage ) );
+          unsigned long count = sampleCount; //Start at sampleCount to keep behavior backwards identical, using first element.
+          ImageRegionConstIteratorWithIndex<VirtualDomainImageType> It( virtualImage, virtualDomainRegion );
+          for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+            {
+            if( count == sampleCount )
+              {
+              count=0; //Reset counter
+              SamplePointType point;
+              virtualImage->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+
+              // randomly perturb the point within a voxel (approximately)
+              for( SizeValueType d = 0; d < ImageDimension; d++ )
+                {
+                point[d] += randomizer->GetNormalVariate() * oneThirdVirtualSpacing[d];
+                }
+              if( !fixedMaskImage || fixedMaskImage->IsInside( point ) )
+                {
+                samplePointSet->SetPoint( index, point );
+                ++index;
+                }
+              }
+            ++count;
+            }
+          break;
+          }
+        case RANDOM:
           {
-          if( count == sampleCount )
+          const unsigned long totalVirtualDomainVoxels = virtualDomainRegion.GetNumberOfPixels();
+          const auto sampleCount = static_cast<unsigned long>(
+           static_cast<float>( totalVirtualDomainVoxels ) * samplingPercentage );
+          ImageRandomConstIteratorWithIndex<VirtualDomainImageType> ItR( virtualImage, virtualDomainRegion );
+          if( reseedIterator )
+            {
+            ItR.ReinitializeSeed();
+            }
+          else
+            {
+            ItR.ReinitializeSeed( seed + 1 );
+            }
+          ItR.SetNumberOfSamples( sampleCount );
+          for( ItR.GoToBegin(); !ItR.IsAtEnd(); ++ItR )
             {
-            count=0; //Reset counter
             SamplePointType point;
-            virtualImage->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+            virtualImage->TransformIndexToPhysicalPoint( ItR.GetIndex(), point );
 
             // randomly perturb the point within a voxel (approximately)
-            for( SizeValueType d = 0; d < ImageDimension; d++ )
+            for ( unsigned int d = 0; d < ImageDimension; d++ )
               {
               point[d] += randomizer->GetNormalVariate() * oneThirdVirtualSpacing[d];
               }
@@ -978,59 +1159,44 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
               ++index;
               }
             }
-          ++count;
-          }
-        break;
-        }
-      case RANDOM:
-        {
-        const unsigned long totalVirtualDomainVoxels = virtualDomainRegion.GetNumberOfPixels();
-        const auto sampleCount = static_cast<unsigned long>(
-         static_cast<float>( totalVirtualDomainVoxels )
-               * this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] );
-        ImageRandomConstIteratorWithIndex<VirtualDomainImageType> ItR( virtualImage, virtualDomainRegion );
-        if (m_ReseedIterator)
-          {
-          ItR.ReinitializeSeed();
-          }
-        else
-          {
-          ItR.ReinitializeSeed( m_CurrentRandomSeed++ );
+          break;
           }
-        ItR.SetNumberOfSamples( sampleCount );
-        for( ItR.GoToBegin(); !ItR.IsAtEnd(); ++ItR )
+        default:
           {
-          SamplePointType point;
-          virtualImage->TransformIndexToPhysicalPoint( ItR.GetIndex(), point );
-
-          // randomly perturb the point within a voxel (approximately)
-          for ( unsigned int d = 0; d < ImageDimension; d++ )
-            {
-            point[d] += randomizer->GetNormalVariate() * oneThirdVirtualSpacing[d];
-            }
-          if( !fixedMaskImage || fixedMaskImage->IsInside( point ) )
-            {
-            samplePointSet->SetPoint( index, point );
-            ++index;
-            }
+          itkExceptionMacro( "Invalid sampling strategy requested." );
           }
-        break;
-        }
-      default:
-        {
-        itkExceptionMacro( "Invalid sampling strategy requested." );
         }
+      return samplePointSet;
+      };
+
+    typename MetricSamplePointSetType::Pointer samplePointSet;
+    if( this->m_MetricFixedDataCache && !reseedIterator )
+      {
+      typename MetricFixedDataCacheType::SampledPointSetKeyType key;
+      key.VirtualDomain = typename MetricFixedDataCacheType::VirtualDomainKeyType( virtualImage, false );
+      key.VirtualDomain.Region = virtualDomainRegion;
+      key.FixedImageMask = fixedMaskImage;
+      key.SamplingStrategy = this->m_MetricSamplingStrategy;
+      key.SamplingPercentage = samplingPercentage;
+      key.RandomSeed = seed;
+      samplePointSet = this->m_MetricFixedDataCache->GetSampledPointSet( key, samplePoints );
+      }
+    else
+      {
+      samplePointSet = samplePoints();
       }
 
     if( multiMetric )
       {
       dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetFixedSampledPointSet( samplePointSet );
       dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetUseFixedSampledPointSet( true );
+      dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetUseFixedSampledPointCache( this->m_UseFixedSampledPointCache );
       }
     else
       {
       dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetFixedSampledPointSet( samplePointSet );
       dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetUseFixedSampledPointSet( true );
+      dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetUseFixedSampledPointCache( this->m_UseFixedSampledPointCache );
       }
     }
 }
@@ -1157,6 +1323,10 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     os << this->m_MetricSamplingPercentagePerLevel[i] << " ";
     }
   os << std::endl;
+  os << indent << "UseFixedSampledPointCache: " << ( this->m_UseFixedSampledPointCache ? "On" : "Off" ) << std::endl;
+  os << indent << "UseAsynchronousSmoothing: " << ( this->m_UseAsynchronousSmoothing ? "On" : "Off" ) << std::endl;
+  itkPrintSelfObjectMacro( FixedSmoothedImageCache );
+  itkPrintSelfObjectMacro( MetricFixedDataCache );
 
   os << indent << "ReseedIterator: " << m_ReseedIterator << std::endl;
   os << indent << "RandomSeed: " << m_RandomSeed << std::endl;
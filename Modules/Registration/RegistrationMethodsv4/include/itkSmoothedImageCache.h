@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSmoothedImageCache_h
+#define itkSmoothedImageCache_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include <mutex>
+#include <vector>
+
+namespace itk
+{
+/** \class SmoothedImageCache
+ * \brief Thread safe cache of the Gaussian smoothed images of a
+ * multi-resolution registration.
+ *
+ * The images are smoothed with DiscreteGaussianImageFilter, as done by
+ * ImageRegistrationMethodv4 at each level. Several registrations sharing a
+ * fixed image, e.g. the registrations of many subjects to one template, can
+ * share a cache so that the fixed image is smoothed once per smoothing sigma
+ * instead of once per registration.
+ *
+ * An image is identified by its pixel container, its largest possible region,
+ * spacing, origin and direction, so that images grafted from the same image
+ * share their cached smoothed images. The cache is not updated when the
+ * pixels of an image are modified in place; call ReleaseImages() in that case.
+ *
+ * GetSmoothedImage() never waits for another thread: if two threads request
+ * the same image which is not cached yet, both compute it and the first
+ * result is kept.
+ *
+ * \sa ImageRegistrationMethodv4
+ *
+ * \ingroup ITKRegistrationMethodsv4
+ */
+template<typename TImage>
+class ITK_TEMPLATE_EXPORT SmoothedImageCache : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SmoothedImageCache);
+
+  /** Standard class type aliases. */
+  using Self = SmoothedImageCache;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( SmoothedImageCache, Object );
+
+  using ImageType = TImage;
+  using ImagePointer = typename ImageType::Pointer;
+  using RealType = double;
+
+  /** Return an image grafted from the smoothed \c image, computing it if it
+   * is not cached. Each call returns a different image object, the pixels of
+   * which are shared, so that the returned images can be used concurrently
+   * as the inputs of different pipelines. */
+  ImagePointer GetSmoothedImage( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits );
+
+  /** Return true if the smoothed \c image is cached. */
+  bool HasSmoothedImage( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits ) const;
+
+  /** Number of cached images. */
+  SizeValueType GetNumberOfImages() const;
+
+  /** Release the cached images. */
+  void ReleaseImages();
+
+  /** Smooth an image as ImageRegistrationMethodv4 does, without caching it. */
+  static ImagePointer SmoothImage( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits );
+
+protected:
+  SmoothedImageCache() = default;
+  ~SmoothedImageCache() override = default;
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+  using PixelContainerConstPointer = typename ImageType::PixelContainerConstPointer;
+
+  struct EntryType
+    {
+    PixelContainerConstPointer         PixelContainer;
+    typename ImageType::RegionType     Region;
+    typename ImageType::SpacingType    Spacing;
+    typename ImageType::PointType      Origin;
+    typename ImageType::DirectionType  Direction;
+    RealType                           Sigma;
+    bool                               SigmaIsSpecifiedInPhysicalUnits;
+    ImagePointer                       SmoothedImage;
+    };
+
+  /** Index of the entry of an image in m_Entries, or -1. The mutex must be
+   * locked. */
+  OffsetValueType FindEntry( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits ) const;
+
+  static ImagePointer GraftImage( const ImageType * image );
+
+  std::vector<EntryType> m_Entries;
+  mutable std::mutex     m_Mutex;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSmoothedImageCache.hxx"
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSmoothedImageCache_hxx
+#define itkSmoothedImageCache_hxx
+
+#include "itkSmoothedImageCache.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkMath.h"
+
+namespace itk
+{
+
+template<typename TImage>
+typename SmoothedImageCache<TImage>::ImagePointer
+SmoothedImageCache<TImage>
+::GetSmoothedImage( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits )
+{
+  {
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  const OffsetValueType entryIndex = this->FindEntry( image, sigma, sigmaIsSpecifiedInPhysicalUnits );
+  if( entryIndex >= 0 )
+    {
+    return Self::GraftImage( this->m_Entries[entryIndex].SmoothedImage );
+    }
+  }
+
+  // Smooth without holding the lock, so that the other threads do not wait.
+  EntryType entry;
+  entry.PixelContainer = image->GetPixelContainer();
+  entry.Region = image->GetLargestPossibleRegion();
+  entry.Spacing = image->GetSpacing();
+  entry.Origin = image->GetOrigin();
+  entry.Direction = image->GetDirection();
+  entry.Sigma = sigma;
+  entry.SigmaIsSpecifiedInPhysicalUnits = sigmaIsSpecifiedInPhysicalUnits;
+  entry.SmoothedImage = Self::SmoothImage( image, sigma, sigmaIsSpecifiedInPhysicalUnits );
+
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  const OffsetValueType entryIndex = this->FindEntry( image, sigma, sigmaIsSpecifiedInPhysicalUnits );
+  if( entryIndex >= 0 )
+    {
+    return Self::GraftImage( this->m_Entries[entryIndex].SmoothedImage );
+    }
+  this->m_Entries.push_back( entry );
+  return Self::GraftImage( entry.SmoothedImage );
+}
+
+template<typename TImage>
+bool
+SmoothedImageCache<TImage>
+::HasSmoothedImage( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits ) const
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  return this->FindEntry( image, sigma, sigmaIsSpecifiedInPhysicalUnits ) >= 0;
+}
+
+template<typename TImage>
+SizeValueType
+SmoothedImageCache<TImage>
+::GetNumberOfImages() const
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  return this->m_Entries.size();
+}
+
+template<typename TImage>
+void
+SmoothedImageCache<TImage>
+::ReleaseImages()
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  this->m_Entries.clear();
+}
+
+template<typename TImage>
+typename SmoothedImageCache<TImage>::ImagePointer
+SmoothedImageCache<TImage>
+::SmoothImage( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits )
+{
+  using SmoothingFilterType = DiscreteGaussianImageFilter<ImageType, ImageType>;
+  typename SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+  if( sigmaIsSpecifiedInPhysicalUnits == true )
+    {
+    smoothingFilter->SetUseImageSpacingOn();
+    }
+  else
+    {
+    smoothingFilter->SetUseImageSpacingOff();
+    }
+  smoothingFilter->SetVariance( itk::Math::sqr( sigma ) );
+  smoothingFilter->SetMaximumError( 0.01 );
+  smoothingFilter->SetInput( image );
+
+  ImagePointer smoothedImage = smoothingFilter->GetOutput();
+  smoothedImage->Update();
+  smoothedImage->DisconnectPipeline();
+  return smoothedImage;
+}
+
+template<typename TImage>
+OffsetValueType
+SmoothedImageCache<TImage>
+::FindEntry( const ImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits ) const
+{
+  for( SizeValueType n = 0; n < this->m_Entries.size(); n++ )
+    {
+    const EntryType & entry = this->m_Entries[n];
+    if( entry.PixelContainer == image->GetPixelContainer() &&
+        entry.Region == image->GetLargestPossibleRegion() &&
+        entry.Spacing == image->GetSpacing() &&
+        entry.Origin == image->GetOrigin() &&
+        entry.Direction == image->GetDirection() &&
+        Math::ExactlyEquals( entry.Sigma, sigma ) &&
+        entry.SigmaIsSpecifiedInPhysicalUnits == sigmaIsSpecifiedInPhysicalUnits )
+      {
+      return static_cast<OffsetValueType>( n );
+      }
+    }
+  return -1;
+}
+
+template<typename TImage>
+typename SmoothedImageCache<TImage>::ImagePointer
+SmoothedImageCache<TImage>
+::GraftImage( const ImageType * image )
+{
+  ImagePointer graftedImage = ImageType::New();
+  graftedImage->Graft( image );
+  return graftedImage;
+}
+
+template<typename TImage>
+void
+SmoothedImageCache<TImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfImages: " << this->GetNumberOfImages() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
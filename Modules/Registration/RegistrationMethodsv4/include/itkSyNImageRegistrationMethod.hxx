@@ -50,6 +50,9 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
   this->m_NumberOfIterationsPerLevel[2] = 40;
   this->m_DownsampleImagesForMetricDerivatives = true;
   this->m_AverageMidPointGradients = false;
+  // The fixed transform is updated at each iteration.
+  this->m_UseFixedSampledPointCache = false;
+
   this->m_FixedToMiddleTransform = nullptr;
   this->m_MovingToMiddleTransform = nullptr;
 }
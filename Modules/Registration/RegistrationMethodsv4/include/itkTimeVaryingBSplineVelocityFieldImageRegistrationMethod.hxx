@@ -50,6 +50,9 @@ TimeVaryingBSplineVelocityFieldImageRegistrationMethod<TFixedImage, TMovingImage
   this->m_NumberOfIterationsPerLevel[0] = 20;
   this->m_NumberOfIterationsPerLevel[1] = 30;
   this->m_NumberOfIterationsPerLevel[2] = 40;
+
+  // The fixed transform is updated at each iteration.
+  this->m_UseFixedSampledPointCache = false;
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
@@ -0,0 +1,186 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "itkBatchImageRegistrationMethodv4.h"
+#include "itkMattesMutualInformationImageToImageMetricv4.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTranslationTransform.h"
+#include "itkTimeProbe.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Register several moving images to one fixed image with
+ * BatchImageRegistrationMethodv4, check that each result is the one of a
+ * single registration, that a failing subject does not stop the others, and
+ * report the throughput of the batch and of sequential registrations.
+ */
+namespace
+{
+
+using ImageType = itk::Image<float, 2>;
+using TransformType = itk::TranslationTransform<double, 2>;
+using RegistrationType = itk::ImageRegistrationMethodv4<ImageType, ImageType, TransformType>;
+using BatchRegistrationType = itk::BatchImageRegistrationMethodv4<RegistrationType>;
+
+ImageType::Pointer
+MakeBlobImage( double centerX, double centerY )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size = { { 80, 80 } };
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it( image, image->GetBufferedRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const double dx = it.GetIndex()[0] - centerX;
+    const double dy = it.GetIndex()[1] - centerY;
+    it.Set( static_cast<float>( 100.0 * std::exp( -( dx * dx + 2.0 * dy * dy ) / 300.0 ) + 20.0 * ( dx > 0 ) ) );
+    }
+  return image;
+}
+
+RegistrationType::Pointer
+CreateRegistration( itk::SizeValueType )
+{
+  using MetricType = itk::MattesMutualInformationImageToImageMetricv4<ImageType, ImageType>;
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetNumberOfHistogramBins( 20 );
+
+  using OptimizerType = itk::GradientDescentOptimizerv4;
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetLearningRate( 20.0 );
+  optimizer->SetNumberOfIterations( 20 );
+  optimizer->SetDoEstimateLearningRateOnce( false );
+  optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetMetric( metric );
+  registration->SetOptimizer( optimizer );
+  registration->SetMetricSamplingStrategy( RegistrationType::REGULAR );
+  registration->SetMetricSamplingPercentage( 0.5 );
+  registration->MetricSamplingReinitializeSeed( 121212 );
+  return registration;
+}
+
+}
+
+int itkBatchImageRegistrationMethodv4Test( int, char *[] )
+{
+  BatchRegistrationType::Pointer batchRegistration = BatchRegistrationType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( batchRegistration, BatchImageRegistrationMethodv4, Object );
+
+  TRY_EXPECT_EXCEPTION( batchRegistration->Update() );
+
+  ImageType::Pointer fixedImage = MakeBlobImage( 40.0, 40.0 );
+  batchRegistration->SetFixedImage( fixedImage );
+  TEST_SET_GET_VALUE( fixedImage.GetPointer(), batchRegistration->GetFixedImage() );
+
+  constexpr unsigned int numberOfSubjects = 6;
+  const double offsets[numberOfSubjects][2] = { { 2, 1 }, { -3, 2 }, { 1, -2 }, { 4, 3 }, { 0, 0 }, { -2, -4 } };
+  for( const auto & offset : offsets )
+    {
+    batchRegistration->AddMovingImage( MakeBlobImage( 40.0 + offset[0], 40.0 + offset[1] ) );
+    }
+  // A subject whose moving image does not overlap the fixed image
+  ImageType::Pointer farMovingImage = MakeBlobImage( 40.0, 40.0 );
+  ImageType::PointType farOrigin;
+  farOrigin.Fill( 1000.0 );
+  farMovingImage->SetOrigin( farOrigin );
+  batchRegistration->AddMovingImage( farMovingImage );
+  TEST_SET_GET_VALUE( numberOfSubjects + 1, batchRegistration->GetNumberOfMovingImages() );
+
+  batchRegistration->SetRegistrationMethodCreator( CreateRegistration );
+  batchRegistration->SetNumberOfThreads( 3 );
+  TEST_SET_GET_VALUE( 3, batchRegistration->GetNumberOfThreads() );
+  TEST_SET_GET_VALUE( 1, batchRegistration->GetNumberOfThreadsPerRegistration() );
+
+  TRY_EXPECT_NO_EXCEPTION( batchRegistration->Update() );
+
+  // The fixed image is smoothed once per sigma: 2, 1 and 0.
+  TEST_SET_GET_VALUE( 3, batchRegistration->GetModifiableFixedSmoothedImageCache()->GetNumberOfImages() );
+
+  // An image grafted from the fixed image, but moved, has its own smoothed images.
+  ImageType::Pointer movedFixedImage = ImageType::New();
+  movedFixedImage->Graft( fixedImage );
+  TEST_EXPECT_TRUE( batchRegistration->GetModifiableFixedSmoothedImageCache()->HasSmoothedImage( movedFixedImage, 2.0, true ) );
+  ImageType::PointType movedOrigin;
+  movedOrigin.Fill( 5.0 );
+  movedFixedImage->SetOrigin( movedOrigin );
+  TEST_EXPECT_TRUE( !batchRegistration->GetModifiableFixedSmoothedImageCache()->HasSmoothedImage( movedFixedImage, 2.0, true ) );
+
+  // The sample points and their fixed side are computed once per level, and
+  // shared by all the subjects. The Mattes metric does not use the gradient
+  // of the fixed image.
+  const BatchRegistrationType::MetricFixedDataCacheType * metricFixedDataCache =
+    batchRegistration->GetModifiableMetricFixedDataCache();
+  TEST_SET_GET_VALUE( 3, metricFixedDataCache->GetNumberOfSampledPointSets() );
+  TEST_SET_GET_VALUE( 3, metricFixedDataCache->GetNumberOfFixedSampledPointCaches() );
+  TEST_SET_GET_VALUE( 0, metricFixedDataCache->GetNumberOfFixedImageGradientImages() );
+
+  TEST_SET_GET_VALUE( 1, batchRegistration->GetNumberOfFailedRegistrations() );
+  const BatchRegistrationType::RegistrationResultType & farResult =
+    batchRegistration->GetRegistrationResult( numberOfSubjects );
+  std::cout << "Expected failure: " << farResult.ErrorDescription << std::endl;
+  TEST_EXPECT_TRUE( !farResult.Succeeded && !farResult.ErrorDescription.empty() );
+
+  // Register the subjects one after the other, without the batch.
+  bool success = true;
+  itk::TimeProbe sequentialTimeProbe;
+  sequentialTimeProbe.Start();
+  for( unsigned int subject = 0; subject < numberOfSubjects; subject++ )
+    {
+    RegistrationType::Pointer registration = CreateRegistration( subject );
+    registration->SetFixedImage( fixedImage );
+    registration->SetMovingImage( batchRegistration->GetMovingImage( subject ) );
+    dynamic_cast<RegistrationType::ImageMetricType *>( registration->GetModifiableMetric() )->SetMaximumNumberOfThreads( 1 );
+    registration->GetModifiableOptimizer()->SetNumberOfThreads( 1 );
+    registration->Update();
+
+    const BatchRegistrationType::RegistrationResultType & result = batchRegistration->GetRegistrationResult( subject );
+    std::cout << "Subject " << subject << ": " << result.Transform->GetParameters()
+              << ", metric value " << result.MetricValue << ", " << result.ElapsedTime << " s" << std::endl;
+    if( !result.Succeeded || result.Transform->GetParameters() != registration->GetTransform()->GetParameters()
+        || result.MetricValue != registration->GetModifiableOptimizer()->GetValue() )
+      {
+      std::cerr << "The batch result of subject " << subject << " differs from the single registration: "
+                << registration->GetTransform()->GetParameters() << std::endl;
+      success = false;
+      }
+    }
+  sequentialTimeProbe.Stop();
+
+  std::cout << "Batch: " << batchRegistration->GetThroughput() << " subjects per second, "
+            << batchRegistration->GetFixedImagePrecomputationTime() << " s of precomputation out of "
+            << batchRegistration->GetElapsedTime() << " s" << std::endl;
+  std::cout << "Sequential: " << numberOfSubjects / sequentialTimeProbe.GetTotal() << " subjects per second" << std::endl;
+
+  batchRegistration->RemoveAllMovingImages();
+  TEST_SET_GET_VALUE( 0, batchRegistration->GetNumberOfMovingImages() );
+
+  batchRegistration->SetRegistrationMethodCreator( []( itk::SizeValueType ) { return RegistrationType::Pointer(); } );
+  batchRegistration->AddMovingImage( fixedImage );
+  TRY_EXPECT_EXCEPTION( batchRegistration->Update() );
+
+  if( !success )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkCorrelationImageToImageMetricv4.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkCastImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTranslationTransform.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Register with a multi metric whose first two metrics share their images,
+ * with and without smoothing the images of the next level while the current
+ * level is optimized, and check that the results are the same, also when an
+ * input image is the output of a pipeline.
+ */
+namespace
+{
+
+using ImageType = itk::Image<double, 2>;
+
+ImageType::Pointer
+MakeBlobImage( double centerX, double centerY )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size = { { 64, 64 } };
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it( image, image->GetBufferedRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const double dx = it.GetIndex()[0] - centerX;
+    const double dy = it.GetIndex()[1] - centerY;
+    it.Set( 100.0 * std::exp( -( dx * dx + 2.0 * dy * dy ) / 200.0 ) );
+    }
+  return image;
+}
+
+using RegistrationType = itk::ImageRegistrationMethodv4<ImageType, ImageType, itk::TranslationTransform<double, 2> >;
+using MultiMetricType = itk::ObjectToObjectMultiMetricv4<2, 2>;
+using MeanSquaresMetricType = itk::MeanSquaresImageToImageMetricv4<ImageType, ImageType>;
+using CorrelationMetricType = itk::CorrelationImageToImageMetricv4<ImageType, ImageType>;
+using ImageMetricType = itk::ImageToImageMetricv4<ImageType, ImageType>;
+
+RegistrationType::Pointer
+Register( bool useAsynchronousSmoothing, ImageType * fixedImage, ImageType * movingImage, ImageType * otherMovingImage )
+{
+  MultiMetricType::Pointer multiMetric = MultiMetricType::New();
+  multiMetric->AddMetric( MeanSquaresMetricType::New() );
+  multiMetric->AddMetric( CorrelationMetricType::New() );
+  multiMetric->AddMetric( MeanSquaresMetricType::New() );
+
+  using OptimizerType = itk::GradientDescentOptimizerv4;
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetLearningRate( 0.01 );
+  optimizer->SetNumberOfIterations( 10 );
+  optimizer->SetDoEstimateLearningRateOnce( false );
+  optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetMetric( multiMetric );
+  registration->SetOptimizer( optimizer );
+  registration->SetFixedImage( 0, fixedImage );
+  registration->SetMovingImage( 0, movingImage );
+  registration->SetFixedImage( 1, fixedImage );
+  registration->SetMovingImage( 1, movingImage );
+  registration->SetFixedImage( 2, fixedImage );
+  registration->SetMovingImage( 2, otherMovingImage );
+
+  // The third level reuses the smoothed images of the second one.
+  constexpr unsigned int numberOfLevels = 4;
+  RegistrationType::ShrinkFactorsArrayType shrinkFactorsPerLevel( numberOfLevels );
+  RegistrationType::SmoothingSigmasArrayType smoothingSigmasPerLevel( numberOfLevels );
+  const unsigned int shrinkFactors[numberOfLevels] = { 2, 2, 1, 1 };
+  const double smoothingSigmas[numberOfLevels] = { 2.0, 1.0, 1.0, 0.0 };
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
+    {
+    shrinkFactorsPerLevel[level] = shrinkFactors[level];
+    smoothingSigmasPerLevel[level] = smoothingSigmas[level];
+    }
+  registration->SetNumberOfLevels( numberOfLevels );
+  registration->SetShrinkFactorsPerLevel( shrinkFactorsPerLevel );
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmasPerLevel );
+  registration->SetUseAsynchronousSmoothing( useAsynchronousSmoothing );
+
+  registration->Update();
+  return registration;
+}
+
+}
+
+int itkImageRegistrationAsynchronousSmoothingTest( int, char *[] )
+{
+  RegistrationType::Pointer registration = RegistrationType::New();
+  TEST_EXPECT_TRUE( !registration->GetUseAsynchronousSmoothing() );
+  TEST_SET_GET_BOOLEAN( registration, UseAsynchronousSmoothing, true );
+
+  ImageType::Pointer fixedImage = MakeBlobImage( 30.0, 32.0 );
+  ImageType::Pointer movingImage = MakeBlobImage( 33.0, 30.0 );
+  ImageType::Pointer otherMovingImage = MakeBlobImage( 32.0, 31.0 );
+
+  RegistrationType::Pointer synchronousRegistration;
+  RegistrationType::Pointer asynchronousRegistration;
+  TRY_EXPECT_NO_EXCEPTION( synchronousRegistration = Register( false, fixedImage, movingImage, otherMovingImage ) );
+  TRY_EXPECT_NO_EXCEPTION( asynchronousRegistration = Register( true, fixedImage, movingImage, otherMovingImage ) );
+
+  // The moving image of the last registration is not disconnected from its
+  // pipeline.
+  using CastFilterType = itk::CastImageFilter<ImageType, ImageType>;
+  CastFilterType::Pointer castFilter = CastFilterType::New();
+  castFilter->SetInput( movingImage );
+  RegistrationType::Pointer pipelineRegistration;
+  TRY_EXPECT_NO_EXCEPTION( pipelineRegistration = Register( true, fixedImage, castFilter->GetOutput(), otherMovingImage ) );
+
+  const RegistrationType::OutputTransformType::ParametersType synchronousParameters =
+    synchronousRegistration->GetTransform()->GetParameters();
+  const RegistrationType::OutputTransformType::ParametersType asynchronousParameters =
+    asynchronousRegistration->GetTransform()->GetParameters();
+  const RegistrationType::OutputTransformType::ParametersType pipelineParameters =
+    pipelineRegistration->GetTransform()->GetParameters();
+  std::cout << "Synchronous smoothing: " << synchronousParameters << std::endl;
+  std::cout << "Asynchronous smoothing: " << asynchronousParameters << std::endl;
+  std::cout << "Asynchronous smoothing of a pipeline output: " << pipelineParameters << std::endl;
+  if( synchronousParameters != asynchronousParameters || synchronousParameters != pipelineParameters )
+    {
+    std::cerr << "The result depends on the asynchronous smoothing." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The metrics of a shared input image share its smoothed image.
+  for( auto * registrationMethod : { synchronousRegistration.GetPointer(), asynchronousRegistration.GetPointer() } )
+    {
+    const MultiMetricType::MetricQueueType & metrics =
+      dynamic_cast<MultiMetricType *>( registrationMethod->GetModifiableMetric() )->GetMetricQueue();
+    const auto * metric0 = dynamic_cast<const ImageMetricType *>( metrics[0].GetPointer() );
+    const auto * metric1 = dynamic_cast<const ImageMetricType *>( metrics[1].GetPointer() );
+    const auto * metric2 = dynamic_cast<const ImageMetricType *>( metrics[2].GetPointer() );
+    TEST_EXPECT_TRUE( metric0->GetFixedImage() == metric1->GetFixedImage() );
+    TEST_EXPECT_TRUE( metric0->GetFixedImage() == metric2->GetFixedImage() );
+    TEST_EXPECT_TRUE( metric0->GetMovingImage() == metric1->GetMovingImage() );
+    TEST_EXPECT_TRUE( metric0->GetMovingImage() != metric2->GetMovingImage() );
+    TEST_EXPECT_TRUE( metric0->GetFixedImage() != fixedImage.GetPointer() );
+    }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -20,11 +20,9 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkImage.h"
+#include <atomic>
 #include <vector>
 #include <map>
-#include "itkProgressReporter.h"
-#include "itkBarrier.h"
-#include "itkPlatformMultiThreader.h"
 
 namespace itk
 {
@@ -44,11 +42,17 @@ namespace itk
  * component image filter which did not produce consecutive labels or
  * impose any particular ordering.
  *
+ * The runs of the lines are extracted, merged and labeled in parallel.
+ * The runs of neighbor lines are merged in a union-find structure updated
+ * with atomic compare-and-swap operations, whose roots are the smallest
+ * labels of their sets, so that the labels do not depend on the number of
+ * threads.
+ *
  * After the filter is executed, ObjectCount holds the number of connected components.
  *
  * \sa ImageToImageFilter
  *
- * \ingroup SingleThreaded
+ * \ingroup MultiThreaded
  * \ingroup ITKConnectedComponents
  *
  * \wiki
@@ -167,26 +171,16 @@ protected:
 
     //  #1 "MaskImage" optional
     Self::AddOptionalInputName("MaskImage",1);
-    this->DynamicMultiThreadingOff();
-    this->SetMultiThreader(PlatformMultiThreader::New());
   }
 
   ~ConnectedComponentImageFilter() override {}
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
   /**
-   * Standard pipeline methods.
+   * Standard pipeline method. The phases of the algorithm are parallelized
+   * over the lines of the image.
    */
-  void BeforeThreadedGenerateData() override;
-
-  void AfterThreadedGenerateData() override;
-
-  void ThreadedGenerateData(const RegionType & outputRegionForThread, ThreadIdType threadId) override;
-
-  void DynamicThreadedGenerateData( const RegionType & ) override
-  {
-    itkExceptionMacro("This class requires threadId so it must use classic multi-threading model");
-  }
+  void GenerateData() override;
 
   /** ConnectedComponentImageFilter needs the entire input. Therefore
    * it must provide an implementation GenerateInputRequestedRegion().
@@ -225,20 +219,15 @@ public:
 
   using OffsetVec = std::vector< typename TInputImage::OffsetValueType >;
 
-  // the types to support union-find operations
-  using UnionFindType = std::vector< LabelType >;
-  UnionFindType m_UnionFind;
-  UnionFindType m_Consecutive;
+  // the types to support union-find operations. The parent of a label is
+  // never larger than the label.
+  using UnionFindType = std::vector< std::atomic< LabelType > >;
+  using ConsecutiveType = std::vector< LabelType >;
+  UnionFindType   m_UnionFind;
+  ConsecutiveType m_Consecutive;
 
-  // functions to support union-find operations
-  void InitUnion( SizeValueType size )
-  {
-    m_UnionFind = UnionFindType(size + 1);
-  }
-
-  void InsertSet(const LabelType label);
-
-  SizeValueType LookupSet(const LabelType label);
+  // functions to support union-find operations, safe to call concurrently
+  LabelType LookupSet(LabelType label);
 
   void LinkLabels(const LabelType lab1, const LabelType lab2);
 
@@ -250,26 +239,11 @@ public:
 
   void CompareLines(lineEncoding & current, const lineEncoding & Neighbour);
 
-  void FillOutput(const LineMapType & LineMap,
-                  ProgressReporter & progress);
-
   void SetupLineOffsets(OffsetVec & LineOffsets);
 
-  void Wait()
-  {
-    // use m_NumberOfLabels.size() to get the number of thread used
-    if ( m_NumberOfLabels.size() > 1 )
-      {
-      m_Barrier->Wait();
-      }
-  }
-
-  typename std::vector< IdentifierType > m_NumberOfLabels;
-  typename std::vector< IdentifierType > m_FirstLineIdToJoin;
-
-  typename Barrier::Pointer m_Barrier;
+  // Index of the first pixel of a line of the requested region
+  IndexType LineIndex(const RegionType & region, SizeValueType lineId) const;
 
-  typename TInputImage::ConstPointer m_Input;
 #if !defined( ITK_WRAPPING_PARSER )
   LineMapType m_LineMap;
 #endif
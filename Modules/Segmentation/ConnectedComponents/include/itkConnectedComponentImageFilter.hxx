@@ -23,10 +23,11 @@
 // don't think we need the indexed version as we only compute the
 // index at the start of each run, but there isn't a choice
 #include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkConstShapedNeighborhoodIterator.h"
-#include "itkImageRegionIterator.h"
 #include "itkMaskImageFilter.h"
 #include "itkConnectedComponentAlgorithm.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -65,8 +66,10 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
 void
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::BeforeThreadedGenerateData()
+::GenerateData()
 {
+  this->AllocateOutputs();
+
   typename TOutputImage::Pointer output = this->GetOutput();
   typename TInputImage::ConstPointer input = this->GetInput();
   typename TMaskImage::ConstPointer mask = this->GetMaskImage();
@@ -78,338 +81,182 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
     {
     maskFilter->SetInput(input);
     maskFilter->SetMaskImage(mask);
+    maskFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
     maskFilter->Update();
-    m_Input = maskFilter->GetOutput();
-    }
-  else
-    {
-    m_Input = input;
+    input = maskFilter->GetOutput();
     }
 
-  ThreadIdType nbOfThreads = this->GetNumberOfThreads();
-  if ( itk::MultiThreaderBase::GetGlobalMaximumNumberOfThreads() != 0 )
-    {
-    nbOfThreads = std::min( this->GetNumberOfThreads(), itk::MultiThreaderBase::GetGlobalMaximumNumberOfThreads() );
-    }
-  // number of threads can be constrained by the region size, so call the
-  // SplitRequestedRegion
-  // to get the real number of threads which will be used
-  typename TOutputImage::RegionType splitRegion;  // dummy region - just to call
-                                                  // the following method
-  nbOfThreads = this->SplitRequestedRegion(0, nbOfThreads, splitRegion);
-
-  // set up the vars used in the threads
-  m_NumberOfLabels.clear();
-  m_NumberOfLabels.resize(nbOfThreads, 0);
-  m_Barrier = Barrier::New();
-  m_Barrier->Initialize(nbOfThreads);
-  const SizeValueType pixelcount = output->GetRequestedRegion().GetNumberOfPixels();
-  const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
-  const SizeValueType linecount = pixelcount / xsize;
+  const RegionType    region = output->GetRequestedRegion();
+  const SizeValueType xsize = region.GetSize()[0];
+  const SizeValueType linecount = xsize > 0 ? region.GetNumberOfPixels() / xsize : 0;
+  m_LineMap.clear();
   m_LineMap.resize(linecount);
-  m_FirstLineIdToJoin.resize(nbOfThreads - 1);
-}
 
-template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-void
-ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::ThreadedGenerateData(const RegionType & outputRegionForThread,
-                       ThreadIdType threadId)
-{
-  typename TOutputImage::Pointer output = this->GetOutput();
-  typename TMaskImage::ConstPointer mask = this->GetMaskImage();
+  MultiThreaderBase *multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfThreads( this->GetNumberOfThreads() );
 
-  const auto nbOfThreads = static_cast<const ThreadIdType>( m_NumberOfLabels.size() );
-
-  // create a line iterator
-  using InputLineIteratorType = itk::ImageLinearConstIteratorWithIndex< InputImageType >;
-  InputLineIteratorType inLineIt(m_Input, outputRegionForThread);
-  inLineIt.SetDirection(0);
-
-  // set the progress reporter to deal with the number of lines
-  const SizeValueType pixelcountForThread = outputRegionForThread.GetNumberOfPixels();
-  const SizeValueType xsizeForThread = outputRegionForThread.GetSize()[0];
-  const SizeValueType linecountForThread = pixelcountForThread / xsizeForThread;
-  ProgressReporter    progress(this, threadId, linecountForThread * 2);
-
-  // find the split axis
-  const IndexType outputRegionIdx = output->GetRequestedRegion().GetIndex();
-  const IndexType outputRegionForThreadIdx = outputRegionForThread.GetIndex();
-  SizeType  outputRegionSize = output->GetRequestedRegion().GetSize();
-  SizeType  outputRegionForThreadSize = outputRegionForThread.GetSize();
-  int             splitAxis = 0;
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
-    {
-    if ( outputRegionSize[i] != outputRegionForThreadSize[i] )
+  // Extract the runs of each line.
+  multiThreader->ParallelizeArrayRange( 0, linecount,
+    [this, &input, &region]( SizeValueType firstLine, SizeValueType lastLinePlus1 )
       {
-      splitAxis = i;
-      }
-    }
-
-  // compute the number of pixels before that threads
-  outputRegionSize[splitAxis] = outputRegionForThreadIdx[splitAxis] - outputRegionIdx[splitAxis];
-  using LineIdType = SizeValueType;
-  LineIdType firstLineIdForThread = RegionType(outputRegionIdx, outputRegionSize).GetNumberOfPixels() / xsizeForThread;
-  LineIdType lineId = firstLineIdForThread;
-
-  OffsetVec LineOffsets;
-  SetupLineOffsets(LineOffsets);
-
-  LineIdType nbOfLabels = 0;
-  for ( inLineIt.GoToBegin();
-        !inLineIt.IsAtEnd();
-        inLineIt.NextLine() )
-    {
-    inLineIt.GoToBeginOfLine();
-    lineEncoding ThisLine;
-    while ( !inLineIt.IsAtEndOfLine() )
-      {
-      const InputPixelType PVal = inLineIt.Get();
-      //std::cout << inLineIt.GetIndex() << std::endl;
-      if ( PVal != NumericTraits< InputPixelType >::ZeroValue( PVal ) )
+      using InputLineIteratorType = ImageLinearConstIteratorWithIndex< InputImageType >;
+      InputLineIteratorType inLineIt(input, region);
+      inLineIt.SetDirection(0);
+      for ( SizeValueType lineId = firstLine; lineId < lastLinePlus1; ++lineId )
         {
-        // We've hit the start of a run
-        runLength thisRun;
-        const IndexType thisIndex = inLineIt.GetIndex();
-        //std::cout << thisIndex << std::endl;
-        SizeValueType length = 1;
-        ++inLineIt;
-        while ( !inLineIt.IsAtEndOfLine()
-                && inLineIt.Get() != NumericTraits< InputPixelType >::ZeroValue( PVal ) )
+        inLineIt.SetIndex( this->LineIndex(region, lineId) );
+        lineEncoding & ThisLine = m_LineMap[lineId];
+        while ( !inLineIt.IsAtEndOfLine() )
           {
-          ++length;
-          ++inLineIt;
+          const InputPixelType PVal = inLineIt.Get();
+          if ( PVal != NumericTraits< InputPixelType >::ZeroValue( PVal ) )
+            {
+            // We've hit the start of a run
+            runLength thisRun;
+            const IndexType thisIndex = inLineIt.GetIndex();
+            SizeValueType length = 1;
+            ++inLineIt;
+            while ( !inLineIt.IsAtEndOfLine()
+                    && inLineIt.Get() != NumericTraits< InputPixelType >::ZeroValue( PVal ) )
+              {
+              ++length;
+              ++inLineIt;
+              }
+            // create the run length object to go in the vector
+            thisRun.length = length;
+            thisRun.label = 0; // will give a real label later
+            thisRun.where = thisIndex;
+            ThisLine.push_back(thisRun);
+            }
+          else
+            {
+            ++inLineIt;
+            }
           }
-        // create the run length object to go in the vector
-        thisRun.length = length;
-        thisRun.label = 0; // will give a real label later
-        thisRun.where = thisIndex;
-        ThisLine.push_back(thisRun);
-        nbOfLabels++;
-        }
-      else
-        {
-        ++inLineIt;
         }
-      }
-    m_LineMap[lineId] = ThisLine;
-    lineId++;
-    progress.CompletedPixel();
-    }
+      }, nullptr );
+  this->UpdateProgress(0.25f);
 
-  m_NumberOfLabels[threadId] = nbOfLabels;
-
-  // wait for the other threads to complete that part
-  this->Wait();
-
-  // compute the total number of labels
-  nbOfLabels = 0;
-  for ( ThreadIdType i = 0; i < nbOfThreads; i++ )
+  // Label the runs in raster order, each in its own set.
+  std::vector< LabelType > firstLabels(linecount + 1);
+  firstLabels[0] = 1;
+  for ( SizeValueType lineId = 0; lineId < linecount; ++lineId )
     {
-    nbOfLabels += m_NumberOfLabels[i];
+    firstLabels[lineId + 1] = firstLabels[lineId] + m_LineMap[lineId].size();
     }
-
-  if ( threadId == 0 )
-    {
-    // set up the union find structure
-    InitUnion(nbOfLabels);
-    // insert all the labels into the structure -- an extra loop but
-    // saves complicating the ones that come later
-    auto MapBegin = m_LineMap.begin();
-    auto MapEnd = m_LineMap.end();
-    auto LineIt = MapBegin;
-    SizeValueType label = 1;
-    for ( LineIt = MapBegin; LineIt != MapEnd; ++LineIt )
+  m_UnionFind = UnionFindType( firstLabels[linecount] );
+  multiThreader->ParallelizeArrayRange( 0, linecount,
+    [this, &firstLabels]( SizeValueType firstLine, SizeValueType lastLinePlus1 )
       {
-      for ( auto cIt = LineIt->begin(); cIt != LineIt->end(); ++cIt )
+      for ( SizeValueType lineId = firstLine; lineId < lastLinePlus1; ++lineId )
         {
-        cIt->label = label;
-        InsertSet(label);
-        label++;
-        }
-      }
-    }
-
-  // wait for the other threads to complete that part
-  this->Wait();
-
-  // now process the map and make appropriate entries in an equivalence
-  // table
-  // itkAssertInDebugAndIgnoreInReleaseMacro( linecount == m_LineMap.size() );
-  const SizeValueType pixelcount = output->GetRequestedRegion().GetNumberOfPixels();
-  const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
-  const SizeValueType linecount = pixelcount / xsize;
-
-  SizeValueType lastLineIdForThread =  linecount;
-  SizeValueType nbOfLineIdToJoin = 0;
-  if ( threadId != nbOfThreads - 1 )
-    {
-    outputRegionForThreadSize = outputRegionForThread.GetSize();
-    outputRegionForThreadSize[splitAxis] -= 1;
-    lastLineIdForThread = firstLineIdForThread
-                          + RegionType(outputRegionIdx, outputRegionForThreadSize).GetNumberOfPixels() / xsizeForThread;
-    m_FirstLineIdToJoin[threadId] = lastLineIdForThread;
-    // found the number of line ids to join
-    nbOfLineIdToJoin =
-      RegionType( outputRegionIdx, outputRegionForThread.GetSize() ).GetNumberOfPixels() / xsizeForThread
-      - RegionType(outputRegionIdx, outputRegionForThreadSize).GetNumberOfPixels() / xsizeForThread;
-    }
-
-  for ( SizeValueType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ++ThisIdx )
-    {
-    if ( !m_LineMap[ThisIdx].empty() )
-      {
-      for ( typename OffsetVec::const_iterator I = LineOffsets.begin();
-            I != LineOffsets.end(); ++I )
-        {
-        const OffsetValueType NeighIdx = ( *I ) + ThisIdx;
-        // check if the neighbor is in the map
-        if ( NeighIdx >= 0 && NeighIdx < static_cast<OffsetValueType>( linecount ) && !m_LineMap[NeighIdx].empty() )
+        LabelType label = firstLabels[lineId];
+        for ( auto & run : m_LineMap[lineId] )
           {
-          // Now check whether they are really neighbors
-          const bool areNeighbors =
-            CheckNeighbors(m_LineMap[ThisIdx][0].where, m_LineMap[NeighIdx][0].where);
-          if ( areNeighbors )
-            {
-            // Compare the two lines
-            CompareLines(m_LineMap[ThisIdx], m_LineMap[NeighIdx]);
-            }
+          run.label = label;
+          m_UnionFind[label].store(label, std::memory_order_relaxed);
+          ++label;
           }
         }
-      }
-    }
+      }, nullptr );
 
-  // wait for the other threads to complete that part
-  this->Wait();
-
-  while ( m_FirstLineIdToJoin.size() != 0 )
-    {
-    if ( threadId * 2 < static_cast<ThreadIdType>( m_FirstLineIdToJoin.size() ) )
+  // Merge the runs of each line with the overlapping runs of the
+  // previous neighbor lines.
+  OffsetVec LineOffsets;
+  SetupLineOffsets(LineOffsets);
+  multiThreader->ParallelizeArrayRange( 0, linecount,
+    [this, &LineOffsets, linecount]( SizeValueType firstLine, SizeValueType lastLinePlus1 )
       {
-      for ( SizeValueType ThisIdx = m_FirstLineIdToJoin[threadId * 2];
-            ThisIdx < m_FirstLineIdToJoin[threadId * 2] + nbOfLineIdToJoin;
-            ++ThisIdx )
+      for ( SizeValueType ThisIdx = firstLine; ThisIdx < lastLinePlus1; ++ThisIdx )
         {
-        if ( !m_LineMap[ThisIdx].empty() )
+        if ( m_LineMap[ThisIdx].empty() )
+          {
+          continue;
+          }
+        for ( typename OffsetVec::const_iterator I = LineOffsets.begin();
+              I != LineOffsets.end(); ++I )
           {
-          for ( typename OffsetVec::const_iterator I = LineOffsets.begin();
-                I != LineOffsets.end(); ++I )
+          const OffsetValueType NeighIdx = ( *I ) + static_cast< OffsetValueType >( ThisIdx );
+          // check if the neighbor is in the map
+          if ( NeighIdx >= 0 && NeighIdx < static_cast<OffsetValueType>( linecount ) && !m_LineMap[NeighIdx].empty() )
             {
-            const OffsetValueType NeighIdx = ( *I ) + ThisIdx;
-            // check if the neighbor is in the map
-            if ( NeighIdx >= 0 && NeighIdx < static_cast<OffsetValueType>( linecount ) && !m_LineMap[NeighIdx].empty() )
+            // Now check whether they are really neighbors
+            const bool areNeighbors =
+              CheckNeighbors(m_LineMap[ThisIdx][0].where, m_LineMap[NeighIdx][0].where);
+            if ( areNeighbors )
               {
-              // Now check whether they are really neighbors
-              const bool areNeighbors =
-                CheckNeighbors(m_LineMap[ThisIdx][0].where, m_LineMap[NeighIdx][0].where);
-              if ( areNeighbors )
-                {
-                // Compare the two lines
-                CompareLines(m_LineMap[ThisIdx], m_LineMap[NeighIdx]);
-                }
+              // Compare the two lines
+              CompareLines(m_LineMap[ThisIdx], m_LineMap[NeighIdx]);
               }
             }
           }
         }
-      }
-
-    this->Wait();
-
-    if ( threadId == 0 )
-      {
-      // remove the region already joined
-      typename std::vector< SizeValueType > newFirstLineIdToJoin;
-      for ( unsigned int i = 1; i < m_FirstLineIdToJoin.size(); i += 2 )
-        {
-        newFirstLineIdToJoin.push_back(m_FirstLineIdToJoin[i]);
-        }
-      m_FirstLineIdToJoin = newFirstLineIdToJoin;
-      }
+      }, nullptr );
+  this->UpdateProgress(0.5f);
 
-    this->Wait();
-    }
-
-  if ( threadId == 0 )
-    {
-    m_ObjectCount = CreateConsecutive();
-    }
-
-  this->Wait();
+  m_ObjectCount = CreateConsecutive();
+  this->UpdateProgress(0.75f);
 
   // check for overflow exception here
   if ( m_ObjectCount > static_cast< SizeValueType >(
          NumericTraits< OutputPixelType >::max() ) )
     {
-    if ( threadId == 0 )
-      {
-      // main thread throw the exception
-      itkExceptionMacro(
-        << "Number of objects greater than maximum of output pixel type ");
-      }
-    else
-      {
-      // other threads just return
-      return;
-      }
+    m_LineMap.clear();
+    m_UnionFind.clear();
+    m_Consecutive.clear();
+    itkExceptionMacro(
+      << "Number of objects greater than maximum of output pixel type ");
     }
 
-  // create the output
-  // A more complex version that is intended to minimize the number of
-  // visits to the output image which should improve cache
-  // performance on large images. We also want to optimize the
-  // performance of the map by being able to iterate through it,
-  // rather than do lots of look ups. Don't know whether that will
-  // make much difference in practice.
-  // Note - this is unnecessary if AllocateOutputs initalizes to zero
-
-  ImageRegionIterator< OutputImageType > oit(output, outputRegionForThread);
-  ImageRegionIterator< OutputImageType > fstart = oit;
-  fstart.GoToBegin();
-  ImageRegionIterator< OutputImageType > fend = oit;
-  fend.GoToEnd();
-
-  lastLineIdForThread = firstLineIdForThread
-                        + RegionType( outputRegionIdx,
-                                      outputRegionForThread.GetSize() ).GetNumberOfPixels() / xsizeForThread;
-
-  for ( SizeValueType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ThisIdx++ )
-    {
-    // now fill the labelled sections
-    for ( typename lineEncoding::const_iterator cIt = m_LineMap[ThisIdx].begin(); cIt != m_LineMap[ThisIdx].end(); ++cIt )
+  // create the output, visiting each line once
+  multiThreader->ParallelizeArrayRange( 0, linecount,
+    [this, &output, &region]( SizeValueType firstLine, SizeValueType lastLinePlus1 )
       {
-      const SizeValueType   Ilab = LookupSet(cIt->label);
-      const OutputPixelType lab = m_Consecutive[Ilab];
-      oit.SetIndex(cIt->where);
-      // initialize the non labelled pixels
-      for (; fstart != oit; ++fstart )
-        {
-        fstart.Set(m_BackgroundValue);
-        }
-      for ( SizeValueType i = 0; i < (SizeValueType) cIt->length; ++i, ++oit )
+      ImageLinearIteratorWithIndex< OutputImageType > oit(output, region);
+      oit.SetDirection(0);
+      for ( SizeValueType lineId = firstLine; lineId < lastLinePlus1; ++lineId )
         {
-        oit.Set(lab);
+        oit.SetIndex( this->LineIndex(region, lineId) );
+        // now fill the labelled sections
+        for ( typename lineEncoding::const_iterator cIt = m_LineMap[lineId].begin(); cIt != m_LineMap[lineId].end(); ++cIt )
+          {
+          const OutputPixelType lab = static_cast< OutputPixelType >( m_Consecutive[LookupSet(cIt->label)] );
+          // initialize the non labelled pixels
+          for (; oit.GetIndex()[0] < cIt->where[0]; ++oit )
+            {
+            oit.Set(m_BackgroundValue);
+            }
+          for ( SizeValueType i = 0; i < (SizeValueType) cIt->length; ++i, ++oit )
+            {
+            oit.Set(lab);
+            }
+          }
+        // fill the rest of the line with background value
+        for (; !oit.IsAtEndOfLine(); ++oit )
+          {
+          oit.Set(m_BackgroundValue);
+          }
         }
-      fstart = oit;
-      //++fstart;
-      }
-    progress.CompletedPixel();
-    }
-  // fill the rest of the image with background value
-  for (; fstart != fend; ++fstart )
-    {
-    fstart.Set(m_BackgroundValue);
-    }
+      }, nullptr );
+
+  m_LineMap.clear();
+  m_UnionFind.clear();
+  m_Consecutive.clear();
+  this->UpdateProgress(1.0f);
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-void
+typename ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >::IndexType
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::AfterThreadedGenerateData()
+::LineIndex(const RegionType & region, SizeValueType lineId) const
 {
-  m_NumberOfLabels.clear();
-  m_Barrier = nullptr;
-  m_LineMap.clear();
-  m_Input = nullptr;
+  IndexType index = region.GetIndex();
+  for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+    index[d] += static_cast< IndexValueType >( lineId % region.GetSize(d) );
+    lineId /= region.GetSize(d);
+    }
+  return index;
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
@@ -585,51 +432,90 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 }
 
 // union find related functions
-template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-void
-ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::InsertSet(const LabelType label)
-{
-  m_UnionFind[label] = label;
-}
-
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
 SizeValueType
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 ::CreateConsecutive()
 {
-  m_Consecutive = UnionFindType( m_UnionFind.size() );
-
-  SizeValueType CLab = 0;
-  SizeValueType count = 0;
-  for ( SizeValueType I = 1; I < m_UnionFind.size(); I++ )
+  // The roots are numbered in increasing order, skipping the background
+  // value. The labels are split in chunks: the roots of each chunk are
+  // counted, then numbered from the number of roots of the previous chunks.
+  const SizeValueType numberOfLabels = m_UnionFind.size();
+  m_Consecutive = ConsecutiveType( numberOfLabels );
+  if ( numberOfLabels <= 1 )
     {
-    SizeValueType L = m_UnionFind[I];
-    if ( L == I )
+    return 0;
+    }
+
+  const SizeValueType chunkSize = 65536;
+  const SizeValueType numberOfChunks = ( numberOfLabels - 1 + chunkSize - 1 ) / chunkSize;
+  std::vector< SizeValueType > rootCounts( numberOfChunks + 1, 0 );
+
+  MultiThreaderBase *multiThreader = this->GetMultiThreader();
+  multiThreader->ParallelizeArray( 0, numberOfChunks,
+    [this, &rootCounts, numberOfLabels, chunkSize]( SizeValueType chunk )
       {
-      if ( CLab == static_cast< SizeValueType >( m_BackgroundValue ) )
+      const SizeValueType last = std::min( 1 + ( chunk + 1 ) * chunkSize, numberOfLabels );
+      SizeValueType count = 0;
+      for ( SizeValueType I = 1 + chunk * chunkSize; I < last; I++ )
         {
-        ++CLab;
+        if ( m_UnionFind[I].load(std::memory_order_relaxed) == I )
+          {
+          ++count;
+          }
         }
-      m_Consecutive[L] = CLab;
-      ++CLab;
-      ++count;
-      }
+      rootCounts[chunk + 1] = count;
+      }, nullptr );
+
+  for ( SizeValueType chunk = 0; chunk < numberOfChunks; ++chunk )
+    {
+    rootCounts[chunk + 1] += rootCounts[chunk];
     }
-  return count;
+
+  const auto background = static_cast< SizeValueType >( m_BackgroundValue );
+  multiThreader->ParallelizeArray( 0, numberOfChunks,
+    [this, &rootCounts, numberOfLabels, chunkSize, background]( SizeValueType chunk )
+      {
+      const SizeValueType last = std::min( 1 + ( chunk + 1 ) * chunkSize, numberOfLabels );
+      SizeValueType CLab = rootCounts[chunk];
+      for ( SizeValueType I = 1 + chunk * chunkSize; I < last; I++ )
+        {
+        if ( m_UnionFind[I].load(std::memory_order_relaxed) == I )
+          {
+          m_Consecutive[I] = CLab < background ? CLab : CLab + 1;
+          ++CLab;
+          }
+        }
+      }, nullptr );
+
+  return rootCounts[numberOfChunks];
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-SizeValueType
+typename ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >::LabelType
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::LookupSet(const LabelType label)
+::LookupSet(LabelType label)
 {
-  // recursively set the equivalence if necessary
-  if ( label != m_UnionFind[label] )
+  // Find the root, then link the visited labels to it. The root remains
+  // an ancestor of these labels even if another thread links it meanwhile,
+  // so the links stay valid without compare-and-swap.
+  LabelType root = label;
+  LabelType parent = m_UnionFind[root].load(std::memory_order_relaxed);
+  while ( parent != root )
     {
-    m_UnionFind[label] = this->LookupSet(m_UnionFind[label]);
+    root = parent;
+    parent = m_UnionFind[root].load(std::memory_order_relaxed);
     }
-  return ( m_UnionFind[label] );
+  while ( label != root )
+    {
+    parent = m_UnionFind[label].load(std::memory_order_relaxed);
+    if ( parent != root )
+      {
+      m_UnionFind[label].store(root, std::memory_order_relaxed);
+      }
+    label = parent;
+    }
+  return root;
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
@@ -637,16 +523,27 @@ void
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 ::LinkLabels(const LabelType lab1, const LabelType lab2)
 {
-  SizeValueType E1 = this->LookupSet(lab1);
-  SizeValueType E2 = this->LookupSet(lab2);
-
-  if ( E1 < E2 )
-    {
-    m_UnionFind[E2] = E1;
-    }
-  else
+  // Link the larger root to the smaller one, unless another thread linked
+  // it meanwhile, in which case the roots are looked up again.
+  LabelType E1 = lab1;
+  LabelType E2 = lab2;
+  for (;; )
     {
-    m_UnionFind[E1] = E2;
+    E1 = this->LookupSet(E1);
+    E2 = this->LookupSet(E2);
+    if ( E1 == E2 )
+      {
+      return;
+      }
+    if ( E1 > E2 )
+      {
+      std::swap(E1, E2);
+      }
+    LabelType expected = E2;
+    if ( m_UnionFind[E2].compare_exchange_strong(expected, E1) )
+      {
+      return;
+      }
     }
 }
 
@@ -67,9 +67,12 @@ namespace itk
  * controlled via methods in the superclass,
  * InPlaceImageFilter::InPlaceOn() and InPlaceImageFilter::InPlaceOff().
  *
+ * The objects are counted and relabeled in parallel. When the sorting by
+ * size is disabled, the objects are kept in the order of their labels.
+ *
  * \sa ConnectedComponentImageFilter, BinaryThresholdImageFilter, ThresholdImageFilter
  *
- * \ingroup SingleThreaded
+ * \ingroup MultiThreaded
  * \ingroup ITKConnectedComponents
  *
  * \wiki
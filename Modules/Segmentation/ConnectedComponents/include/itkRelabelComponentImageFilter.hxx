@@ -21,9 +21,9 @@
 #include "itkRelabelComponentImageFilter.h"
 #include "itkImageRegionIterator.h"
 #include "itkNumericTraits.h"
-#include "itkProgressReporter.h"
 #include "itksys/hash_map.hxx"
-#include <map>
+#include <algorithm>
+#include <mutex>
 
 namespace itk
 {
@@ -50,24 +50,17 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
 {
   SizeValueType i;
 
-  // Use a map to keep track of the size of each object.  Object
-  // number -> ObjectType (which has Object number and the two sizes)
-  using MapType = itksys::hash_map< LabelType, RelabelComponentObjectType >;
+  // Use a map to keep track of the number of pixels of each object.
+  using MapType = itksys::hash_map< LabelType, SizeValueType >;
   MapType sizeMap;
   typename MapType::iterator mapIt;
-  using MapValueType = typename MapType::value_type;
 
   // Get the input and the output
   typename TInputImage::ConstPointer input = this->GetInput();
   typename TOutputImage::Pointer output = this->GetOutput();
 
-  // Setup a progress reporter.  We have 2 stages to the algorithm so
-  // use the total number of pixels accessed. We walk the entire input
-  // in the first pass, then walk just the output requested region in
-  // the second pass.
-  ProgressReporter progress( this, 0,
-                             input->GetRequestedRegion().GetNumberOfPixels()
-                             + output->GetRequestedRegion().GetNumberOfPixels() );
+  MultiThreaderBase *multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   // Calculate the size of pixel
   float physicalPixelSize = 1.0;
@@ -76,46 +69,44 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     physicalPixelSize *= input->GetSpacing()[i];
     }
 
-  RelabelComponentObjectType initialSize;
-  initialSize.m_SizeInPixels = 1;
-  initialSize.m_SizeInPhysicalUnits = physicalPixelSize;
-
   // First pass: walk the entire input image and determine what
   // labels are used and the number of pixels used in each label.
-  //
-
-  // walk the input
-  ImageRegionConstIterator< InputImageType > it( input, input->GetRequestedRegion() );
-  it.GoToBegin();
-
-  while ( !it.IsAtEnd() )
-    {
-    // Get the input pixel value
-    const auto inputValue = static_cast< LabelType >( it.Get() );
-
-    // if the input pixel is not the background
-    if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
+  // Each work unit counts the pixels of its region in its own map, which
+  // is then added to the map of the whole image.
+  std::mutex sizeMapMutex;
+  multiThreader->template ParallelizeImageRegion< ImageDimension >( input->GetRequestedRegion(),
+    [&input, &sizeMap, &sizeMapMutex]( const RegionType & region )
       {
-      // Does this label already exist
-      mapIt = sizeMap.find(inputValue);
-      if ( mapIt == sizeMap.end() )
+      MapType localSizeMap;
+      ImageRegionConstIterator< InputImageType > it( input, region );
+
+      // Consecutive pixels often have the same label.
+      LabelType       previousValue = NumericTraits< LabelType >::ZeroValue();
+      SizeValueType * previousSize = nullptr;
+      while ( !it.IsAtEnd() )
         {
-        // label is not currently in the map
-        initialSize.m_ObjectNumber = inputValue;
-        sizeMap.insert( MapValueType(inputValue, initialSize) );
+        // Get the input pixel value
+        const auto inputValue = static_cast< LabelType >( it.Get() );
+
+        // if the input pixel is not the background
+        if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
+          {
+          if ( previousSize == nullptr || inputValue != previousValue )
+            {
+            previousValue = inputValue;
+            previousSize = &localSizeMap[inputValue];
+            }
+          ++( *previousSize );
+          }
+        ++it;
         }
-      else
+
+      std::lock_guard< std::mutex > lock( sizeMapMutex );
+      for ( const auto & localSize : localSizeMap )
         {
-        // label is already in the map, update the values
-        ( *mapIt ).second.m_SizeInPixels++;
-        ( *mapIt ).second.m_SizeInPhysicalUnits += physicalPixelSize;
+        sizeMap[localSize.first] += localSize.second;
         }
-      }
-
-    // increment the iterators
-    ++it;
-    progress.CompletedPixel();
-    }
+      }, nullptr );
 
   // Now we need to reorder the labels. Use the m_ObjectSortingOrder
   // to determine how to sort the objects. Define a map for converting
@@ -125,24 +116,38 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
   VectorType sizeVector;
   typename VectorType::iterator vit;
 
-  using RelabelMapType = std::map< LabelType, LabelType >;
+  using RelabelMapType = itksys::hash_map< LabelType, LabelType >;
   using RelabelMapValueType = typename RelabelMapType::value_type;
   RelabelMapType relabelMap;
 
   // copy the original object map to a vector so we can sort it
+  sizeVector.reserve( sizeMap.size() );
   for ( mapIt = sizeMap.begin(); mapIt != sizeMap.end(); ++mapIt )
     {
-    sizeVector.push_back( ( *mapIt ).second );
+    RelabelComponentObjectType object;
+    object.m_ObjectNumber = ( *mapIt ).first;
+    object.m_SizeInPixels = ( *mapIt ).second;
+    object.m_SizeInPhysicalUnits = ( *mapIt ).second * physicalPixelSize;
+    sizeVector.push_back( object );
     }
 
   // Sort the objects by size by default, unless m_SortByObjectSize
-  // is set to false.
+  // is set to false, in which case they are sorted by label.
   if ( m_SortByObjectSize )
     {
     std::sort(  sizeVector.begin(),
                 sizeVector.end(),
                 RelabelComponentSizeInPixelsComparator() );
     }
+  else
+    {
+    std::sort(  sizeVector.begin(),
+                sizeVector.end(),
+                []( const RelabelComponentObjectType & a, const RelabelComponentObjectType & b )
+                  {
+                  return a.m_ObjectNumber < b.m_ObjectNumber;
+                  } );
+    }
 
   // create a lookup table to map the input label to the output label.
   // cache the object sizes for later access by the user
@@ -193,35 +198,39 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
 
   // Remap the labels.  Note we only walk the region of the output
   // that was requested.  This may be a subset of the input image.
-  OutputPixelType                        outputValue;
-  ImageRegionIterator< OutputImageType > oit;
-  oit = ImageRegionIterator< OutputImageType >( output,
-                                                output->GetRequestedRegion() );
-  it = ImageRegionConstIterator< InputImageType >( input,
-                                                   output->GetRequestedRegion() );
-
-  it.GoToBegin();
-  oit.GoToBegin();
-  while ( !oit.IsAtEnd() )
-    {
-    const auto inputValue = static_cast< LabelType >( it.Get() );
-
-    if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
-      {
-      // lookup the mapped label
-      outputValue = static_cast< OutputPixelType >( relabelMap[inputValue] );
-      oit.Set(outputValue);
-      }
-    else
+  const RelabelMapType & constRelabelMap = relabelMap;
+  multiThreader->template ParallelizeImageRegion< ImageDimension >( output->GetRequestedRegion(),
+    [&input, &output, &constRelabelMap]( const RegionType & region )
       {
-      oit.Set(inputValue);
-      }
+      ImageRegionConstIterator< InputImageType > it( input, region );
+      ImageRegionIterator< OutputImageType >     oit( output, region );
 
-    // increment the iterators
-    ++it;
-    ++oit;
-    progress.CompletedPixel();
-    }
+      LabelType       previousValue = NumericTraits< LabelType >::ZeroValue();
+      OutputPixelType previousOutputValue = NumericTraits< OutputPixelType >::ZeroValue();
+      while ( !oit.IsAtEnd() )
+        {
+        const auto inputValue = static_cast< LabelType >( it.Get() );
+
+        if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
+          {
+          // lookup the mapped label
+          if ( inputValue != previousValue )
+            {
+            previousValue = inputValue;
+            previousOutputValue = static_cast< OutputPixelType >( constRelabelMap.find( inputValue )->second );
+            }
+          oit.Set(previousOutputValue);
+          }
+        else
+          {
+          oit.Set(inputValue);
+          }
+
+        // increment the iterators
+        ++it;
+        ++oit;
+        }
+      }, this );
 }
 
 template< typename TInputImage, typename TOutputImage >
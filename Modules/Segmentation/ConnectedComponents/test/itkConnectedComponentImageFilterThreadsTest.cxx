@@ -0,0 +1,157 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkConnectedComponentImageFilter.h"
+#include "itkRelabelComponentImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include <queue>
+
+// Label a random image with several numbers of threads, and compare the
+// labels to a flood fill in raster order. Then check that the relabeled
+// objects are sorted by size and do not depend on the number of threads.
+
+namespace
+{
+
+constexpr unsigned int Dimension = 3;
+using InputImageType = itk::Image< unsigned char, Dimension >;
+using LabelImageType = itk::Image< unsigned short, Dimension >;
+
+LabelImageType::Pointer
+FloodFill( const InputImageType * input, bool fullyConnected )
+{
+  const InputImageType::RegionType region = input->GetBufferedRegion();
+  LabelImageType::Pointer labels = LabelImageType::New();
+  labels->SetRegions( region );
+  labels->Allocate( true );
+
+  unsigned short label = 0;
+  itk::ImageRegionConstIteratorWithIndex< InputImageType > it( input, region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() == 0 || labels->GetPixel( it.GetIndex() ) != 0 )
+      {
+      continue;
+      }
+    ++label;
+    std::queue< InputImageType::IndexType > queue;
+    queue.push( it.GetIndex() );
+    labels->SetPixel( it.GetIndex(), label );
+    while ( !queue.empty() )
+      {
+      const InputImageType::IndexType index = queue.front();
+      queue.pop();
+      for ( int n = 0; n < 27; ++n )
+        {
+        InputImageType::OffsetType offset = { { n % 3 - 1, n / 3 % 3 - 1, n / 9 - 1 } };
+        const int distance = std::abs( offset[0] ) + std::abs( offset[1] ) + std::abs( offset[2] );
+        if ( distance == 0 || ( !fullyConnected && distance > 1 ) )
+          {
+          continue;
+          }
+        const InputImageType::IndexType neighbor = index + offset;
+        if ( region.IsInside( neighbor ) && input->GetPixel( neighbor ) != 0 && labels->GetPixel( neighbor ) == 0 )
+          {
+          labels->SetPixel( neighbor, label );
+          queue.push( neighbor );
+          }
+        }
+      }
+    }
+  return labels;
+}
+
+bool
+SameImage( const LabelImageType * image1, const LabelImageType * image2 )
+{
+  itk::ImageRegionConstIteratorWithIndex< LabelImageType > it( image1, image1->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != image2->GetPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Label " << it.Get() << " instead of " << image2->GetPixel( it.GetIndex() ) << " at "
+                << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkConnectedComponentImageFilterThreadsTest( int, char * [] )
+{
+  InputImageType::Pointer input = InputImageType::New();
+  InputImageType::IndexType start = { { 5, -3, 2 } };
+  InputImageType::SizeType size = { { 37, 29, 23 } };
+  input->SetRegions( InputImageType::RegionType( start, size ) );
+  input->Allocate();
+  itk::ImageRegionIteratorWithIndex< InputImageType > it( input, input->GetBufferedRegion() );
+  unsigned int seed = 12345;
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    seed = seed * 1103515245 + 12345;
+    it.Set( ( seed >> 16 ) % 100 < 35 ? 1 : 0 );
+    }
+
+  using FilterType = itk::ConnectedComponentImageFilter< InputImageType, LabelImageType >;
+  using RelabelFilterType = itk::RelabelComponentImageFilter< LabelImageType, LabelImageType >;
+  const bool fullyConnectedValues[] = { false, true };
+  for ( bool fullyConnected : fullyConnectedValues )
+    {
+    LabelImageType::Pointer expected = FloodFill( input, fullyConnected );
+
+    LabelImageType::Pointer relabeled;
+    for ( itk::ThreadIdType numberOfThreads = 1; numberOfThreads <= 8; numberOfThreads += 3 )
+      {
+      std::cout << "FullyConnected: " << fullyConnected << ", threads: " << numberOfThreads << std::endl;
+
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( input );
+      filter->SetFullyConnected( fullyConnected );
+      filter->SetNumberOfThreads( numberOfThreads );
+      TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+      if ( !SameImage( filter->GetOutput(), expected ) )
+        {
+        return EXIT_FAILURE;
+        }
+
+      RelabelFilterType::Pointer relabel = RelabelFilterType::New();
+      relabel->SetInput( filter->GetOutput() );
+      relabel->SetMinimumObjectSize( 2 );
+      relabel->SetNumberOfThreads( numberOfThreads );
+      TRY_EXPECT_NO_EXCEPTION( relabel->Update() );
+      const RelabelFilterType::ObjectSizeInPixelsContainerType & sizes = relabel->GetSizeOfObjectsInPixels();
+      TEST_EXPECT_EQUAL( filter->GetObjectCount(), relabel->GetOriginalNumberOfObjects() );
+      TEST_EXPECT_TRUE( std::is_sorted( sizes.rbegin(), sizes.rend() ) );
+      TEST_EXPECT_TRUE( sizes.empty() || sizes.back() >= 2 );
+      if ( relabeled.IsNull() )
+        {
+        relabeled = relabel->GetOutput();
+        }
+      else if ( !SameImage( relabel->GetOutput(), relabeled ) )
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkHierarchicalQueue_h
+#define itkHierarchicalQueue_h
+
+#include "itkIntTypes.h"
+#include <map>
+#include <type_traits>
+#include <vector>
+
+namespace itk
+{
+/** \class HierarchicalQueue
+ * \brief Priority queue of the morphological flooding algorithms.
+ *
+ * The hierarchical queue (FAH, for "File d'Attente Hierarchique") pops the
+ * values of the smallest priority first, and the values of the same
+ * priority in the order they were pushed. It is described in Chapter 9.2
+ * of Pierre Soille's book "Morphological Image Analysis: Principles and
+ * Applications", Second Edition, Springer, 2003.
+ *
+ * When the priorities are integers and SetPriorityRange() declares a range
+ * of at most MaximumNumberOfBuckets values, the queue of each priority is a
+ * bucket of an array indexed by the priority: pushing and popping take a
+ * constant time. Otherwise the queues are stored in a std::map.
+ *
+ * \ingroup ITKWatersheds
+ */
+template< typename TPriority, typename TValue >
+class HierarchicalQueue
+{
+public:
+  using PriorityType = TPriority;
+  using ValueType = TValue;
+
+  /** Largest range of priorities stored in buckets. */
+  static constexpr SizeValueType MaximumNumberOfBuckets = 65536;
+
+  /** Declare the range of the priorities of the values to push. Clears the
+   * queue. */
+  void SetPriorityRange(const PriorityType & minimum, const PriorityType & maximum)
+  {
+    m_Buckets.clear();
+    m_Map.clear();
+    m_Size = 0;
+    m_Front = 0;
+    if ( std::is_integral< PriorityType >::value && !( maximum < minimum )
+         && static_cast< double >( maximum ) - static_cast< double >( minimum ) < MaximumNumberOfBuckets )
+      {
+      m_Minimum = minimum;
+      m_Buckets.resize( static_cast< SizeValueType >( maximum - minimum ) + 1 );
+      }
+  }
+
+  /** Add a value at the end of the queue of its priority. With buckets, the
+   * priority must be in the declared range. */
+  void Push(const PriorityType & priority, const ValueType & value)
+  {
+    if ( !m_Buckets.empty() )
+      {
+      const auto bucket = static_cast< SizeValueType >( priority - m_Minimum );
+      m_Buckets[bucket].m_Values.push_back(value);
+      if ( bucket < m_Front )
+        {
+        m_Front = bucket;
+        }
+      }
+    else
+      {
+      m_Map[priority].m_Values.push_back(value);
+      }
+    ++m_Size;
+  }
+
+  bool Empty() const
+  {
+    return m_Size == 0;
+  }
+
+  SizeValueType Size() const
+  {
+    return m_Size;
+  }
+
+  /** Priority of the front value. The queue must not be empty. */
+  PriorityType GetFrontPriority()
+  {
+    if ( !m_Buckets.empty() )
+      {
+      this->SkipEmptyBuckets();
+      return static_cast< PriorityType >( m_Minimum + m_Front );
+      }
+    return m_Map.begin()->first;
+  }
+
+  /** Remove the front value and return it. The queue must not be empty. */
+  ValueType Pop()
+  {
+    --m_Size;
+    if ( !m_Buckets.empty() )
+      {
+      this->SkipEmptyBuckets();
+      return m_Buckets[m_Front].Pop();
+      }
+    const auto     first = m_Map.begin();
+    const ValueType value = first->second.Pop();
+    if ( first->second.Empty() )
+      {
+      m_Map.erase(first);
+      }
+    return value;
+  }
+
+private:
+  // The values of a priority. The storage is reused while the values of
+  // the priority are popped and pushed again.
+  struct FIFO
+  {
+    std::vector< ValueType > m_Values;
+    SizeValueType            m_First = 0;
+
+    bool Empty() const
+    {
+      return m_First == m_Values.size();
+    }
+
+    ValueType Pop()
+    {
+      const ValueType value = m_Values[m_First++];
+      if ( this->Empty() )
+        {
+        m_Values.clear();
+        m_First = 0;
+        }
+      return value;
+    }
+  };
+
+  // Move the front to the first non empty bucket, and release the storage
+  // of the empty buckets.
+  void SkipEmptyBuckets()
+  {
+    while ( m_Buckets[m_Front].Empty() )
+      {
+      std::vector< ValueType >().swap(m_Buckets[m_Front].m_Values);
+      ++m_Front;
+      }
+  }
+
+  std::vector< FIFO >            m_Buckets;
+  std::map< PriorityType, FIFO > m_Map;
+  PriorityType                   m_Minimum{};
+  SizeValueType                  m_Front = 0;
+  SizeValueType                  m_Size = 0;
+};
+} // end namespace itk
+
+#endif
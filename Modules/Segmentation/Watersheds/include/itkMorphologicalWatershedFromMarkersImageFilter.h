@@ -64,6 +64,11 @@ namespace itk
  * Chapter 9.2 of Pierre Soille's book "Morphological Image Analysis:
  * Principles and Applications", Second Edition, Springer, 2003.
  *
+ * The pixels are flooded in the order of a hierarchical queue. With integer
+ * input pixels, the queue is an array of FIFOs indexed by the pixel values
+ * (see HierarchicalQueue), and the flooding runs in linear time. The output
+ * does not depend on the number of threads.
+ *
  * This code was contributed in the Insight Journal paper:
  * "The watershed transform in ITK - discussion and new developments"
  * by Beare R., Lehmann G.
@@ -173,7 +178,8 @@ protected:
    * \sa ProcessObject::EnlargeOutputRequestedRegion() */
   void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) override;
 
-  /** The filter is single threaded. */
+  /** The initialization stage is multithreaded, the flooding is single
+   * threaded. */
   void GenerateData() override;
 
 private:
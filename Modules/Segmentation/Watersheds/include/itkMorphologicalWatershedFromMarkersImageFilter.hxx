@@ -19,16 +19,10 @@
 #define itkMorphologicalWatershedFromMarkersImageFilter_hxx
 
 #include <algorithm>
-#include <queue>
-#include <list>
+#include <vector>
 #include "itkMorphologicalWatershedFromMarkersImageFilter.h"
+#include "itkHierarchicalQueue.h"
 #include "itkProgressReporter.h"
-#include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkConstShapedNeighborhoodIterator.h"
-#include "itkConstantBoundaryCondition.h"
-#include "itkSize.h"
-#include "itkConnectedComponentAlgorithm.h"
 
 namespace itk
 {
@@ -91,8 +85,8 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   // The 2 algorithms are very similar and so are integrated in the same filter.
 
   //---------------------------------------------------------------------------
-  // declare the vars common to the 2 algorithms: constants, iterators,
-  // hierarchical queue, progress reporter, and status image
+  // declare the vars common to the 2 algorithms: constants, neighbors,
+  // pixel flags, hierarchical queue and progress reporter
   // also allocate output images and verify preconditions
   //---------------------------------------------------------------------------
 
@@ -109,336 +103,303 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   const InputImageType * inputImage = this->GetInput();
   LabelImageType * outputImage = this->GetOutput();
 
-  // Set up the progress reporter
-  // we can't found the exact number of pixel to process in the 2nd pass, so we
-  // use the maximum number possible.
-  ProgressReporter progress(this, 0, markerImage->GetRequestedRegion().GetNumberOfPixels() * 2);
-
   // mask and marker must have the same size
   if ( markerImage->GetRequestedRegion().GetSize() != inputImage->GetRequestedRegion().GetSize() )
     {
     itkExceptionMacro(<< "Marker and input must have the same size.");
     }
 
-  // FAH (in french: File d'Attente Hierarchique)
-  using QueueType = std::queue< IndexType >;
-  using MapType = std::map< InputImagePixelType, QueueType >;
-  MapType fah;
-
-  // the radius which will be used for all the shaped iterators
-  Size< ImageDimension > radius;
-  radius.Fill(1);
-
-  // iterator for the marker image
-  using MarkerIteratorType = ConstShapedNeighborhoodIterator< LabelImageType >;
-  typename MarkerIteratorType::ConstIterator nmIt;
-  MarkerIteratorType
-  markerIt( radius, markerImage, markerImage->GetRequestedRegion() );
-  // add a boundary constant to avoid adding pixels on the border in the fah
-  ConstantBoundaryCondition< LabelImageType > lcbc;
-  lcbc.SetConstant( NumericTraits< LabelImagePixelType >::max() );
-  markerIt.OverrideBoundaryCondition(&lcbc);
-  setConnectivity(&markerIt, m_FullyConnected);
-
-  // iterator for the input image
-  using InputIteratorType = ConstShapedNeighborhoodIterator< InputImageType >;
-  InputIteratorType
-  inputIt( radius, inputImage, inputImage->GetRequestedRegion() );
-  typename InputIteratorType::ConstIterator niIt;
-  setConnectivity(&inputIt, m_FullyConnected);
-
-  // iterator for the output image
-  using OutputIteratorType = ShapedNeighborhoodIterator< LabelImageType >;
-  using OffsetType = typename OutputIteratorType::OffsetType;
-  typename OutputIteratorType::Iterator noIt;
-  OutputIteratorType
-  outputIt( radius, outputImage, outputImage->GetRequestedRegion() );
-  setConnectivity(&outputIt, m_FullyConnected);
+  // the pixels are accessed through their offsets in the buffers, which all
+  // hold the whole images
+  const LabelImageRegionType region = outputImage->GetBufferedRegion();
+  if ( markerImage->GetBufferedRegion().GetSize() != region.GetSize()
+       || inputImage->GetBufferedRegion().GetSize() != region.GetSize() )
+    {
+    itkExceptionMacro(<< "Marker, input and output buffers must have the same size.");
+    }
+  const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+  if ( numberOfPixels == 0 )
+    {
+    return;
+    }
+  const LabelImagePixelType *marker = markerImage->GetBufferPointer();
+  const InputImagePixelType *input = inputImage->GetBufferPointer();
+  LabelImagePixelType *      output = outputImage->GetBufferPointer();
+
+  // the neighbors of a pixel, in the order of the shaped neighborhood
+  // iterators configured by setConnectivity(), which is the order the
+  // pixels enter the FAH
+  using OffsetType = typename LabelImageType::OffsetType;
+  std::vector< OffsetType >      neighbors;
+  std::vector< OffsetValueType > neighborOffsets;
+  const OffsetValueType *        offsetTable = outputImage->GetOffsetTable();
+  SizeValueType                  neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    neighborhoodSize *= 3;
+    }
+  for ( SizeValueType n = 0; n < neighborhoodSize; ++n )
+    {
+    OffsetType      offset;
+    OffsetValueType linearOffset = 0;
+    unsigned int    nonZero = 0;
+    SizeValueType   remainder = n;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      offset[d] = static_cast< OffsetValueType >( remainder % 3 ) - 1;
+      remainder /= 3;
+      nonZero += offset[d] != 0;
+      linearOffset += offset[d] * offsetTable[d];
+      }
+    if ( nonZero == 0 || ( !m_FullyConnected && nonZero > 1 ) )
+      {
+      continue;
+      }
+    neighbors.push_back(offset);
+    neighborOffsets.push_back(linearOffset);
+    }
+  const unsigned int numberOfNeighbors = static_cast< unsigned int >( neighbors.size() );
+
+  // the state of each pixel: on the border of the image, where some
+  // neighbors are outside the image, and already processed (only used by
+  // Meyer's algorithm)
+  enum { Border = 1, Processed = 2 };
+  std::vector< unsigned char > flags(numberOfPixels);
 
   //---------------------------------------------------------------------------
-  // Meyer's algorithm
+  // first stage, multithreaded over blocks of lines:
+  //  - copy markers pixels to output image, and mark the other pixels as
+  //    watershed
+  //  - with Meyer's algorithm, set markers pixels to already processed status
+  //    and find the background pixels with marker pixel(s) in their
+  //    neighborhood
+  //  - with Beucher's algorithm, find the markers pixels with background
+  //    pixel(s) in their neighborhood
+  //  - find the range of the input values
+  // The pixels found are added to the FAH in a serial pass, in the order of
+  // a raster scan, so that the result does not depend on the number of
+  // threads.
   //---------------------------------------------------------------------------
-  if ( m_MarkWatershedLine )
+  const typename LabelImageRegionType::SizeType size = region.GetSize();
+  const SizeValueType                           lineLength = size[0];
+  const SizeValueType                           numberOfLines = numberOfPixels / lineLength;
+  const SizeValueType                           linesPerBlock = std::max< SizeValueType >(1, 16384 / lineLength);
+  const SizeValueType                           numberOfBlocks = ( numberOfLines + linesPerBlock - 1 ) / linesPerBlock;
+
+  std::vector< std::vector< OffsetValueType > > blockCandidates(numberOfBlocks);
+  std::vector< InputImagePixelType >            blockMinimum(numberOfBlocks);
+  std::vector< InputImagePixelType >            blockMaximum(numberOfBlocks);
+  const bool                                    markWatershedLine = m_MarkWatershedLine;
+
+  auto initializeBlock = [&]( SizeValueType block )
     {
-    // first stage:
-    //  - set markers pixels to already processed status
-    //  - copy markers pixels to output image
-    //  - init FAH with indexes of background pixels with marker pixel(s) in
-    //    their neighborhood
-
-    ConstantBoundaryCondition< LabelImageType > lcbc2;
-    // outside pixel are watershed so they won't be use to find real watershed
-    // pixels
-    lcbc2.SetConstant(wsLabel);
-    outputIt.OverrideBoundaryCondition(&lcbc2);
-
-    // create a temporary image to store the state of each pixel (processed or
-    // not)
-    using StatusImageType = Image< bool, ImageDimension >;
-    typename StatusImageType::Pointer statusImage = StatusImageType::New();
-    statusImage->SetRegions( markerImage->GetLargestPossibleRegion() );
-    statusImage->Allocate();
-
-    // iterator for the status image
-    using StatusIteratorType = ShapedNeighborhoodIterator< StatusImageType >;
-    typename StatusIteratorType::Iterator nsIt;
-    StatusIteratorType
-                                                 statusIt( radius, statusImage, outputImage->GetRequestedRegion() );
-    ConstantBoundaryCondition< StatusImageType > bcbc;
-    bcbc.SetConstant(true);    // outside pixel are already processed
-    statusIt.OverrideBoundaryCondition(&bcbc);
-    setConnectivity(&statusIt, m_FullyConnected);
-
-    // the status image must be initialized before the first stage. In the
-    // first stage, the set to true are the neighbors of the marker (and the
-    // marker) so it's difficult (impossible ?) to init the status image at
-    // the same time
-    // the overhead should be small
-    statusImage->FillBuffer(false);
-
-    for ( markerIt.GoToBegin(), statusIt.GoToBegin(), outputIt.GoToBegin(), inputIt.GoToBegin();
-          !markerIt.IsAtEnd();
-          ++markerIt, ++outputIt )
+    const SizeValueType            firstLine = block * linesPerBlock;
+    const SizeValueType            lastLinePlus1 = std::min(firstLine + linesPerBlock, numberOfLines);
+    std::vector< OffsetValueType > & candidates = blockCandidates[block];
+    InputImagePixelType            minimum = input[firstLine * lineLength];
+    InputImagePixelType            maximum = minimum;
+    for ( SizeValueType line = firstLine; line < lastLinePlus1; ++line )
       {
-      LabelImagePixelType markerPixel = markerIt.GetCenterPixel();
-      if ( markerPixel != bgLabel )
+      bool          lineOnBorder = false;
+      SizeValueType remainder = line;
+      for ( unsigned int d = 1; d < ImageDimension; ++d )
         {
-        IndexType idx = markerIt.GetIndex();
-
-        // move the iterators to the right place
-        OffsetType shift = idx - statusIt.GetIndex();
-        statusIt += shift;
-        inputIt += shift;
-
-        // this pixel belongs to a marker
-        // mark it as already processed
-        statusIt.SetCenterPixel(true);
-        // copy it to the output image
-        outputIt.SetCenterPixel(markerPixel);
-        // and increase progress because this pixel will not be used in the
-        // flooding stage.
-        progress.CompletedPixel();
-
-        // search the background pixels in the neighborhood
-        for ( nmIt = markerIt.Begin(), nsIt = statusIt.Begin(), niIt = inputIt.Begin();
-              nmIt != markerIt.End();
-              nmIt++, nsIt++, niIt++ )
-          {
-          if ( !nsIt.Get() && nmIt.Get() == bgLabel )
-            {
-            // this neighbor is a background pixel and is not already
-            // processed; add its index to fah
-            fah[niIt.Get()].push( markerIt.GetIndex()
-                                  + nmIt.GetNeighborhoodOffset() );
-            // mark it as already in the fah to avoid adding it several times
-            nsIt.Set(true);
-            }
-          }
+        const SizeValueType coordinate = remainder % size[d];
+        remainder /= size[d];
+        lineOnBorder |= coordinate == 0 || coordinate + 1 == size[d];
         }
-      else
+      const OffsetValueType lineStart = static_cast< OffsetValueType >( line * lineLength );
+      for ( SizeValueType x = 0; x < lineLength; ++x )
         {
-        // Some pixels may be never processed so, by default, non marked pixels
-        // must be marked as watershed
-        outputIt.SetCenterPixel(wsLabel);
-        }
-      // one more pixel done in the init stage
-      progress.CompletedPixel();
-      }
-    // fill the borders of the status image with "true"
-    //FillSides<StatusImageType>(statusImage, true);
-    // Now disable the boundary checks
-    //outputIt.NeedToUseBoundaryConditionOff();
-    //statusIt.NeedToUseBoundaryConditionOff();
-    //inputIt.NeedToUseBoundaryConditionOff();
-    // end of init stage
-
-    // flooding
-    // init all the iterators
-    outputIt.GoToBegin();
-    statusIt.GoToBegin();
-    inputIt.GoToBegin();
-
-    // and start flooding
-    while ( !fah.empty() )
-      {
-      // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
-      // and remove them from the fah
-      fah.erase( fah.begin() );
-
-      while ( !currentQueue.empty() )
-        {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
-
-        // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
-        outputIt += shift;
-        statusIt += shift;
-        inputIt += shift;
-
-        // iterate over the neighbors. If there is only one marker value, give
-        // that value to the pixel, else keep it as is (watershed line)
-        LabelImagePixelType marker = wsLabel;
-        bool                collision = false;
-        for ( noIt = outputIt.Begin(); noIt != outputIt.End(); noIt++ )
+        const OffsetValueType p = lineStart + static_cast< OffsetValueType >( x );
+        const bool            border = lineOnBorder || x == 0 || x + 1 == lineLength;
+        flags[p] = border ? Border : 0;
+        minimum = std::min(minimum, input[p]);
+        maximum = std::max(maximum, input[p]);
+
+        const LabelImagePixelType markerPixel = marker[p];
+        if ( markerPixel == bgLabel )
+          {
+          // Some pixels may be never processed so, by default, non marked
+          // pixels must be marked as watershed
+          output[p] = wsLabel;
+          continue;
+          }
+        output[p] = markerPixel;
+        IndexType index;
+        if ( border )
+          {
+          index = outputImage->ComputeIndex(p);
+          }
+        if ( markWatershedLine )
           {
-          LabelImagePixelType o = noIt.Get();
-          if ( o != wsLabel )
+          flags[p] |= Processed;
+          for ( unsigned int i = 0; i < numberOfNeighbors; ++i )
             {
-            if ( marker != wsLabel && o != marker )
+            if ( border && !region.IsInside(index + neighbors[i]) )
               {
-              collision = true;
-              break;
+              continue;
+              }
+            const OffsetValueType q = p + neighborOffsets[i];
+            if ( marker[q] == bgLabel )
+              {
+              candidates.push_back(q);
               }
-            else
-                  { marker = o; }
             }
           }
-        if ( !collision )
+        else
           {
-          // set the marker value
-          outputIt.SetCenterPixel(marker);
-          // and propagate to the neighbors
-          for ( niIt = inputIt.Begin(), nsIt = statusIt.Begin();
-                niIt != inputIt.End();
-                niIt++, nsIt++ )
+          for ( unsigned int i = 0; i < numberOfNeighbors; ++i )
             {
-            if ( !nsIt.Get() )
+            if ( border && !region.IsInside(index + neighbors[i]) )
+              {
+              continue;
+              }
+            if ( marker[p + neighborOffsets[i]] == bgLabel )
               {
-              // the pixel is not yet processed. add it to the fah
-              InputImagePixelType GrayVal = niIt.Get();
-              if ( GrayVal <= currentValue )
-                {
-                currentQueue.push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
-                }
-              else
-                {
-                fah[GrayVal].push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
-                }
-              // mark it as already in the fah
-              nsIt.Set(true);
+              candidates.push_back(p);
+              break;
               }
             }
           }
-        // one more pixel in the flooding stage
-        progress.CompletedPixel();
         }
       }
+    blockMinimum[block] = minimum;
+    blockMaximum[block] = maximum;
+    };
+
+  MultiThreaderBase *multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  multiThreader->ParallelizeArray(0, numberOfBlocks, initializeBlock, nullptr);
+
+  // FAH (in french: File d'Attente Hierarchique). With integer input pixels,
+  // the values are stored in an array of queues indexed by the input values.
+  using QueueType = HierarchicalQueue< InputImagePixelType, OffsetValueType >;
+  QueueType fah;
+  fah.SetPriorityRange( *std::min_element( blockMinimum.begin(), blockMinimum.end() ),
+                        *std::max_element( blockMaximum.begin(), blockMaximum.end() ) );
+  for ( auto & candidates : blockCandidates )
+    {
+    for ( const OffsetValueType q : candidates )
+      {
+      if ( !markWatershedLine )
+        {
+        fah.Push(input[q], q);
+        }
+      else if ( !( flags[q] & Processed ) )
+        {
+        // this neighbor is a background pixel and is not already in the fah;
+        // mark it to avoid adding it several times
+        fah.Push(input[q], q);
+        flags[q] |= Processed;
+        }
+      }
+    std::vector< OffsetValueType >().swap(candidates);
     }
 
+  // we can't found the exact number of pixel to process in the 2nd pass, so
+  // we use the maximum number possible.
+  ProgressReporter progress(this, 0, numberOfPixels, 100, 0.5f, 0.5f);
+
   //---------------------------------------------------------------------------
-  // Beucher's algorithm
+  // Meyer's algorithm
   //---------------------------------------------------------------------------
-  else
+  if ( markWatershedLine )
     {
-    // first stage:
-    //  - copy markers pixels to output image
-    //  - init FAH with indexes of pixels with background pixel in their
-    //    neighborhood
-
-    ConstantBoundaryCondition< LabelImageType > lcbc2;
-    // outside pixel are watershed so they won't be use to find real watershed
-    // pixels
-    lcbc2.SetConstant( NumericTraits< LabelImagePixelType >::max() );
-    outputIt.OverrideBoundaryCondition(&lcbc2);
-
-    for ( markerIt.GoToBegin(), outputIt.GoToBegin(), inputIt.GoToBegin();
-          !markerIt.IsAtEnd();
-          ++markerIt, ++outputIt )
+    // flooding. The pixels lower than the current value are flooded at the
+    // current value.
+    while ( !fah.Empty() )
       {
-      LabelImagePixelType markerPixel = markerIt.GetCenterPixel();
-      if ( markerPixel != bgLabel )
+      const InputImagePixelType currentValue = fah.GetFrontPriority();
+      const OffsetValueType     p = fah.Pop();
+      const bool                border = ( flags[p] & Border ) != 0;
+      IndexType                 index;
+      if ( border )
+        {
+        index = outputImage->ComputeIndex(p);
+        }
+
+      // iterate over the neighbors. If there is only one marker value, give
+      // that value to the pixel, else keep it as is (watershed line). The
+      // pixels outside the image are watershed.
+      LabelImagePixelType label = wsLabel;
+      bool                collision = false;
+      for ( unsigned int i = 0; i < numberOfNeighbors; ++i )
         {
-        IndexType  idx = markerIt.GetIndex();
-        OffsetType shift = idx - inputIt.GetIndex();
-        inputIt += shift;
-
-        // this pixels belongs to a marker
-        // copy it to the output image
-        outputIt.SetCenterPixel(markerPixel);
-        // search if it has background pixel in its neighborhood
-        bool haveBgNeighbor = false;
-        for ( nmIt = markerIt.Begin(); nmIt != markerIt.End(); nmIt++ )
+        if ( border && !region.IsInside(index + neighbors[i]) )
           {
-          if ( nmIt.Get() == bgLabel )
+          continue;
+          }
+        const LabelImagePixelType o = output[p + neighborOffsets[i]];
+        if ( o != wsLabel )
+          {
+          if ( label != wsLabel && o != label )
             {
-            haveBgNeighbor = true;
+            collision = true;
             break;
             }
-          }
-        if ( haveBgNeighbor )
-          {
-          // there is a background pixel in the neighborhood; add to fah
-          fah[inputIt.GetCenterPixel()].push( markerIt.GetIndex() );
-          }
-        else
-          {
-          // increase progress because this pixel will not be used in the
-          // flooding stage.
-          progress.CompletedPixel();
+          label = o;
           }
         }
-      else
+      if ( !collision )
         {
-        outputIt.SetCenterPixel(wsLabel);
+        // set the marker value
+        output[p] = label;
+        // and propagate to the neighbors which are not yet processed. The
+        // pixels outside the image are already processed.
+        for ( unsigned int i = 0; i < numberOfNeighbors; ++i )
+          {
+          if ( border && !region.IsInside(index + neighbors[i]) )
+            {
+            continue;
+            }
+          const OffsetValueType q = p + neighborOffsets[i];
+          if ( !( flags[q] & Processed ) )
+            {
+            fah.Push(std::max(input[q], currentValue), q);
+            // mark it as already in the fah
+            flags[q] |= Processed;
+            }
+          }
         }
+      // one more pixel in the flooding stage
       progress.CompletedPixel();
       }
-    // end of init stage
+    }
 
+  //---------------------------------------------------------------------------
+  // Beucher's algorithm
+  //---------------------------------------------------------------------------
+  else
+    {
     // flooding
-    // init all the iterators
-    outputIt.GoToBegin();
-    inputIt.GoToBegin();
-
-    // and start flooding
-    while ( !fah.empty() )
+    while ( !fah.Empty() )
       {
-      // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
-      // and remove them from the fah
-      fah.erase( fah.begin() );
+      const InputImagePixelType currentValue = fah.GetFrontPriority();
+      const OffsetValueType     p = fah.Pop();
+      const bool                border = ( flags[p] & Border ) != 0;
+      IndexType                 index;
+      if ( border )
+        {
+        index = outputImage->ComputeIndex(p);
+        }
 
-      while ( !currentQueue.empty() )
+      const LabelImagePixelType currentMarker = output[p];
+      // iterate over neighbors to propagate the marker
+      for ( unsigned int i = 0; i < numberOfNeighbors; ++i )
         {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
-
-        // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
-        outputIt += shift;
-        inputIt += shift;
-
-        LabelImagePixelType currentMarker = outputIt.GetCenterPixel();
-        // get the current value of the pixel
-        // iterate over neighbors to propagate the marker
-        for ( noIt = outputIt.Begin(), niIt = inputIt.Begin();
-              noIt != outputIt.End();
-              noIt++, niIt++ )
+        if ( border && !region.IsInside(index + neighbors[i]) )
           {
-          if ( noIt.Get() == wsLabel )
-            {
-            // the pixel is not yet processed. It can be labeled with the
-            // current label
-            noIt.Set(currentMarker);
-            InputImagePixelType GrayVal = niIt.Get();
-            if ( GrayVal <= currentValue )
-              {
-              currentQueue.push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
-              }
-            else
-              {
-              fah[GrayVal].push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
-              }
-            progress.CompletedPixel();
-            }
+          continue;
+          }
+        const OffsetValueType q = p + neighborOffsets[i];
+        if ( output[q] == wsLabel )
+          {
+          // the pixel is not yet processed. It can be labeled with the
+          // current label
+          output[q] = currentMarker;
+          fah.Push(std::max(input[q], currentValue), q);
+          progress.CompletedPixel();
           }
         }
       }
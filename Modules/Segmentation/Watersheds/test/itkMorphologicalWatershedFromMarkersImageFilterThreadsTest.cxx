@@ -0,0 +1,193 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMorphologicalWatershedFromMarkersImageFilter.h"
+#include "itkHierarchicalQueue.h"
+#include "itkImageRegionIterator.h"
+#include "itkTestingMacros.h"
+#include <random>
+
+// Check the order of the hierarchical queue, with and without buckets.
+// Then flood a random image with integer and floating point pixels, which
+// use the two kinds of queues, and with several numbers of threads, and
+// check that the labels are the same.
+
+namespace
+{
+
+bool
+TestQueue( bool useBuckets )
+{
+  using QueueType = itk::HierarchicalQueue< short, unsigned int >;
+  QueueType queue;
+  if ( useBuckets )
+    {
+    queue.SetPriorityRange( -20, 20 );
+    }
+
+  std::mt19937 generator( 7 );
+  std::vector< short > priorities;
+  // Values are pushed in increasing order, so that the values of the same
+  // priority come out in increasing order.
+  unsigned int value = 0;
+  for ( ; value < 200; ++value )
+    {
+    const auto priority = static_cast< short >( static_cast< int >( generator() % 41 ) - 20 );
+    priorities.push_back( priority );
+    queue.Push( priority, value );
+    }
+
+  short        lastPriority = -20;
+  unsigned int lastValue = 0;
+  bool         first = true;
+  while ( !queue.Empty() )
+    {
+    const short        priority = queue.GetFrontPriority();
+    const unsigned int popped = queue.Pop();
+    if ( priorities[popped] != priority || priority < lastPriority
+         || ( !first && priority == lastPriority && popped < lastValue ) )
+      {
+      std::cerr << "Wrong order: value " << popped << " of priority " << priorities[popped] << " popped at priority "
+                << priority << " after value " << lastValue << " of priority " << lastPriority << std::endl;
+      return false;
+      }
+    // Flooding pushes values of priorities not lower than the current one.
+    if ( value < 400 && generator() % 2 )
+      {
+      const auto pushed = static_cast< short >( std::min( 20, priority + static_cast< int >( generator() % 3 ) ) );
+      priorities.push_back( pushed );
+      queue.Push( pushed, value++ );
+      }
+    lastPriority = priority;
+    lastValue = popped;
+    first = false;
+    }
+  if ( queue.Size() != 0 )
+    {
+    std::cerr << "The queue is not empty" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+constexpr unsigned int Dimension = 3;
+using ShortImageType = itk::Image< short, Dimension >;
+using FloatImageType = itk::Image< float, Dimension >;
+using LabelImageType = itk::Image< unsigned char, Dimension >;
+
+template< typename TInputImage >
+LabelImageType::Pointer
+Flood( const TInputImage * input, const LabelImageType * markers, bool markWatershedLine, bool fullyConnected,
+       unsigned int numberOfThreads )
+{
+  using FilterType = itk::MorphologicalWatershedFromMarkersImageFilter< TInputImage, LabelImageType >;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  filter->SetMarkerImage( markers );
+  filter->SetMarkWatershedLine( markWatershedLine );
+  filter->SetFullyConnected( fullyConnected );
+  filter->SetNumberOfThreads( numberOfThreads );
+  filter->Update();
+  LabelImageType::Pointer output = filter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+}
+
+int itkMorphologicalWatershedFromMarkersImageFilterThreadsTest( int, char *[] )
+{
+  if ( !TestQueue( true ) || !TestQueue( false ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A region which does not start at the origin, so that the pixels on the
+  // border of the image are found from their index.
+  ShortImageType::RegionType region;
+  region.SetIndex( 0, 3 );
+  region.SetIndex( 1, -2 );
+  region.SetIndex( 2, 5 );
+  region.SetSize( 0, 37 );
+  region.SetSize( 1, 29 );
+  region.SetSize( 2, 11 );
+
+  ShortImageType::Pointer shortImage = ShortImageType::New();
+  shortImage->SetRegions( region );
+  shortImage->Allocate();
+  FloatImageType::Pointer floatImage = FloatImageType::New();
+  floatImage->SetRegions( region );
+  floatImage->Allocate();
+  LabelImageType::Pointer markers = LabelImageType::New();
+  markers->SetRegions( region );
+  markers->Allocate();
+
+  std::mt19937 generator( 42 );
+  itk::ImageRegionIterator< ShortImageType > sit( shortImage, region );
+  itk::ImageRegionIterator< FloatImageType > fit( floatImage, region );
+  itk::ImageRegionIterator< LabelImageType > mit( markers, region );
+  for ( ; !sit.IsAtEnd(); ++sit, ++fit, ++mit )
+    {
+    // Few values, for plateaus.
+    const auto value = static_cast< short >( static_cast< int >( generator() % 12 ) * 50 - 300 );
+    sit.Set( value );
+    fit.Set( value );
+    mit.Set( generator() % 150 == 0 ? static_cast< unsigned char >( 1 + generator() % 5 ) : 0 );
+    }
+
+  for ( unsigned int mode = 0; mode < 4; ++mode )
+    {
+    const bool markWatershedLine = mode & 1;
+    const bool fullyConnected = ( mode & 2 ) != 0;
+    LabelImageType::Pointer reference = Flood( shortImage.GetPointer(), markers.GetPointer(), markWatershedLine,
+                                               fullyConnected, 1 );
+    for ( unsigned int numberOfThreads = 1; numberOfThreads <= 3; numberOfThreads += 2 )
+      {
+      LabelImageType::Pointer shortLabels = Flood( shortImage.GetPointer(), markers.GetPointer(),
+                                                   markWatershedLine, fullyConnected, numberOfThreads );
+      LabelImageType::Pointer floatLabels = Flood( floatImage.GetPointer(), markers.GetPointer(),
+                                                   markWatershedLine, fullyConnected, numberOfThreads );
+      itk::ImageRegionIterator< LabelImageType > rit( reference, region );
+      itk::ImageRegionIterator< LabelImageType > it1( shortLabels, region );
+      itk::ImageRegionIterator< LabelImageType > it2( floatLabels, region );
+      for ( mit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++it1, ++it2, ++mit )
+        {
+        if ( rit.Get() != it1.Get() || rit.Get() != it2.Get() )
+          {
+          std::cerr << "Different labels at " << rit.GetIndex() << " with " << numberOfThreads
+                    << " threads, MarkWatershedLine: " << markWatershedLine << ", FullyConnected: "
+                    << fullyConnected << std::endl;
+          return EXIT_FAILURE;
+          }
+        if ( mit.Get() != 0 && rit.Get() != mit.Get() )
+          {
+          std::cerr << "Marker changed at " << rit.GetIndex() << std::endl;
+          return EXIT_FAILURE;
+          }
+        if ( !markWatershedLine && rit.Get() == 0 )
+          {
+          std::cerr << "Pixel not flooded at " << rit.GetIndex() << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}